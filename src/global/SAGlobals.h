@@ -122,6 +122,7 @@ enum DataType {
 
 
     , VectorDouble				=100    ///< 数组
+    , VectorExpression			=110    ///< 由表达式延迟计算的数组，保存时物化为VectorDouble
     , VectorPoint				=200    ///< 点数组
     , VectorInt				    =300    ///< 数组
     , VectorVariant				=400    ///< 数组
@@ -7,6 +7,7 @@ SUBDIRS = \
           signACommonUI\
           signAScience\
           signACoreFun\
+          signABatch\
           signAPlugin/FunPlugin \
           signAPlugin/TextImport \
           signAPlugin/DsfFileImport \
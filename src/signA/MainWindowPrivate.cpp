@@ -304,6 +304,10 @@ void MainWindowPrivate::setupUi(MainWindow *mainWinowPtr)
     actionDrawIntervalChart = new QAction(mainWinowPtr);
     actionDrawIntervalChart->setObjectName(QStringLiteral("actionDrawIntervalChart"));
 
+    actionDrawSpectrogramChart = new QAction(mainWinowPtr);
+    actionDrawSpectrogramChart->setObjectName(QStringLiteral("actionDrawSpectrogramChart"));
+    actionDrawSpectrogramChart->setIcon(QIcon(":/icons/icons/SpectroChart.svg"));
+
 
 
     actionSelectionRegionMove = new QAction(mainWinowPtr);
@@ -321,6 +325,10 @@ void MainWindowPrivate::setupUi(MainWindow *mainWinowPtr)
     actionFigureEditSubPlotGeometry->setCheckable(true);
     actionFigureEditSubPlotGeometry->setIcon(QIcon(":/icons/icons/subplotEdit.png"));
 
+    actionFigureExportImage = new QAction(mainWinowPtr);
+    actionFigureExportImage->setObjectName(QStringLiteral("actionFigureExportImage"));
+    actionFigureExportImage->setIcon(QIcon(":/icons/icons/export.png"));
+
 
     actionChartEditor = new QActionGroup(mainWinowPtr);
     actionChartEditor->setExclusive(true);
@@ -438,6 +446,7 @@ void MainWindowPrivate::setupUi(MainWindow *mainWinowPtr)
     menuHistogramChart->setIcon(QIcon(":/icons/icons/histogramChart.svg"));
     menuHistogramChart->addAction(actionDrawHistogramChart);
     menuHistogramChart->addAction(actionDrawIntervalChart);
+    menuHistogramChart->addAction(actionDrawSpectrogramChart);
 
     menuBoxChart = new SARibbonMenu(menuBar);
     menuBoxChart->setObjectName(QStringLiteral("menuBoxChart"));
@@ -627,6 +636,7 @@ void MainWindowPrivate::setupUi(MainWindow *mainWinowPtr)
     //figure Opt pannel
     figureOptRibbonPannel = operateRibbonCategory->addPannel("Figure Option");
     figureOptRibbonPannel->addLargeAction(actionFigureEditSubPlotGeometry);
+    figureOptRibbonPannel->addLargeAction(actionFigureExportImage);
 
     //! 3.4 Analysis
     analysisRibbonCategory = menuBar->addCategoryPage(QStringLiteral("Analysis"));
@@ -966,6 +976,7 @@ void MainWindowPrivate::retranslateUi(MainWindow *mainWinowPtr)
     actionSingleSelection->setText(QApplication::translate("MainWindow", "New Select", 0));
     actionAdditionalSelection->setText(QApplication::translate("MainWindow", "Add Select", 0));
     actionDrawIntervalChart->setText(QApplication::translate("MainWindow", "Add Interval", 0));
+    actionDrawSpectrogramChart->setText(QApplication::translate("MainWindow", "Spectrogram", 0));
     actionIntersectionSelection->setText(QApplication::translate("MainWindow", "Int Select", 0));
     actionSubtractionSelection->setText(QApplication::translate("MainWindow", "Sub Select", 0));
     actionDrawScatterChart->setText(QApplication::translate("MainWindow", "Scatter", 0));
@@ -980,6 +991,7 @@ void MainWindowPrivate::retranslateUi(MainWindow *mainWinowPtr)
     actionValueCreatePointVector->setText(QApplication::translate("MainWindow", "point vector", 0));
     actionValueCreateVariantTable->setText(QApplication::translate("MainWindow", "variant table", 0));
     actionFigureEditSubPlotGeometry->setText(QApplication::translate("MainWindow", "Subplot\nEdit", 0));
+    actionFigureExportImage->setText(QApplication::translate("MainWindow", "Export\nImage", 0));
     actionColorMapTable->setText(QApplication::translate("MainWindow", "Highlight\nTable", 0));
     menuFile->setTitle(QApplication::translate("MainWindow", "File", 0));
     menuExport->setTitle(QApplication::translate("MainWindow", "Export", 0));
@@ -111,6 +111,7 @@ public:
     QAction *actionDrawBarChart;
     QAction *actionDrawBoxChart;
     QAction *actionDrawIntervalChart;
+    QAction *actionDrawSpectrogramChart;
     QAction *actionSelectionRegionMove;     ///<
     QAction *actionSelectionRegionDataMove; ///<
 
@@ -121,6 +122,7 @@ public:
 
 
     QAction *actionFigureEditSubPlotGeometry;///< 编辑子窗口位置
+    QAction *actionFigureExportImage;///< 绘图窗口导出为图片
 
 
     QAction *actionSelectSkin;///<
@@ -11,6 +11,7 @@
 #include "SATcpClient.h"
 #include "SATcpDataProcessSocket.h"
 #include "SATcpSocket.h"
+#include "SAServerDefine.h"
 
 
 SADataClient::SADataClient(QObject *p) : QObject(p)
@@ -95,6 +96,16 @@ void SADataClient::request2DPointsDescribe(const QVector<QPointF>& arrs, int seq
 }
 
 
+/**
+ * @brief 取消请求，会触发@sa reqCancel 信号
+ * @param sequenceID
+ */
+void SADataClient::cancelRequest(int sequenceID)
+{
+    emit reqCancel(sequenceID);
+}
+
+
 /**
  * @brief 重试连接服务器
  */
@@ -124,7 +135,13 @@ void SADataClient::onSocketConnected(QAbstractSocket *socket)
         return;
     }
     connect(this, &SADataClient::req2DPointsDescribe, ds, &SATcpDataProcessSocket::request2DPointsDescribe);
+    connect(this, &SADataClient::reqCancel, ds, &SATcpDataProcessSocket::requestCancel);
+    //token握手时会协商数据区的压缩编码，socket位于客户端线程，需要投递过去
+    QMetaObject::invokeMethod(ds, "requestToken", Qt::QueuedConnection
+        , Q_ARG(int, int(QCoreApplication::applicationPid()))
+        , Q_ARG(QString, QString(SA_SERVER_MAIN_APP_ID)));
     connect(ds, &SATcpDataProcessSocket::receive2DPointsDescribe, this, &SADataClient::receive2DPointsDescribe);
+    connect(ds, &SATcpDataProcessSocket::receiveError, this, &SADataClient::receiveRequestError);
 
     emit connectedServeResult(true);
     emit messageInfo(tr("connect calc serve success"));
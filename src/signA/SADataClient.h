@@ -72,6 +72,16 @@ signals:
      */
     void receive2DPointsDescribe(const SAPropertiesGroup& res,int sequenceID,unsigned int extendValue);
 
+    /**
+     * @brief 请求出错，服务端不会再返回此请求的结果
+     *
+     * 被取消的请求也通过此信号结束，errcode为SA::ProtocolErrorCanceled
+     * @param msg 错误信息
+     * @param errcode 错误码 \sa SA::ServeProtocolErrorCode
+     * @param sequenceID 请求的流水号
+     */
+    void receiveRequestError(const QString& msg,int errcode,int sequenceID);
+
     /**
      * @brief 请求2维数据的统计描述
      * @param arrs
@@ -79,6 +89,12 @@ signals:
      */
     void req2DPointsDescribe(const QVector<QPointF>& arrs, int sequenceID, int sortcount);
 
+    /**
+     * @brief 取消请求
+     * @param sequenceID 请求的流水号
+     */
+    void reqCancel(int sequenceID);
+
 public slots:
     //尝试连接服务器，此函数失败会继续重连，由于失败会继续，因此会阻塞
     Q_SLOT void tryConnectToServe(int retrycount = 5, int timeout = 5000);
@@ -86,6 +102,9 @@ public slots:
     //请求二维点描述，会触发@sa req2DPointsDescribe 信号
     Q_SLOT void request2DPointsDescribe(const QVector<QPointF>& arrs, int sequenceID, int sortcount = 20);
 
+    //取消请求，会触发@sa reqCancel 信号，还没有完成的请求会以SA::ProtocolErrorCanceled通过@sa receiveRequestError 返回
+    Q_SLOT void cancelRequest(int sequenceID);
+
 private slots:
     //连接成功槽
     Q_SLOT void onSocketConnected(QAbstractSocket *socket);
@@ -2,6 +2,7 @@
 #include "mainwindow.h"
 
 #include <QTime>
+#include <QtNumeric>
 
 //#include <SAPlotChart.h>
 #include "SAChart2D.h"
@@ -14,6 +15,7 @@
 #include "SAXYSeries.h"
 #include "SAData.h"
 #include "SAScatterSeries.h"
+#include "SASpectrogramSeries.h"
 #include "SAAddLineChartSetDialog.h"
 #include "SAAddCurveTypeDialog.h"
 #include "SAIntervalSeries.h"
@@ -1135,6 +1137,61 @@ QList<QwtPlotTradingCurve *> SADrawDelegate::drawBoxChart(const QList<SAAbstract
     return res;
 }
 
+///
+/// \brief 绘制谱图
+///
+/// 每个二维数据单独一个figure，行对应y，列对应x，范围为行列索引
+/// \param datas 非二维的数据会被忽略
+/// \return
+///
+QList<SASpectrogramSeries *> SADrawDelegate::drawSpectrogram(const QList<SAAbstractDatas *> &datas)
+{
+    QList<SASpectrogramSeries *> res;
+    for(SAAbstractDatas* data : datas)
+    {
+        if(SA::Dim2 != data->getDim())
+        {
+            continue;
+        }
+        const int rows = data->getSize(SA::Dim1);
+        const int cols = data->getSize(SA::Dim2);
+        if(rows <= 0 || cols <= 0)
+        {
+            continue;
+        }
+        QVector<double> values(rows*cols);
+        for(int r=0;r<rows;++r)
+        {
+            for(int c=0;c<cols;++c)
+            {
+                bool isOK = false;
+                const double v = data->getAt(r,c).toDouble(&isOK);
+                values[r*cols+c] = isOK ? v : qQNaN();
+            }
+        }
+        QMdiSubWindow* w = createFigureMdiSubWidget(data->getName());
+        SAFigureWindow* pFigure = getFigureWidgetFromMdiSubWindow(w);
+        SAChart2D* chart = pFigure->current2DPlot();
+        if(!chart)
+        {
+            chart = pFigure->create2DPlot();
+        }
+        SASpectrogramSeries* p = chart->addSpectrogram(values,rows,cols
+                                                       ,QwtInterval(0,cols),QwtInterval(0,rows)
+                                                       ,data->getName());
+        if(p)
+        {
+            res.append(p);
+        }
+        w->show();
+    }
+    if(res.isEmpty())
+    {
+        getMainWindow()->showWarningMessageInfo(tr("invalid data type,spectrogram accept 2D table type"));
+    }
+    return res;
+}
+
 QList<QwtPlotCurve *> SADrawDelegate::drawBoxWithWizard()
 {
     QList<QwtPlotCurve *> res;
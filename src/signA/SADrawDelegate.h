@@ -15,6 +15,7 @@ class SAChart2D;
 class QwtPlotTradingCurve;
 class QwtPlotBarChart;
 class QwtPlotIntervalCurve;
+class SASpectrogramSeries;
 ///
 /// \brief 处理绘图函数
 ///
@@ -66,6 +67,9 @@ public:
     QList<QwtPlotCurve *> drawBoxWithWizard();
     QwtPlotTradingCurve* drawBoxWithWizard(SAAbstractDatas* boxSeries);
 
+//谱图 Spectrogram
+    QList<SASpectrogramSeries*> drawSpectrogram(const QList<SAAbstractDatas*>& datas);
+
 //把QMdiSubWindow的内部SAFigureWidget获取
     static SAFigureWindow* getFigureWidgetFromMdiSubWindow(QMdiSubWindow* w);
     //获取当前可用的绘图
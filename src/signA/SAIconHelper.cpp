@@ -1,5 +1,6 @@
 #include "SAIconHelper.h"
 #include "qwt_plot_item.h"
+#include "SACommonUIGlobal.h"
 #define ICON_FIGURE			QIcon(":/windowIcons/icons/windowIcon/figureWindow.svg")
 #define ICON_LINECHART			QIcon(":/icons/icons/lineChart.svg")
 #define ICON_BARCHART			QIcon(":/icons/icons/barChart.svg")
@@ -58,6 +59,7 @@ QIcon SAIconHelper::getIconByPlotItem(const QwtPlotItem *item)
         return (ICON_HISTOGRAMCHART);
 
     case QwtPlotItem::Rtti_PlotSpectrogram://For QwtPlotSpectrogram
+    case SA::RTTI_SASpectrogram://For SASpectrogramSeries
         return (ICON_SPECTROCHART);
 
     case QwtPlotItem::Rtti_PlotSVG://For QwtPlotSvgItem
@@ -192,6 +192,7 @@ void MainWindow::initUI()
     connect(ui->actionDrawScatterChart, &QAction::triggered, this, &MainWindow::onActionAddScatterChartTriggered);
     connect(ui->actionDrawBoxChart, &QAction::triggered, this, &MainWindow::onActionAddBoxChartTriggered);
     connect(ui->actionDrawIntervalChart, &QAction::triggered, this, &MainWindow::onActionAddIntervalChartTriggered);
+    connect(ui->actionDrawSpectrogramChart, &QAction::triggered, this, &MainWindow::onActionAddSpectrogramChartTriggered);
     //-------------------------------------
     //- value operate
     connect(ui->actionValueCreateWizard, &QAction::triggered, this, &MainWindow::onActionValueCreateWizardTriggered);
@@ -364,6 +365,8 @@ void MainWindow::initUI()
     //figure subplot 编辑
     ui->actionFigureEditSubPlotGeometry->setChecked(false);
     connect(ui->actionFigureEditSubPlotGeometry, &QAction::triggered, this, &MainWindow::onActionFigureEditSubPlotGeometryTriggered);
+    //figure 导出图片
+    connect(ui->actionFigureExportImage, &QAction::triggered, this, &MainWindow::onActionFigureExportImageTriggered);
 
     //窗口激活对应数据特性的mdiSubWindowActived
     connect(ui->mdiArea, &QMdiArea::subWindowActivated
@@ -1402,6 +1405,22 @@ void MainWindow::onActionAddIntervalChartTriggered()
 }
 
 
+///
+/// \brief 绘制谱图
+///
+void MainWindow::onActionAddSpectrogramChartTriggered()
+{
+    QList<SAAbstractDatas *> datas = getSeletedDatas();
+
+    if (datas.size() != 0) {
+        QList<SASpectrogramSeries *> res = m_drawDelegate->drawSpectrogram(datas);
+        if (res.size() > 0) {
+            raiseMainDock();
+        }
+    }
+}
+
+
 ///
 /// \brief 图表开始矩形选框工具
 /// \param b
@@ -1979,6 +1998,33 @@ void MainWindow::onActionFigureEditSubPlotGeometryTriggered(bool on)
 }
 
 
+///
+/// \brief 绘图窗口导出为图片，子图的画布在线程池中并行绘制
+///
+void MainWindow::onActionFigureExportImageTriggered()
+{
+    SAFigureWindow *fig = getCurrentFigureWindow();
+
+    if (nullptr == fig) {
+        showWarningMessageInfo(tr("no figure to export"));
+        return;
+    }
+    QString path = QFileDialog::getSaveFileName(this, tr("Export Image"), QString()
+        , tr("PNG (*.png);;JPEG (*.jpg *.jpeg);;BMP (*.bmp)"));
+
+    if (path.isEmpty()) {
+        return;
+    }
+    QImage image = fig->renderToImage();
+
+    if (!image.save(path)) {
+        showWarningMessageInfo(tr("can not save image to %1").arg(path));
+        return;
+    }
+    showNormalMessageInfo(tr("figure exported to %1").arg(path));
+}
+
+
 ///
 /// \brief 清除项目
 ///
@@ -396,6 +396,9 @@ private slots:
     //IntervalChartTriggered
     void onActionAddIntervalChartTriggered();
 
+    //谱图
+    void onActionAddSpectrogramChartTriggered();
+
     //开始矩形选框工具
     void onActionStartRectSelectTriggered(bool b);
 
@@ -481,6 +484,9 @@ private slots:
     //figure subplot set 子窗口编辑开关
     void onActionFigureEditSubPlotGeometryTriggered(bool on);
 
+    //绘图窗口导出为图片
+    void onActionFigureExportImageTriggered();
+
     /// \}
 
     ///
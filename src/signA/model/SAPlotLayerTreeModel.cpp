@@ -442,6 +442,7 @@ QString SAPlotLayerTreeModel::itemToName(const QwtPlotItem *item)
         return (tr("Histogram Plot"));
 
     case QwtPlotItem::Rtti_PlotSpectrogram://For QwtPlotSpectrogram
+    case SA::RTTI_SASpectrogram://For SASpectrogramSeries
         return (tr("Spectrogram Plot"));
 
     case QwtPlotItem::Rtti_PlotSVG://For QwtPlotSvgItem
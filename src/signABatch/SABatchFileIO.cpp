@@ -0,0 +1,354 @@
+#include "SABatchFileIO.h"
+#include <QCoreApplication>
+#include <QFile>
+#include <QFileInfo>
+#include <QDataStream>
+#include <QTextStream>
+#include <QRegExp>
+#include "SACsvStream.h"
+#include "SADataHeader.h"
+#include "SAValueManager.h"
+#include "SAAbstractDatas.h"
+#include "sa_fun_core.h"
+#define TR(str) \
+    QCoreApplication::translate("SABatchFileIO", str, 0)
+
+//写csv时每次从变量中取出的行数
+#define BATCH_CSV_CHUNK_ROWS    (4096)
+
+//dsf文件的波形类型标记和文件头，格式和DsfFileImport插件一致
+#define DSF_WAVE_TYPE           (100)
+#define DSF_HEADER_OFFSET       (608)
+#define DSF_DATA_OFFSET         (640)
+struct DSF_Header {
+    int KindOfData;
+    float RMSValue;
+    float PpValue;
+    float KurValue;
+    int SampleLen;
+    int SampleFre;
+    short Gain;
+    short Filter;
+    short OutTrigger;
+    short Integral;
+};
+
+static bool read_dsf(const QString& filePath, SABatchWave& wave, QString *errString);
+static bool read_text(const QString& filePath, const SABatchInputOption& opt, SABatchWave& wave, QString *errString);
+static bool read_sad(const QString& filePath, SABatchWave& wave, QString *errString);
+static double fs_from_x(const QVector<double>& xs);
+
+
+/**
+ * @brief 支持读取的文件过滤器
+ * @return
+ */
+QStringList batch_input_name_filters()
+{
+    return (QStringList() << "*.dsf" << "*.csv" << "*.txt" << "*.sad");
+}
+
+
+/**
+ * @brief 读取一个数据文件为波形
+ * @param filePath 文件路径，按后缀识别格式
+ * @param opt 读取设置，opt.fs大于0时覆盖文件中的采样率
+ * @param wave 读取的波形，波形名为不带后缀的文件名
+ * @param errString 错误信息
+ * @return 成功返回true
+ */
+bool batch_read_wave(const QString& filePath, const SABatchInputOption& opt, SABatchWave& wave, QString *errString)
+{
+    QFileInfo fi(filePath);
+    const QString suffix = fi.suffix().toLower();
+    bool isOK = false;
+
+    wave = SABatchWave();
+    if (suffix == "dsf") {
+        isOK = read_dsf(filePath, wave, errString);
+    }else if ((suffix == "csv") || (suffix == "txt")) {
+        isOK = read_text(filePath, opt, wave, errString);
+    }else if (suffix == "sad") {
+        isOK = read_sad(filePath, wave, errString);
+    }else{
+        if (errString) {
+            *errString = TR("unsupported file type:\"%1\"").arg(filePath);
+        }
+        return (false);
+    }
+    if (!isOK) {
+        return (false);
+    }
+    if (opt.fs > 0) {
+        wave.fs = opt.fs;
+    }
+    wave.name = fi.completeBaseName();
+    return (true);
+}
+
+
+/**
+ * @brief 保存变量为sad文件
+ * @param data 变量
+ * @param filePath 文件路径
+ * @param errString 错误信息
+ * @return 成功返回true
+ */
+bool batch_write_sad(const SAAbstractDatas *data, const QString& filePath, QString *errString)
+{
+    QFile file(filePath);
+
+    if (!file.open(QIODevice::WriteOnly)) {
+        if (errString) {
+            *errString = TR("can not write file \"%1\":%2").arg(filePath).arg(file.errorString());
+        }
+        return (false);
+    }
+    QDataStream out(&file);
+
+    data->write(out);
+    if (out.status() != QDataStream::Ok) {
+        if (errString) {
+            *errString = TR("write file \"%1\" error").arg(filePath);
+        }
+        return (false);
+    }
+    return (true);
+}
+
+
+/**
+ * @brief 保存变量为csv文件
+ *
+ * 一维变量一列，二维变量（点序列、表格）按行列展开，内容和数据表格显示的一致
+ * @param data 变量
+ * @param filePath 文件路径
+ * @param errString 错误信息
+ * @return 成功返回true
+ */
+bool batch_write_csv(const SAAbstractDatas *data, const QString& filePath, QString *errString)
+{
+    QFile file(filePath);
+
+    if (!file.open(QIODevice::WriteOnly|QIODevice::Text)) {
+        if (errString) {
+            *errString = TR("can not write file \"%1\":%2").arg(filePath).arg(file.errorString());
+        }
+        return (false);
+    }
+    QTextStream st(&file);
+    const int dim = data->getDim();
+    const int rows = (SA::Dim0 == dim) ? 1 : data->getSize(SA::Dim1);
+    const int cols = (SA::Dim2 == dim) ? data->getSize(SA::Dim2) : 1;
+    QVector<QString> cells(BATCH_CSV_CHUNK_ROWS * cols);
+    QStringList line;
+
+    for (int row = 0; row < rows; row += BATCH_CSV_CHUNK_ROWS)
+    {
+        const int n = qMin(BATCH_CSV_CHUNK_ROWS, rows - row);
+        //按列批量取出一段，再按行写出
+        for (int c = 0; c < cols; ++c)
+        {
+            data->displayRange(row, c, n, cells.data() + c * BATCH_CSV_CHUNK_ROWS);
+        }
+        for (int r = 0; r < n; ++r)
+        {
+            line.clear();
+            for (int c = 0; c < cols; ++c)
+            {
+                line.append(cells[c * BATCH_CSV_CHUNK_ROWS + r]);
+            }
+            st << SACsvStream::toCsvStringLine(line) << '\n';
+        }
+    }
+    st.flush();
+    if (st.status() != QTextStream::Ok) {
+        if (errString) {
+            *errString = TR("write file \"%1\" error").arg(filePath);
+        }
+        return (false);
+    }
+    return (true);
+}
+
+
+/**
+ * @brief 读取dsf波形文件
+ */
+static bool read_dsf(const QString& filePath, SABatchWave& wave, QString *errString)
+{
+    QFile file(filePath);
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (errString) {
+            *errString = TR("can not open file:\"%1\" ,because:%2").arg(filePath).arg(file.errorString());
+        }
+        return (false);
+    }
+    int type = 0;
+
+    if ((4 != file.read((char *)&type, 4)) || (DSF_WAVE_TYPE != type) || (file.size() < DSF_DATA_OFFSET)) {
+        if (errString) {
+            *errString = TR("dsf file is not wave type:\"%1\"").arg(filePath);
+        }
+        return (false);
+    }
+    DSF_Header header;
+
+    file.seek(DSF_HEADER_OFFSET);
+    if (sizeof(DSF_Header) != file.read((char *)(&header), sizeof(DSF_Header))) {
+        if (errString) {
+            *errString = TR("dsf file invalid:\"%1\",can not read wave header").arg(filePath);
+        }
+        return (false);
+    }
+    if ((header.SampleLen <= 0) || (header.SampleLen > 1e8) || (header.SampleFre <= 0)) {
+        if (errString) {
+            *errString = TR("dsf file invalid:\"%1\",SampleLen:%2,SampleFre:%3")
+                .arg(filePath).arg(header.SampleLen).arg(header.SampleFre);
+        }
+        return (false);
+    }
+    QVector<float> y(header.SampleLen);
+    const qint64 totalReadWaveSize = sizeof(float) * qint64(header.SampleLen);
+
+    file.seek(DSF_DATA_OFFSET);
+    if (totalReadWaveSize != file.read((char *)y.data(), totalReadWaveSize)) {
+        if (errString) {
+            *errString = TR("dsf file invalid:\"%1\",data length error").arg(filePath);
+        }
+        return (false);
+    }
+    wave.ys.resize(header.SampleLen);
+    for (int i = 0; i < header.SampleLen; ++i)
+    {
+        wave.ys[i] = y[i];
+    }
+    wave.fs = header.SampleFre;
+    return (true);
+}
+
+
+/**
+ * @brief 读取csv或txt文件
+ *
+ * csv按逗号分隔，txt按空白、逗号、分号分隔，空行忽略
+ */
+static bool read_text(const QString& filePath, const SABatchInputOption& opt, SABatchWave& wave, QString *errString)
+{
+    QFile file(filePath);
+
+    if (!file.open(QIODevice::ReadOnly|QIODevice::Text)) {
+        if (errString) {
+            *errString = TR("can not open file:\"%1\" ,because:%2").arg(filePath).arg(file.errorString());
+        }
+        return (false);
+    }
+    if ((opt.yColumn < 0) || (opt.yColumn == opt.xColumn)) {
+        if (errString) {
+            *errString = TR("invalid y column:%1").arg(opt.yColumn);
+        }
+        return (false);
+    }
+    const bool isCsv = (QFileInfo(filePath).suffix().toLower() == "csv");
+    const QRegExp sep("[\\s,;]+");
+    const bool hasX = (opt.xColumn >= 0);
+    QTextStream st(&file);
+    int lineNum = 0;
+
+    while (!st.atEnd())
+    {
+        const QString str = st.readLine();
+        ++lineNum;
+        if ((lineNum <= opt.skipRows) || str.trimmed().isEmpty()) {
+            continue;
+        }
+        const QStringList sections = isCsv ? SACsvStream::fromCsvLine(str) : str.trimmed().split(sep);
+        bool isOK = (sections.size() > opt.yColumn) && (!hasX || (sections.size() > opt.xColumn));
+        double x = 0, y = 0;
+        if (isOK) {
+            y = sections[opt.yColumn].trimmed().toDouble(&isOK);
+        }
+        if (isOK && hasX) {
+            x = sections[opt.xColumn].trimmed().toDouble(&isOK);
+        }
+        if (!isOK) {
+            if (errString) {
+                *errString = TR("file \"%1\" line %2 is not a number").arg(filePath).arg(lineNum);
+            }
+            return (false);
+        }
+        wave.ys.append(y);
+        if (hasX) {
+            wave.xs.append(x);
+        }
+    }
+    if (hasX) {
+        wave.fs = fs_from_x(wave.xs);
+    }
+    return (true);
+}
+
+
+/**
+ * @brief 读取sad变量文件
+ */
+static bool read_sad(const QString& filePath, SABatchWave& wave, QString *errString)
+{
+    QFile file(filePath);
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (errString) {
+            *errString = TR("can not open file:\"%1\" ,because:%2").arg(filePath).arg(file.errorString());
+        }
+        return (false);
+    }
+    QDataStream in(&file);
+    SADataHeader typeInfo;
+    SAValueManager::IDATA_PTR data;
+
+    try{
+        in >> typeInfo;
+        if (typeInfo.isValid()) {
+            data = SAValueManager::makeDataByType(static_cast<SA::DataType>(typeInfo.getDataType()));
+        }
+        if (data) {
+            data->read(in);
+        }
+    }catch(...) {
+        data = nullptr;
+    }
+    if ((nullptr == data) || (in.status() != QDataStream::Ok)) {
+        if (errString) {
+            *errString = TR("file:\"%1\" failed to read").arg(filePath);
+        }
+        return (false);
+    }
+    if (SA::VectorPoint == data->getType()) {
+        saFun::getPointFVectorXYData(data.get(), wave.xs, wave.ys);
+        wave.fs = fs_from_x(wave.xs);
+        return (true);
+    }
+    if (!saFun::getDoubleVector(data.get(), wave.ys)) {
+        if (errString) {
+            *errString = saFun::getLastErrorString();
+        }
+        return (false);
+    }
+    return (true);
+}
+
+
+/**
+ * @brief 由等间隔的x计算采样率
+ * @return x少于两个或间隔不为正时返回0
+ */
+static double fs_from_x(const QVector<double>& xs)
+{
+    if (xs.size() < 2) {
+        return (0);
+    }
+    const double dt = xs[1] - xs[0];
+
+    return ((dt > 0) ? (1.0 / dt) : 0);
+}
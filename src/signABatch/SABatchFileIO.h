@@ -0,0 +1,31 @@
+#ifndef SABATCHFILEIO_H
+#define SABATCHFILEIO_H
+#include <QString>
+#include <QStringList>
+#include "SABatchPipeline.h"
+class SAAbstractDatas;
+
+/**
+ * @brief 批处理的文件读写
+ *
+ * 支持读取的文件：
+ * - dsf：DSE106采集的波形文件，采样率取自文件头
+ * - csv/txt：按@ref SABatchInputOption 指定的列读取
+ * - sad：工程保存的变量文件，可以是double序列或点序列
+ *
+ * 结果保存为sad（可直接复制到工程的数据目录）或csv
+ */
+
+//支持读取的文件过滤器
+QStringList batch_input_name_filters();
+
+//读取一个数据文件为波形，波形名为文件名
+bool batch_read_wave(const QString& filePath, const SABatchInputOption& opt, SABatchWave& wave, QString *errString);
+
+//保存变量为sad文件，和工程保存变量的格式一致
+bool batch_write_sad(const SAAbstractDatas *data, const QString& filePath, QString *errString);
+
+//保存变量为csv文件
+bool batch_write_csv(const SAAbstractDatas *data, const QString& filePath, QString *errString);
+
+#endif // SABATCHFILEIO_H
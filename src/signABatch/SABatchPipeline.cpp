@@ -0,0 +1,436 @@
+#include "SABatchPipeline.h"
+#include <QCoreApplication>
+#include <QFile>
+#include <QDomDocument>
+#include <QDomElement>
+#include <tuple>
+#include "SAVectorDouble.h"
+#include "SAVectorPointF.h"
+#include "SATableVariant.h"
+#include "sa_fun_core.h"
+#include "sa_fun_dsp.h"
+#include "sa_fun_num.h"
+#include "sa_fun_fit.h"
+#include "sa_fun_preproc.h"
+#define TR(str) \
+    QCoreApplication::translate("SABatchPipeline", str, 0)
+
+static void set_error(QString *errString, const QString& err);
+static bool attr_to_int(const QDomElement& ele, const QString& attr, int& val, QString *errString);
+static bool attr_to_double(const QDomElement& ele, const QString& attr, double& val, QString *errString);
+static bool attr_to_bool(const QDomElement& ele, const QString& attr, bool& val, QString *errString);
+static void make_wave_x(SABatchWave& wave);
+
+
+SABatchPipeline::Step::Step()
+    : type(StepDetrend)
+    , save(false)
+    , window(SA::SADsp::WindowHanning)
+    , fftSize(0)
+    , ampType(SA::SADsp::Amplitude)
+    , pdw(SA::SADsp::MSA)
+    , samplingInterval(0.1)
+    , n(1)
+    , points(5)
+    , power(1)
+{
+}
+
+
+SABatchPipeline::SABatchPipeline() : m_isSaveResult(true)
+{
+}
+
+
+/**
+ * @brief 从xml文件加载流程
+ * @param filePath 流程描述文件
+ * @param errString 错误信息
+ * @return 成功返回true
+ */
+bool SABatchPipeline::load(const QString& filePath, QString *errString)
+{
+    QFile file(filePath);
+
+    if (!file.open(QIODevice::ReadOnly|QIODevice::Text)) {
+        set_error(errString, TR("can not open pipeline file \"%1\":%2").arg(filePath).arg(file.errorString()));
+        return (false);
+    }
+    return (loadFromXml(QString::fromUtf8(file.readAll()), errString));
+}
+
+
+/**
+ * @brief 从xml文本加载流程，格式见类说明
+ * @param xml
+ * @param errString 错误信息
+ * @return 成功返回true，失败时流程保持不变
+ */
+bool SABatchPipeline::loadFromXml(const QString& xml, QString *errString)
+{
+    QDomDocument doc;
+    QString err;
+    int line = 0;
+
+    if (!doc.setContent(xml, &err, &line)) {
+        set_error(errString, TR("pipeline xml error at line %1:%2").arg(line).arg(err));
+        return (false);
+    }
+    QDomElement root = doc.documentElement();
+
+    if (root.tagName() != "pipeline") {
+        set_error(errString, TR("pipeline xml root must be <pipeline>"));
+        return (false);
+    }
+    SABatchPipeline old = *this;
+
+    m_input = SABatchInputOption();
+    m_steps.clear();
+    m_isSaveResult = true;
+    bool isOK = attr_to_bool(root, "save-result", m_isSaveResult, errString);
+    QDomElement input = root.firstChildElement("input");
+
+    if (isOK && !input.isNull()) {
+        isOK = attr_to_int(input, "x-column", m_input.xColumn, errString)
+            && attr_to_int(input, "y-column", m_input.yColumn, errString)
+            && attr_to_int(input, "skip-rows", m_input.skipRows, errString)
+            && attr_to_double(input, "fs", m_input.fs, errString);
+    }
+    for (QDomElement ele = root.firstChildElement("step"); isOK && !ele.isNull(); ele = ele.nextSiblingElement("step"))
+    {
+        isOK = loadStep(ele, errString);
+    }
+    if (isOK && m_steps.isEmpty()) {
+        set_error(errString, TR("pipeline has no step"));
+        isOK = false;
+    }
+    if (!isOK) {
+        *this = old;
+    }
+    return (isOK);
+}
+
+
+const SABatchInputOption& SABatchPipeline::inputOption() const
+{
+    return (m_input);
+}
+
+
+const QList<SABatchPipeline::Step>& SABatchPipeline::steps() const
+{
+    return (m_steps);
+}
+
+
+bool SABatchPipeline::isSaveResult() const
+{
+    return (m_isSaveResult);
+}
+
+
+/**
+ * @brief 对一个波形执行流程
+ * @param wave 波形，执行后为最终的波形
+ * @param results 各步需要保存的结果
+ * @param errString 错误信息
+ * @return 任意一步失败返回false
+ */
+bool SABatchPipeline::run(SABatchWave& wave, QList<IDATA_PTR>& results, QString *errString) const
+{
+    if (wave.ys.isEmpty()) {
+        set_error(errString, TR("wave \"%1\" is empty").arg(wave.name));
+        return (false);
+    }
+    for (int i = 0; i < m_steps.size(); ++i)
+    {
+        if (!runStep(m_steps[i], wave, results, errString)) {
+            if (errString) {
+                *errString = TR("step %1 \"%2\" failed:%3").arg(i+1).arg(m_steps[i].name).arg(*errString);
+            }
+            return (false);
+        }
+    }
+    if (m_isSaveResult) {
+        results.append(makeWaveData(wave, wave.name + "_result"));
+    }
+    return (true);
+}
+
+
+/**
+ * @brief 波形转换为变量
+ * @param wave
+ * @param name 变量名
+ * @return 有x或采样率时为点序列，否则为double序列
+ */
+SABatchPipeline::IDATA_PTR SABatchPipeline::makeWaveData(const SABatchWave& wave, const QString& name)
+{
+    if (wave.xs.isEmpty() && wave.fs <= 0) {
+        return (std::make_shared<SAVectorDouble>(name, wave.ys));
+    }
+    SABatchWave w = wave;
+
+    make_wave_x(w);
+    return (std::make_shared<SAVectorPointF>(name, w.xs, w.ys));
+}
+
+
+bool SABatchPipeline::loadStep(const QDomElement& ele, QString *errString)
+{
+    Step step;
+    const QString fun = ele.attribute("fun");
+
+    if (fun == "detrendDirect") {
+        step.type = StepDetrend;
+    }else if (fun == "setWindow") {
+        step.type = StepWindow;
+        const QString w = ele.attribute("window", "hanning").toLower();
+        if (w == "rect") {
+            step.window = SA::SADsp::WindowRect;
+        }else if (w == "hanning") {
+            step.window = SA::SADsp::WindowHanning;
+        }else if (w == "hamming") {
+            step.window = SA::SADsp::WindowHamming;
+        }else if (w == "blackman") {
+            step.window = SA::SADsp::WindowBlackman;
+        }else if (w == "bartlett") {
+            step.window = SA::SADsp::WindowBartlett;
+        }else {
+            set_error(errString, TR("unknown window \"%1\"").arg(w));
+            return (false);
+        }
+    }else if (fun == "pointSmooth") {
+        step.type = StepPointSmooth;
+        if (!attr_to_int(ele, "points", step.points, errString) || !attr_to_int(ele, "power", step.power, errString)) {
+            return (false);
+        }
+    }else if (fun == "spectrum") {
+        step.type = StepSpectrum;
+        const QString amp = ele.attribute("amp", "amplitude").toLower();
+        if (amp == "magnitude") {
+            step.ampType = SA::SADsp::Magnitude;
+        }else if (amp == "magnitude-db") {
+            step.ampType = SA::SADsp::MagnitudeDB;
+        }else if (amp == "amplitude") {
+            step.ampType = SA::SADsp::Amplitude;
+        }else if (amp == "amplitude-db") {
+            step.ampType = SA::SADsp::AmplitudeDB;
+        }else {
+            set_error(errString, TR("unknown spectrum amplitude type \"%1\"").arg(amp));
+            return (false);
+        }
+        if (!attr_to_int(ele, "fft-size", step.fftSize, errString)) {
+            return (false);
+        }
+    }else if (fun == "powerSpectrum") {
+        step.type = StepPowerSpectrum;
+        const QString pdw = ele.attribute("way", "msa").toLower();
+        if (pdw == "msa") {
+            step.pdw = SA::SADsp::MSA;
+        }else if (pdw == "ssa") {
+            step.pdw = SA::SADsp::SSA;
+        }else if (pdw == "tisa") {
+            step.pdw = SA::SADsp::TISA;
+        }else {
+            set_error(errString, TR("unknown power density way \"%1\"").arg(pdw));
+            return (false);
+        }
+        if (!attr_to_int(ele, "fft-size", step.fftSize, errString)
+            || !attr_to_double(ele, "sampling-interval", step.samplingInterval, errString)) {
+            return (false);
+        }
+    }else if (fun == "statistics") {
+        step.type = StepStatistics;
+    }else if (fun == "polyfit") {
+        step.type = StepPolyfit;
+        if (!attr_to_int(ele, "n", step.n, errString)) {
+            return (false);
+        }
+        if (step.n < 0) {
+            set_error(errString, TR("polyfit order must not be negative"));
+            return (false);
+        }
+    }else {
+        set_error(errString, TR("unknown step fun \"%1\"").arg(fun));
+        return (false);
+    }
+    if (step.fftSize < 0) {
+        set_error(errString, TR("fft size must not be negative"));
+        return (false);
+    }
+    if (!attr_to_bool(ele, "save", step.save, errString)) {
+        return (false);
+    }
+    step.name = ele.attribute("name", fun);
+    m_steps.append(step);
+    return (true);
+}
+
+
+bool SABatchPipeline::runStep(const Step& step, SABatchWave& wave, QList<IDATA_PTR>& results, QString *errString) const
+{
+    switch (step.type)
+    {
+    case StepDetrend:
+        saFun::detrendDirect(wave.ys);
+        break;
+
+    case StepWindow:
+        saFun::setWindow(wave.ys, step.window);
+        break;
+
+    case StepPointSmooth:
+    {
+        QVector<double> ys;
+        if (!saFun::pointSmooth(wave.ys, step.points, step.power, ys)) {
+            set_error(errString, saFun::getLastErrorString());
+            return (false);
+        }
+        wave.ys.swap(ys);
+        break;
+    }
+
+    case StepSpectrum:
+    case StepPowerSpectrum:
+    {
+        if (wave.fs <= 0) {
+            set_error(errString, TR("sample rate is unknown, set fs in <input> or use time domain wave"));
+            return (false);
+        }
+        QVector<double> fre, mag;
+        if (StepSpectrum == step.type) {
+            saFun::spectrum(wave.ys, wave.fs, step.fftSize, step.ampType, fre, mag);
+        }else{
+            saFun::powerSpectrum(wave.ys, wave.fs, step.fftSize, step.pdw, fre, mag, step.samplingInterval);
+        }
+        if (mag.isEmpty()) {
+            set_error(errString, TR("fft failed"));
+            return (false);
+        }
+        wave.xs.swap(fre);
+        wave.ys.swap(mag);
+        wave.fs = 0;
+        break;
+    }
+
+    case StepStatistics:
+    {
+        SAVectorDouble ys(wave.name, wave.ys);
+        std::shared_ptr<SATableVariant> table = saFun::statistics(&ys);
+        if (nullptr == table) {
+            set_error(errString, saFun::getLastErrorString());
+            return (false);
+        }
+        table->setName(wave.name + "_" + step.name);
+        results.append(table);
+        return (true);
+    }
+
+    case StepPolyfit:
+    {
+        SABatchWave w = wave;
+        make_wave_x(w);
+        auto fit = saFun::polyfit(w.xs, w.ys, step.n);
+        std::shared_ptr<SAVectorDouble> factor = std::get<0>(fit);
+        std::shared_ptr<SATableVariant> info = std::get<1>(fit);
+        if (nullptr == factor || nullptr == info) {
+            set_error(errString, saFun::getLastErrorString());
+            return (false);
+        }
+        factor->setName(QString("%1_%2_%3Factor").arg(wave.name).arg(step.name).arg(step.n));
+        info->setName(QString("%1_%2_%3ErrInfo").arg(wave.name).arg(step.name).arg(step.n));
+        results.append(factor);
+        results.append(info);
+        return (true);
+    }
+
+    default:
+        set_error(errString, TR("unknown step"));
+        return (false);
+    }
+    if (step.save) {
+        results.append(makeWaveData(wave, wave.name + "_" + step.name));
+    }
+    return (true);
+}
+
+
+static void set_error(QString *errString, const QString& err)
+{
+    if (errString) {
+        *errString = err;
+    }
+}
+
+
+static bool attr_to_int(const QDomElement& ele, const QString& attr, int& val, QString *errString)
+{
+    if (!ele.hasAttribute(attr)) {
+        return (true);
+    }
+    bool isOK = false;
+    int v = ele.attribute(attr).toInt(&isOK);
+
+    if (!isOK) {
+        set_error(errString, TR("attribute \"%1\" of <%2> must be an integer").arg(attr).arg(ele.tagName()));
+        return (false);
+    }
+    val = v;
+    return (true);
+}
+
+
+static bool attr_to_double(const QDomElement& ele, const QString& attr, double& val, QString *errString)
+{
+    if (!ele.hasAttribute(attr)) {
+        return (true);
+    }
+    bool isOK = false;
+    double v = ele.attribute(attr).toDouble(&isOK);
+
+    if (!isOK) {
+        set_error(errString, TR("attribute \"%1\" of <%2> must be a number").arg(attr).arg(ele.tagName()));
+        return (false);
+    }
+    val = v;
+    return (true);
+}
+
+
+static bool attr_to_bool(const QDomElement& ele, const QString& attr, bool& val, QString *errString)
+{
+    if (!ele.hasAttribute(attr)) {
+        return (true);
+    }
+    const QString v = ele.attribute(attr).toLower();
+
+    if ((v == "true") || (v == "1")) {
+        val = true;
+    }else if ((v == "false") || (v == "0")) {
+        val = false;
+    }else{
+        set_error(errString, TR("attribute \"%1\" of <%2> must be true or false").arg(attr).arg(ele.tagName()));
+        return (false);
+    }
+    return (true);
+}
+
+
+/**
+ * @brief 补全波形的x，有采样率时为i/fs，否则为索引
+ */
+static void make_wave_x(SABatchWave& wave)
+{
+    if (!wave.xs.isEmpty()) {
+        return;
+    }
+    const int size = wave.ys.size();
+    const double dt = (wave.fs > 0) ? (1.0 / wave.fs) : 1.0;
+
+    wave.xs.resize(size);
+    for (int i = 0; i < size; ++i)
+    {
+        wave.xs[i] = i * dt;
+    }
+}
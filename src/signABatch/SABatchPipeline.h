@@ -0,0 +1,113 @@
+#ifndef SABATCHPIPELINE_H
+#define SABATCHPIPELINE_H
+#include <QString>
+#include <QList>
+#include <QVector>
+#include <memory>
+#include "SADsp.h"
+class SAAbstractDatas;
+class QDomElement;
+
+/**
+ * @brief 批处理中流动的波形
+ *
+ * xs为空时x为等间隔序列i/fs，fs也无效时x为索引
+ */
+struct SABatchWave {
+    QString name;           ///< 波形名，一般为文件名，结果的变量名以此为前缀
+    QVector<double> xs;
+    QVector<double> ys;
+    double fs;              ///< 采样率，小于等于0表示未知，频谱后置为0
+    SABatchWave() : fs(0)
+    {
+    }
+};
+
+/**
+ * @brief 数据文件的读取设置，对应流程描述中的input元素
+ */
+struct SABatchInputOption {
+    int xColumn;            ///< 文本文件中x所在的列，-1表示没有x列
+    int yColumn;            ///< 文本文件中y所在的列
+    int skipRows;           ///< 文本文件开头跳过的行数（表头）
+    double fs;              ///< 采样率，大于0时覆盖文件中的采样率
+    SABatchInputOption() : xColumn(-1), yColumn(0), skipRows(0), fs(0)
+    {
+    }
+};
+
+/**
+ * @brief 批处理流程
+ *
+ * 流程由xml描述，每个step对应一个saFun函数，按顺序作用在波形上：
+ * @code
+ * <pipeline save-result="true">
+ *   <input x-column="-1" y-column="0" skip-rows="1" fs="0"/>
+ *   <step fun="detrendDirect"/>
+ *   <step fun="setWindow" window="hanning"/>
+ *   <step fun="spectrum" fft-size="0" amp="amplitude" save="true"/>
+ *   <step fun="statistics"/>
+ *   <step fun="polyfit" n="3"/>
+ * </pipeline>
+ * @endcode
+ * 变换波形的step（detrendDirect、setWindow、pointSmooth、spectrum、powerSpectrum）设置save="true"时
+ * 保存变换后的波形，统计类的step（statistics、polyfit）不改变波形，总是保存结果，
+ * save-result为true时保存最终的波形
+ *
+ * 流程只保存参数，@ref run 可以在多个线程中同时调用
+ */
+class SABatchPipeline
+{
+public:
+    enum StepType {
+        StepDetrend
+        , StepWindow
+        , StepPointSmooth
+        , StepSpectrum
+        , StepPowerSpectrum
+        , StepStatistics
+        , StepPolyfit
+    };
+    struct Step {
+        StepType type;
+        bool save;                                      ///< 是否保存此步的结果波形
+        QString name;                                   ///< 结果变量名的后缀
+        SA::SADsp::WindowType window;                   ///< setWindow的窗
+        int fftSize;                                    ///< spectrum、powerSpectrum的fft长度，0为自动
+        SA::SADsp::SpectrumType ampType;                ///< spectrum的幅值类型
+        SA::SADsp::PowerDensityWay pdw;                 ///< powerSpectrum的功率谱估计方法
+        double samplingInterval;                        ///< powerSpectrum TISA方法的采样间隔
+        int n;                                          ///< polyfit的阶次
+        int points;                                     ///< pointSmooth的点数
+        int power;                                      ///< pointSmooth的次数
+        Step();
+    };
+    typedef std::shared_ptr<SAAbstractDatas> IDATA_PTR;
+
+    SABatchPipeline();
+    //从xml文件加载流程
+    bool load(const QString& filePath, QString *errString = nullptr);
+    //从xml文本加载流程
+    bool loadFromXml(const QString& xml, QString *errString = nullptr);
+
+    const SABatchInputOption& inputOption() const;
+    const QList<Step>& steps() const;
+    bool isSaveResult() const;
+
+    //对一个波形执行流程，结果追加到results
+    bool run(SABatchWave& wave, QList<IDATA_PTR>& results, QString *errString = nullptr) const;
+
+    //波形转换为变量，有x时为点序列，否则为double序列
+    static IDATA_PTR makeWaveData(const SABatchWave& wave, const QString& name);
+
+private:
+    bool loadStep(const QDomElement& ele, QString *errString);
+    bool runStep(const Step& step, SABatchWave& wave, QList<IDATA_PTR>& results, QString *errString) const;
+
+private:
+    SABatchInputOption m_input;
+    QList<Step> m_steps;
+    bool m_isSaveResult;
+};
+
+#endif // SABATCHPIPELINE_H
@@ -0,0 +1,191 @@
+#include "SABatchRunner.h"
+#include <QCoreApplication>
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
+#include <QDir>
+#include <QFileInfo>
+#include <QHash>
+#include <QElapsedTimer>
+#include <stdio.h>
+#include "SAAbstractDatas.h"
+#include "SABatchFileIO.h"
+#define TR(str) \
+    QCoreApplication::translate("SABatchRunner", str, 0)
+
+/**
+ * @brief 处理一个文件的任务
+ */
+class SABatchFileRunable : public QRunnable
+{
+public:
+    SABatchFileRunable(SABatchRunner *runner, const QString& filePath)
+        : m_runner(runner)
+        , m_filePath(filePath)
+    {
+        setAutoDelete(true);
+    }
+
+
+    void run() override
+    {
+        QString err;
+        QElapsedTimer timer;
+
+        timer.start();
+        bool isSuccess = m_runner->processFile(m_filePath, &err);
+
+        m_runner->report(m_filePath, isSuccess, isSuccess ? TR("%1 ms").arg(timer.elapsed()) : err);
+    }
+
+
+private:
+    SABatchRunner *m_runner;
+    QString m_filePath;
+};
+
+
+SABatchRunner::SABatchRunner(const SABatchPipeline& pipeline, const QString& outputDir, OutputFormat fmt)
+    : m_pipeline(pipeline)
+    , m_outputDir(outputDir)
+    , m_format(fmt)
+    , m_jobs(0)
+    , m_total(0)
+{
+}
+
+
+void SABatchRunner::setJobs(int jobs)
+{
+    m_jobs = jobs;
+}
+
+
+int SABatchRunner::jobs() const
+{
+    return ((m_jobs > 0) ? m_jobs : qMax(1, QThread::idealThreadCount()));
+}
+
+
+/**
+ * @brief 处理所有文件
+ *
+ * 使用独立的线程池，线程数即同时处理的文件数
+ * @param files 文件列表
+ * @return 失败的文件数，输出目录无法创建或输入文件重名时所有文件都算失败
+ */
+int SABatchRunner::run(const QStringList& files)
+{
+    m_total = files.size();
+    m_finished.store(0);
+    m_failed.store(0);
+    if (!checkDuplicateNames(files)) {
+        return (m_total);
+    }
+    if (!QDir().mkpath(m_outputDir)) {
+        fprintf(stderr, "%s\n", TR("can not make output dir:%1").arg(m_outputDir).toLocal8Bit().constData());
+        return (m_total);
+    }
+    QThreadPool pool;
+
+    pool.setMaxThreadCount(jobs());
+    for (const QString& f : files)
+    {
+        pool.start(new SABatchFileRunable(this, f));
+    }
+    pool.waitForDone();
+    return (m_failed.load());
+}
+
+
+/**
+ * @brief 检查输入文件的文件名（不含后缀）是否重复
+ *
+ * 结果文件名由输入文件名和步骤名组成，重名的输入在不同线程中会写出同一个结果文件，互相覆盖
+ * @param files 文件列表
+ * @return 没有重名返回true
+ */
+bool SABatchRunner::checkDuplicateNames(const QStringList& files) const
+{
+    QHash<QString, QString> names;
+    bool isOK = true;
+
+    for (const QString& f : files)
+    {
+        QString name = QFileInfo(f).completeBaseName();
+#ifdef Q_OS_WIN
+        //windows的文件名不区分大小写
+        name = name.toLower();
+#endif
+        auto i = names.constFind(name);
+        if (i != names.constEnd()) {
+            fprintf(stderr, "%s\n", TR("duplicate input file name:\"%1\" and \"%2\" write the same output files")
+                .arg(i.value()).arg(f).toLocal8Bit().constData());
+            isOK = false;
+            continue;
+        }
+        names.insert(name, f);
+    }
+    return (isOK);
+}
+
+
+/**
+ * @brief 处理一个文件：读取、执行流程、保存结果
+ * @param filePath 文件路径
+ * @param errString 错误信息
+ * @return 成功返回true
+ */
+bool SABatchRunner::processFile(const QString& filePath, QString *errString) const
+{
+    SABatchWave wave;
+
+    if (!batch_read_wave(filePath, m_pipeline.inputOption(), wave, errString)) {
+        return (false);
+    }
+    QList<SABatchPipeline::IDATA_PTR> results;
+
+    if (!m_pipeline.run(wave, results, errString)) {
+        return (false);
+    }
+    //波形不再需要，先释放再保存
+    wave = SABatchWave();
+    const QString suffix = (OutputCsv == m_format) ? "csv" : "sad";
+
+    for (const SABatchPipeline::IDATA_PTR& d : results)
+    {
+        const QString path = QDir(m_outputDir).filePath(d->getName() + "." + suffix);
+        const bool isOK = (OutputCsv == m_format)
+            ? batch_write_csv(d.get(), path, errString)
+            : batch_write_sad(d.get(), path, errString);
+        if (!isOK) {
+            return (false);
+        }
+    }
+    return (true);
+}
+
+
+/**
+ * @brief 汇报一个文件的处理结果，输出到标准输出，失败时输出到标准错误
+ * @param filePath 文件路径
+ * @param isSuccess 是否成功
+ * @param msg 成功时为耗时，失败时为错误信息
+ */
+void SABatchRunner::report(const QString& filePath, bool isSuccess, const QString& msg)
+{
+    const int finished = m_finished.fetchAndAddOrdered(1) + 1;
+
+    if (!isSuccess) {
+        m_failed.fetchAndAddOrdered(1);
+    }
+    QMutexLocker locker(&m_reportMutex);
+    const QString line = QString("[%1/%2] %3 %4:%5")
+        .arg(finished).arg(m_total)
+        .arg(isSuccess ? "ok" : "failed")
+        .arg(filePath)
+        .arg(msg);
+
+    fprintf(isSuccess ? stdout : stderr, "%s\n", line.toLocal8Bit().constData());
+    fflush(isSuccess ? stdout : stderr);
+}
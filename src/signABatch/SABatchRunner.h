@@ -0,0 +1,56 @@
+#ifndef SABATCHRUNNER_H
+#define SABATCHRUNNER_H
+#include <QString>
+#include <QStringList>
+#include <QMutex>
+#include <QAtomicInt>
+#include "SABatchPipeline.h"
+
+/**
+ * @brief 批处理的执行者
+ *
+ * 每个文件是一个任务，任务在工作线程中完成读取、计算和保存，保存后释放所有数据，
+ * 因此同时驻留在内存中的文件数不超过线程数，内存占用和文件总数无关
+ *
+ * 每个文件的结果保存在输出目录下，文件名为变量名，sad格式可以直接复制到工程的数据目录
+ *
+ * 变量名以输入文件的文件名（不含后缀）开头，文件名相同的输入（例如不同目录下的同名文件）会写出相同的结果文件，
+ * 因此开始前会检查，有重名时不处理任何文件
+ */
+class SABatchRunner
+{
+public:
+    enum OutputFormat {
+        OutputSad
+        , OutputCsv
+    };
+    SABatchRunner(const SABatchPipeline& pipeline, const QString& outputDir, OutputFormat fmt);
+    //设置并行的线程数，小于等于0时使用cpu核数
+    void setJobs(int jobs);
+    int jobs() const;
+
+    //处理所有文件，阻塞直到全部完成，返回失败的文件数
+    int run(const QStringList& files);
+
+    //处理一个文件，在工作线程中调用
+    bool processFile(const QString& filePath, QString *errString) const;
+
+    //汇报一个文件的处理结果，可以在多个线程中调用
+    void report(const QString& filePath, bool isSuccess, const QString& msg);
+
+private:
+    //检查输入文件的文件名（不含后缀）是否重复，重复的文件输出到标准错误
+    bool checkDuplicateNames(const QStringList& files) const;
+
+private:
+    const SABatchPipeline& m_pipeline;
+    QString m_outputDir;
+    OutputFormat m_format;
+    int m_jobs;
+    int m_total;
+    QAtomicInt m_finished;
+    QAtomicInt m_failed;
+    QMutex m_reportMutex;
+};
+
+#endif // SABATCHRUNNER_H
@@ -0,0 +1,109 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDir>
+#include <QFileInfo>
+#include <QElapsedTimer>
+#include <stdio.h>
+#include "SABatchPipeline.h"
+#include "SABatchRunner.h"
+#include "SABatchFileIO.h"
+
+/**
+ * @brief 展开输入，目录展开为目录下所有支持的文件（不递归）
+ * @param inputs 命令行给出的文件和目录
+ * @return 文件列表
+ */
+static QStringList expand_input_files(const QStringList& inputs)
+{
+    QStringList files;
+
+    for (const QString& input : inputs)
+    {
+        QFileInfo fi(input);
+        if (!fi.isDir()) {
+            files.append(input);
+            continue;
+        }
+        QDir dir(input);
+        const QFileInfoList infos = dir.entryInfoList(batch_input_name_filters(), QDir::Files|QDir::NoSymLinks, QDir::Name);
+        for (const QFileInfo& f : infos)
+        {
+            files.append(f.absoluteFilePath());
+        }
+    }
+    return (files);
+}
+
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+
+    QCoreApplication::setApplicationName("signABatch");
+    QCommandLineParser parser;
+
+    parser.setApplicationDescription(QCoreApplication::translate("main", "run a saFun pipeline over data files without gui"));
+    parser.addHelpOption();
+    QCommandLineOption pipelineOption(QStringList() << "p" << "pipeline"
+        , QCoreApplication::translate("main", "pipeline description xml file")
+        , "file");
+    QCommandLineOption outputOption(QStringList() << "o" << "output"
+        , QCoreApplication::translate("main", "output directory")
+        , "dir");
+    QCommandLineOption formatOption(QStringList() << "f" << "format"
+        , QCoreApplication::translate("main", "output format, sad or csv")
+        , "format", "sad");
+    QCommandLineOption jobsOption(QStringList() << "j" << "jobs"
+        , QCoreApplication::translate("main", "number of files processed at the same time, default is cpu count")
+        , "n", "0");
+
+    parser.addOption(pipelineOption);
+    parser.addOption(outputOption);
+    parser.addOption(formatOption);
+    parser.addOption(jobsOption);
+    parser.addPositionalArgument("inputs", QCoreApplication::translate("main", "data files (dsf,csv,txt,sad) or directories"), "inputs...");
+    parser.process(a);
+
+    if (!parser.isSet(pipelineOption) || !parser.isSet(outputOption) || parser.positionalArguments().isEmpty()) {
+        fprintf(stderr, "%s\n", parser.helpText().toLocal8Bit().constData());
+        return (1);
+    }
+    const QString format = parser.value(formatOption).toLower();
+
+    if ((format != "sad") && (format != "csv")) {
+        fprintf(stderr, "unknown format:%s\n", format.toLocal8Bit().constData());
+        return (1);
+    }
+    bool isOK = false;
+    const int jobs = parser.value(jobsOption).toInt(&isOK);
+
+    if (!isOK) {
+        fprintf(stderr, "invalid jobs:%s\n", parser.value(jobsOption).toLocal8Bit().constData());
+        return (1);
+    }
+    SABatchPipeline pipeline;
+    QString err;
+
+    if (!pipeline.load(parser.value(pipelineOption), &err)) {
+        fprintf(stderr, "%s\n", err.toLocal8Bit().constData());
+        return (1);
+    }
+    const QStringList files = expand_input_files(parser.positionalArguments());
+
+    if (files.isEmpty()) {
+        fprintf(stderr, "no input file\n");
+        return (1);
+    }
+    SABatchRunner runner(pipeline, parser.value(outputOption)
+        , (format == "csv") ? SABatchRunner::OutputCsv : SABatchRunner::OutputSad);
+
+    runner.setJobs(jobs);
+    QElapsedTimer timer;
+
+    timer.start();
+    const int failed = runner.run(files);
+
+    fprintf(stdout, "%d files, %d failed, %d jobs, %lld ms\n"
+        , files.size(), failed, runner.jobs(), timer.elapsed());
+    return ((0 == failed) ? 0 : 2);
+}
@@ -0,0 +1,48 @@
+#-------------------------------------------------
+#
+# 无界面的批处理程序
+#
+# 按流程描述文件对大量数据文件依次执行saFun函数（去直流、加窗、频谱、统计、拟合等），
+# 多个文件在线程池中并行处理，结果保存为sad或csv文件，用于夜间等无人值守的批量计算
+#
+#-------------------------------------------------
+message("--------------SA Batch 批处理程序--------------------------")
+message(Qt version: $$[QT_VERSION])
+message(Qt is installed in $$[QT_INSTALL_PREFIX])
+win32-msvc*:QMAKE_CXXFLAGS += /wd"4819" #忽略warning C4819: 该文件包含不能在当前代码页(936)中表示的字符。请将该文件保存为 Unicode 格式以防止数据丢失
+
+QT += core gui
+QT += xml
+#signALib的头文件引用了QtWidgets，程序本身不创建任何窗口，使用QCoreApplication运行
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+include(../sa_common.pri)
+
+DESTDIR = $$SA_BIN_DIR
+OTHER_FILES += readme.md
+
+TARGET = signABatch
+TEMPLATE = app
+CONFIG += c++11
+CONFIG += console
+CONFIG -= app_bundle
+INCLUDEPATH += $$PWD
+
+
+SOURCES += main.cpp \
+    SABatchPipeline.cpp \
+    SABatchFileIO.cpp \
+    SABatchRunner.cpp
+
+HEADERS += \
+    SABatchPipeline.h \
+    SABatchFileIO.h \
+    SABatchRunner.h
+
+
+#sa api support
+#{
+include($$PWD/../signAUtil/signAUtil.pri)
+include($$PWD/../signALib/signALib.pri)
+include($$PWD/../signAScience/signAScience.pri)
+include($$PWD/../signACoreFun/signACoreFun.pri)
+#}
@@ -7,6 +7,7 @@
 #include "qwt_plot_spectrocurve.h"
 #include "qwt_plot_tradingcurve.h"
 #include "SAChart.h"
+#include <QCache>
 class QwtPlotItemDataModelPrivate
 {
     SA_IMPL_PUBLIC(QwtPlotItemDataModel)
@@ -19,10 +20,14 @@ public:
     bool m_enableBkColor;///< 是否允许背景色
     int m_bkAlpha;///< 背景透明度
     QMap<int,QPair<QwtPlotItem*,int> > m_columnMap;
+    int m_fetchedRowCount;///< 已提供给视图的数据行数
+    QCache<quint64,QVector<double> > m_dataCache;///< 数据缓存，键为列号和块号
     QwtPlotItemDataModelPrivate(QwtPlotItemDataModel* d):q_ptr(d)
       ,m_rowCount(0)
       ,m_enableBkColor(true)
       ,m_bkAlpha(30)
+      ,m_fetchedRowCount(0)
+      ,m_dataCache(SA_PLOT_ITEM_DATA_MODEL_CACHE_BLOCKS)
     {
 
     }
@@ -34,6 +39,8 @@ QwtPlotItemDataModel::QwtPlotItemDataModel(QObject* p)
     :QAbstractTableModel(p)
     ,d_ptr(new QwtPlotItemDataModelPrivate(this))
 {
+    //数据和行列都在模型重置时更新，缓存随之失效
+    connect(this,&QAbstractItemModel::modelReset,this,&QwtPlotItemDataModel::clearDataCache);
 }
 
 QwtPlotItemDataModel::~QwtPlotItemDataModel()
@@ -45,6 +52,8 @@ void QwtPlotItemDataModel::setPlotItems(const QList<QwtPlotItem*>& items)
 {
     beginResetModel();
     d_ptr->m_items = items;
+    d_ptr->m_rowCount = 0;
+    d_ptr->m_fetchedRowCount = 0;
     updateRowCount();
     updateColumnCount();
     updateItemColor();
@@ -62,6 +71,7 @@ void QwtPlotItemDataModel::clear()
 {
     beginResetModel();
     d_ptr->m_rowCount = 0;
+    d_ptr->m_fetchedRowCount = 0;
     d_ptr->m_items.clear();
     d_ptr->m_itemsRowCount.clear();
     d_ptr->m_itemsColor.clear();
@@ -73,7 +83,7 @@ void QwtPlotItemDataModel::clear()
 int QwtPlotItemDataModel::rowCount(const QModelIndex& parent) const
 {
     Q_UNUSED(parent);
-    return d_ptr->m_rowCount;
+    return d_ptr->m_fetchedRowCount;
 }
 
 int QwtPlotItemDataModel::columnCount(const QModelIndex& parent) const
@@ -81,6 +91,42 @@ int QwtPlotItemDataModel::columnCount(const QModelIndex& parent) const
     Q_UNUSED(parent);
     return d_ptr->m_columnMap.size();
 }
+///
+/// \brief 是否还有数据行没有提供给视图
+/// \param parent
+/// \return
+///
+bool QwtPlotItemDataModel::canFetchMore(const QModelIndex &parent) const
+{
+    if(parent.isValid())
+        return false;
+    return d_ptr->m_fetchedRowCount < d_ptr->m_rowCount;
+}
+///
+/// \brief 视图滚动到底部时再提供一页数据行
+///
+/// 插入的行范围通过rowCount前后的差值计算，子类在rowCount附加的行也能正确通知视图
+/// \param parent
+///
+void QwtPlotItemDataModel::fetchMore(const QModelIndex &parent)
+{
+    if(!canFetchMore(parent))
+        return;
+    const int oldFetched = d_ptr->m_fetchedRowCount;
+    const int fetched = qMin(d_ptr->m_rowCount,oldFetched + SA_PLOT_ITEM_DATA_MODEL_FETCH_ROWS);
+    const int first = rowCount(parent);
+    d_ptr->m_fetchedRowCount = fetched;
+    const int last = rowCount(parent) - 1;
+    d_ptr->m_fetchedRowCount = oldFetched;
+    if(last < first)
+    {
+        d_ptr->m_fetchedRowCount = fetched;
+        return;
+    }
+    beginInsertRows(QModelIndex(),first,last);
+    d_ptr->m_fetchedRowCount = fetched;
+    endInsertRows();
+}
 
 QVariant QwtPlotItemDataModel::headerData(int section, Qt::Orientation orientation, int role) const
 {
@@ -124,7 +170,7 @@ QVariant QwtPlotItemDataModel::data(const QModelIndex& index, int role) const
 
         if(index.row() >= getItemRowCount(item))
             return QVariant();
-        return getItemData(index.row(),col,item);
+        return cachedItemData(index.row(),index.column(),col,item);
     }
     else if(role == Qt::BackgroundColorRole)
     {
@@ -226,6 +272,7 @@ int QwtPlotItemDataModel::calcPlotMultiBarChartDim(const QwtPlotMultiBarChart *p
 ///
 void QwtPlotItemDataModel::updateRowCount()
 {
+    const int oldRowCount = d_ptr->m_rowCount;
     d_ptr->m_rowCount = 0;
     d_ptr->m_itemsRowCount.clear();
     for(auto i = d_ptr->m_items.begin ();i!=d_ptr->m_items.end ();++i)
@@ -237,6 +284,14 @@ void QwtPlotItemDataModel::updateRowCount()
         }
         d_ptr->m_itemsRowCount[*i] = dataCount;
     }
+    //之前已经全部提供给视图的保持全部提供，否则至少提供一页
+    if(oldRowCount > 0 && d_ptr->m_fetchedRowCount >= oldRowCount)
+    {
+        d_ptr->m_fetchedRowCount = d_ptr->m_rowCount;
+    }
+    d_ptr->m_fetchedRowCount = qBound(qMin(d_ptr->m_rowCount,SA_PLOT_ITEM_DATA_MODEL_FETCH_ROWS)
+                                      ,d_ptr->m_fetchedRowCount
+                                      ,d_ptr->m_rowCount);
 }
 ///
 /// \brief 更新列数
@@ -524,6 +579,57 @@ double QwtPlotItemDataModel::getItemData(int row, int col, QwtPlotItem *item) co
     return nan();
 }
 ///
+/// \brief 批量获取数据
+///
+/// 默认逐个调用getItemData，数据连续存放的子类可以重载以批量读取
+/// \param row 开始的行
+/// \param col 以数据为基准的列
+/// \param count 最多读取的个数
+/// \param item
+/// \param out 输出，长度至少为count
+/// \return 实际读取的个数
+///
+int QwtPlotItemDataModel::getItemDatas(int row, int col, int count, QwtPlotItem *item, double *out) const
+{
+    const int n = qBound(0,getItemRowCount(item) - row,count);
+    for(int i=0;i<n;++i)
+    {
+        out[i] = getItemData(row+i,col,item);
+    }
+    return n;
+}
+///
+/// \brief 从缓存获取数据，块不存在时通过getItemDatas整块读取
+/// \param row 行号
+/// \param tableCol 表格的列号
+/// \param col 以数据为基准的列
+/// \param item
+/// \return
+///
+double QwtPlotItemDataModel::cachedItemData(int row, int tableCol, int col, QwtPlotItem *item) const
+{
+    const int block = row / SA_PLOT_ITEM_DATA_MODEL_CACHE_BLOCK_ROWS;
+    const int offset = row - block * SA_PLOT_ITEM_DATA_MODEL_CACHE_BLOCK_ROWS;
+    const quint64 key = (quint64(tableCol) << 32) | quint32(block);
+    QVector<double>* values = d_ptr->m_dataCache.object(key);
+    if(nullptr == values)
+    {
+        values = new QVector<double>(SA_PLOT_ITEM_DATA_MODEL_CACHE_BLOCK_ROWS);
+        const int n = getItemDatas(block * SA_PLOT_ITEM_DATA_MODEL_CACHE_BLOCK_ROWS,col
+                                   ,SA_PLOT_ITEM_DATA_MODEL_CACHE_BLOCK_ROWS,item,values->data());
+        values->resize(n);
+        d_ptr->m_dataCache.insert(key,values);
+    }
+    if(offset >= values->size())
+        return nan();
+    return values->at(offset);
+}
+
+void QwtPlotItemDataModel::clearDataCache()
+{
+    d_ptr->m_dataCache.clear();
+}
+///
 /// \brief 获取绘图数据维度的描述
 /// \param item
 /// \param index
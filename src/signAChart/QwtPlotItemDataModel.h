@@ -12,9 +12,34 @@
 class QwtPlotMultiBarChart;
 class QwtPlotItemDataModelPrivate;
 #define QwtPlotItemDataModel_Use_Dynamic_Cast 0
+
+///
+/// \def 视图每次向模型获取的数据行数
+///
+#ifndef SA_PLOT_ITEM_DATA_MODEL_FETCH_ROWS
+#define SA_PLOT_ITEM_DATA_MODEL_FETCH_ROWS 65536
+#endif
+
+///
+/// \def 数据缓存中每块的行数
+///
+#ifndef SA_PLOT_ITEM_DATA_MODEL_CACHE_BLOCK_ROWS
+#define SA_PLOT_ITEM_DATA_MODEL_CACHE_BLOCK_ROWS 256
+#endif
+
+///
+/// \def 数据缓存的最大块数，只需覆盖可见范围附近
+///
+#ifndef SA_PLOT_ITEM_DATA_MODEL_CACHE_BLOCKS
+#define SA_PLOT_ITEM_DATA_MODEL_CACHE_BLOCKS 256
+#endif
+
 ///
 /// \brief 显示item数据的tablemodel
 ///
+/// 数据行按SA_PLOT_ITEM_DATA_MODEL_FETCH_ROWS分页通过canFetchMore/fetchMore提供给视图，
+/// 单元格的值按块通过getItemDatas批量读取，只缓存最近访问的块，模型重置时缓存清空
+///
 class SA_CHART_EXPORT QwtPlotItemDataModel : public QAbstractTableModel
 {
     Q_OBJECT
@@ -61,6 +86,8 @@ public:
 public:
     int rowCount(const QModelIndex &parent = QModelIndex()) const;
     int columnCount(const QModelIndex &parent = QModelIndex()) const;
+    bool canFetchMore(const QModelIndex &parent) const;
+    void fetchMore(const QModelIndex &parent);
     QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const;
     QVariant data(const QModelIndex &index, int role) const;
     bool setData(const QModelIndex &index, const QVariant &value, int role = Qt::EditRole);
@@ -72,6 +99,8 @@ protected:
     virtual int calcItemDataColumnCount(QwtPlotItem* item) const;
     //获取数据 row col 要对应item的维度 ,col是以数据为基准而不是以表格为基准
     virtual double getItemData(int row,int col,QwtPlotItem* item) const;
+    //批量获取数据，从row行开始读取count个第col列的数据到out，返回实际读取的个数
+    virtual int getItemDatas(int row,int col,int count,QwtPlotItem* item,double* out) const;
     //设置数据 row col 要对应item的维度
     virtual bool setPlotItemData(int row,int col,QwtPlotItem* item,const QVariant& var);
     //更新最大行数
@@ -80,6 +109,10 @@ protected:
     void updateColumnCount();
     //更新颜色
     void updateItemColor();
+private:
+    //从缓存获取数据
+    double cachedItemData(int row,int tableCol,int col,QwtPlotItem* item) const;
+    void clearDataCache();
 };
 
 #endif // QWTPLOTITEMDATAMODEL_H
@@ -927,6 +927,7 @@ SA2DGraph::SA2DGraph(QWidget *parent) : QwtPlot(parent)
     pCanvas->setFrameStyle(QFrame::Box);
     pCanvas->setLineWidth(1);
     pCanvas->setBorderRadius(0);//设置圆角为0
+    pCanvas->setLayerCacheEnable(true);//背景、数据、交互元素分层缓存
     pCanvas->setCursor(Qt::ArrowCursor);
     setCanvas(pCanvas);
     pCanvas->setFocusPolicy(Qt::ClickFocus);
@@ -44,7 +44,13 @@ void SAAbstractRegionSelectEditor::setSelectionMode(const SelectionMode &selecti
 ///
 bool SAAbstractRegionSelectEditor::isContains(const QPointF &p) const
 {
-    return getSelectRegion().contains(p);
+    const QPainterPath region = getSelectRegion();
+    //先用外接矩形排除，QPainterPath::contains的开销要大得多
+    if(!region.controlPointRect().contains(p))
+    {
+        return false;
+    }
+    return region.contains(p);
 }
 
 ///
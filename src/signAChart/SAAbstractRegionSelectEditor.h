@@ -25,7 +25,7 @@ public:
     virtual QPainterPath getSelectRegion() const = 0;
     //设置选区
     virtual void setSelectRegion(const QPainterPath& shape) = 0;
-    //判断点是否在区域里 此算法频繁调用会耗时
+    //判断点是否在区域里 此算法频繁调用会耗时，批量判断使用SAChart::getIndexsInRang
     virtual bool isContains(const QPointF& p) const;
     //获取绑定的x轴
     int getXAxis() const;
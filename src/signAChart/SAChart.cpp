@@ -18,6 +18,7 @@
 #include "qwt_plot_spectrocurve.h"
 #include "qwt_plot_tradingcurve.h"
 #include "qwt_plot_spectrogram.h"
+#include "SAXYSpatialIndex.h"
 #include <numeric>
 
 
@@ -562,23 +563,17 @@ void SAChart::getXYDatas(QVector<double> *xs, QVector<double> *ys, const QwtSeri
 ///
 size_t SAChart::getXYDatas(QVector<QPointF> &xys,QVector<int>* indexs, const QwtSeriesStore<QPointF> *cur, const QRectF &rang)
 {
+    QVector<int> inRangIndexs;
+    const size_t realSize = getIndexsInRang(inRangIndexs,cur,rang);
     const QwtSeriesData<QPointF>* datas = cur->data();
-    size_t size = datas->size();
-    size_t realSize = 0;
-    if(!rang.isNull() && rang.isValid())
+    xys.reserve(xys.size() + inRangIndexs.size());
+    for(int i : inRangIndexs)
     {
-        for(size_t i=0;i<size;++i)
-        {
-            if(rang.contains(datas->sample(i)))
-            {
-                xys.push_back(datas->sample(i));
-                ++realSize;
-                if(indexs)
-                {
-                    (*indexs).append(i);
-                }
-            }
-        }
+        xys.push_back(datas->sample(i));
+    }
+    if(indexs)
+    {
+        (*indexs) += inRangIndexs;
     }
     return realSize;
 }
@@ -587,34 +582,165 @@ size_t SAChart::getXYDatas(QVector<QPointF> &xys,QVector<int>* indexs, const Qwt
 
 size_t SAChart::getXYDatas(QVector<double> *xs, QVector<double> *ys, QVector<int> *indexs, const QwtSeriesStore<QPointF> *cur, const QRectF &rang)
 {
-    size_t size = cur->dataSize();
-    size_t realSize = 0;
-    if(!rang.isNull() && rang.isValid())
+    QVector<int> inRangIndexs;
+    const size_t realSize = getIndexsInRang(inRangIndexs,cur,rang);
+    const QwtSeriesData<QPointF>* datas = cur->data();
+    if(xs)
     {
-        for(size_t i=0;i<size;++i)
+        xs->reserve(xs->size() + inRangIndexs.size());
+    }
+    if(ys)
+    {
+        ys->reserve(ys->size() + inRangIndexs.size());
+    }
+    for(int i : inRangIndexs)
+    {
+        const QPointF p = datas->sample(i);
+        if(ys)
         {
-            QPointF p = cur->sample(i);
-            if(rang.contains(p))
-            {
-                if(ys)
-                {
-                    (*ys).push_back(p.y());
-                }
-                if(xs)
-                {
-                    (*xs).push_back(p.x());
-                }
-                if(indexs)
-                {
-                    (*indexs).push_back(i);
-                }
-                ++realSize;
-            }
+            (*ys).push_back(p.y());
         }
+        if(xs)
+        {
+            (*xs).push_back(p.x());
+        }
+    }
+    if(indexs)
+    {
+        (*indexs) += inRangIndexs;
     }
     return realSize;
 }
 
+///
+/// \brief 获取曲线的空间索引
+///
+/// 曲线需要继承\sa SAXYSpatialIndexProvider 才能提供索引
+/// \param series
+/// \return 曲线没有提供索引返回nullptr
+///
+const SAXYSpatialIndex *SAChart::getSpatialIndex(const QwtSeriesStore<QPointF> *series)
+{
+    const SAXYSpatialIndexProvider* provider = dynamic_cast<const SAXYSpatialIndexProvider*>(series);
+    if(nullptr == provider)
+    {
+        return nullptr;
+    }
+    const SAXYSpatialIndex* index = provider->getSpatialIndex();
+    if(nullptr == index || index->series() != series->data())
+    {
+        //索引和当前数据不对应
+        return nullptr;
+    }
+    return index;
+}
+///
+/// \brief 通过空间索引查找屏幕位置离曲线最近的点
+/// \param item 曲线对应的绘图元素，用于获取坐标映射
+/// \param series 曲线数据
+/// \param pos 屏幕位置
+/// \param index 最近点的索引，没有有效点时为-1
+/// \param dist 不为nullptr时返回最近点的屏幕距离
+/// \return 曲线没有空间索引或坐标映射非线性时返回false，此时需要遍历查找
+///
+bool SAChart::closestPointBySpatialIndex(const QwtPlotItem *item, const QwtSeriesStore<QPointF> *series, const QPoint &pos, int *index, double *dist)
+{
+    if(nullptr == item || nullptr == item->plot())
+    {
+        return false;
+    }
+    const SAXYSpatialIndex* spatialIndex = getSpatialIndex(series);
+    if(nullptr == spatialIndex)
+    {
+        return false;
+    }
+    const QwtScaleMap xMap = item->plot()->canvasMap(item->xAxis());
+    const QwtScaleMap yMap = item->plot()->canvasMap(item->yAxis());
+    if(!SAXYSpatialIndex::isLinearMap(xMap) || !SAXYSpatialIndex::isLinearMap(yMap))
+    {
+        return false;
+    }
+    const int i = spatialIndex->closestPoint(pos,xMap,yMap,dist);
+    if(index)
+    {
+        *index = i;
+    }
+    return true;
+}
+
+///
+/// \brief 获取矩形范围内数据点的索引
+/// \param indexs 按升序追加
+/// \param series
+/// \param rang
+/// \return 范围内的点数
+///
+size_t SAChart::getIndexsInRang(QVector<int> &indexs, const QwtSeriesStore<QPointF> *series, const QRectF &rang)
+{
+    if(rang.isNull() || !rang.isValid())
+    {
+        return 0;
+    }
+    const int oldSize = indexs.size();
+    const SAXYSpatialIndex* spatialIndex = getSpatialIndex(series);
+    if(spatialIndex)
+    {
+        spatialIndex->query(rang,indexs);
+        return indexs.size() - oldSize;
+    }
+    const QwtSeriesData<QPointF>* datas = series->data();
+    const int size = static_cast<int>(datas->size());
+    for(int i=0;i<size;++i)
+    {
+        if(rang.contains(datas->sample(i)))
+        {
+            indexs.append(i);
+        }
+    }
+    return indexs.size() - oldSize;
+}
+
+///
+/// \brief 获取区域范围内数据点的索引
+///
+/// 先用区域的外接矩形筛选，只对外接矩形内的点调用QPainterPath::contains
+/// \param indexs 按升序追加
+/// \param series
+/// \param rang
+/// \return 范围内的点数
+///
+size_t SAChart::getIndexsInRang(QVector<int> &indexs, const QwtSeriesStore<QPointF> *series, const QPainterPath &rang)
+{
+    if(rang.isEmpty())
+    {
+        return 0;
+    }
+    const int oldSize = indexs.size();
+    const SAXYSpatialIndex* spatialIndex = getSpatialIndex(series);
+    if(spatialIndex)
+    {
+        spatialIndex->query(rang,indexs);
+        return indexs.size() - oldSize;
+    }
+    const QRectF bound = rang.boundingRect();
+    const QwtSeriesData<QPointF>* datas = series->data();
+    const int size = static_cast<int>(datas->size());
+    for(int i=0;i<size;++i)
+    {
+        const QPointF point = datas->sample(i);
+        if(point.x() < bound.left() || point.x() > bound.right()
+                || point.y() < bound.top() || point.y() > bound.bottom())
+        {
+            continue;
+        }
+        if(rang.contains(point))
+        {
+            indexs.append(i);
+        }
+    }
+    return indexs.size() - oldSize;
+}
+
 
 
 ///
@@ -628,21 +754,17 @@ size_t SAChart::getXYDatas(QVector<double> *xs, QVector<double> *ys, QVector<int
 ///
 size_t SAChart::getXYDatas(QVector<QPointF> &xys, QVector<int>* indexs, const QwtSeriesStore<QPointF> *series, const QPainterPath &rang)
 {
-    size_t length = series->data()->size();
-    QPointF point;
-    size_t resCount = 0;
-    for(size_t i = 0;i<length;++i)
+    QVector<int> inRangIndexs;
+    const size_t resCount = getIndexsInRang(inRangIndexs,series,rang);
+    const QwtSeriesData<QPointF>* datas = series->data();
+    xys.reserve(xys.size() + inRangIndexs.size());
+    for(int i : inRangIndexs)
     {
-        point = series->data()->sample(i);
-        if(rang.contains(point))
-        {
-            ++resCount;
-            xys.append(point);
-            if(indexs)
-            {
-                (*indexs).append(i);
-            }
-        }
+        xys.append(datas->sample(i));
+    }
+    if(indexs)
+    {
+        (*indexs) += inRangIndexs;
     }
     return resCount;
 }
@@ -663,29 +785,33 @@ size_t SAChart::getXYDatas(QVector<double> *xs
                            , const QwtSeriesStore<QPointF> *series
                            , const QPainterPath &rang)
 {
-    size_t length = series->data()->size();
-    QPointF point;
-    size_t resCount = 0;
-    for(size_t i = 0;i<length;++i)
+    QVector<int> inRangIndexs;
+    const size_t resCount = getIndexsInRang(inRangIndexs,series,rang);
+    const QwtSeriesData<QPointF>* datas = series->data();
+    if(xs)
     {
-        point = series->data()->sample(i);
-        if(rang.contains(point))
+        xs->reserve(xs->size() + inRangIndexs.size());
+    }
+    if(ys)
+    {
+        ys->reserve(ys->size() + inRangIndexs.size());
+    }
+    for(int i : inRangIndexs)
+    {
+        const QPointF point = datas->sample(i);
+        if(xs)
         {
-            ++resCount;
-            if(xs)
-            {
-                (*xs).append(point.x());
-            }
-            if(ys)
-            {
-                (*ys).append(point.y());
-            }
-            if(indexs)
-            {
-                (*indexs).append(i);
-            }
+            (*xs).append(point.x());
+        }
+        if(ys)
+        {
+            (*ys).append(point.y());
         }
     }
+    if(indexs)
+    {
+        (*indexs) += inRangIndexs;
+    }
     return resCount;
 }
 ///
@@ -906,6 +1032,24 @@ void SAChart::setCurveLinePenStyle(QwtPlotCurve *cur, Qt::PenStyle style)
     cur->setPen(pen);
 }
 ///
+/// \brief 获取屏幕位置离曲线最近的点
+///
+/// 曲线提供空间索引时通过索引查找，否则调用QwtPlotCurve::closestPoint遍历所有点
+/// \param cur 曲线
+/// \param pos 屏幕位置
+/// \param dist 不为nullptr时返回最近点的屏幕距离
+/// \return 最近点的索引，没有找到返回-1
+///
+int SAChart::closestPoint(const QwtPlotCurve *cur, const QPoint &pos, double *dist)
+{
+    int index = -1;
+    if(closestPointBySpatialIndex(cur,cur,pos,&index,dist))
+    {
+        return index;
+    }
+    return cur->closestPoint(pos,dist);
+}
+///
 /// \brief 设置曲线的线形
 /// \param cur 曲线
 /// \param style
@@ -946,11 +1090,13 @@ int SAChart::removeDataInRang(const QRectF &removeRang, const QVector<QPointF> &
 int SAChart::removeDataInRang(const QPainterPath &removeRang, const QVector<QPointF> &rawData, QVector<QPointF> &newData)
 {
     size_t length = rawData.size();
+    const QRectF bound = removeRang.boundingRect();
     newData.reserve(length);
     for(size_t i = 0;i<length;++i)
     {
         const QPointF& point = rawData[i];
-        if(removeRang.contains(point))
+        //外接矩形外的点不需要精确判断
+        if(bound.contains(point) && removeRang.contains(point))
             continue;
         newData.push_back(point);
     }
@@ -965,16 +1111,21 @@ int SAChart::removeDataInRang(const QPainterPath &removeRang, const QVector<QPoi
 ///
 int SAChart::removeDataInRang(const QRectF &removeRang, QwtSeriesStore<QPointF> *curve)
 {
-    size_t length = curve->data()->size();
+    QVector<int> removeIndexs;
+    getIndexsInRang(removeIndexs,curve,removeRang);
+    const QwtSeriesData<QPointF>* datas = curve->data();
+    const int length = static_cast<int>(datas->size());
     QVector<QPointF> newLine;
-    newLine.reserve(length);
-    QPointF point;
-    for(size_t i = 0;i<length;++i)
+    newLine.reserve(length - removeIndexs.size());
+    int r = 0;
+    for(int i = 0;i<length;++i)
     {
-        point = curve->data()->sample(i);
-        if(removeRang.contains(point))
+        if(r < removeIndexs.size() && removeIndexs[r] == i)
+        {
+            ++r;
             continue;
-        newLine.push_back(point);
+        }
+        newLine.push_back(datas->sample(i));
     }
     curve->setData( new QwtPointSeriesData( newLine ) );
     return newLine.size();
@@ -982,16 +1133,21 @@ int SAChart::removeDataInRang(const QRectF &removeRang, QwtSeriesStore<QPointF>
 
 int SAChart::removeDataInRang(const QPainterPath &removeRang, QwtSeriesStore<QPointF> *curve)
 {
-    size_t length = curve->data()->size();
+    QVector<int> removeIndexs;
+    getIndexsInRang(removeIndexs,curve,removeRang);
+    const QwtSeriesData<QPointF>* datas = curve->data();
+    const int length = static_cast<int>(datas->size());
     QVector<QPointF> newLine;
-    newLine.reserve(length);
-    QPointF point;
-    for(size_t i = 0;i<length;++i)
+    newLine.reserve(length - removeIndexs.size());
+    int r = 0;
+    for(int i = 0;i<length;++i)
     {
-        point = curve->data()->sample(i);
-        if(removeRang.contains(point))
+        if(r < removeIndexs.size() && removeIndexs[r] == i)
+        {
+            ++r;
             continue;
-        newLine.push_back(point);
+        }
+        newLine.push_back(datas->sample(i));
     }
     curve->setData( new QwtPointSeriesData( newLine ) );
     return newLine.size();
@@ -1519,11 +1675,15 @@ int SAChart::closestPoint(const QwtPlotBarChart *bar, const QPoint &pos, double
 
     if ( bar->plot() == NULL || numSamples <= 0 )
         return -1;
+    int index = -1;
+    if(closestPointBySpatialIndex(bar,bar,pos,&index,dist))
+    {
+        return index;
+    }
     const QwtSeriesData<QPointF> *series = bar->data();
     const QwtScaleMap xMap = bar->plot()->canvasMap( bar->xAxis() );
     const QwtScaleMap yMap = bar->plot()->canvasMap( bar->yAxis() );
 
-    int index = -1;
     double dmin = 1.0e10;
 
     for ( uint i = 0; i < numSamples; i++ )
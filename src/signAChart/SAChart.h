@@ -27,6 +27,7 @@ class QwtScaleDraw;
 class QwtDateScaleDraw;
 class QwtPlotCurve;
 class QwtPlotBarChart;
+class SAXYSpatialIndex;
 ///
 /// \brief 这是一个辅助类，用于绘图的辅助
 ///
@@ -179,10 +180,37 @@ public:
     static size_t getXYDatas(QVector<QPointF>& xys, QVector<int> *indexs, const QwtSeriesStore<QPointF> *cur, const QRectF& rang);
     static size_t getXYDatas(QVector<double> *xs, QVector<double> *ys, QVector<int> *indexs, const QwtSeriesStore<QPointF> *cur, const QRectF& rang);
 
+    //获取曲线的空间索引，曲线没有提供索引返回nullptr
+    static const SAXYSpatialIndex *getSpatialIndex(const QwtSeriesStore<QPointF> *series);
+    //通过空间索引查找屏幕位置离曲线最近的点，曲线没有索引或坐标非线性时返回false
+    static bool closestPointBySpatialIndex(const QwtPlotItem* item, const QwtSeriesStore<QPointF> *series, const QPoint& pos, int* index, double *dist);
+
+    //获取范围内数据点的索引，优先使用空间索引，按升序追加到indexs
+    static size_t getIndexsInRang(QVector<int>& indexs, const QwtSeriesStore<QPointF> *series, const QRectF& rang);
+    static size_t getIndexsInRang(QVector<int>& indexs, const QwtSeriesStore<QPointF> *series, const QPainterPath& rang);
+
     //对2d数据点的提取操作
     static size_t getXYDatas(QVector<QPointF>& xys, QVector<int> *indexs, const QwtSeriesStore<QPointF> *series, const QPainterPath& rang);
     static size_t getXYDatas(QVector<double> *xs, QVector<double> *ys, QVector<int> *indexs, const QwtSeriesStore<QPointF> *series, const QPainterPath& rang);
 
+    ///
+    /// \brief 提取选区内的样本及其索引
+    /// \param datas 选区内的样本
+    /// \param indexs 选区内样本的索引，升序
+    /// \param series 数据
+    /// \param rang 选区
+    /// \param fpCheck 判断样本是否在选区的函数 bool (const QPainterPath&,const T&)
+    /// \return 选区内的样本数
+    ///
+    template<typename T, typename FpCheckValueInRange>
+    static size_t getSamplesInRang(QVector<T>& datas, QVector<int>& indexs, const QwtSeriesStore<T> *series, const QPainterPath& rang, FpCheckValueInRange fpCheck);
+
+    ///
+    /// \brief 提取选区内的2d数据点及其索引，使用空间索引，判断规则固定为\sa isPointInRange
+    ///
+    template<typename FpCheckValueInRange>
+    static size_t getSamplesInRang(QVector<QPointF>& datas, QVector<int>& indexs, const QwtSeriesStore<QPointF> *series, const QPainterPath& rang, FpCheckValueInRange fpCheck);
+
     //对3d数据提取
     static void getXYZDatas(QVector<QwtPoint3D>& xyzs, const QwtSeriesStore<QwtPoint3D> *cur);
 
@@ -248,6 +276,9 @@ public:
     //设置曲线的样式
     static void setCurvePenStyle(QwtPlotCurve *cur, Qt::PenStyle style);
 
+    //获取屏幕位置离曲线最近的点，和QwtPlotCurve::closestPoint一致，曲线有空间索引时使用索引
+    static int closestPoint(const QwtPlotCurve *cur, const QPoint& pos, double *dist);
+
 ////////////////////// QwtPlotBarChart曲线相关操作//////////////////////////////
     //获取屏幕位置离bar最近的点，类似于QwtPlotCurve::closestPoint
     static int closestPoint(const QwtPlotBarChart *bar, const QPoint& pos, double *dist);
@@ -280,6 +311,33 @@ void SAChart::getSeriesData(QVector<T>& vec, const QwtSeriesStore<T> *series, in
 }
 
 
+template<typename T, typename FpCheckValueInRange>
+size_t SAChart::getSamplesInRang(QVector<T>& datas, QVector<int>& indexs, const QwtSeriesStore<T> *series, const QPainterPath& rang, FpCheckValueInRange fpCheck)
+{
+    const int size = (int)(series->dataSize());
+    size_t count = 0;
+
+    for (int i = 0; i < size; ++i)
+    {
+        const T v = series->sample(i);
+        if (fpCheck(rang, v)) {
+            datas.append(v);
+            indexs.append(i);
+            ++count;
+        }
+    }
+    return (count);
+}
+
+
+template<typename FpCheckValueInRange>
+size_t SAChart::getSamplesInRang(QVector<QPointF>& datas, QVector<int>& indexs, const QwtSeriesStore<QPointF> *series, const QPainterPath& rang, FpCheckValueInRange fpCheck)
+{
+    Q_UNUSED(fpCheck);
+    return (getXYDatas(datas, &indexs, series, rang));
+}
+
+
 template<typename T, typename PlotItemType>
 void SAChart::setVectorSampleData(QwtPlotItem *item, const QVector<T>& datas)
 {
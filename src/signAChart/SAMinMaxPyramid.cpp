@@ -0,0 +1,367 @@
+#include "SAMinMaxPyramid.h"
+#include <qmath.h>
+
+SAMinMaxPyramid::SAMinMaxPyramid(int baseBucket)
+    :m_baseBucket(qMax(baseBucket,2))
+    ,m_size(0)
+    ,m_isValid(false)
+{
+
+}
+///
+/// \brief 构建金字塔
+/// \param series 曲线数据，x值需要单调不减
+/// \return x值不单调或数据点过少时返回false，此时金字塔无效
+///
+bool SAMinMaxPyramid::build(const QwtSeriesData<QPointF> *series)
+{
+    clear();
+    if(nullptr == series)
+    {
+        return false;
+    }
+    m_size = static_cast<int>(series->size());
+    if(m_size < 2 || !isMonotonic(series,0,m_size-1))
+    {
+        return false;
+    }
+    int count = (m_size + m_baseBucket - 1) / m_baseBucket;
+    m_levels.append(QVector<int>(2*count));
+    for(int b=0;b<count;++b)
+    {
+        buildBaseBucket(series,b);
+    }
+    while(count > 1)
+    {
+        count = (count + 1) / 2;
+        m_levels.append(QVector<int>(2*count));
+        const int level = m_levels.size()-1;
+        for(int b=0;b<count;++b)
+        {
+            mergeBucket(series,level,b);
+        }
+    }
+    m_isValid = true;
+    return true;
+}
+///
+/// \brief 数据的[from,to]区间被修改后进行增量更新
+///
+/// 只重新计算被修改的底层桶，再逐层往上合并，复杂度为O(to-from+log(n))
+/// \param series 修改后的数据
+/// \param from 修改的起始索引
+/// \param to 修改的结束索引
+/// \return 数据长度变化时会重新构建，x值不单调时返回false
+///
+bool SAMinMaxPyramid::update(const QwtSeriesData<QPointF> *series, int from, int to)
+{
+    if(nullptr == series || !m_isValid || static_cast<int>(series->size()) != m_size)
+    {
+        return build(series);
+    }
+    from = qBound(0,from,m_size-1);
+    to = qBound(0,to,m_size-1);
+    if(from > to)
+    {
+        qSwap(from,to);
+    }
+    //修改点和两侧相邻点需要保持单调
+    if(!isMonotonic(series,qMax(from-1,0),qMin(to+1,m_size-1)))
+    {
+        clear();
+        return false;
+    }
+    int b0 = from / m_baseBucket;
+    int b1 = to / m_baseBucket;
+    for(int b=b0;b<=b1;++b)
+    {
+        buildBaseBucket(series,b);
+    }
+    for(int level=1;level<m_levels.size();++level)
+    {
+        b0 /= 2;
+        b1 /= 2;
+        for(int b=b0;b<=b1;++b)
+        {
+            mergeBucket(series,level,b);
+        }
+    }
+    return true;
+}
+///
+/// \brief 清空
+///
+void SAMinMaxPyramid::clear()
+{
+    m_levels.clear();
+    m_size = 0;
+    m_isValid = false;
+}
+///
+/// \brief 是否有效
+/// \return
+///
+bool SAMinMaxPyramid::isValid() const
+{
+    return m_isValid;
+}
+///
+/// \brief 构建时的数据长度
+/// \return
+///
+int SAMinMaxPyramid::size() const
+{
+    return m_size;
+}
+///
+/// \brief 层数
+/// \return
+///
+int SAMinMaxPyramid::levelCount() const
+{
+    return m_levels.size();
+}
+///
+/// \brief 指定层的桶尺寸
+/// \param level
+/// \return
+///
+int SAMinMaxPyramid::bucketSize(int level) const
+{
+    return m_baseBucket << level;
+}
+///
+/// \brief 选择[from,to]区间需要绘制的点的索引
+///
+/// 选择桶尺寸不超过每桶期望点数的最高层，每个桶输出首点、最小点、最大点、尾点，
+/// 区间两端不完整的桶直接扫描原始数据，区间点数本身不多时直接输出所有点
+/// \param series 曲线数据，需要和构建时一致
+/// \param from 起始索引
+/// \param to 结束索引
+/// \param maxBuckets 期望的最大桶数，一般为绘图区域的像素宽度
+/// \param indexs 输出的索引，按升序排列
+///
+void SAMinMaxPyramid::selectIndexs(const QwtSeriesData<QPointF> *series, int from, int to, int maxBuckets, QVector<int> &indexs) const
+{
+    indexs.clear();
+    if(!m_isValid || nullptr == series)
+    {
+        return;
+    }
+    from = qMax(from,0);
+    to = qMin(to,m_size-1);
+    if(from > to)
+    {
+        return;
+    }
+    maxBuckets = qMax(maxBuckets,1);
+    const int count = to - from + 1;
+    if(count <= 4*maxBuckets)
+    {
+        indexs.reserve(count);
+        for(int i=from;i<=to;++i)
+        {
+            indexs.append(i);
+        }
+        return;
+    }
+    const int target = count / maxBuckets;
+    indexs.reserve(4*maxBuckets+8);
+    //对原始数据按step分桶进行M4
+    auto rawM4 = [&](int s,int e,int step){
+        for(int i=s;i<=e;i+=step)
+        {
+            const int last = qMin(i+step-1,e);
+            int minIndex,maxIndex;
+            scanMinMax(series,i,last,minIndex,maxIndex);
+            appendM4(indexs,i,minIndex,maxIndex,last);
+        }
+    };
+    if(bucketSize(0) > target)
+    {
+        //可见点数不多，金字塔的底层比一个像素还粗，直接扫描原始数据
+        rawM4(from,to,target);
+        return;
+    }
+    int level = 0;
+    while((level+1) < m_levels.size() && bucketSize(level+1) <= target)
+    {
+        ++level;
+    }
+    const int s = bucketSize(level);
+    const QVector<int>& buckets = m_levels[level];
+    int bf = from / s;
+    int bl = to / s;
+    if(from != bf*s)
+    {
+        rawM4(from,qMin(to,(bf+1)*s-1),target);
+        ++bf;
+    }
+    const bool isLastPartial = (bl >= bf) && ((to+1) != qMin((bl+1)*s,m_size));
+    if(isLastPartial)
+    {
+        --bl;
+    }
+    for(int b=bf;b<=bl;++b)
+    {
+        appendM4(indexs,b*s,buckets[2*b],buckets[2*b+1],qMin(b*s+s,m_size)-1);
+    }
+    if(isLastPartial)
+    {
+        rawM4((bl+1)*s,to,target);
+    }
+}
+///
+/// \brief 在单调的x中查找第一个x值不小于value的索引
+/// \param series
+/// \param value
+/// \return 所有x都小于value时返回size
+///
+int SAMinMaxPyramid::lowerBound(const QwtSeriesData<QPointF> *series, double value)
+{
+    int first = 0;
+    int len = static_cast<int>(series->size());
+    while(len > 0)
+    {
+        const int half = len / 2;
+        const int mid = first + half;
+        if(series->sample(mid).x() < value)
+        {
+            first = mid + 1;
+            len -= half + 1;
+        }
+        else
+        {
+            len = half;
+        }
+    }
+    return first;
+}
+///
+/// \brief 在单调的x中查找第一个x值大于value的索引
+/// \param series
+/// \param value
+/// \return 所有x都不大于value时返回size
+///
+int SAMinMaxPyramid::upperBound(const QwtSeriesData<QPointF> *series, double value)
+{
+    int first = 0;
+    int len = static_cast<int>(series->size());
+    while(len > 0)
+    {
+        const int half = len / 2;
+        const int mid = first + half;
+        if(!(value < series->sample(mid).x()))
+        {
+            first = mid + 1;
+            len -= half + 1;
+        }
+        else
+        {
+            len = half;
+        }
+    }
+    return first;
+}
+///
+/// \brief 判断[from,to]区间的x值是否单调不减
+/// \param series
+/// \param from
+/// \param to
+/// \return 含有nan时也返回false
+///
+bool SAMinMaxPyramid::isMonotonic(const QwtSeriesData<QPointF> *series, int from, int to)
+{
+    if(from > to)
+    {
+        return true;
+    }
+    double prev = series->sample(from).x();
+    if(qIsNaN(prev))
+    {
+        return false;
+    }
+    for(int i=from+1;i<=to;++i)
+    {
+        const double x = series->sample(i).x();
+        if(!(x >= prev))
+        {
+            return false;
+        }
+        prev = x;
+    }
+    return true;
+}
+
+void SAMinMaxPyramid::buildBaseBucket(const QwtSeriesData<QPointF> *series, int bucket)
+{
+    const int from = bucket * m_baseBucket;
+    const int to = qMin(from + m_baseBucket,m_size) - 1;
+    int minIndex,maxIndex;
+    scanMinMax(series,from,to,minIndex,maxIndex);
+    QVector<int>& level0 = m_levels[0];
+    level0[2*bucket] = minIndex;
+    level0[2*bucket+1] = maxIndex;
+}
+
+void SAMinMaxPyramid::mergeBucket(const QwtSeriesData<QPointF> *series, int level, int bucket)
+{
+    const QVector<int>& lower = m_levels[level-1];
+    QVector<int>& cur = m_levels[level];
+    const int c0 = 2*bucket;
+    const int c1 = c0 + 1;
+    if(2*c1 >= lower.size())
+    {
+        //下一层是奇数个桶，最后一个桶直接继承
+        cur[2*bucket] = lower[2*c0];
+        cur[2*bucket+1] = lower[2*c0+1];
+        return;
+    }
+    const int min0 = lower[2*c0];
+    const int min1 = lower[2*c1];
+    const int max0 = lower[2*c0+1];
+    const int max1 = lower[2*c1+1];
+    const double ymin0 = series->sample(min0).y();
+    const double ymin1 = series->sample(min1).y();
+    const double ymax0 = series->sample(max0).y();
+    const double ymax1 = series->sample(max1).y();
+    cur[2*bucket] = (qIsNaN(ymin0) || ymin1 < ymin0) ? min1 : min0;
+    cur[2*bucket+1] = (qIsNaN(ymax0) || ymax1 > ymax0) ? max1 : max0;
+}
+
+void SAMinMaxPyramid::scanMinMax(const QwtSeriesData<QPointF> *series, int from, int to, int &minIndex, int &maxIndex)
+{
+    minIndex = maxIndex = from;
+    double ymin = series->sample(from).y();
+    double ymax = ymin;
+    for(int i=from+1;i<=to;++i)
+    {
+        const double y = series->sample(i).y();
+        if(qIsNaN(y))
+        {
+            continue;
+        }
+        if(y < ymin || qIsNaN(ymin))
+        {
+            ymin = y;
+            minIndex = i;
+        }
+        if(y > ymax || qIsNaN(ymax))
+        {
+            ymax = y;
+            maxIndex = i;
+        }
+    }
+}
+
+void SAMinMaxPyramid::appendM4(QVector<int> &indexs, int first, int minIndex, int maxIndex, int last)
+{
+    int m4[4] = {first,qMin(minIndex,maxIndex),qMax(minIndex,maxIndex),last};
+    for(int i=0;i<4;++i)
+    {
+        if(indexs.isEmpty() || indexs.last() < m4[i])
+        {
+            indexs.append(m4[i]);
+        }
+    }
+}
@@ -0,0 +1,70 @@
+#ifndef SAMINMAXPYRAMID_H
+#define SAMINMAXPYRAMID_H
+#include "SAChartGlobals.h"
+#include <QVector>
+#include <QPointF>
+#include "qwt_series_data.h"
+
+///
+/// \def 金字塔最底层每个桶包含的点数
+///
+#ifndef SA_MINMAX_PYRAMID_BASE_BUCKET
+#define SA_MINMAX_PYRAMID_BASE_BUCKET 64
+#endif
+
+///
+/// \brief 曲线绘制用的多分辨率最小/最大值金字塔（M4降采样）
+///
+/// 要求数据的x值单调不减，第0层每SA_MINMAX_PYRAMID_BASE_BUCKET个点为一个桶，记录桶内y最小值和最大值的索引，
+/// 往上每层桶的尺寸翻倍，由下一层两个相邻桶合并得到
+///
+/// 绘制时根据可见范围的点数和像素宽度选择合适的层，每个桶只输出首点、最小点、最大点、尾点，
+/// 绘制的点数约为像素宽度的数倍，且不会丢失峰值
+///
+/// 金字塔只保存索引，数据本身依然由曲线持有，因此使用时传入的数据必须和构建时一致
+///
+class SA_CHART_EXPORT SAMinMaxPyramid
+{
+public:
+    SAMinMaxPyramid(int baseBucket = SA_MINMAX_PYRAMID_BASE_BUCKET);
+    //构建金字塔，x值不单调时返回false
+    bool build(const QwtSeriesData<QPointF> *series);
+    //数据的[from,to]区间被修改后进行增量更新，要求数据长度没有变化
+    bool update(const QwtSeriesData<QPointF> *series, int from, int to);
+    //清空
+    void clear();
+    //是否有效
+    bool isValid() const;
+    //构建时的数据长度
+    int size() const;
+    //层数
+    int levelCount() const;
+    //指定层的桶尺寸
+    int bucketSize(int level) const;
+    //选择[from,to]区间需要绘制的点的索引，maxBuckets为期望的最大桶数，一般为像素宽度
+    void selectIndexs(const QwtSeriesData<QPointF> *series, int from, int to, int maxBuckets, QVector<int>& indexs) const;
+    //在单调的x中查找第一个x值不小于value的索引
+    static int lowerBound(const QwtSeriesData<QPointF> *series, double value);
+    //在单调的x中查找第一个x值大于value的索引
+    static int upperBound(const QwtSeriesData<QPointF> *series, double value);
+    //判断[from,to]区间的x值是否单调不减
+    static bool isMonotonic(const QwtSeriesData<QPointF> *series, int from, int to);
+
+private:
+    //计算第0层第bucket个桶
+    void buildBaseBucket(const QwtSeriesData<QPointF> *series, int bucket);
+    //由下一层合并计算level层第bucket个桶
+    void mergeBucket(const QwtSeriesData<QPointF> *series, int level, int bucket);
+    //原始点的扫描
+    static void scanMinMax(const QwtSeriesData<QPointF> *series, int from, int to, int& minIndex, int& maxIndex);
+    //把桶的首点、最小点、最大点、尾点按索引顺序追加
+    static void appendM4(QVector<int>& indexs, int first, int minIndex, int maxIndex, int last);
+
+private:
+    int m_baseBucket;                       ///< 第0层的桶尺寸
+    int m_size;                             ///< 构建时的数据长度
+    bool m_isValid;                         ///< 是否有效
+    QVector<QVector<int> > m_levels;        ///< 每层的桶，每个桶依次存放最小值索引和最大值索引
+};
+
+#endif // SAMINMAXPYRAMID_H
@@ -1,7 +1,11 @@
 #include "SAPlotCanvas.h"
 #include <QPainter>
 #include <QPaintEvent>
+#include <QStyleOption>
 #include <QDebug>
+#include "qwt_plot.h"
+#include "qwt_painter.h"
+#include "qwt_scale_map.h"
 
 class SAPlotCanvasPrivate
 {
@@ -9,10 +13,20 @@ public:
     SA_IMPL_PUBLIC(SAPlotCanvas)
     QBrush canvasBackBrush;
     QColor canvasBorderColor;
+    bool isLayerCache;                      ///< 是否开启图层缓存
+    QPixmap backgroundLayer;                ///< 背景层缓存
+    QPixmap dataLayer;                      ///< 数据层缓存，透明背景
+    SAPlotCanvas::Layers dirtyLayers;       ///< 失效的图层
+    int scopeDepth;                         ///< LayerUpdateScope嵌套的层数
+    SAPlotCanvas::Layers scopeLayers;       ///< LayerUpdateScope作用域内重绘时刷新的图层
+    QVector<double> layerMapKey;            ///< 缓存渲染时的坐标映射，变化时缓存全部失效
     SAPlotCanvasPrivate(SAPlotCanvas *p) :
         q_ptr(p),
         canvasBackBrush(Qt::white),
-        canvasBorderColor(Qt::black)
+        canvasBorderColor(Qt::black),
+        isLayerCache(false),
+        dirtyLayers(SAPlotCanvas::AllLayers),
+        scopeDepth(0)
     {
     }
 
@@ -34,8 +48,59 @@ public:
 
         q_ptr->setStyleSheet(qss);
     }
+
+
+    //当前的坐标映射，用于判断缓存是否过期
+    QVector<double> currentMapKey() const
+    {
+        QVector<double> key;
+        const QwtPlot *plot = q_ptr->plot();
+
+        if (nullptr == plot) {
+            return (key);
+        }
+        key.reserve(4 * QwtPlot::axisCnt);
+        for (int axisId = 0; axisId < QwtPlot::axisCnt; ++axisId)
+        {
+            const QwtScaleMap m = plot->canvasMap(axisId);
+            key << m.s1() << m.s2() << m.p1() << m.p2();
+        }
+        return (key);
+    }
 };
 
+
+/**
+ * @brief 开始作用域，作用域内的重绘只刷新layers指定的图层
+ * @param plot 绘图
+ * @param layers 需要刷新的图层，叠加层不缓存，只刷新叠加层时传入OverlayLayer
+ */
+SAPlotCanvas::LayerUpdateScope::LayerUpdateScope(QwtPlot *plot, SAPlotCanvas::Layers layers)
+    : m_canvas(plot ? qobject_cast<SAPlotCanvas *>(plot->canvas()) : nullptr)
+{
+    if (m_canvas) {
+        SAPlotCanvasPrivate *d = m_canvas->d_ptr.data();
+        if (0 == d->scopeDepth) {
+            d->scopeLayers = layers;
+        }else {
+            d->scopeLayers |= layers;
+        }
+        ++(d->scopeDepth);
+    }
+}
+
+
+SAPlotCanvas::LayerUpdateScope::~LayerUpdateScope()
+{
+    if (m_canvas) {
+        SAPlotCanvasPrivate *d = m_canvas->d_ptr.data();
+        if (--(d->scopeDepth) <= 0) {
+            d->scopeDepth = 0;
+            d->scopeLayers = SAPlotCanvas::Layers();
+        }
+    }
+}
+
 SAPlotCanvas::SAPlotCanvas(QwtPlot *p) : QwtPlotCanvas(p)
     , d_ptr(new SAPlotCanvasPrivate(this))
 {
@@ -109,12 +174,188 @@ void SAPlotCanvas::useQss()
 }
 
 
+/**
+ * @brief 设置是否开启图层缓存
+ *
+ * 开启后QwtPlotCanvas自身的BackingStore不再使用，圆角画布不支持图层缓存
+ * @param on
+ */
+void SAPlotCanvas::setLayerCacheEnable(bool on)
+{
+    if (d_ptr->isLayerCache == on) {
+        return;
+    }
+    d_ptr->isLayerCache = on;
+    d_ptr->backgroundLayer = QPixmap();
+    d_ptr->dataLayer = QPixmap();
+    d_ptr->dirtyLayers = AllLayers;
+    QwtPlotCanvas::replot();
+}
+
+
+bool SAPlotCanvas::isLayerCacheEnable() const
+{
+    return (d_ptr->isLayerCache && (borderRadius() <= 0.0));
+}
+
+
+/**
+ * @brief 标记图层缓存失效
+ * @param layers
+ */
+void SAPlotCanvas::invalidateLayers(SAPlotCanvas::Layers layers)
+{
+    d_ptr->dirtyLayers |= layers;
+}
+
+
+/**
+ * @brief 绘图元素所在的图层
+ *
+ * 网格、坐标刻度、区域背景属于背景层，标记、形状（选区）、文字标签以及SA的标记属于叠加层，其余属于数据层
+ * @param item
+ * @return
+ */
+SAPlotCanvas::Layer SAPlotCanvas::itemLayer(const QwtPlotItem *item) const
+{
+    const int rtti = item->rtti();
+
+    switch (rtti)
+    {
+    case QwtPlotItem::Rtti_PlotGrid:
+    case QwtPlotItem::Rtti_PlotScale:
+    case QwtPlotItem::Rtti_PlotZone:
+        return (BackgroundLayer);
+
+    case QwtPlotItem::Rtti_PlotMarker:
+    case QwtPlotItem::Rtti_PlotShape:
+    case QwtPlotItem::Rtti_PlotTextLabel:
+    case QwtPlotItem::Rtti_PlotLegend:
+        return (OverlayLayer);
+
+    default:
+        break;
+    }
+    if ((rtti >= SARttiMarker_LowerBoundary) && (rtti <= SARttiMarker_UpperBoundary)) {
+        return (OverlayLayer);
+    }
+    return (DataLayer);
+}
+
+
+/**
+ * @brief 重绘
+ *
+ * 在@ref LayerUpdateScope 作用域内只让指定的图层失效，否则所有图层失效
+ */
+void SAPlotCanvas::replot()
+{
+    if (!isLayerCacheEnable()) {
+        QwtPlotCanvas::replot();
+        return;
+    }
+    invalidateLayers((d_ptr->scopeDepth > 0) ? d_ptr->scopeLayers : AllLayers);
+    if (testPaintAttribute(QwtPlotCanvas::ImmediatePaint)) {
+        repaint(contentsRect());
+    }else {
+        update(contentsRect());
+    }
+}
+
+
 void SAPlotCanvas::paintEvent(QPaintEvent *e)
 {
-//    QPainter p(this);
+    if (!isLayerCacheEnable() || (nullptr == plot())) {
+        QwtPlotCanvas::paintEvent(e);
+        return;
+    }
+    updateLayerCache();
+    QPainter painter(this);
+
+    painter.setClipRegion(e->region());
+    painter.drawPixmap(0, 0, d_ptr->backgroundLayer);
+    painter.drawPixmap(0, 0, d_ptr->dataLayer);
+    painter.save();
+    painter.setClipRect(contentsRect(), Qt::IntersectClip);
+    drawLayerItems(&painter, OverlayLayer);
+    painter.restore();
+    if (!testAttribute(Qt::WA_StyledBackground) && (frameWidth() > 0)) {
+        drawBorder(&painter);
+    }
+    if (hasFocus() && (focusIndicator() == CanvasFocusIndicator)) {
+        drawFocusIndicator(&painter);
+    }
+}
+
+
+/**
+ * @brief 绘制指定图层的绘图元素，和QwtPlot::drawItems一致
+ * @param painter
+ * @param layer
+ */
+void SAPlotCanvas::drawLayerItems(QPainter *painter, SAPlotCanvas::Layer layer) const
+{
+    const QwtPlot *p = plot();
+    QwtScaleMap maps[QwtPlot::axisCnt];
+
+    for (int axisId = 0; axisId < QwtPlot::axisCnt; ++axisId)
+    {
+        maps[axisId] = p->canvasMap(axisId);
+    }
+    const QRectF canvasRect = contentsRect();
+    const QwtPlotItemList& items = p->itemList();
+
+    for (QwtPlotItemIterator it = items.begin(); it != items.end(); ++it)
+    {
+        const QwtPlotItem *item = *it;
+        if ((nullptr == item) || !item->isVisible() || (itemLayer(item) != layer)) {
+            continue;
+        }
+        painter->save();
+        painter->setRenderHint(QPainter::Antialiasing, item->testRenderHint(QwtPlotItem::RenderAntialiased));
+        painter->setRenderHint(QPainter::HighQualityAntialiasing, item->testRenderHint(QwtPlotItem::RenderAntialiased));
+        item->draw(painter, maps[item->xAxis()], maps[item->yAxis()], canvasRect);
+        painter->restore();
+    }
+}
+
+
+/**
+ * @brief 重新渲染失效的缓存图层
+ *
+ * 尺寸或坐标映射变化时所有图层都会失效
+ */
+void SAPlotCanvas::updateLayerCache()
+{
+    const QVector<double> key = d_ptr->currentMapKey();
 
-//    if (testAttribute(Qt::WA_StyledBackground)) {
-//        setAttribute(Qt::WA_StyledBackground, false);
-//    }
-    QwtPlotCanvas::paintEvent(e);
+    if ((d_ptr->backgroundLayer.size() != size()) || (key != d_ptr->layerMapKey)) {
+        d_ptr->dirtyLayers = AllLayers;
+        d_ptr->layerMapKey = key;
+    }
+    if (d_ptr->dirtyLayers & BackgroundLayer) {
+        QPixmap pm = QwtPainter::backingStore(this, size());
+        QwtPainter::fillPixmap(this, pm);
+        QPainter p(&pm);
+        if (testAttribute(Qt::WA_StyledBackground)) {
+            //样式表背景（背景色和边框）
+            QStyleOption opt;
+            opt.initFrom(this);
+            style()->drawPrimitive(QStyle::PE_Widget, &opt, &p, this);
+        }
+        p.setClipRect(contentsRect());
+        drawLayerItems(&p, BackgroundLayer);
+        p.end();
+        d_ptr->backgroundLayer = pm;
+    }
+    if (d_ptr->dirtyLayers & DataLayer) {
+        QPixmap pm = QwtPainter::backingStore(this, size());
+        pm.fill(Qt::transparent);
+        QPainter p(&pm);
+        p.setClipRect(contentsRect());
+        drawLayerItems(&p, DataLayer);
+        p.end();
+        d_ptr->dataLayer = pm;
+    }
+    d_ptr->dirtyLayers = Layers();
 }
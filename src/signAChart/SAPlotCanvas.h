@@ -2,17 +2,54 @@
 #define SAPLOTCANVAS_H
 #include "SAChartGlobals.h"
 #include "qwt_plot_canvas.h"
+#include <QPointer>
 class QPaintEvent;
+class QwtPlotItem;
 SA_IMPL_FORWARD_DECL(SAPlotCanvas)
 
 /**
  * @brief 重写了paint背景的方法
+ *
+ * 开启图层缓存后（@ref setLayerCacheEnable ），画布分为背景层（背景、网格）、数据层（曲线等）和叠加层（标记、选区等交互元素），
+ * 背景层和数据层分别缓存为pixmap，叠加层每次绘制时直接画在缓存之上，
+ * 在@ref LayerUpdateScope 作用域内的重绘只重新渲染指定的图层，只改变叠加层的交互只需重新合成缓存
+ * @note 图层缓存下同一图层内依然按z值绘制，但叠加层总在数据层之上，数据层总在背景层之上
  */
 class SA_CHART_EXPORT SAPlotCanvas : public QwtPlotCanvas
 {
     Q_OBJECT
     SA_IMPL(SAPlotCanvas)
 public:
+    /**
+     * @brief 画布的图层
+     */
+    enum Layer {
+        BackgroundLayer = 0x01,         ///< 背景以及网格、坐标刻度等
+        DataLayer       = 0x02,         ///< 数据
+        OverlayLayer    = 0x04,         ///< 标记、选区等交互元素，不缓存
+        AllLayers       = BackgroundLayer | DataLayer | OverlayLayer
+    };
+    Q_DECLARE_FLAGS(Layers, Layer)
+
+    /**
+     * @brief 作用域内绘图的重绘只刷新指定的图层，其余图层使用缓存
+     *
+     * 例如拖动选区时：
+     * @code
+     * SAPlotCanvas::LayerUpdateScope scope(plot(), SAPlotCanvas::OverlayLayer);
+     * moveEdit(pos);
+     * plot()->replot();
+     * @endcode
+     * 画布不是SAPlotCanvas或没有开启图层缓存时没有任何作用
+     */
+    class SA_CHART_EXPORT LayerUpdateScope
+    {
+    public:
+        LayerUpdateScope(QwtPlot *plot, SAPlotCanvas::Layers layers);
+        ~LayerUpdateScope();
+    private:
+        QPointer<SAPlotCanvas> m_canvas;
+    };
     explicit SAPlotCanvas(QwtPlot *p = nullptr);
     virtual ~SAPlotCanvas();
     //获取背景
@@ -26,8 +63,29 @@ public:
     //设置qss
     void useQss();
 
+    //图层缓存
+    void setLayerCacheEnable(bool on);
+    bool isLayerCacheEnable() const;
+
+    //标记图层缓存失效，下次绘制时重新渲染
+    void invalidateLayers(Layers layers = AllLayers);
+
+    //绘图元素所在的图层
+    virtual Layer itemLayer(const QwtPlotItem *item) const;
+
+public slots:
+    //QwtPlot::replot会调用此函数
+    void replot();
+
 protected:
     void paintEvent(QPaintEvent *e) override;
+
+private:
+    //绘制指定图层的绘图元素
+    void drawLayerItems(QPainter *painter, Layer layer) const;
+    //重新渲染失效的缓存图层
+    void updateLayerCache();
 };
+Q_DECLARE_OPERATORS_FOR_FLAGS(SAPlotCanvas::Layers)
 
 #endif // SAPLOTCANVAS_H
@@ -11,14 +11,38 @@
 #include "qwt_column_symbol.h"
 #include "qwt_plot_intervalcurve.h"
 #include "qwt_interval_symbol.h"
+#include <QtEndian>
+#include <QDebug>
+#include <type_traits>
+#include <cstring>
+#include <climits>
 ///< 版本标示，每个序列化都应该带有版本信息，用于对下兼容
 const int gc_version = 1;
 const int gc_magic_mark = 0x5A6B4CF1;
+///< 样本块的标示，旧格式在同样位置直接写入QVector，通过标示区分
+const unsigned int gc_point_block_mark = 0xab2320;
+const unsigned int gc_interval_block_mark = 0xabf320;
 namespace sa {
 void serialize_out_scale_widge(QDataStream &out, const QwtPlot *chart,int axis);
 void serialize_in_scale_widge(QDataStream &in, QwtPlot *chart,int axis);
-
-
+//样本数组的读写
+void serialize_out_sample_block(QDataStream &out,const QwtPlotItem* item,const QVector<QPointF>& sample);
+void serialize_in_sample_block(QDataStream &in,QwtPlotItem* item,QVector<QPointF>& sample);
+void serialize_out_sample_block(QDataStream &out,const QVector<QwtIntervalSample>& sample);
+void serialize_in_sample_block(QDataStream &in,QVector<QwtIntervalSample>& sample);
+//double数组按原始内存块读写
+void serialize_out_raw_doubles(QDataStream &out,const double* p,qint64 count);
+void serialize_in_raw_doubles(QDataStream &in,double* p,qint64 count,bool isLittleEndian);
+///
+/// \brief 样本块的存储方式
+///
+enum SampleBlockMode
+{
+    SampleBlockStream = 0,///< 逐个元素写入QDataStream
+    SampleBlockRaw = 1,///< 原始内存块
+    SampleBlockReference = 2///< 引用工程中的数据
+};
+static SASeriesDataResolver* s_series_data_resolver = nullptr;
 }
 
 sa::SABadSerializeExpection::SABadSerializeExpection()
@@ -42,6 +66,234 @@ const char *sa::SABadSerializeExpection::what() const noexcept
 }
 #endif
 
+sa::SASeriesDataResolver::~SASeriesDataResolver()
+{
+
+}
+
+sa::SASeriesDataResolverInstaller::SASeriesDataResolverInstaller(SASeriesDataResolver *resolver)
+    :m_previous(s_series_data_resolver)
+{
+    s_series_data_resolver = resolver;
+}
+
+sa::SASeriesDataResolverInstaller::~SASeriesDataResolverInstaller()
+{
+    s_series_data_resolver = m_previous;
+}
+
+sa::SASeriesDataResolver *sa::seriesDataResolver()
+{
+    return s_series_data_resolver;
+}
+///
+/// \brief double数组按原始内存块写入，记录字节序，大数组分多次写入
+/// \param out
+/// \param p
+/// \param count double的个数
+///
+void sa::serialize_out_raw_doubles(QDataStream &out, const double *p, qint64 count)
+{
+    const char* data = reinterpret_cast<const char*>(p);
+    qint64 bytes = count * static_cast<qint64>(sizeof(double));
+    while(bytes > 0)
+    {
+        const int len = static_cast<int>(qMin<qint64>(bytes,SA_SERIALIZE_RAW_BLOCK_BYTES));
+        if(out.writeRawData(data,len) != len)
+        {
+            throw SABadSerializeExpection();
+        }
+        data += len;
+        bytes -= len;
+    }
+}
+///
+/// \brief 读取原始内存块写入的double数组，字节序和本机不同时逐个翻转
+/// \param in
+/// \param p 需要已分配count个double
+/// \param count double的个数
+/// \param isLittleEndian 写入时的字节序
+///
+void sa::serialize_in_raw_doubles(QDataStream &in, double *p, qint64 count, bool isLittleEndian)
+{
+    char* data = reinterpret_cast<char*>(p);
+    qint64 bytes = count * static_cast<qint64>(sizeof(double));
+    while(bytes > 0)
+    {
+        const int len = static_cast<int>(qMin<qint64>(bytes,SA_SERIALIZE_RAW_BLOCK_BYTES));
+        if(in.readRawData(data,len) != len)
+        {
+            throw SABadSerializeExpection();
+        }
+        data += len;
+        bytes -= len;
+    }
+    if(isLittleEndian != (QSysInfo::ByteOrder == QSysInfo::LittleEndian))
+    {
+        for(qint64 i=0;i<count;++i)
+        {
+            quint64 v;
+            std::memcpy(&v,p+i,sizeof(v));
+            v = qbswap(v);
+            std::memcpy(p+i,&v,sizeof(v));
+        }
+    }
+}
+///
+/// \brief 写入点序列样本
+///
+/// 解析器能给出引用时只写入引用，否则按原始内存块写入
+/// \param out
+/// \param item 样本所属的item，传给解析器
+/// \param sample
+///
+void sa::serialize_out_sample_block(QDataStream &out, const QwtPlotItem *item, const QVector<QPointF> &sample)
+{
+    const qint64 count = sample.size();
+    QByteArray ref;
+    if(s_series_data_resolver)
+    {
+        ref = s_series_data_resolver->reference(item,sample);
+    }
+    if(!ref.isEmpty())
+    {
+        out << static_cast<qint8>(SampleBlockReference) << ref << count;
+        return;
+    }
+    if(!std::is_same<qreal,double>::value)
+    {
+        out << static_cast<qint8>(SampleBlockStream) << sample;
+        return;
+    }
+    out << static_cast<qint8>(SampleBlockRaw)
+        << (QSysInfo::ByteOrder == QSysInfo::LittleEndian)
+        << count;
+    serialize_out_raw_doubles(out,reinterpret_cast<const double*>(sample.constData()),count*2);
+}
+///
+/// \brief 读取点序列样本
+///
+/// 引用无法解析（数据已不在工程中或长度不一致）时样本为空，并输出警告
+/// \param in
+/// \param item
+/// \param sample
+///
+void sa::serialize_in_sample_block(QDataStream &in, QwtPlotItem *item, QVector<QPointF> &sample)
+{
+    qint8 mode;
+    in >> mode;
+    sample.clear();
+    if(SampleBlockStream == mode)
+    {
+        in >> sample;
+        return;
+    }
+    if(SampleBlockReference == mode)
+    {
+        QByteArray ref;
+        qint64 count;
+        in >> ref >> count;
+        if(nullptr == s_series_data_resolver
+                || !s_series_data_resolver->resolve(item,ref,sample)
+                || sample.size() != count)
+        {
+            qWarning() << "can not resolve sample reference" << ref
+                       << "of" << (item ? item->title().text() : QString())
+                       << ",expect" << count << "points but got" << sample.size()
+                       << ",the item will be empty";
+            sample.clear();
+        }
+        return;
+    }
+    if(SampleBlockRaw != mode)
+    {
+        throw SABadSerializeExpection();
+    }
+    bool isLittleEndian;
+    qint64 count;
+    in >> isLittleEndian >> count;
+    if(in.status() != QDataStream::Ok || count < 0 || count > (INT_MAX / 2))
+    {
+        throw SABadSerializeExpection();
+    }
+    sample.resize(static_cast<int>(count));
+    if(std::is_same<qreal,double>::value)
+    {
+        serialize_in_raw_doubles(in,reinterpret_cast<double*>(sample.data()),count*2,isLittleEndian);
+        return;
+    }
+    QVector<double> tmp(static_cast<int>(count*2));
+    serialize_in_raw_doubles(in,tmp.data(),count*2,isLittleEndian);
+    for(int i=0;i<sample.size();++i)
+    {
+        sample[i] = QPointF(tmp[2*i],tmp[2*i+1]);
+    }
+}
+///
+/// \brief 写入区间样本
+///
+/// 所有区间都包含边界时按(value,min,max)的原始内存块写入，否则逐个元素写入
+/// \param out
+/// \param sample
+///
+void sa::serialize_out_sample_block(QDataStream &out, const QVector<QwtIntervalSample> &sample)
+{
+    const int count = sample.size();
+    QVector<double> tmp(count*3);
+    double* p = tmp.data();
+    for(int i=0;i<count;++i)
+    {
+        const QwtIntervalSample& s = sample[i];
+        if(QwtInterval::IncludeBorders != s.interval.borderFlags())
+        {
+            out << static_cast<qint8>(SampleBlockStream) << sample;
+            return;
+        }
+        p[3*i] = s.value;
+        p[3*i+1] = s.interval.minValue();
+        p[3*i+2] = s.interval.maxValue();
+    }
+    out << static_cast<qint8>(SampleBlockRaw)
+        << (QSysInfo::ByteOrder == QSysInfo::LittleEndian)
+        << static_cast<qint64>(count);
+    serialize_out_raw_doubles(out,p,qint64(count)*3);
+}
+///
+/// \brief 读取区间样本
+/// \param in
+/// \param sample
+///
+void sa::serialize_in_sample_block(QDataStream &in, QVector<QwtIntervalSample> &sample)
+{
+    qint8 mode;
+    in >> mode;
+    sample.clear();
+    if(SampleBlockStream == mode)
+    {
+        in >> sample;
+        return;
+    }
+    if(SampleBlockRaw != mode)
+    {
+        throw SABadSerializeExpection();
+    }
+    bool isLittleEndian;
+    qint64 count;
+    in >> isLittleEndian >> count;
+    if(in.status() != QDataStream::Ok || count < 0 || count > (INT_MAX / 3))
+    {
+        throw SABadSerializeExpection();
+    }
+    QVector<double> tmp(static_cast<int>(count*3));
+    serialize_in_raw_doubles(in,tmp.data(),count*3,isLittleEndian);
+    const double* p = tmp.constData();
+    sample.resize(static_cast<int>(count));
+    for(int i=0;i<sample.size();++i)
+    {
+        sample[i] = QwtIntervalSample(p[3*i],p[3*i+1],p[3*i+2]);
+    }
+}
+
 
 
 void sa::serialize_out_scale_widge(QDataStream &out, const QwtPlot *chart,int axis)
@@ -483,11 +735,12 @@ QDataStream &sa::operator <<(QDataStream &out, const QwtPlotCurve *item)
         << (int)(item->orientation())
            ;
     //save sample
-    const unsigned int ck0 = 0xab231f;
     const unsigned int ck1 = 0x956fda;
     QVector<QPointF> sample;
     SAChart::getXYDatas(sample,item);
-    out << ck0 << sample << ck1;
+    out << gc_point_block_mark;
+    serialize_out_sample_block(out,item,sample);
+    out << ck1;
     //QwtSymbol的序列化
     const QwtSymbol* symbol = item->symbol();
     bool isHaveSymbol = (symbol != nullptr);
@@ -567,12 +820,20 @@ QDataStream &sa::operator >>(QDataStream &in, QwtPlotCurve *item)
     unsigned int tmp0,tmp1;
     QVector<QPointF> sample;
     in >> tmp0 ;
-    if(ck0 != tmp0)
+    if(gc_point_block_mark == tmp0)
+    {
+        serialize_in_sample_block(in,item,sample);
+    }
+    else if(ck0 == tmp0)
+    {
+        in >> sample;
+    }
+    else
     {
         throw SABadSerializeExpection();
         return in;
     }
-    in >> sample >> tmp1;
+    in >> tmp1;
     if(ck1 != tmp1)
     {
         throw SABadSerializeExpection();
@@ -610,11 +871,12 @@ QDataStream &sa::operator <<(QDataStream &out, const QwtPlotBarChart *item)
         << (int)(item->orientation())
            ;
     //save sample
-    const unsigned int ck0 = 0xab231f;
     const unsigned int ck1 = 0x956fda;
     QVector<QPointF> sample;
     SAChart::getXYDatas(sample,item);
-    out << ck0 <<sample << ck1;
+    out << gc_point_block_mark;
+    serialize_out_sample_block(out,item,sample);
+    out << ck1;
     //Symbol
     const QwtColumnSymbol*cs = item->symbol();
     bool isColumnSymbol = (cs != nullptr);
@@ -669,13 +931,21 @@ QDataStream &sa::operator >>(QDataStream &in, QwtPlotBarChart *item)
     const unsigned int ck1 = 0x956fda;
     unsigned int tmp0,tmp1;
     in >> tmp0;
-    if(ck0 != tmp0)
+    QVector<QPointF> sample;
+    if(gc_point_block_mark == tmp0)
+    {
+        serialize_in_sample_block(in,item,sample);
+    }
+    else if(ck0 == tmp0)
+    {
+        in >> sample;
+    }
+    else
     {
         throw SABadSerializeExpection();
         return in;
     }
-    QVector<QPointF> sample;
-    in >> sample >>tmp1;
+    in >> tmp1;
     if(ck1 != tmp1)
     {
         throw SABadSerializeExpection();
@@ -708,11 +978,12 @@ QDataStream &sa::operator <<(QDataStream &out, const QwtPlotIntervalCurve *item)
         << item->testPaintAttribute(QwtPlotIntervalCurve::ClipSymbol)
            ;
     //save sample
-    const unsigned int ck0 = 0xabf31f;
     const unsigned int ck1 = 0x9f6fda;
     QVector<QwtIntervalSample> sample;
     SAChart::getSeriesData(sample,item);
-    out << ck0 << sample << ck1;
+    out << gc_interval_block_mark;
+    serialize_out_sample_block(out,sample);
+    out << ck1;
     //QwtSymbol的序列化
     const QwtIntervalSymbol* symbol = item->symbol();
     bool isHaveSymbol = (symbol != nullptr);
@@ -759,12 +1030,20 @@ QDataStream &sa::operator >>(QDataStream &in, QwtPlotIntervalCurve *item)
     unsigned int tmp0,tmp1;
     QVector<QwtIntervalSample> sample;
     in >> tmp0 ;
-    if(ck0 != tmp0)
+    if(gc_interval_block_mark == tmp0)
+    {
+        serialize_in_sample_block(in,sample);
+    }
+    else if(ck0 == tmp0)
+    {
+        in >> sample;
+    }
+    else
     {
         throw SABadSerializeExpection();
         return in;
     }
-    in >> sample >> tmp1;
+    in >> tmp1;
     if(ck1 != tmp1)
     {
         throw SABadSerializeExpection();
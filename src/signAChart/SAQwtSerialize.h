@@ -2,6 +2,9 @@
 #define SAQWTSERIALIZE_H
 #include "SAChartGlobals.h"
 #include <QDataStream>
+#include <QByteArray>
+#include <QVector>
+#include <QPointF>
 #include "qwt_text.h"
 #include "qwt_samples.h"
 
@@ -18,6 +21,14 @@ class QwtPlotBarChart;
 class QwtColumnSymbol;
 class QwtPlotIntervalCurve;
 class QwtIntervalSymbol;
+
+///
+/// \def 样本数组按原始内存块读写时每次读写的最大字节数
+///
+#ifndef SA_SERIALIZE_RAW_BLOCK_BYTES
+#define SA_SERIALIZE_RAW_BLOCK_BYTES (1 << 24)
+#endif
+
 ///
 /// \brief 序列化类都是带异常的，使用中需要处理异常
 ///
@@ -34,6 +45,38 @@ namespace sa {
 #endif
     };
 
+    ///
+    /// \brief 曲线样本的引用解析器
+    ///
+    /// 曲线的样本如果和工程中已保存的数据一致，保存时只写入引用，加载时再由引用取回样本，
+    /// 避免同一份数据在工程中保存两次。引用的内容由解析器自己定义，序列化只负责存取
+    ///
+    /// 解析器通过\sa SASeriesDataResolverInstaller 在保存和加载期间安装
+    ///
+    class SA_CHART_EXPORT SASeriesDataResolver
+    {
+    public:
+        virtual ~SASeriesDataResolver();
+        //保存时调用，返回空表示没有可引用的数据，此时写入完整样本
+        virtual QByteArray reference(const QwtPlotItem* item,const QVector<QPointF>& sample) = 0;
+        //加载时调用，由引用取回样本，失败返回false，此时item的样本为空并输出警告
+        virtual bool resolve(QwtPlotItem* item,const QByteArray& ref,QVector<QPointF>& sample) = 0;
+    };
+
+    ///
+    /// \brief 在作用域内安装曲线样本的引用解析器，析构时恢复之前的解析器
+    ///
+    class SA_CHART_EXPORT SASeriesDataResolverInstaller
+    {
+    public:
+        SASeriesDataResolverInstaller(SASeriesDataResolver* resolver);
+        ~SASeriesDataResolverInstaller();
+    private:
+        SASeriesDataResolver* m_previous;
+    };
+    //当前安装的解析器，没有时返回nullptr
+    SA_CHART_EXPORT SASeriesDataResolver* seriesDataResolver();
+
     // QFrame的序列化
     SA_CHART_EXPORT QDataStream& operator <<(QDataStream & out,const QFrame* f);
     SA_CHART_EXPORT QDataStream& operator >>(QDataStream & in,QFrame* f);
@@ -0,0 +1,124 @@
+#ifndef SASPSCRINGBUFFER_H
+#define SASPSCRINGBUFFER_H
+#include <QVector>
+#include <atomic>
+#include <algorithm>
+
+///
+/// \brief 单生产者单消费者的无锁环形队列
+///
+/// 生产者只修改写位置，消费者只修改读位置，两者通过原子变量的acquire/release同步，
+/// 因此一个线程写入、另一个线程读取时不需要加锁，队列满时写入会被截断而不是覆盖
+///
+/// 容量会向上取整为2的幂，以便用位与代替取模
+///
+template<typename T>
+class SASpscRingBuffer
+{
+public:
+    SASpscRingBuffer(int capacity);
+    //容量
+    int capacity() const;
+    //当前元素个数，在生产者和消费者线程中调用时为近似值
+    int size() const;
+    //写入n个元素，返回实际写入的个数，只能在生产者线程调用
+    int push(const T* datas, int n);
+    bool push(const T& data);
+    //读取最多maxCount个元素，返回实际读取的个数，只能在消费者线程调用
+    int pop(T* datas, int maxCount);
+    //丢弃所有已写入的元素，只能在消费者线程调用
+    void discard();
+private:
+    QVector<T> m_buffer;
+    T* m_data;///< 构造后不再变化，读写线程都直接通过指针访问，避免QVector的detach检查
+    size_t m_mask;
+    //读写位置分开放置，避免生产者和消费者的伪共享
+    char m_pad0[64];
+    std::atomic<size_t> m_head;///< 写位置，只由生产者修改
+    char m_pad1[64];
+    std::atomic<size_t> m_tail;///< 读位置，只由消费者修改
+    char m_pad2[64];
+};
+
+template<typename T>
+SASpscRingBuffer<T>::SASpscRingBuffer(int capacity)
+    :m_head(0)
+    ,m_tail(0)
+{
+    size_t c = 2;
+    while(c < static_cast<size_t>(qMax(capacity,2)))
+    {
+        c <<= 1;
+    }
+    m_buffer.resize(static_cast<int>(c));
+    m_data = m_buffer.data();
+    m_mask = c - 1;
+}
+
+template<typename T>
+int SASpscRingBuffer<T>::capacity() const
+{
+    return m_buffer.size();
+}
+
+template<typename T>
+int SASpscRingBuffer<T>::size() const
+{
+    const size_t tail = m_tail.load(std::memory_order_acquire);
+    const size_t head = m_head.load(std::memory_order_acquire);
+    return static_cast<int>(head - tail);
+}
+
+template<typename T>
+int SASpscRingBuffer<T>::push(const T *datas, int n)
+{
+    const size_t head = m_head.load(std::memory_order_relaxed);
+    const size_t tail = m_tail.load(std::memory_order_acquire);
+    const size_t freeCount = static_cast<size_t>(m_buffer.size()) - (head - tail);
+    const size_t count = std::min(static_cast<size_t>(qMax(n,0)),freeCount);
+    if(0 == count)
+    {
+        return 0;
+    }
+    //写入可能跨过缓冲区末尾，分两段拷贝
+    T* buffer = m_data;
+    const size_t begin = head & m_mask;
+    const size_t first = std::min(count,static_cast<size_t>(m_buffer.size()) - begin);
+    std::copy(datas,datas+first,buffer+begin);
+    std::copy(datas+first,datas+count,buffer);
+    m_head.store(head + count,std::memory_order_release);
+    return static_cast<int>(count);
+}
+
+template<typename T>
+bool SASpscRingBuffer<T>::push(const T &data)
+{
+    return 1 == push(&data,1);
+}
+
+template<typename T>
+int SASpscRingBuffer<T>::pop(T *datas, int maxCount)
+{
+    const size_t tail = m_tail.load(std::memory_order_relaxed);
+    const size_t head = m_head.load(std::memory_order_acquire);
+    const size_t count = std::min(static_cast<size_t>(qMax(maxCount,0)),head - tail);
+    if(0 == count)
+    {
+        return 0;
+    }
+    const T* buffer = m_data;
+    const size_t begin = tail & m_mask;
+    const size_t first = std::min(count,static_cast<size_t>(m_buffer.size()) - begin);
+    std::copy(buffer+begin,buffer+begin+first,datas);
+    std::copy(buffer,buffer+(count-first),datas+first);
+    m_tail.store(tail + count,std::memory_order_release);
+    return static_cast<int>(count);
+}
+
+template<typename T>
+void SASpscRingBuffer<T>::discard()
+{
+    m_tail.store(m_head.load(std::memory_order_acquire),std::memory_order_release);
+}
+
+#endif // SASPSCRINGBUFFER_H
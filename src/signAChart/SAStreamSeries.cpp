@@ -0,0 +1,410 @@
+#include "SAStreamSeries.h"
+#include "qwt_plot.h"
+#include "qwt_scale_div.h"
+#include "qwt_plot_directpainter.h"
+#include "SAPlotCanvas.h"
+
+///
+/// \def 界面线程每次从队列取数的最大点数
+///
+#ifndef SA_STREAM_SERIES_DRAIN_CHUNK
+#define SA_STREAM_SERIES_DRAIN_CHUNK 65536
+#endif
+
+SARingSeriesData::SARingSeriesData(int capacity)
+    :m_buffer(qMax(capacity,1))
+    ,m_start(0)
+    ,m_size(0)
+    ,m_timeWindow(0)
+{
+
+}
+
+size_t SARingSeriesData::size() const
+{
+    return static_cast<size_t>(m_size);
+}
+
+QPointF SARingSeriesData::sample(size_t i) const
+{
+    int index = m_start + static_cast<int>(i);
+    if(index >= m_buffer.size())
+    {
+        index -= m_buffer.size();
+    }
+    return m_buffer[index];
+}
+///
+/// \brief 外接矩形，数据变化后第一次调用时重新计算
+/// \return
+///
+QRectF SARingSeriesData::boundingRect() const
+{
+    if(d_boundingRect.width() < 0.0)
+    {
+        d_boundingRect = qwtBoundingRect(*this);
+    }
+    return d_boundingRect;
+}
+///
+/// \brief 追加点
+///
+/// 容量满后覆盖最旧的点，之后再按时间窗口移除旧点
+/// \param points
+/// \param n
+/// \return 被移除的点数
+///
+int SARingSeriesData::append(const QPointF *points, int n)
+{
+    if(n <= 0)
+    {
+        return 0;
+    }
+    const int cap = m_buffer.size();
+    int removed = 0;
+    if(n >= cap)
+    {
+        //新数据比容量还多，只保留最新的cap个点
+        removed = m_size + (n - cap);
+        std::copy(points + (n - cap),points + n,m_buffer.begin());
+        m_start = 0;
+        m_size = cap;
+    }
+    else
+    {
+        int pos = m_start + m_size;
+        if(pos >= cap)
+        {
+            pos -= cap;
+        }
+        for(int i=0;i<n;++i)
+        {
+            m_buffer[pos] = points[i];
+            if(++pos >= cap)
+            {
+                pos = 0;
+            }
+        }
+        m_size += n;
+        if(m_size > cap)
+        {
+            removed = m_size - cap;
+            m_start = pos;
+            m_size = cap;
+        }
+    }
+    removed += removeOutOfWindow();
+    d_boundingRect = QRectF(0.0,0.0,-1.0,-1.0);
+    return removed;
+}
+///
+/// \brief 设置容量，容量变小时保留最新的点
+/// \param capacity
+///
+void SARingSeriesData::setCapacity(int capacity)
+{
+    capacity = qMax(capacity,1);
+    if(capacity == m_buffer.size())
+    {
+        return;
+    }
+    const int keep = qMin(m_size,capacity);
+    QVector<QPointF> buffer(capacity);
+    for(int i=0;i<keep;++i)
+    {
+        buffer[i] = sample(m_size - keep + i);
+    }
+    m_buffer.swap(buffer);
+    m_start = 0;
+    m_size = keep;
+    d_boundingRect = QRectF(0.0,0.0,-1.0,-1.0);
+}
+
+int SARingSeriesData::capacity() const
+{
+    return m_buffer.size();
+}
+///
+/// \brief 设置时间窗口，x值比最新点早于窗口的点会被移除
+/// \param window 小于等于0时不限制
+///
+void SARingSeriesData::setTimeWindow(double window)
+{
+    m_timeWindow = window;
+    if(removeOutOfWindow() > 0)
+    {
+        d_boundingRect = QRectF(0.0,0.0,-1.0,-1.0);
+    }
+}
+
+double SARingSeriesData::timeWindow() const
+{
+    return m_timeWindow;
+}
+
+void SARingSeriesData::clear()
+{
+    m_start = 0;
+    m_size = 0;
+    d_boundingRect = QRectF(0.0,0.0,-1.0,-1.0);
+}
+
+int SARingSeriesData::removeOutOfWindow()
+{
+    if(m_timeWindow <= 0 || m_size <= 0)
+    {
+        return 0;
+    }
+    const double limit = sample(m_size - 1).x() - m_timeWindow;
+    int removed = 0;
+    while(m_size > 0 && m_buffer[m_start].x() < limit)
+    {
+        if(++m_start >= m_buffer.size())
+        {
+            m_start = 0;
+        }
+        --m_size;
+        ++removed;
+    }
+    return removed;
+}
+
+SAStreamSeries::SAStreamSeries(const QString &title, int capacity, QObject *par)
+    :QObject(par)
+    ,QwtPlotCurve(title)
+    ,m_fifo(SA_STREAM_SERIES_FIFO_CAPACITY)
+    ,m_droppedCount(0)
+    ,m_drainBuffer(SA_STREAM_SERIES_DRAIN_CHUNK)
+    ,m_autoScaleInterval(SA_STREAM_SERIES_AUTOSCALE_INTERVAL)
+    ,m_needReplot(false)
+    ,m_directPainter(new QwtPlotDirectPainter())
+{
+    setData(new SARingSeriesData(capacity));
+    m_refreshTimer.setInterval(SA_STREAM_SERIES_REFRESH_INTERVAL);
+    connect(&m_refreshTimer,&QTimer::timeout,this,&SAStreamSeries::flush);
+    m_refreshTimer.start();
+}
+
+SAStreamSeries::~SAStreamSeries()
+{
+
+}
+///
+/// \brief 生产者写入一个点
+/// \param x
+/// \param y
+/// \return 队列满时返回false
+///
+bool SAStreamSeries::append(double x, double y)
+{
+    const QPointF p(x,y);
+    return 1 == append(&p,1);
+}
+///
+/// \brief 生产者写入多个点
+///
+/// 只写入无锁队列，可以在任意一个固定的生产者线程调用
+/// \param points
+/// \param n
+/// \return 实际写入的点数，队列满时多出的点被丢弃并计入\sa droppedCount
+///
+int SAStreamSeries::append(const QPointF *points, int n)
+{
+    const int count = m_fifo.push(points,n);
+    if(count < n)
+    {
+        m_droppedCount.fetch_add(static_cast<quint64>(n - count),std::memory_order_relaxed);
+    }
+    return count;
+}
+
+int SAStreamSeries::append(const QVector<QPointF> &points)
+{
+    return append(points.constData(),points.size());
+}
+
+quint64 SAStreamSeries::droppedCount() const
+{
+    return m_droppedCount.load(std::memory_order_relaxed);
+}
+///
+/// \brief 环形数据
+/// \return 数据被替换为其他类型时返回nullptr
+///
+SARingSeriesData *SAStreamSeries::ringData()
+{
+    return dynamic_cast<SARingSeriesData*>(data());
+}
+
+const SARingSeriesData *SAStreamSeries::ringData() const
+{
+    return dynamic_cast<const SARingSeriesData*>(data());
+}
+
+void SAStreamSeries::setCapacity(int capacity)
+{
+    SARingSeriesData* d = ringData();
+    if(d)
+    {
+        d->setCapacity(capacity);
+        m_needReplot = true;
+    }
+}
+
+int SAStreamSeries::capacity() const
+{
+    const SARingSeriesData* d = ringData();
+    return d ? d->capacity() : 0;
+}
+
+void SAStreamSeries::setTimeWindow(double window)
+{
+    SARingSeriesData* d = ringData();
+    if(d)
+    {
+        d->setTimeWindow(window);
+        m_needReplot = true;
+    }
+}
+
+double SAStreamSeries::timeWindow() const
+{
+    const SARingSeriesData* d = ringData();
+    return d ? d->timeWindow() : 0;
+}
+
+void SAStreamSeries::setRefreshInterval(int ms)
+{
+    m_refreshTimer.setInterval(qMax(ms,1));
+}
+
+int SAStreamSeries::refreshInterval() const
+{
+    return m_refreshTimer.interval();
+}
+
+void SAStreamSeries::setAutoScaleInterval(int ms)
+{
+    m_autoScaleInterval = qMax(ms,0);
+}
+
+int SAStreamSeries::autoScaleInterval() const
+{
+    return m_autoScaleInterval;
+}
+
+void SAStreamSeries::clear()
+{
+    m_fifo.discard();
+    SARingSeriesData* d = ringData();
+    if(d)
+    {
+        d->clear();
+    }
+    m_needReplot = true;
+}
+///
+/// \brief 把队列中的数据取出，追加到环形数据并绘制
+///
+/// 新数据都在当前坐标范围内时只增量绘制新的线段（包含和上一个点的连线），
+/// 否则标记需要整体重绘，整体重绘受\sa autoScaleInterval 限制，被延后时依然先增量绘制
+///
+void SAStreamSeries::flush()
+{
+    SARingSeriesData* d = ringData();
+    if(nullptr == d)
+    {
+        m_fifo.discard();
+        return;
+    }
+    int total = 0;
+    int removed = 0;
+    for(;;)
+    {
+        const int n = m_fifo.pop(m_drainBuffer.data(),m_drainBuffer.size());
+        if(n <= 0)
+        {
+            break;
+        }
+        removed += d->append(m_drainBuffer.constData(),n);
+        total += n;
+    }
+    if(total > 0)
+    {
+        emit samplesAppended(total);
+    }
+    if(nullptr == plot() || !isVisible())
+    {
+        return;
+    }
+    if(0 == total)
+    {
+        if(m_needReplot)
+        {
+            throttledReplot();
+        }
+        return;
+    }
+    const int size = static_cast<int>(d->size());
+    const int first = qMax(size - total,0);
+    if(removed > 0 || !isInsideScale(first,size-1))
+    {
+        m_needReplot = true;
+    }
+    if(m_needReplot && throttledReplot())
+    {
+        return;
+    }
+    m_directPainter->drawSeries(this,qMax(first-1,0),size-1);
+    //增量绘制没有进入分层缓存，数据层需要在下次绘制时重新渲染
+    SAPlotCanvas* canvas = qobject_cast<SAPlotCanvas*>(plot()->canvas());
+    if(canvas)
+    {
+        canvas->invalidateLayers(SAPlotCanvas::DataLayer);
+    }
+}
+///
+/// \brief 判断[from,to]区间的点是否在自动缩放坐标轴的当前范围内
+///
+/// 非自动缩放的坐标轴超出范围的部分直接被裁剪，不需要重绘
+/// \param from
+/// \param to
+/// \return
+///
+bool SAStreamSeries::isInsideScale(int from, int to) const
+{
+    const QwtPlot* p = plot();
+    const bool isXAuto = p->axisAutoScale(xAxis());
+    const bool isYAuto = p->axisAutoScale(yAxis());
+    if(!isXAuto && !isYAuto)
+    {
+        return true;
+    }
+    const QwtInterval xInterval = p->axisScaleDiv(xAxis()).interval().normalized();
+    const QwtInterval yInterval = p->axisScaleDiv(yAxis()).interval().normalized();
+    for(int i=from;i<=to;++i)
+    {
+        const QPointF s = sample(i);
+        if(isXAuto && !xInterval.contains(s.x()))
+        {
+            return false;
+        }
+        if(isYAuto && !yInterval.contains(s.y()))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool SAStreamSeries::throttledReplot()
+{
+    if(m_lastReplot.isValid() && m_lastReplot.elapsed() < m_autoScaleInterval)
+    {
+        return false;
+    }
+    m_needReplot = false;
+    m_lastReplot.restart();
+    plot()->replot();
+    return true;
+}
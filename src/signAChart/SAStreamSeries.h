@@ -0,0 +1,139 @@
+#ifndef SASTREAMSERIES_H
+#define SASTREAMSERIES_H
+#include "SAChartGlobals.h"
+#include <QObject>
+#include <QVector>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <atomic>
+#include <memory>
+#include "qwt_plot_curve.h"
+#include "qwt_series_data.h"
+#include "SASpscRingBuffer.h"
+class QwtPlotDirectPainter;
+
+///
+/// \def 实时曲线默认保留的点数
+///
+#ifndef SA_STREAM_SERIES_CAPACITY
+#define SA_STREAM_SERIES_CAPACITY 1000000
+#endif
+
+///
+/// \def 生产者到界面线程的无锁队列容量，按1MS/s、刷新间隔30ms计算留有足够余量
+///
+#ifndef SA_STREAM_SERIES_FIFO_CAPACITY
+#define SA_STREAM_SERIES_FIFO_CAPACITY (1<<20)
+#endif
+
+///
+/// \def 界面线程取数和增量绘制的间隔（ms）
+///
+#ifndef SA_STREAM_SERIES_REFRESH_INTERVAL
+#define SA_STREAM_SERIES_REFRESH_INTERVAL 30
+#endif
+
+///
+/// \def 需要整体重绘（坐标轴自动缩放、旧数据移出）时两次重绘的最小间隔（ms）
+///
+#ifndef SA_STREAM_SERIES_AUTOSCALE_INTERVAL
+#define SA_STREAM_SERIES_AUTOSCALE_INTERVAL 500
+#endif
+
+///
+/// \brief 固定内存的环形曲线数据
+///
+/// 容量满后新点覆盖最旧的点，设置了时间窗口时x值比最新点早于窗口的点也会被移除，
+/// x值视为时间，要求单调不减，外接矩形在需要时才重新计算
+///
+/// 此数据只在界面线程访问，跨线程写入见\sa SAStreamSeries
+///
+class SA_CHART_EXPORT SARingSeriesData : public QwtSeriesData<QPointF>
+{
+public:
+    SARingSeriesData(int capacity = SA_STREAM_SERIES_CAPACITY);
+    virtual size_t size() const;
+    virtual QPointF sample(size_t i) const;
+    virtual QRectF boundingRect() const;
+    //追加点，返回因容量或时间窗口被移除的点数
+    int append(const QPointF* points, int n);
+    //容量
+    void setCapacity(int capacity);
+    int capacity() const;
+    //时间窗口，小于等于0时不限制
+    void setTimeWindow(double window);
+    double timeWindow() const;
+    //清空
+    void clear();
+private:
+    //按时间窗口移除旧点，返回移除的点数
+    int removeOutOfWindow();
+private:
+    QVector<QPointF> m_buffer;
+    int m_start;///< 最旧点在m_buffer中的位置
+    int m_size;///< 点数
+    double m_timeWindow;
+};
+
+///
+/// \brief 实时曲线，用于高速采集数据的显示
+///
+/// 生产者线程通过append写入单生产者单消费者的无锁队列，不会触碰界面线程，
+/// 界面线程按刷新间隔批量取出数据追加到\sa SARingSeriesData ，新数据只通过QwtPlotDirectPainter增量绘制，
+/// 只有新数据超出自动缩放的坐标轴范围或旧数据被移出时才需要整体重绘，整体重绘受最小间隔限制
+///
+/// \note 对象需要在界面线程创建，append只能由同一个生产者线程调用，
+/// 不要对此曲线调用setSamples/setData替换数据
+///
+class SA_CHART_EXPORT SAStreamSeries : public QObject, public QwtPlotCurve
+{
+    Q_OBJECT
+public:
+    SAStreamSeries(const QString& title = QString(), int capacity = SA_STREAM_SERIES_CAPACITY, QObject* par = nullptr);
+    virtual ~SAStreamSeries();
+    //生产者写入，队列满时多出的点被丢弃，返回实际写入的点数
+    bool append(double x, double y);
+    int append(const QPointF* points, int n);
+    int append(const QVector<QPointF>& points);
+    //因队列满被丢弃的点数
+    quint64 droppedCount() const;
+    //环形数据
+    SARingSeriesData* ringData();
+    const SARingSeriesData* ringData() const;
+    //容量
+    void setCapacity(int capacity);
+    int capacity() const;
+    //时间窗口，小于等于0时不限制
+    void setTimeWindow(double window);
+    double timeWindow() const;
+    //取数和增量绘制的间隔（ms）
+    void setRefreshInterval(int ms);
+    int refreshInterval() const;
+    //整体重绘的最小间隔（ms）
+    void setAutoScaleInterval(int ms);
+    int autoScaleInterval() const;
+    //清空已显示的数据和队列中尚未取出的数据
+    void clear();
+public slots:
+    //立即把队列中的数据取出并绘制
+    void flush();
+signals:
+    //界面线程追加了count个点
+    void samplesAppended(int count);
+private:
+    //新数据是否在不需要重绘的坐标范围内
+    bool isInsideScale(int from, int to) const;
+    //受最小间隔限制的整体重绘，返回是否进行了重绘
+    bool throttledReplot();
+private:
+    SASpscRingBuffer<QPointF> m_fifo;
+    std::atomic<quint64> m_droppedCount;
+    QVector<QPointF> m_drainBuffer;///< 从队列取数的缓冲
+    QTimer m_refreshTimer;
+    QElapsedTimer m_lastReplot;
+    int m_autoScaleInterval;
+    bool m_needReplot;///< 标记是否还有被延后的整体重绘
+    std::unique_ptr<QwtPlotDirectPainter> m_directPainter;
+};
+
+#endif // SASTREAMSERIES_H
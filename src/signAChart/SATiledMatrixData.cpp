@@ -0,0 +1,276 @@
+#include "SATiledMatrixData.h"
+#include "SAParallel.h"
+#include <limits>
+#include <qmath.h>
+
+SATiledMatrixData::SATiledMatrixData()
+{
+
+}
+///
+/// \brief 设置数据并构建所有层
+/// \param values 按行存放的矩阵
+/// \param rows 行数
+/// \param cols 列数
+///
+void SATiledMatrixData::setValues(const double *values, int rows, int cols)
+{
+    clear();
+    if(nullptr == values || rows <= 0 || cols <= 0)
+    {
+        return;
+    }
+    const int shift = tileShift();
+    const int ts = tileSize();
+    Level level0 = createLevel(rows,cols);
+    QVector<float>* tiles = level0.tiles.data();
+    const int tileRows = level0.tileRows;
+    const int tileCols = level0.tileCols;
+    const int parts = qMin(SA::parallelPartCount(qint64(rows) * cols,SA_TILED_MATRIX_MIN_CHUNK),tileRows);
+    QVector<double> mins(parts,std::numeric_limits<double>::infinity());
+    QVector<double> maxs(parts,-std::numeric_limits<double>::infinity());
+    double* pMin = mins.data();
+    double* pMax = maxs.data();
+    //按分块行分段，每段把原始数据拷贝到自己的分块并统计值范围
+    SA::parallelFor(parts,[=](int p){
+        const int tr0 = tileRows * p / parts;
+        const int tr1 = tileRows * (p+1) / parts;
+        double vmin = pMin[p];
+        double vmax = pMax[p];
+        for(int tr=tr0;tr<tr1;++tr)
+        {
+            for(int tc=0;tc<tileCols;++tc)
+            {
+                tiles[tr*tileCols + tc].fill(std::numeric_limits<float>::quiet_NaN(),ts*ts);
+            }
+            const int r0 = tr << shift;
+            const int r1 = qMin(rows,r0 + ts);
+            for(int r=r0;r<r1;++r)
+            {
+                const double* src = values + qint64(r) * cols;
+                for(int tc=0;tc<tileCols;++tc)
+                {
+                    float* dst = tiles[tr*tileCols + tc].data() + ((r - r0) << shift);
+                    const int c0 = tc << shift;
+                    const int c1 = qMin(cols,c0 + ts);
+                    for(int c=c0;c<c1;++c)
+                    {
+                        const double v = src[c];
+                        dst[c - c0] = static_cast<float>(v);
+                        if(qIsFinite(v))
+                        {
+                            vmin = qMin(vmin,v);
+                            vmax = qMax(vmax,v);
+                        }
+                    }
+                }
+            }
+        }
+        pMin[p] = vmin;
+        pMax[p] = vmax;
+    });
+    double vmin = mins[0];
+    double vmax = maxs[0];
+    for(int p=1;p<parts;++p)
+    {
+        vmin = qMin(vmin,mins[p]);
+        vmax = qMax(vmax,maxs[p]);
+    }
+    if(vmin <= vmax)
+    {
+        m_valueRange.setInterval(vmin,vmax);
+    }
+    m_levels.append(level0);
+    while(m_levels.last().rows > 1 || m_levels.last().cols > 1)
+    {
+        buildLevel(m_levels.size());
+    }
+}
+
+void SATiledMatrixData::setValues(const QVector<double> &values, int rows, int cols)
+{
+    if(qint64(rows) * cols > values.size())
+    {
+        clear();
+        return;
+    }
+    setValues(values.constData(),rows,cols);
+}
+///
+/// \brief 清空
+///
+void SATiledMatrixData::clear()
+{
+    m_levels.clear();
+    m_valueRange = QwtInterval();
+}
+
+bool SATiledMatrixData::isEmpty() const
+{
+    return m_levels.isEmpty();
+}
+
+int SATiledMatrixData::rows() const
+{
+    return m_levels.isEmpty() ? 0 : m_levels[0].rows;
+}
+
+int SATiledMatrixData::cols() const
+{
+    return m_levels.isEmpty() ? 0 : m_levels[0].cols;
+}
+
+int SATiledMatrixData::levelCount() const
+{
+    return m_levels.size();
+}
+
+int SATiledMatrixData::levelRows(int level) const
+{
+    return m_levels[level].rows;
+}
+
+int SATiledMatrixData::levelCols(int level) const
+{
+    return m_levels[level].cols;
+}
+///
+/// \brief 第level层第row行第col列的值
+///
+/// 第level层的一个格子对应原始矩阵2^level×2^level个格子
+/// \param level
+/// \param row
+/// \param col
+/// \return 超出范围时返回NaN
+///
+double SATiledMatrixData::value(int level, int row, int col) const
+{
+    if(level < 0 || level >= m_levels.size())
+    {
+        return qQNaN();
+    }
+    const Level& l = m_levels[level];
+    if(row < 0 || row >= l.rows || col < 0 || col >= l.cols)
+    {
+        return qQNaN();
+    }
+    const int shift = tileShift();
+    const int mask = tileSize() - 1;
+    return l.tiles[(row >> shift) * l.tileCols + (col >> shift)][((row & mask) << shift) + (col & mask)];
+}
+
+const float *SATiledMatrixData::tile(int level, int tileRow, int tileCol) const
+{
+    const Level& l = m_levels[level];
+    return l.tiles[tileRow * l.tileCols + tileCol].constData();
+}
+
+int SATiledMatrixData::tileCols(int level) const
+{
+    return m_levels[level].tileCols;
+}
+
+QwtInterval SATiledMatrixData::valueRange() const
+{
+    return m_valueRange;
+}
+
+int SATiledMatrixData::tileSize()
+{
+    return (1 << tileShift());
+}
+
+int SATiledMatrixData::tileShift()
+{
+    static const int s_shift = [](){
+        int shift = 0;
+        while((1 << shift) < SA_TILED_MATRIX_TILE_SIZE)
+        {
+            ++shift;
+        }
+        return shift;
+    }();
+    return s_shift;
+}
+///
+/// \brief 创建一层，只分配分块的个数，分块内容在构建时分配
+/// \param rows
+/// \param cols
+/// \return
+///
+SATiledMatrixData::Level SATiledMatrixData::createLevel(int rows, int cols)
+{
+    const int ts = tileSize();
+    Level l;
+    l.rows = rows;
+    l.cols = cols;
+    l.tileRows = (rows + ts - 1) / ts;
+    l.tileCols = (cols + ts - 1) / ts;
+    l.tiles.resize(l.tileRows * l.tileCols);
+    return l;
+}
+///
+/// \brief 由下一层构建第level层，每个格子为下一层2×2个格子中非NaN值的均值
+/// \param level
+///
+void SATiledMatrixData::buildLevel(int level)
+{
+    const Level& src = m_levels[level-1];
+    Level dst = createLevel((src.rows + 1) / 2,(src.cols + 1) / 2);
+    const int shift = tileShift();
+    const int ts = tileSize();
+    const int mask = ts - 1;
+    QVector<float>* tiles = dst.tiles.data();
+    const int tileRows = dst.tileRows;
+    const int tileCols = dst.tileCols;
+    const int rows = dst.rows;
+    const int cols = dst.cols;
+    const int parts = qMin(SA::parallelPartCount(qint64(rows) * cols * 4,SA_TILED_MATRIX_MIN_CHUNK),tileRows);
+    auto at = [&src,shift,mask](int r,int c)->float{
+        return src.tiles[(r >> shift) * src.tileCols + (c >> shift)][((r & mask) << shift) + (c & mask)];
+    };
+    SA::parallelFor(parts,[&,tiles](int p){
+        const int tr0 = tileRows * p / parts;
+        const int tr1 = tileRows * (p+1) / parts;
+        for(int tr=tr0;tr<tr1;++tr)
+        {
+            for(int tc=0;tc<tileCols;++tc)
+            {
+                QVector<float>& t = tiles[tr*tileCols + tc];
+                t.fill(std::numeric_limits<float>::quiet_NaN(),ts*ts);
+                float* dstData = t.data();
+                const int r0 = tr << shift;
+                const int r1 = qMin(rows,r0 + ts);
+                const int c0 = tc << shift;
+                const int c1 = qMin(cols,c0 + ts);
+                for(int r=r0;r<r1;++r)
+                {
+                    const int sr1 = qMin(2*r+1,src.rows-1);
+                    for(int c=c0;c<c1;++c)
+                    {
+                        const int sc1 = qMin(2*c+1,src.cols-1);
+                        double sum = 0;
+                        int n = 0;
+                        for(int sr=2*r;sr<=sr1;++sr)
+                        {
+                            for(int sc=2*c;sc<=sc1;++sc)
+                            {
+                                const float v = at(sr,sc);
+                                if(!qIsNaN(v))
+                                {
+                                    sum += v;
+                                    ++n;
+                                }
+                            }
+                        }
+                        if(n > 0)
+                        {
+                            dstData[((r - r0) << shift) + (c - c0)] = static_cast<float>(sum / n);
+                        }
+                    }
+                }
+            }
+        }
+    });
+    m_levels.append(dst);
+}
@@ -0,0 +1,76 @@
+#ifndef SATILEDMATRIXDATA_H
+#define SATILEDMATRIXDATA_H
+#include "SAChartGlobals.h"
+#include <QVector>
+#include "qwt_interval.h"
+
+///
+/// \def 每个分块每个方向的格子数，需要是2的幂
+///
+#ifndef SA_TILED_MATRIX_TILE_SIZE
+#define SA_TILED_MATRIX_TILE_SIZE 256
+#endif
+
+///
+/// \def 并行构建时每个任务至少处理的格子数
+///
+#ifndef SA_TILED_MATRIX_MIN_CHUNK
+#define SA_TILED_MATRIX_MIN_CHUNK 65536
+#endif
+
+///
+/// \brief 分块存放的多分辨率矩阵，用于谱图等大矩阵的显示
+///
+/// 第0层为原始矩阵，往上每层的格子由下一层2×2个格子中非NaN值的均值得到，行列数减半（向上取整），
+/// 直到只剩一个格子；每层按SA_TILED_MATRIX_TILE_SIZE×SA_TILED_MATRIX_TILE_SIZE分块存放，
+/// 相邻的格子在内存中也相邻，缩放时只需要访问可见范围内的分块
+///
+/// 数据以单精度保存，仅用于显示，构建按分块行在线程池中并行
+///
+class SA_CHART_EXPORT SATiledMatrixData
+{
+public:
+    SATiledMatrixData();
+    //设置数据，values按行存放，第r行第c列为values[r*cols+c]
+    void setValues(const double* values, int rows, int cols);
+    void setValues(const QVector<double>& values, int rows, int cols);
+    //清空
+    void clear();
+    bool isEmpty() const;
+    //原始矩阵的行列数
+    int rows() const;
+    int cols() const;
+    //层数
+    int levelCount() const;
+    //第level层的行列数
+    int levelRows(int level) const;
+    int levelCols(int level) const;
+    //第level层第row行第col列的值
+    double value(int level, int row, int col) const;
+    //第level层的一个分块，分块内按行存放，不足一个分块的部分为NaN
+    const float* tile(int level, int tileRow, int tileCol) const;
+    //第level层每行的分块数
+    int tileCols(int level) const;
+    //值范围，忽略NaN，没有有效值时无效
+    QwtInterval valueRange() const;
+    //分块尺寸
+    static int tileSize();
+    static int tileShift();
+private:
+    struct Level
+    {
+        int rows;
+        int cols;
+        int tileRows;
+        int tileCols;
+        QVector<QVector<float> > tiles;
+    };
+    static Level createLevel(int rows, int cols);
+    //由下一层构建第level层
+    void buildLevel(int level);
+private:
+    QVector<Level> m_levels;
+    QwtInterval m_valueRange;
+};
+
+#endif // SATILEDMATRIXDATA_H
@@ -85,7 +85,7 @@ int SAXYDataTracker::itemClosedPoint(const QwtPlotItem *item, const QPoint &pos,
 #if 1
     if(const QwtPlotCurve *pc = dynamic_cast<const QwtPlotCurve *>(item))
     {
-        index = pc->closestPoint (pos,dist);
+        index = SAChart::closestPoint(pc,pos,dist);
         if(-1 != index)
         {
             point = pc->sample(index);
@@ -105,7 +105,7 @@ int SAXYDataTracker::itemClosedPoint(const QwtPlotItem *item, const QPoint &pos,
     case QwtPlotItem::Rtti_PlotCurve:
     {
         const QwtPlotCurve * cur = static_cast<const QwtPlotCurve*>(item);
-        index = cur->closestPoint (pos,dist);
+        index = SAChart::closestPoint(cur,pos,dist);
         if(-1 != index)
         {
             point = cur->sample(index);
@@ -135,7 +135,7 @@ int SAXYDataTracker::itemClosedPoint(const QwtPlotItem *item, const QPoint &pos,
 ///
 /// \brief 遍历所有数据找到最近点
 /// \param pos 绘图坐标
-/// \note 此算法是遍历所有数据，在数据量大时请谨慎
+/// \note 提供空间索引的曲线（如SAXYSeries）通过索引查找，其余曲线会遍历所有数据，在数据量大时请谨慎
 ///
 void SAXYDataTracker::calcClosestPoint(const QPoint& pos)
 {
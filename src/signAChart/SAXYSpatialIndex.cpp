@@ -0,0 +1,470 @@
+#include "SAXYSpatialIndex.h"
+#include "SAMinMaxPyramid.h"
+#include <algorithm>
+#include <limits>
+#include <qmath.h>
+
+SAXYSpatialIndex::SAXYSpatialIndex()
+    :m_series(nullptr)
+    ,m_size(0)
+    ,m_isSortedX(false)
+    ,m_cols(0)
+    ,m_rows(0)
+{
+
+}
+///
+/// \brief 构建索引
+///
+/// 先判断x是否单调，单调时不需要额外内存，否则按点数确定网格尺寸，用计数排序把点索引按格子排列
+/// \param series
+///
+void SAXYSpatialIndex::build(const QwtSeriesData<QPointF> *series)
+{
+    clear();
+    if(nullptr == series)
+    {
+        return;
+    }
+    m_series = series;
+    m_size = static_cast<int>(series->size());
+    if(m_size <= 0)
+    {
+        return;
+    }
+    double left = 0,right = 0,top = 0,bottom = 0;
+    bool hasValid = false;
+    m_isSortedX = true;
+    double prevX = 0;
+    for(int i=0;i<m_size;++i)
+    {
+        const QPointF p = series->sample(i);
+        if(m_isSortedX && ((i > 0 && !(p.x() >= prevX)) || qIsNaN(p.x())))
+        {
+            m_isSortedX = false;
+        }
+        prevX = p.x();
+        if(qIsNaN(p.x()) || qIsNaN(p.y()))
+        {
+            continue;
+        }
+        if(!hasValid)
+        {
+            left = right = p.x();
+            top = bottom = p.y();
+            hasValid = true;
+            continue;
+        }
+        left = qMin(left,p.x());
+        right = qMax(right,p.x());
+        top = qMin(top,p.y());
+        bottom = qMax(bottom,p.y());
+    }
+    if(!hasValid)
+    {
+        return;
+    }
+    m_bound = QRectF(QPointF(left,top),QPointF(right,bottom));
+    if(m_isSortedX)
+    {
+        return;
+    }
+    //网格尺寸，按外接矩形的宽高比分配行列
+    const int cellCount = qMax(1,m_size / SA_XY_SPATIAL_INDEX_CELL_POINTS);
+    const double w = qMax(m_bound.width(),1e-300);
+    const double h = qMax(m_bound.height(),1e-300);
+    m_cols = qBound(1,qRound(qSqrt(cellCount * w / h)),cellCount);
+    m_rows = qMax(1,cellCount / m_cols);
+    m_cellStart.fill(0,m_cols*m_rows + 1);
+    QVector<int> cellOfPoint(m_size,-1);
+    for(int i=0;i<m_size;++i)
+    {
+        const QPointF p = series->sample(i);
+        if(qIsNaN(p.x()) || qIsNaN(p.y()))
+        {
+            continue;
+        }
+        const int c = cellRow(p.y()) * m_cols + cellCol(p.x());
+        cellOfPoint[i] = c;
+        ++m_cellStart[c+1];
+    }
+    for(int c=0;c<m_cols*m_rows;++c)
+    {
+        m_cellStart[c+1] += m_cellStart[c];
+    }
+    m_cellIndexs.resize(m_cellStart.last());
+    QVector<int> cursor = m_cellStart;
+    for(int i=0;i<m_size;++i)
+    {
+        if(cellOfPoint[i] >= 0)
+        {
+            m_cellIndexs[cursor[cellOfPoint[i]]++] = i;
+        }
+    }
+}
+///
+/// \brief 清空
+///
+void SAXYSpatialIndex::clear()
+{
+    m_series = nullptr;
+    m_size = 0;
+    m_isSortedX = false;
+    m_bound = QRectF();
+    m_cols = m_rows = 0;
+    m_cellStart.clear();
+    m_cellIndexs.clear();
+    m_blocks.clear();
+    m_kdIndexs.clear();
+}
+///
+/// \brief 索引对应的数据
+/// \return
+///
+const QwtSeriesData<QPointF> *SAXYSpatialIndex::series() const
+{
+    return m_series;
+}
+///
+/// \brief 点数
+/// \return
+///
+int SAXYSpatialIndex::size() const
+{
+    return m_size;
+}
+///
+/// \brief x是否单调不减
+/// \return
+///
+bool SAXYSpatialIndex::isSortedX() const
+{
+    return m_isSortedX;
+}
+///
+/// \brief 所有有效点的外接矩形
+/// \return
+///
+QRectF SAXYSpatialIndex::boundingRect() const
+{
+    return m_bound;
+}
+///
+/// \brief 查询矩形内的点
+/// \param rect 范围，判断规则和QRectF::contains一致
+/// \param indexs 结果，按索引升序追加
+///
+void SAXYSpatialIndex::query(const QRectF &rect, QVector<int> &indexs) const
+{
+    if(rect.isNull() || !rect.isValid())
+    {
+        return;
+    }
+    queryCandidates(rect.normalized(),indexs,[&rect](const QPointF& p)->bool{
+        return rect.contains(p);
+    });
+}
+///
+/// \brief 查询区域内的点
+/// \param path 范围，判断规则和QPainterPath::contains一致
+/// \param indexs 结果，按索引升序追加
+///
+void SAXYSpatialIndex::query(const QPainterPath &path, QVector<int> &indexs) const
+{
+    if(path.isEmpty())
+    {
+        return;
+    }
+    queryCandidates(path.boundingRect(),indexs,[&path](const QPointF& p)->bool{
+        return path.contains(p);
+    });
+}
+///
+/// \brief 查找屏幕上离pos最近的点，结果和QwtPlotCurve::closestPoint一致
+///
+/// x单调时从pos所在的块开始向两侧扩展，块在x方向的屏幕距离不小于当前最近距离时停止该方向，
+/// 块的屏幕外接矩形距离不小于当前最近距离时跳过整块；x不单调时在kd树中查找，
+/// 划分线的屏幕距离不小于当前最近距离时跳过另一侧
+/// \param pos 屏幕坐标
+/// \param xMap x坐标映射，需要是线性
+/// \param yMap y坐标映射，需要是线性
+/// \param dist 不为nullptr时返回最近点的屏幕距离
+/// \return 最近点的索引，没有有效点或坐标映射非线性时返回-1
+///
+int SAXYSpatialIndex::closestPoint(const QPointF &pos, const QwtScaleMap &xMap, const QwtScaleMap &yMap, double *dist) const
+{
+    if(nullptr == m_series || m_size <= 0 || m_bound.isNull() || !isLinearMap(xMap) || !isLinearMap(yMap))
+    {
+        return -1;
+    }
+    int index = -1;
+    double dmin = std::numeric_limits<double>::max();
+    //点到屏幕区间[a,b]的距离
+    auto gap = [](double v,double a,double b)->double{
+        if(a > b)
+        {
+            qSwap(a,b);
+        }
+        return (v < a) ? (a - v) : ((v > b) ? (v - b) : 0.0);
+    };
+    if(m_isSortedX)
+    {
+        buildBlocks();
+        const int blockCount = m_blocks.size();
+        const int first = qMin(SAMinMaxPyramid::lowerBound(m_series,xMap.invTransform(pos.x())),m_size-1);
+        const int start = first / SA_XY_SPATIAL_INDEX_BLOCK_POINTS;
+        //dir为1时往右，-1时往左
+        for(int dir=1;dir>=-1;dir-=2)
+        {
+            for(int b=(dir > 0 ? start : start-1);b>=0 && b<blockCount;b+=dir)
+            {
+                const Block& block = m_blocks[b];
+                const double gx = gap(pos.x(),xMap.transform(block.x0),xMap.transform(block.x1));
+                if(gx*gx > dmin)
+                {
+                    break;
+                }
+                if(block.ymin > block.ymax)
+                {
+                    continue;
+                }
+                const double gy = gap(pos.y(),yMap.transform(block.ymin),yMap.transform(block.ymax));
+                if(gx*gx + gy*gy > dmin)
+                {
+                    continue;
+                }
+                const int last = qMin((b+1)*SA_XY_SPATIAL_INDEX_BLOCK_POINTS,m_size);
+                for(int i=b*SA_XY_SPATIAL_INDEX_BLOCK_POINTS;i<last;++i)
+                {
+                    const QPointF p = m_series->sample(i);
+                    const double cx = xMap.transform(p.x()) - pos.x();
+                    const double cy = yMap.transform(p.y()) - pos.y();
+                    const double d = cx*cx + cy*cy;
+                    if(d < dmin || (d == dmin && i < index))
+                    {
+                        dmin = d;
+                        index = i;
+                    }
+                }
+            }
+        }
+    }
+    else
+    {
+        buildKdTree();
+        searchKdTree(0,m_kdIndexs.size(),0,pos,xMap,yMap,index,dmin);
+    }
+    if(dist && index >= 0)
+    {
+        *dist = qSqrt(dmin);
+    }
+    return index;
+}
+///
+/// \brief 坐标映射是否为线性
+/// \param map
+/// \return
+///
+bool SAXYSpatialIndex::isLinearMap(const QwtScaleMap &map)
+{
+    return nullptr == map.transformation();
+}
+
+void SAXYSpatialIndex::buildBlocks() const
+{
+    if(!m_blocks.isEmpty())
+    {
+        return;
+    }
+    const int count = (m_size + SA_XY_SPATIAL_INDEX_BLOCK_POINTS - 1) / SA_XY_SPATIAL_INDEX_BLOCK_POINTS;
+    m_blocks.resize(count);
+    for(int b=0;b<count;++b)
+    {
+        const int from = b*SA_XY_SPATIAL_INDEX_BLOCK_POINTS;
+        const int last = qMin(from + SA_XY_SPATIAL_INDEX_BLOCK_POINTS,m_size);
+        Block& block = m_blocks[b];
+        block.x0 = m_series->sample(from).x();
+        block.x1 = m_series->sample(last-1).x();
+        block.ymin = std::numeric_limits<double>::max();
+        block.ymax = -std::numeric_limits<double>::max();
+        for(int i=from;i<last;++i)
+        {
+            const double y = m_series->sample(i).y();
+            if(qIsNaN(y))
+            {
+                continue;
+            }
+            block.ymin = qMin(block.ymin,y);
+            block.ymax = qMax(block.ymax,y);
+        }
+    }
+}
+
+void SAXYSpatialIndex::buildKdTree() const
+{
+    if(!m_kdIndexs.isEmpty())
+    {
+        return;
+    }
+    m_kdIndexs.reserve(m_size);
+    for(int i=0;i<m_size;++i)
+    {
+        const QPointF p = m_series->sample(i);
+        if(!qIsNaN(p.x()) && !qIsNaN(p.y()))
+        {
+            m_kdIndexs.append(i);
+        }
+    }
+    buildKdTree(0,m_kdIndexs.size(),0);
+}
+
+void SAXYSpatialIndex::buildKdTree(int from, int to, int depth) const
+{
+    if(to - from <= 1)
+    {
+        return;
+    }
+    const int mid = (from + to) / 2;
+    const QwtSeriesData<QPointF>* series = m_series;
+    if(depth % 2 == 0)
+    {
+        std::nth_element(m_kdIndexs.begin()+from,m_kdIndexs.begin()+mid,m_kdIndexs.begin()+to
+                         ,[series](int a,int b)->bool{
+            return series->sample(a).x() < series->sample(b).x();
+        });
+    }
+    else
+    {
+        std::nth_element(m_kdIndexs.begin()+from,m_kdIndexs.begin()+mid,m_kdIndexs.begin()+to
+                         ,[series](int a,int b)->bool{
+            return series->sample(a).y() < series->sample(b).y();
+        });
+    }
+    buildKdTree(from,mid,depth+1);
+    buildKdTree(mid+1,to,depth+1);
+}
+
+void SAXYSpatialIndex::searchKdTree(int from, int to, int depth, const QPointF &pos, const QwtScaleMap &xMap, const QwtScaleMap &yMap, int &index, double &dmin) const
+{
+    if(from >= to)
+    {
+        return;
+    }
+    const int mid = (from + to) / 2;
+    const int i = m_kdIndexs[mid];
+    const QPointF p = m_series->sample(i);
+    const double sx = xMap.transform(p.x());
+    const double sy = yMap.transform(p.y());
+    const double cx = sx - pos.x();
+    const double cy = sy - pos.y();
+    const double d = cx*cx + cy*cy;
+    if(d < dmin || (d == dmin && i < index))
+    {
+        //距离相同时取索引小的，和顺序遍历的结果一致
+        dmin = d;
+        index = i;
+    }
+    //判断pos在划分线的哪一侧需要用数值坐标，屏幕坐标可能是反向的
+    double gapSplit;
+    bool isLeft;
+    if(depth % 2 == 0)
+    {
+        isLeft = xMap.invTransform(pos.x()) < p.x();
+        gapSplit = cx;
+    }
+    else
+    {
+        isLeft = yMap.invTransform(pos.y()) < p.y();
+        gapSplit = cy;
+    }
+    if(isLeft)
+    {
+        searchKdTree(from,mid,depth+1,pos,xMap,yMap,index,dmin);
+        if(gapSplit*gapSplit <= dmin)
+        {
+            searchKdTree(mid+1,to,depth+1,pos,xMap,yMap,index,dmin);
+        }
+    }
+    else
+    {
+        searchKdTree(mid+1,to,depth+1,pos,xMap,yMap,index,dmin);
+        if(gapSplit*gapSplit <= dmin)
+        {
+            searchKdTree(from,mid,depth+1,pos,xMap,yMap,index,dmin);
+        }
+    }
+}
+
+template<typename FpContains>
+void SAXYSpatialIndex::queryCandidates(const QRectF &bound, QVector<int> &indexs, FpContains fpContains) const
+{
+    if(nullptr == m_series || m_size <= 0 || (!m_isSortedX && m_cellStart.isEmpty()))
+    {
+        //没有有效点
+        return;
+    }
+    if(bound.right() < m_bound.left() || bound.left() > m_bound.right()
+            || bound.bottom() < m_bound.top() || bound.top() > m_bound.bottom())
+    {
+        return;
+    }
+    if(m_isSortedX)
+    {
+        const int first = SAMinMaxPyramid::lowerBound(m_series,bound.left());
+        const int last = SAMinMaxPyramid::upperBound(m_series,bound.right());
+        for(int i=first;i<last;++i)
+        {
+            const QPointF p = m_series->sample(i);
+            if(p.y() >= bound.top() && p.y() <= bound.bottom() && fpContains(p))
+            {
+                indexs.append(i);
+            }
+        }
+        return;
+    }
+    const int c0 = cellCol(bound.left());
+    const int c1 = cellCol(bound.right());
+    const int r0 = cellRow(bound.top());
+    const int r1 = cellRow(bound.bottom());
+    const int oldSize = indexs.size();
+    for(int r=r0;r<=r1;++r)
+    {
+        for(int c=c0;c<=c1;++c)
+        {
+            const int cell = r*m_cols + c;
+            for(int k=m_cellStart[cell];k<m_cellStart[cell+1];++k)
+            {
+                const int i = m_cellIndexs[k];
+                const QPointF p = m_series->sample(i);
+                if(bound.contains(p) && fpContains(p))
+                {
+                    indexs.append(i);
+                }
+            }
+        }
+    }
+    std::sort(indexs.begin()+oldSize,indexs.end());
+}
+
+int SAXYSpatialIndex::cellCol(double x) const
+{
+    const double w = m_bound.width();
+    if(w <= 0)
+    {
+        return 0;
+    }
+    //先在浮点下截断，避免超出int范围
+    const double c = qBound(0.0,(x - m_bound.left()) / w * m_cols,double(m_cols-1));
+    return static_cast<int>(c);
+}
+
+int SAXYSpatialIndex::cellRow(double y) const
+{
+    const double h = m_bound.height();
+    if(h <= 0)
+    {
+        return 0;
+    }
+    const double r = qBound(0.0,(y - m_bound.top()) / h * m_rows,double(m_rows-1));
+    return static_cast<int>(r);
+}
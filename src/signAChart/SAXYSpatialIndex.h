@@ -0,0 +1,105 @@
+#ifndef SAXYSPATIALINDEX_H
+#define SAXYSPATIALINDEX_H
+#include "SAChartGlobals.h"
+#include <QVector>
+#include <QPointF>
+#include <QRectF>
+#include <QPainterPath>
+#include "qwt_series_data.h"
+#include "qwt_scale_map.h"
+
+///
+/// \def 均匀网格每个格子期望的点数
+///
+#ifndef SA_XY_SPATIAL_INDEX_CELL_POINTS
+#define SA_XY_SPATIAL_INDEX_CELL_POINTS 16
+#endif
+
+///
+/// \def x单调时最近点查找的分块点数
+///
+#ifndef SA_XY_SPATIAL_INDEX_BLOCK_POINTS
+#define SA_XY_SPATIAL_INDEX_BLOCK_POINTS 64
+#endif
+
+///
+/// \brief xy数据的空间索引，用于选区内数据的快速提取
+///
+/// x单调时直接通过二分查找定位x范围，否则构建均匀网格，每个格子记录落在其中的点的索引，
+/// 查询时先用选区的外接矩形筛选出候选点，只对候选点做精确的包含判断
+///
+/// 最近点查找同样分两种情况，x单调时按块记录x范围和y范围，从鼠标所在的块向两侧扩展，
+/// 块的屏幕距离超过当前最近距离时停止；否则构建隐式kd树（点索引的排列，按中位数交替以x、y划分），
+/// 两种结构都在第一次查找时才构建
+///
+/// 索引不复制数据，只保存数据指针，数据变化后索引必须重新构建，一般由曲线持有，
+/// 见\sa SAXYSpatialIndexProvider
+///
+class SA_CHART_EXPORT SAXYSpatialIndex
+{
+public:
+    SAXYSpatialIndex();
+    //构建索引
+    void build(const QwtSeriesData<QPointF>* series);
+    //清空
+    void clear();
+    //索引对应的数据
+    const QwtSeriesData<QPointF>* series() const;
+    //点数
+    int size() const;
+    //x是否单调不减
+    bool isSortedX() const;
+    //所有有效点的外接矩形
+    QRectF boundingRect() const;
+    //查询矩形内的点，结果按索引升序
+    void query(const QRectF& rect, QVector<int>& indexs) const;
+    //查询区域内的点，先用外接矩形筛选，再对候选点做精确判断，结果按索引升序
+    void query(const QPainterPath& path, QVector<int>& indexs) const;
+    //查找屏幕上离pos最近的点，xMap和yMap需要是线性坐标，返回-1代表没有找到
+    int closestPoint(const QPointF& pos, const QwtScaleMap& xMap, const QwtScaleMap& yMap, double* dist = nullptr) const;
+    //坐标映射是否为线性，非线性坐标（如对数坐标）下最近点查找的剪枝不成立
+    static bool isLinearMap(const QwtScaleMap& map);
+private:
+    //x单调时最近点查找用的块
+    struct Block
+    {
+        double x0;///< 块内第一个点的x
+        double x1;///< 块内最后一个点的x
+        double ymin;///< 块内y最小值，块内都是nan时大于ymax
+        double ymax;///< 块内y最大值
+    };
+    void buildBlocks() const;
+    void buildKdTree() const;
+    void buildKdTree(int from, int to, int depth) const;
+    //在kd树的[from,to)区间中查找，dmin为当前最近距离的平方
+    void searchKdTree(int from, int to, int depth, const QPointF& pos, const QwtScaleMap& xMap, const QwtScaleMap& yMap, int& index, double& dmin) const;
+    //外接矩形筛选候选点，fpContains为精确判断
+    template<typename FpContains>
+    void queryCandidates(const QRectF& bound, QVector<int>& indexs, FpContains fpContains) const;
+    int cellCol(double x) const;
+    int cellRow(double y) const;
+private:
+    const QwtSeriesData<QPointF>* m_series;
+    int m_size;
+    bool m_isSortedX;
+    QRectF m_bound;
+    int m_cols;
+    int m_rows;
+    QVector<int> m_cellStart;///< 每个格子在m_cellIndexs中的起始位置，长度为格子数+1
+    QVector<int> m_cellIndexs;///< 按格子排列的点索引
+    mutable QVector<Block> m_blocks;///< x单调时的分块，第一次查找最近点时构建
+    mutable QVector<int> m_kdIndexs;///< 隐式kd树，每个区间的中点为划分点，第一次查找最近点时构建
+};
+
+///
+/// \brief 提供空间索引的接口，持有索引的曲线继承此接口，SAChart的区域提取函数会优先使用索引
+///
+class SA_CHART_EXPORT SAXYSpatialIndexProvider
+{
+public:
+    virtual ~SAXYSpatialIndexProvider(){}
+    //获取空间索引，索引需要和当前数据一致，返回nullptr代表没有索引
+    virtual const SAXYSpatialIndex* getSpatialIndex() const = 0;
+};
+
+#endif // SAXYSPATIALINDEX_H
@@ -8,6 +8,9 @@
 #include <qwt_column_symbol.h>
 #include <numeric>
 #include <QPalette>
+#include "SAChart.h"
+#include "SAXYSpatialIndex.h"
+#include "SAMinMaxPyramid.h"
 SAYDataTracker::SAYDataTracker( QWidget *canvas ):
 QwtPlotPicker( canvas )
 {
@@ -103,6 +106,27 @@ QLineF SAYDataTracker::curveLineAt(const QwtPlotCurve *curve, double x ) const
 
     if ( curve->dataSize() >= 2 )
     {
+        const SAXYSpatialIndex* spatialIndex = SAChart::getSpatialIndex(curve);
+        if(spatialIndex)
+        {
+            //有空间索引时可以知道x是否单调，x不单调时二分查找没有意义
+            if(!spatialIndex->isSortedX())
+            {
+                return line;
+            }
+            const int index = SAMinMaxPyramid::upperBound(curve->data(),x);
+            if(index > 0 && index < spatialIndex->size())
+            {
+                line.setP1( curve->sample( index - 1 ) );
+                line.setP2( curve->sample( index ) );
+            }
+            else if(index == spatialIndex->size() && x == curve->sample( index - 1 ).x())
+            {
+                line.setP1( curve->sample( index - 2 ) );
+                line.setP2( curve->sample( index - 1 ) );
+            }
+            return line;
+        }
         const QRectF br = curve->boundingRect();
         if ( br.isValid() && x >= br.left() && x <= br.right() )
         {
@@ -23,6 +23,7 @@ CONFIG += c++11
 
 
 include($$PWD/../3rdParty/qwt/qwt_set.pri)
+include($$PWD/../signAUtil/signAUtil.pri)
 
 
 DEFINES += SA_CHART_MAKE #定义此变量后将会构建DEFINES += USE_QWT#定义绘图引擎使用qwt
@@ -49,7 +50,12 @@ HEADERS += \
     SAEllipseRegionSelectEditor.h \
     SAPolygonRegionSelectEditor.h \
     SACrossTracker.h \
-    SAQwtSerialize.h
+    SAQwtSerialize.h \
+    SAMinMaxPyramid.h \
+    SAXYSpatialIndex.h \
+    SASpscRingBuffer.h \
+    SAStreamSeries.h \
+    SATiledMatrixData.h
 
 SOURCES += \
     QwtPlotItemDataModel.cpp \
@@ -70,6 +76,10 @@ SOURCES += \
     SAEllipseRegionSelectEditor.cpp \
     SAPolygonRegionSelectEditor.cpp \
     SACrossTracker.cpp \
-    SAQwtSerialize.cpp
+    SAQwtSerialize.cpp \
+    SAMinMaxPyramid.cpp \
+    SAXYSpatialIndex.cpp \
+    SAStreamSeries.cpp \
+    SATiledMatrixData.cpp
 
 OTHER_FILES += readme.md
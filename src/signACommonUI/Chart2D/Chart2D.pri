@@ -8,11 +8,15 @@ HEADERS += \
     $$PWD/SAXYSeries.h \
     $$PWD/SABarSeries.h \
     $$PWD/SASeriesAndDataPtrMapper.h \
+    $$PWD/SASeriesDataReferenceResolver.h \
     $$PWD/SAFigureOptCommand.h \
     $$PWD/SAFigureOptCommands.h \
     $$PWD/SASelectRegionEditor.h \
     $$PWD/SASelectRegionDataEditor.h \
     $$PWD/SAScatterSeries.h \
+    $$PWD/SAScatterDensityCache.h \
+    $$PWD/SAChartMainThreadPoster.h \
+    $$PWD/SASpectrogramSeries.h \
     $$PWD/SABoxSeries.h \
     $$PWD/SAHistogramSeries.h \
     $$PWD/SAPlotItemTreeModel.h \
@@ -29,11 +33,15 @@ SOURCES += \
     $$PWD/SAXYSeries.cpp \
     $$PWD/SABarSeries.cpp \
     $$PWD/SASeriesAndDataPtrMapper.cpp \
+    $$PWD/SASeriesDataReferenceResolver.cpp \
     $$PWD/SAFigureOptCommand.cpp \
     $$PWD/SAFigureOptCommands.cpp \
     $$PWD/SASelectRegionEditor.cpp \
     $$PWD/SASelectRegionDataEditor.cpp \
     $$PWD/SAScatterSeries.cpp \
+    $$PWD/SAScatterDensityCache.cpp \
+    $$PWD/SAChartMainThreadPoster.cpp \
+    $$PWD/SASpectrogramSeries.cpp \
     $$PWD/SABoxSeries.cpp \
     $$PWD/SAHistogramSeries.cpp \
     $$PWD/SAPlotItemTreeModel.cpp \
@@ -29,6 +29,7 @@
 #include "SAIntervalSeries.h"
 #include "SABoxSeries.h"
 #include "SAHistogramSeries.h"
+#include "SASpectrogramSeries.h"
 #include "qwt_plot_intervalcurve.h"
 #include "qwt_plot_multi_barchart.h"
 #include "qwt_plot_canvas.h"
@@ -383,6 +384,7 @@ bool SAChart2D::isPlotChartItem(const QwtPlotItem *item)
     case SA::RTTI_SABoxSeries:
     case SA::RTTI_SAHistogramSeries:
     case SA::RTTI_SAScatterSeries:
+    case SA::RTTI_SASpectrogram:
         return (true);
 
     default:
@@ -808,6 +810,30 @@ SABoxSeries *SAChart2D::addBox(SAAbstractDatas *datas)
 }
 
 
+///
+/// \brief 绘制谱图
+/// \param values 按行存放的矩阵，行对应y，列对应x
+/// \param rows 行数
+/// \param cols 列数
+/// \param xInterval 矩阵在x方向覆盖的范围
+/// \param yInterval 矩阵在y方向覆盖的范围
+/// \param name 名称
+/// \return 矩阵为空时返回nullptr
+///
+SASpectrogramSeries *SAChart2D::addSpectrogram(const QVector<double>& values, int rows, int cols
+    , const QwtInterval& xInterval, const QwtInterval& yInterval, const QString& name)
+{
+    QScopedPointer<SASpectrogramSeries> series(new SASpectrogramSeries(name));
+
+    series->setMatrix(values, rows, cols, xInterval, yInterval);
+    if (series->matrix().isEmpty()) {
+        return (nullptr);
+    }
+    addItem(series.data(), tr("add spectrogram:%1").arg(series->title().text()));
+    return (series.take());
+}
+
+
 ///
 /// \brief 添加一条竖直线
 /// \return
@@ -1289,7 +1315,8 @@ bool SAChart2D::isCurrentSelectItemsHaveChartItem() const
 
     for (int i = 0; i < items.size(); ++i)
     {
-        if (SAChart::checkIsPlotChartItem(items[i])) {
+        if (SAChart::checkIsPlotChartItem(items[i])
+            || (SA::RTTI_SASpectrogram == items[i]->rtti())) {
             return (true);
         }
     }
@@ -1672,6 +1699,7 @@ QDataStream& operator <<(QDataStream& out, const SAChart2D *chart)
         case QwtPlotItem::Rtti_PlotSpectrogram:
         case QwtPlotItem::Rtti_PlotTradingCurve:
         case QwtPlotItem::Rtti_PlotMultiBarChart:
+        case SA::RTTI_SASpectrogram:
             break;
 
         default:
@@ -1756,8 +1784,8 @@ QDataStream& operator >>(QDataStream& in, SAChart2D *chart)
         {
         case QwtPlotItem::Rtti_PlotCurve:
         {
-            QScopedPointer<QwtPlotCurve> p(new QwtPlotCurve);
-            in >> tmp0 >> p.data() >> tmp1;
+            QScopedPointer<SAXYSeries> p(new SAXYSeries);
+            in >> tmp0 >> static_cast<QwtPlotCurve *>(p.data()) >> tmp1;
             if ((itemCheck0 != tmp0) || (itemCheck1 != tmp1)) {
                 throw sa::SABadSerializeExpection();
                 return (in);
@@ -1768,8 +1796,8 @@ QDataStream& operator >>(QDataStream& in, SAChart2D *chart)
 
         case QwtPlotItem::Rtti_PlotBarChart:
         {
-            QScopedPointer<QwtPlotBarChart> p(new QwtPlotBarChart);
-            in >> tmp0 >> p.data() >> tmp1;
+            QScopedPointer<SABarSeries> p(new SABarSeries);
+            in >> tmp0 >> static_cast<QwtPlotBarChart *>(p.data()) >> tmp1;
             if ((itemCheck0 != tmp0) || (itemCheck1 != tmp1)) {
                 throw sa::SABadSerializeExpection();
                 return (in);
@@ -17,8 +17,10 @@ class SAAbstractPlotEditor;
 class SABoxSeries;
 class SAHistogramSeries;
 class SAIntervalSeries;
+class SASpectrogramSeries;
 class QwtPlotBarChart;
 class QwtPlotIntervalCurve;
+class QwtInterval;
 ///
 /// \brief sa 2d 曲线绘图的基本窗口封装，包括支持SAAbstractDatas的处理
 ///
@@ -93,6 +95,10 @@ public:
     //绘制箱盒图-支持redo/undo
     SABoxSeries *addBox(SAAbstractDatas *datas);
 
+    //绘制谱图-支持redo/undo
+    SASpectrogramSeries *addSpectrogram(const QVector<double>& values, int rows, int cols
+        , const QwtInterval& xInterval, const QwtInterval& yInterval, const QString& name = QString());
+
     //添加样条线-支持redo/undo
     QwtPlotMarker *addVLine(double val);
     QwtPlotMarker *addHLine(double val);
@@ -0,0 +1,44 @@
+#include "SAChartMainThreadPoster.h"
+#include <QCoreApplication>
+#include <QMutex>
+#include <QMutexLocker>
+
+SAChartMainThreadPoster::SAChartMainThreadPoster():QObject(nullptr)
+{
+    qRegisterMetaType<std::function<void()> >();
+    connect(this,&SAChartMainThreadPoster::posted
+            ,this,&SAChartMainThreadPoster::onPosted
+            ,Qt::QueuedConnection);
+}
+///
+/// \brief 主线程的实例
+///
+/// 无论在哪个线程第一次调用，实例都位于QCoreApplication所在的线程
+/// \return
+///
+SAChartMainThreadPoster *SAChartMainThreadPoster::instance()
+{
+    static SAChartMainThreadPoster* s_poster = nullptr;
+    static QBasicMutex s_mutex;
+    QMutexLocker locker(&s_mutex);
+    if(nullptr == s_poster)
+    {
+        s_poster = new SAChartMainThreadPoster();
+        s_poster->moveToThread(QCoreApplication::instance()->thread());
+        s_poster->setParent(QCoreApplication::instance());
+    }
+    return s_poster;
+}
+///
+/// \brief 投递回调，回调在主线程的事件循环中执行
+/// \param fp
+///
+void SAChartMainThreadPoster::post(const std::function<void()> &fp)
+{
+    emit instance()->posted(fp);
+}
+
+void SAChartMainThreadPoster::onPosted(const std::function<void()> &fp)
+{
+    fp();
+}
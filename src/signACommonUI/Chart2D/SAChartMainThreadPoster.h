@@ -0,0 +1,41 @@
+#ifndef SACHARTMAINTHREADPOSTER_H
+#define SACHARTMAINTHREADPOSTER_H
+#include "SACommonUIGlobal.h"
+#include <QObject>
+#include <QMetaType>
+#include <functional>
+Q_DECLARE_METATYPE(std::function<void()>)
+
+///
+/// \brief 把后台线程的结果投递回主线程
+///
+/// 绘图元素在线程池中构建缓存，完成后通过queued信号回到主线程执行回调，
+/// 回调中需要自行判断所属的绘图元素是否还存在（例如持有weak_ptr）
+///
+/// \code
+/// SAChartMainThreadPoster::post([weakState,result](){
+///     auto state = weakState.lock();
+///     if(state)
+///     {
+///         ...
+///     }
+/// });
+/// \endcode
+///
+class SA_COMMON_UI_EXPORT SAChartMainThreadPoster : public QObject
+{
+    Q_OBJECT
+public:
+    //主线程的实例
+    static SAChartMainThreadPoster* instance();
+    //投递回调，可以在任意线程调用
+    static void post(const std::function<void()>& fp);
+signals:
+    void posted(const std::function<void()>& fp);
+private slots:
+    void onPosted(const std::function<void()>& fp);
+private:
+    SAChartMainThreadPoster();
+};
+
+#endif // SACHARTMAINTHREADPOSTER_H
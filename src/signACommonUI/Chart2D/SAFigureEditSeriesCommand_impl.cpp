@@ -3,6 +3,7 @@
 #include "qwt_series_store.h"
 #include "SAChart.h"
 #include "QwtPlotItemDataModel.h"
+#include "SAXYSeries.h"
 ///
 /// \brief The SAFigureEditSeriesDataCommandPrivate class
 /// 通用impl接口
@@ -27,6 +28,16 @@ public:
     virtual void undo() = 0;
     //api isSizeChanged
     virtual bool isSizeChanged() const = 0;
+protected:
+    //只修改了[from,to]的值，曲线的降采样金字塔增量更新，不需要整体重建
+    void updateLodRange(int from,int to)
+    {
+        SAXYSeries* series = dynamic_cast<SAXYSeries*>(m_item);
+        if(series)
+        {
+            series->updateLodRange(from,to);
+        }
+    }
 private:
     SAChart2D *m_chart;
     QwtPlotItem *m_item;
@@ -163,6 +174,10 @@ void SAFigureDataCommandEditSeriesPrivate_SeriesStoreItem<T,PlotItemType,FpSetFu
         vecDatas[m_index] = m_newData;
     }
     m_fpSetSample(item(),vecDatas);
+    if(!m_isSizeChanged)
+    {
+        updateLodRange(m_index,m_index);
+    }
 }
 
 
@@ -184,6 +199,10 @@ void SAFigureDataCommandEditSeriesPrivate_SeriesStoreItem<T, PlotItemType, FpSet
         vecDatas.resize(m_oldDataSize);
     }
     m_fpSetSample(item(),vecDatas);
+    if(!m_isSizeChanged)
+    {
+        updateLodRange(m_index,m_index);
+    }
     //SAChart::setVectorSampleData(item(),vecDatas);
 }
 
@@ -80,15 +80,8 @@ void SAFigureRemoveSeriesDatasInRangCommandPrivate_SeriesStoreItem<T,PlotItemTyp
 ::init(const QPainterPath &selectRange)
 {
     m_oldDataSize = (int)(m_series->dataSize());
-    for(int i = 0;i<m_oldDataSize;++i)
-    {
-        const T& data = m_series->sample(i);
-        if(m_fpCheckValueInRange(selectRange,data))
-        {
-            m_inRangeDatas.append(data);
-            m_inRangeIndexs.append(i);
-        }
-    }
+    //2d点会通过曲线的空间索引先按外接矩形筛选
+    SAChart::getSamplesInRang(m_inRangeDatas,m_inRangeIndexs,m_series,selectRange,m_fpCheckValueInRange);
     m_isValid = (m_inRangeDatas.size() > 0);
 }
 template<typename T,typename PlotItemType,typename FpSetSeriesSampleFun,typename FpCheckValueInRange>
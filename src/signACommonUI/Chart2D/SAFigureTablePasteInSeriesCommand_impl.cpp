@@ -1,6 +1,7 @@
 ﻿#include "SAFigureTableCommands.h"
 #include "QwtPlotItemDataModel.h"
 #include "SAChart.h"
+#include "SAXYSeries.h"
 ///
 /// \brief The SAAbstractFiguresTablePasteInSeriesCommandPrivate class
 /// 通用impl接口
@@ -26,6 +27,16 @@ public:
     //api isSizeChanged
     virtual bool isSizeChanged() const = 0;
     static QSize getClipboardTableSize(const QList<QVariantList>& clipboardTable);
+protected:
+    //只修改了[from,to]的值，曲线的降采样金字塔增量更新，不需要整体重建
+    void updateLodRange(int from,int to)
+    {
+        SAXYSeries* series = dynamic_cast<SAXYSeries*>(m_item);
+        if(series)
+        {
+            series->updateLodRange(from,to);
+        }
+    }
 private:
     SAChart2D *m_chart;
     QwtPlotItem *m_item;
@@ -190,6 +201,11 @@ void SAFigureTablePasteInSeriesCommandPrivate_SeriesStoreItem<T, PlotItemType, F
             vecDatas[index] = std::get<2>((*i));
     }
     m_fpSetSample(item(),vecDatas);
+    if(!m_isSizeChanged && !m_replaceInfos.isEmpty())
+    {
+        //替换的行号是递增的
+        updateLodRange(std::get<0>(m_replaceInfos.first()),std::get<0>(m_replaceInfos.last()));
+    }
 }
 template<typename T,typename PlotItemType,typename FpSetFun,typename FpSetSeriesSampleFun>
 void SAFigureTablePasteInSeriesCommandPrivate_SeriesStoreItem<T, PlotItemType, FpSetFun,FpSetSeriesSampleFun>
@@ -211,6 +227,10 @@ void SAFigureTablePasteInSeriesCommandPrivate_SeriesStoreItem<T, PlotItemType, F
             vecDatas[index] = std::get<1>((*i));
     }
     m_fpSetSample(item(),vecDatas);
+    if(!m_isSizeChanged && !m_replaceInfos.isEmpty())
+    {
+        updateLodRange(std::get<0>(m_replaceInfos.first()),std::get<0>(m_replaceInfos.last()));
+    }
 }
 template<typename T,typename PlotItemType,typename FpSetFun,typename FpSetSeriesSampleFun>
 bool SAFigureTablePasteInSeriesCommandPrivate_SeriesStoreItem<T, PlotItemType, FpSetFun,FpSetSeriesSampleFun>
@@ -11,8 +11,15 @@
 #include <QChildEvent>
 #include <QCursor>
 #include <QPainter>
+#include <QRunnable>
+#include <QThreadPool>
+#include <QThread>
+//qwt
+#include "qwt_plot_renderer.h"
+#include "qwt_plot_canvas.h"
 //sa chart
 #include "SAChart2D.h"
+#include "SAXYSeries.h"
 #include "SAQwtSerialize.h"
 //sa lib
 #include "SAData.h"
@@ -74,6 +81,86 @@ public:
     }
 };
 
+/**
+ * @brief 在工作线程中把一个子图的画布绘制到QImage
+ *
+ * 坐标映射、画布尺寸和背景在构造时（界面线程）获取，工作线程只调用QwtPlot::drawItems，
+ * 不访问任何widget，运行期间界面线程需要等待，不能修改子图
+ */
+class SAFigureCanvasRenderTask : public QRunnable
+{
+public:
+    SAFigureCanvasRenderTask(const QwtPlot *plot, QImage *image)
+        : m_plot(plot)
+        , m_image(image)
+    {
+        const QWidget *canvas = plot->canvas();
+
+        m_canvasSize = canvas->size();
+        m_contentsRect = canvas->contentsRect();
+        m_background = canvas->palette().brush(canvas->backgroundRole());
+        for (int axisId = 0; axisId < QwtPlot::axisCnt; ++axisId)
+        {
+            m_maps[axisId] = plot->canvasMap(axisId);
+        }
+    }
+
+
+    virtual void run()
+    {
+        if (m_canvasSize.isEmpty()) {
+            return;
+        }
+        *m_image = QImage(m_canvasSize, QImage::Format_ARGB32_Premultiplied);
+        m_image->fill(Qt::transparent);
+        QPainter painter(m_image);
+
+        painter.fillRect(QRect(QPoint(0, 0), m_canvasSize), m_background);
+        painter.setClipRect(m_contentsRect);
+        m_plot->drawItems(&painter, m_contentsRect, m_maps);
+    }
+
+
+private:
+    const QwtPlot *m_plot;
+    QImage *m_image;
+    QSize m_canvasSize;
+    QRect m_contentsRect;
+    QBrush m_background;
+    QwtScaleMap m_maps[QwtPlot::axisCnt];
+};
+
+/**
+ * @brief 合成用的渲染器，标题、坐标轴、图例照常绘制，画布直接使用预先绘制好的图片
+ */
+class SAFigureChartRenderer : public QwtPlotRenderer
+{
+public:
+    SAFigureChartRenderer() : m_canvasImage(nullptr)
+    {
+    }
+
+
+    void setCanvasImage(const QImage *image)
+    {
+        m_canvasImage = image;
+    }
+
+
+    virtual void renderCanvas(const QwtPlot *plot, QPainter *painter, const QRectF& canvasRect, const QwtScaleMap *maps) const
+    {
+        if ((nullptr == m_canvasImage) || m_canvasImage->isNull()) {
+            QwtPlotRenderer::renderCanvas(plot, painter, canvasRect, maps);
+            return;
+        }
+        painter->drawImage(canvasRect, *m_canvasImage);
+    }
+
+
+private:
+    const QImage *m_canvasImage;
+};
+
 //=============================================================================
 
 SAFigureWindow::SAFigureWindow(QWidget *parent) :
@@ -448,6 +535,72 @@ SAFigureContainer *SAFigureWindow::getFigureContainer()
 }
 
 
+/**
+ * @brief 离屏渲染整个绘图窗口
+ *
+ * 子图的画布（数据绘制的主要耗时部分）在独立的线程池中并行绘制到各自的QImage，
+ * 界面线程等待全部完成后，再按子图在窗口中的位置绘制标题、坐标轴、图例并贴上画布图片，
+ * 多子图时耗时取决于最慢的子图而不是所有子图之和
+ *
+ * 曲线的降采样金字塔、空间索引等缓存是第一次绘制时按需构建的，线程中绘制前先在界面线程中构建好，
+ * 见@ref SAXYSeries::prepareForConcurrentDraw
+ * @param isParallel 为false时在界面线程中依次绘制，用于对比或调试
+ * @return 和窗口尺寸一致的图片
+ */
+QImage SAFigureWindow::renderToImage(bool isParallel) const
+{
+    QImage res(size(), QImage::Format_ARGB32_Premultiplied);
+
+    res.fill(Qt::transparent);
+    QPainter painter(&res);
+
+    painter.fillRect(rect(), d_ptr->backgroundBrush);
+    QList<SAChart2D *> charts = get2DPlots();
+
+    for (int i = charts.size() - 1; i >= 0; --i)
+    {
+        if (!charts[i]->isVisible()) {
+            charts.removeAt(i);
+        }
+    }
+    for (int i = 0; i < charts.size(); ++i)
+    {
+        const QwtPlotItemList& items = charts[i]->itemList();
+        for (int j = 0; j < items.size(); ++j)
+        {
+            SAXYSeries *series = dynamic_cast<SAXYSeries *>(items[j]);
+            if (series) {
+                series->prepareForConcurrentDraw();
+            }
+        }
+    }
+    QVector<QImage> canvasImages(charts.size());
+    QThreadPool pool;
+
+    pool.setMaxThreadCount(qMax(QThread::idealThreadCount(), 1));
+    for (int i = 0; i < charts.size(); ++i)
+    {
+        SAFigureCanvasRenderTask *task = new SAFigureCanvasRenderTask(charts[i], &canvasImages[i]);
+        if (isParallel) {
+            pool.start(task);
+        }else {
+            task->run();
+            delete task;
+        }
+    }
+    pool.waitForDone();
+    SAFigureChartRenderer renderer;
+
+    for (int i = 0; i < charts.size(); ++i)
+    {
+        SAChart2D *chart = charts[i];
+        renderer.setCanvasImage(&(canvasImages[i]));
+        renderer.render(chart, &painter, QRectF(chart->mapTo(this, QPoint(0, 0)), chart->size()));
+    }
+    return (res);
+}
+
+
 ///
 /// \brief 返回在当前光标下的2D图
 /// \return 如果当前没有返回nullptr
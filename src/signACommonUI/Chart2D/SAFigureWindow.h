@@ -4,6 +4,7 @@
 #include <QMainWindow>
 #include <QScopedPointer>
 #include <QPainter>
+#include <QImage>
 #include "SAMainWindow.h"
 #include "SACommonUIGlobal.h"
 #include "qwt_plot_histogram.h"
@@ -92,6 +93,9 @@ public:
     //获取窗口容器
     SAFigureContainer *getFigureContainer();
 
+    //离屏渲染整个绘图窗口，isParallel为true时各子图的画布在线程池中并行绘制
+    QImage renderToImage(bool isParallel = true) const;
+
 public slots:
     //redo
     void redo();
@@ -30,6 +30,7 @@ QList<QwtPlotItem *> SAPlotItemTreeModel::getItems(QwtPlot *plot) const
         case SA::RTTI_SABoxSeries:
         case SA::RTTI_SAHistogramSeries:
         case SA::RTTI_SAScatterSeries:
+        case SA::RTTI_SASpectrogram:
             res.append(items[i]);
             break;
         default:
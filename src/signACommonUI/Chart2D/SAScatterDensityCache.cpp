@@ -0,0 +1,295 @@
+#include "SAScatterDensityCache.h"
+#include "SAXYSpatialIndex.h"
+#include "SAParallel.h"
+#include <qmath.h>
+
+///
+/// \brief 把count个点按线程数分段分箱到cells个格子
+///
+/// 每段使用独立的计数数组，最后合并，避免原子操作，最后一段直接累加到out中
+/// \param count 点数
+/// \param cells 格子数
+/// \param out 输出计数，长度为cells，结果累加到out中
+/// \param fpCell 第i个点所在的格子，不在范围内返回-1
+///
+template<typename FpCell>
+static void sa_parallel_bin(int count, int cells, QVector<quint32>& out, FpCell fpCell)
+{
+    const int parts = SA::parallelPartCount(count,SA_SCATTER_DENSITY_MIN_CHUNK);
+    auto binRange = [&fpCell,count,parts](int part,quint32* grid){
+        const int begin = static_cast<int>(qint64(count) * part / parts);
+        const int end = static_cast<int>(qint64(count) * (part+1) / parts);
+        for(int i=begin;i<end;++i)
+        {
+            const int c = fpCell(i);
+            if(c >= 0)
+            {
+                ++grid[c];
+            }
+        }
+    };
+    if(1 == parts)
+    {
+        binRange(0,out.data());
+        return;
+    }
+    QVector<QVector<quint32> > partials(parts-1);
+    QVector<quint32*> grids(parts);
+    for(int p=0;p<parts-1;++p)
+    {
+        partials[p].fill(0,cells);
+        grids[p] = partials[p].data();
+    }
+    grids[parts-1] = out.data();
+    quint32* const* pGrids = grids.constData();
+    SA::parallelFor(parts,[&binRange,pGrids](int p){
+        binRange(p,pGrids[p]);
+    });
+    quint32* dst = out.data();
+    for(int p=0;p<parts-1;++p)
+    {
+        const quint32* src = partials[p].constData();
+        for(int c=0;c<cells;++c)
+        {
+            dst[c] += src[c];
+        }
+    }
+}
+
+SAScatterDensityCache::SAScatterDensityCache()
+{
+
+}
+///
+/// \brief 构建金字塔
+/// \param series
+///
+void SAScatterDensityCache::build(const QwtSeriesData<QPointF> *series)
+{
+    clear();
+    if(nullptr == series || series->size() <= 0)
+    {
+        return;
+    }
+    QRectF bound = series->boundingRect();
+    if(!(bound.width() >= 0) || !(bound.height() >= 0))
+    {
+        return;
+    }
+    //所有点x或y相同时扩展范围，避免除0
+    if(bound.width() <= 0)
+    {
+        bound.adjust(-0.5,0,0.5,0);
+    }
+    if(bound.height() <= 0)
+    {
+        bound.adjust(0,-0.5,0,0.5);
+    }
+    m_bound = bound;
+    const int grid = SA_SCATTER_DENSITY_GRID;
+    QVector<quint32> level0(grid*grid,0);
+    const double left = bound.left();
+    const double top = bound.top();
+    const double sx = grid / bound.width();
+    const double sy = grid / bound.height();
+    sa_parallel_bin(static_cast<int>(series->size()),grid*grid,level0,[series,left,top,sx,sy,grid](int i)->int{
+        const QPointF p = series->sample(i);
+        if(qIsNaN(p.x()) || qIsNaN(p.y()))
+        {
+            return -1;
+        }
+        const int c = qBound(0,static_cast<int>((p.x() - left) * sx),grid-1);
+        const int r = qBound(0,static_cast<int>((p.y() - top) * sy),grid-1);
+        return r*grid + c;
+    });
+    m_levels.append(level0);
+    m_levelGrid.append(grid);
+    //逐层2×2合并
+    while(m_levelGrid.last() > 1)
+    {
+        const int lower = m_levelGrid.last();
+        const int cur = lower / 2;
+        const QVector<quint32>& src = m_levels.last();
+        QVector<quint32> dst(cur*cur,0);
+        for(int r=0;r<cur;++r)
+        {
+            for(int c=0;c<cur;++c)
+            {
+                const int i = 2*r*lower + 2*c;
+                dst[r*cur + c] = src[i] + src[i+1] + src[i+lower] + src[i+lower+1];
+            }
+        }
+        m_levels.append(dst);
+        m_levelGrid.append(cur);
+    }
+}
+///
+/// \brief 清空
+///
+void SAScatterDensityCache::clear()
+{
+    m_bound = QRectF();
+    m_levels.clear();
+    m_levelGrid.clear();
+}
+///
+/// \brief 是否已经构建
+/// \return
+///
+bool SAScatterDensityCache::isValid() const
+{
+    return !m_levels.isEmpty();
+}
+///
+/// \brief 渲染当前可见范围的密度图
+///
+/// 坐标为线性且金字塔最精细一层的格子不大于一个像素时从金字塔重采样，否则直接对点分箱，
+/// 有空间索引时只对可见的点分箱
+/// \param series 数据，需要和构建时一致
+/// \param index 空间索引，可以为nullptr
+/// \param xMap
+/// \param yMap
+/// \param canvasRect
+/// \param lut 颜色表
+/// \return 尺寸和canvasRect一致的图片
+///
+QImage SAScatterDensityCache::render(const QwtSeriesData<QPointF> *series, const SAXYSpatialIndex *index
+                                     , const QwtScaleMap &xMap, const QwtScaleMap &yMap, const QRectF &canvasRect
+                                     , const QVector<QRgb> &lut) const
+{
+    const int width = qCeil(canvasRect.width());
+    const int height = qCeil(canvasRect.height());
+    if(width <= 0 || height <= 0 || nullptr == series || lut.isEmpty())
+    {
+        return QImage();
+    }
+    QVector<quint32> screen(width*height,0);
+    const bool isLinear = SAXYSpatialIndex::isLinearMap(xMap) && SAXYSpatialIndex::isLinearMap(yMap);
+    const double vx0 = xMap.invTransform(canvasRect.left());
+    const double vx1 = xMap.invTransform(canvasRect.right());
+    const double vy0 = yMap.invTransform(canvasRect.top());
+    const double vy1 = yMap.invTransform(canvasRect.bottom());
+    //一个像素对应的数据尺寸
+    const double px = qAbs(vx1 - vx0) / width;
+    const double py = qAbs(vy1 - vy0) / height;
+    bool isResample = false;
+    if(isLinear && isValid())
+    {
+        int level = 0;
+        auto binW = [this](int l)->double{ return m_bound.width() / m_levelGrid[l]; };
+        auto binH = [this](int l)->double{ return m_bound.height() / m_levelGrid[l]; };
+        if(binW(0) <= px && binH(0) <= py)
+        {
+            while((level+1) < m_levels.size() && binW(level+1) <= px && binH(level+1) <= py)
+            {
+                ++level;
+            }
+            resampleLevel(level,xMap,yMap,canvasRect,width,height,screen);
+            isResample = true;
+        }
+    }
+    if(!isResample)
+    {
+        QVector<int> indexs;
+        const bool useIndexs = isLinear && (nullptr != index) && (index->series() == series);
+        if(useIndexs)
+        {
+            index->query(QRectF(QPointF(vx0,vy0),QPointF(vx1,vy1)).normalized(),indexs);
+        }
+        binPoints(series,indexs,useIndexs,xMap,yMap,canvasRect,width,height,screen);
+    }
+    return colorize(screen,width,height,lut);
+}
+
+void SAScatterDensityCache::resampleLevel(int level, const QwtScaleMap &xMap, const QwtScaleMap &yMap, const QRectF &canvasRect
+                                          , int width, int height, QVector<quint32> &screen) const
+{
+    const int grid = m_levelGrid[level];
+    const QVector<quint32>& counts = m_levels[level];
+    const double binW = m_bound.width() / grid;
+    const double binH = m_bound.height() / grid;
+    const double vx0 = qMin(xMap.invTransform(canvasRect.left()),xMap.invTransform(canvasRect.right()));
+    const double vx1 = qMax(xMap.invTransform(canvasRect.left()),xMap.invTransform(canvasRect.right()));
+    const double vy0 = qMin(yMap.invTransform(canvasRect.top()),yMap.invTransform(canvasRect.bottom()));
+    const double vy1 = qMax(yMap.invTransform(canvasRect.top()),yMap.invTransform(canvasRect.bottom()));
+    //只遍历和可见范围相交的格子
+    const int c0 = qBound(0,static_cast<int>(qFloor((vx0 - m_bound.left()) / binW)),grid-1);
+    const int c1 = qBound(0,static_cast<int>(qFloor((vx1 - m_bound.left()) / binW)),grid-1);
+    const int r0 = qBound(0,static_cast<int>(qFloor((vy0 - m_bound.top()) / binH)),grid-1);
+    const int r1 = qBound(0,static_cast<int>(qFloor((vy1 - m_bound.top()) / binH)),grid-1);
+    quint32* dst = screen.data();
+    for(int r=r0;r<=r1;++r)
+    {
+        const double sy = yMap.transform(m_bound.top() + (r + 0.5) * binH) - canvasRect.top();
+        if(!(sy >= 0 && sy < height))
+        {
+            continue;
+        }
+        const int iy = static_cast<int>(sy);
+        for(int c=c0;c<=c1;++c)
+        {
+            const quint32 n = counts[r*grid + c];
+            if(0 == n)
+            {
+                continue;
+            }
+            const double sx = xMap.transform(m_bound.left() + (c + 0.5) * binW) - canvasRect.left();
+            if(sx >= 0 && sx < width)
+            {
+                dst[iy*width + static_cast<int>(sx)] += n;
+            }
+        }
+    }
+}
+
+void SAScatterDensityCache::binPoints(const QwtSeriesData<QPointF> *series, const QVector<int> &indexs, bool useIndexs
+                                      , const QwtScaleMap &xMap, const QwtScaleMap &yMap, const QRectF &canvasRect
+                                      , int width, int height, QVector<quint32> &screen)
+{
+    const double left = canvasRect.left();
+    const double top = canvasRect.top();
+    const int count = useIndexs ? indexs.size() : static_cast<int>(series->size());
+    const int* pIndexs = indexs.constData();
+    sa_parallel_bin(count,width*height,screen,[=,&xMap,&yMap](int i)->int{
+        const QPointF p = series->sample(useIndexs ? pIndexs[i] : i);
+        const double sx = xMap.transform(p.x()) - left;
+        const double sy = yMap.transform(p.y()) - top;
+        if(!(sx >= 0 && sx < width && sy >= 0 && sy < height))
+        {
+            return -1;
+        }
+        return static_cast<int>(sy)*width + static_cast<int>(sx);
+    });
+}
+
+QImage SAScatterDensityCache::colorize(const QVector<quint32> &screen, int width, int height, const QVector<QRgb> &lut)
+{
+    QImage image(width,height,QImage::Format_ARGB32);
+    image.fill(Qt::transparent);
+    quint32 maxCount = 0;
+    for(int i=0;i<screen.size();++i)
+    {
+        maxCount = qMax(maxCount,screen[i]);
+    }
+    if(0 == maxCount)
+    {
+        return image;
+    }
+    //按对数映射，避免少数密集像素把其余像素压到最低一档
+    const double logMax = qLn(1.0 + maxCount);
+    const int last = lut.size() - 1;
+    for(int y=0;y<height;++y)
+    {
+        QRgb* line = reinterpret_cast<QRgb*>(image.scanLine(y));
+        const quint32* counts = screen.constData() + y*width;
+        for(int x=0;x<width;++x)
+        {
+            if(counts[x] > 0)
+            {
+                const int i = qMin(static_cast<int>(qLn(1.0 + counts[x]) / logMax * last + 0.5),last);
+                line[x] = lut[i];
+            }
+        }
+    }
+    return image;
+}
@@ -0,0 +1,65 @@
+#ifndef SASCATTERDENSITYCACHE_H
+#define SASCATTERDENSITYCACHE_H
+#include "SACommonUIGlobal.h"
+#include <QVector>
+#include <QRectF>
+#include <QImage>
+#include <QRgb>
+#include "qwt_series_data.h"
+#include "qwt_scale_map.h"
+class SAXYSpatialIndex;
+
+///
+/// \def 密度金字塔最精细一层每个方向的格子数
+///
+#ifndef SA_SCATTER_DENSITY_GRID
+#define SA_SCATTER_DENSITY_GRID 1024
+#endif
+
+///
+/// \def 并行分箱时每个任务至少处理的点数
+///
+#ifndef SA_SCATTER_DENSITY_MIN_CHUNK
+#define SA_SCATTER_DENSITY_MIN_CHUNK 65536
+#endif
+
+///
+/// \brief 散点密度图的多分辨率缓存
+///
+/// 在数据的外接矩形上建立SA_SCATTER_DENSITY_GRID×SA_SCATTER_DENSITY_GRID的二维直方图，
+/// 往上每层由下一层2×2个格子合并，构成金字塔，构建时按点分段在线程池中并行分箱
+///
+/// 绘制时按当前可见范围选择格子不大于一个像素的最粗一层，只把可见的格子重采样到屏幕网格，
+/// 缩放不需要重新遍历所有点；放大到最精细一层的格子也大于像素时，通过空间索引只对可见的点直接分箱
+///
+class SA_COMMON_UI_EXPORT SAScatterDensityCache
+{
+public:
+    SAScatterDensityCache();
+    //构建金字塔
+    void build(const QwtSeriesData<QPointF>* series);
+    //清空
+    void clear();
+    //是否已经构建
+    bool isValid() const;
+    //渲染当前可见范围的密度图，lut为从低到高的颜色表，没有点的像素透明
+    QImage render(const QwtSeriesData<QPointF>* series, const SAXYSpatialIndex* index
+                  , const QwtScaleMap& xMap, const QwtScaleMap& yMap, const QRectF& canvasRect
+                  , const QVector<QRgb>& lut) const;
+private:
+    //金字塔第level层在可见范围内的格子重采样到屏幕网格
+    void resampleLevel(int level, const QwtScaleMap& xMap, const QwtScaleMap& yMap, const QRectF& canvasRect
+                       , int width, int height, QVector<quint32>& screen) const;
+    //把点直接分箱到屏幕网格，indexs为空时使用所有点
+    static void binPoints(const QwtSeriesData<QPointF>* series, const QVector<int>& indexs, bool useIndexs
+                          , const QwtScaleMap& xMap, const QwtScaleMap& yMap, const QRectF& canvasRect
+                          , int width, int height, QVector<quint32>& screen);
+    //计数映射为颜色
+    static QImage colorize(const QVector<quint32>& screen, int width, int height, const QVector<QRgb>& lut);
+private:
+    QRectF m_bound;                         ///< 金字塔覆盖的数据范围
+    QVector<QVector<quint32> > m_levels;    ///< 每层的计数，按行存放
+    QVector<int> m_levelGrid;               ///< 每层每个方向的格子数
+};
+
+#endif // SASCATTERDENSITYCACHE_H
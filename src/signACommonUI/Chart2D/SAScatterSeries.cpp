@@ -1,23 +1,253 @@
 ﻿#include "SAScatterSeries.h"
+#include "SAScatterDensityCache.h"
+#include "SALineGradientColorList.h"
+#include "SAChartMainThreadPoster.h"
+#include <QPainter>
+#include <QRunnable>
+#include <QThreadPool>
 
+///
+/// \brief 密度金字塔的状态
+///
+/// 和曲线降采样的状态一样按generation判断金字塔是否过期，后台构建的结果回到主线程后，
+/// generation不一致的直接丢弃
+///
+class SAScatterDensityState
+{
+public:
+    SAScatterDensityState(SAScatterSeries* s)
+        :series(s)
+        ,generation(0)
+        ,cacheGeneration(-1)
+        ,buildingGeneration(-1)
+    {
+    }
+    SAScatterSeries* series;
+    int generation;///< 数据的代号
+    int cacheGeneration;///< 金字塔对应的数据代号
+    int buildingGeneration;///< 正在后台构建的数据代号
+    std::shared_ptr<SAScatterDensityCache> cache;
+};
 
+///
+/// \brief 在线程池中构建密度金字塔
+///
+class SAScatterDensityBuilder : public QRunnable
+{
+public:
+    SAScatterDensityBuilder(QwtSeriesData<QPointF>* snapshot,int generation,const std::shared_ptr<SAScatterDensityState>& state)
+        :m_snapshot(snapshot)
+        ,m_generation(generation)
+        ,m_state(state)
+    {
+    }
+    virtual void run()
+    {
+        std::shared_ptr<SAScatterDensityCache> cache = std::make_shared<SAScatterDensityCache>();
+        cache->build(m_snapshot.get());
+        m_snapshot.reset();
+        std::weak_ptr<SAScatterDensityState> weakState = m_state;
+        const int generation = m_generation;
+        SAChartMainThreadPoster::post([weakState,cache,generation](){
+            std::shared_ptr<SAScatterDensityState> state = weakState.lock();
+            if(nullptr == state)
+            {
+                //曲线已经析构
+                return;
+            }
+            if(state->buildingGeneration == generation)
+            {
+                state->buildingGeneration = -1;
+            }
+            if(state->generation != generation)
+            {
+                //构建过程中数据又发生了变化
+                return;
+            }
+            state->cache = cache;
+            state->cacheGeneration = generation;
+            state->series->itemChanged();
+        });
+    }
+private:
+    std::unique_ptr<QwtSeriesData<QPointF> > m_snapshot;
+    int m_generation;
+    std::weak_ptr<SAScatterDensityState> m_state;
+};
 
 SAScatterSeries::SAScatterSeries(const QString &title):SAXYSeries(title)
+  ,m_density(std::make_shared<SAScatterDensityState>(this))
 {
-    setStyle( QwtPlotCurve::Dots );
+    init();
 }
 
 SAScatterSeries::SAScatterSeries(const QwtText &title):SAXYSeries(title)
+  ,m_density(std::make_shared<SAScatterDensityState>(this))
 {
-    setStyle( QwtPlotCurve::Dots );
+    init();
 }
 
 SAScatterSeries::SAScatterSeries(const QString &title, SAAbstractDatas *dataPoints)
     :SAXYSeries(title)
+    ,m_density(std::make_shared<SAScatterDensityState>(this))
 {
-    setStyle( QwtPlotCurve::Dots );
+    init();
     setSamples(dataPoints);
 }
 
+SAScatterSeries::~SAScatterSeries()
+{
+
+}
+///
+/// \brief 设置绘制方式
+/// \param mode
+///
+void SAScatterSeries::setRenderMode(SAScatterSeries::RenderMode mode)
+{
+    if(m_renderMode != mode)
+    {
+        m_renderMode = mode;
+        itemChanged();
+    }
+}
+
+SAScatterSeries::RenderMode SAScatterSeries::renderMode() const
+{
+    return m_renderMode;
+}
+///
+/// \brief 设置自动模式下使用密度图的点数阈值
+/// \param count
+///
+void SAScatterSeries::setDensityThreshold(int count)
+{
+    if(m_densityThreshold != count)
+    {
+        m_densityThreshold = count;
+        itemChanged();
+    }
+}
+
+int SAScatterSeries::densityThreshold() const
+{
+    return m_densityThreshold;
+}
+///
+/// \brief 设置密度图的颜色表
+/// \param clr 颜色从低密度到高密度排列
+///
+void SAScatterSeries::setDensityColorList(const SALineGradientColorList &clr)
+{
+    const QVector<QColor>& colors = clr.colorlist();
+    if(colors.isEmpty())
+    {
+        return;
+    }
+    m_densityLut.resize(colors.size());
+    for(int i=0;i<colors.size();++i)
+    {
+        m_densityLut[i] = colors[i].rgba();
+    }
+    itemChanged();
+}
+///
+/// \brief 当前是否使用密度图绘制
+/// \return
+///
+bool SAScatterSeries::isDensityRender() const
+{
+    switch(m_renderMode)
+    {
+    case DensityRender:
+        return true;
+    case AutoRender:
+        return static_cast<int>(dataSize()) > m_densityThreshold;
+    default:
+        break;
+    }
+    return false;
+}
+///
+/// \brief 绘制
+///
+/// 使用密度图时整条曲线作为一张图片绘制，增量绘制（from,to不是全部数据）时依然逐点绘制，
+/// 密度金字塔在后台构建，构建完成前也逐点绘制
+///
+void SAScatterSeries::drawSeries(QPainter *painter, const QwtScaleMap &xMap, const QwtScaleMap &yMap, const QRectF &canvasRect, int from, int to) const
+{
+    const int last = static_cast<int>(dataSize()) - 1;
+    if(!isDensityRender() || from > 0 || (to >= 0 && to < last))
+    {
+        SAXYSeries::drawSeries(painter,xMap,yMap,canvasRect,from,to);
+        return;
+    }
+    if(m_density->cacheGeneration != m_density->generation || nullptr == m_density->cache)
+    {
+        scheduleDensityBuild();
+        SAXYSeries::drawSeries(painter,xMap,yMap,canvasRect,from,to);
+        return;
+    }
+    const QImage image = m_density->cache->render(data(),getSpatialIndex(),xMap,yMap,canvasRect,m_densityLut);
+    if(!image.isNull())
+    {
+        painter->drawImage(canvasRect.topLeft(),image);
+    }
+}
+///
+/// \brief 在界面线程中构建绘制用到的缓存
+///
+void SAScatterSeries::prepareForConcurrentDraw()
+{
+    SAXYSeries::prepareForConcurrentDraw();
+    if(!isDensityRender())
+    {
+        return;
+    }
+    if(m_density->cacheGeneration != m_density->generation || nullptr == m_density->cache)
+    {
+        std::shared_ptr<SAScatterDensityCache> cache = std::make_shared<SAScatterDensityCache>();
+        cache->build(data());
+        m_density->cache = cache;
+        m_density->cacheGeneration = m_density->generation;
+    }
+    getSpatialIndex();
+}
+///
+/// \brief 数据变化，密度金字塔失效
+///
+void SAScatterSeries::dataChanged()
+{
+    ++(m_density->generation);
+    SAXYSeries::dataChanged();
+}
+
+void SAScatterSeries::init()
+{
+    setStyle( QwtPlotCurve::Dots );
+    m_renderMode = AutoRender;
+    m_densityThreshold = SA_SCATTER_DENSITY_THRESHOLD;
+    setDensityColorList(SALineGradientColorList(QColor(49,54,149),QColor(215,48,39),256));
+}
+///
+/// \brief 在后台构建密度金字塔
+///
+/// 数据快照见\sa SAXYSeries::createDataSnapshot ，不支持快照的数据一直逐点绘制
+///
+void SAScatterSeries::scheduleDensityBuild() const
+{
+    if(m_density->buildingGeneration == m_density->generation)
+    {
+        return;
+    }
+    QwtSeriesData<QPointF>* snapshot = createDataSnapshot();
+    if(nullptr == snapshot)
+    {
+        return;
+    }
+    m_density->buildingGeneration = m_density->generation;
+    QThreadPool::globalInstance()->start(new SAScatterDensityBuilder(snapshot,m_density->generation,m_density));
+}
+
 
 
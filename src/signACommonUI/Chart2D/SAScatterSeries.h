@@ -3,16 +3,71 @@
 #include "SACommonUIGlobal.h"
 #include "SASeriesAndDataPtrMapper.h"
 #include "SAXYSeries.h"
+#include <QRgb>
+#include <QVector>
+#include <memory>
+///
+/// \def 自动模式下点数超过此数量时使用密度图绘制
+///
+#ifndef SA_SCATTER_DENSITY_THRESHOLD
+#define SA_SCATTER_DENSITY_THRESHOLD 200000
+#endif
 class SAAbstractDatas;
+class SAScatterDensityState;
+class SALineGradientColorList;
+///
+/// \brief 散点图
+///
+/// 点数很多时逐点绘制符号既慢又互相覆盖，此时可以用密度图绘制：把点分箱到屏幕分辨率的二维直方图，
+/// 按颜色表着色后作为图片绘制，见\sa SAScatterDensityCache
+///
+/// 密度金字塔在后台构建，构建完成前按普通散点绘制
+///
 class SA_COMMON_UI_EXPORT SAScatterSeries : public SAXYSeries
 {
 public:
+    ///
+    /// \brief 绘制方式
+    ///
+    enum RenderMode
+    {
+        SymbolRender    ///< 逐点绘制符号
+        ,DensityRender  ///< 密度图
+        ,AutoRender     ///< 点数超过阈值时使用密度图
+    };
     explicit SAScatterSeries( const QString &title = QString() );
     explicit SAScatterSeries( const QwtText &title );
     explicit SAScatterSeries(const QString &title,SAAbstractDatas* dataPoints);
+    virtual ~SAScatterSeries();
     //跨域重载
     using QwtPlotCurve::setSamples;
     using SAXYSeries::setSamples;
+    //绘制方式，默认为AutoRender
+    void setRenderMode(RenderMode mode);
+    RenderMode renderMode() const;
+    //自动模式的点数阈值
+    void setDensityThreshold(int count);
+    int densityThreshold() const;
+    //密度图的颜色表，从低密度到高密度
+    void setDensityColorList(const SALineGradientColorList& clr);
+    //当前是否使用密度图绘制
+    bool isDensityRender() const;
+    virtual void drawSeries( QPainter *painter,
+        const QwtScaleMap &xMap, const QwtScaleMap &yMap,
+        const QRectF &canvasRect, int from, int to ) const;
+    //密度图绘制时同时构建密度金字塔和空间索引
+    virtual void prepareForConcurrentDraw();
+protected:
+    virtual void dataChanged();
+private:
+    void init();
+    //在后台构建密度金字塔
+    void scheduleDensityBuild() const;
+private:
+    RenderMode m_renderMode;
+    int m_densityThreshold;
+    QVector<QRgb> m_densityLut;///< 密度图颜色表
+    std::shared_ptr<SAScatterDensityState> m_density;///< 密度金字塔的状态，第一次以密度图绘制时在后台构建
 };
 
 #endif // SASCATTERSERIES_H
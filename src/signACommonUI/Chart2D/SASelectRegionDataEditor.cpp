@@ -1,6 +1,7 @@
 ﻿#include "SASelectRegionDataEditor.h"
 #include "SAChart2D.h"
 #include "SAChart.h"
+#include "SAPlotCanvas.h"
 #include "qwt_plot_barchart.h"
 #include "SAAbstractRegionSelectEditor.h"
 #include "SAFigureOptCommands.h"
@@ -65,27 +66,12 @@ public:
         {
             QPainterPath trPath = SAChart::transformPath(item()->plot(),otPath,xaxis,yaxis
                                                        ,item()->xAxis(),item()->yAxis());
-
-            for(size_t i=0;i<m_plotItem->dataSize();++i)
-            {
-                if(fun(trPath,m_plotItem->sample(i)))
-                {
-                    m_indexs.append((int)i);
-                    m_datas.append(m_plotItem->sample(i));
-                }
-            }
+            SAChart::getSamplesInRang(m_datas,m_indexs,m_plotItem,trPath,fun);
             m_newDatas = m_datas;
         }
         else
         {
-            for(size_t i=0;i<m_plotItem->dataSize();++i)
-            {
-                if(fun(otPath,m_plotItem->sample(i)))
-                {
-                    m_indexs.append((int)i);
-                    m_datas.append(m_plotItem->sample(i));
-                }
-            }
+            SAChart::getSamplesInRang(m_datas,m_indexs,m_plotItem,otPath,fun);
             m_newDatas = m_datas;
         }
     }
@@ -552,6 +538,8 @@ bool SASelectRegionDataEditor::mouseMovedEvent(const QMouseEvent *e)
     {
         return false;
     }
+    //选区和数据变化，背景使用缓存
+    SAPlotCanvas::LayerUpdateScope scope(plot(), SAPlotCanvas::DataLayer);
     moveEdit(e->pos());
     plot()->replot();
     return true;
@@ -630,7 +618,10 @@ bool SASelectRegionDataEditor::keyPressEvent(const QKeyEvent *e)
         default:
             return false;
         }
-        plot()->replot();
+        {
+            SAPlotCanvas::LayerUpdateScope scope(plot(), SAPlotCanvas::DataLayer);
+            plot()->replot();
+        }
         return true;
     }
     else
@@ -700,7 +691,10 @@ bool SASelectRegionDataEditor::keyPressEvent(const QKeyEvent *e)
         default:
             return false;
         }
-        plot()->replot();
+        {
+            SAPlotCanvas::LayerUpdateScope scope(plot(), SAPlotCanvas::DataLayer);
+            plot()->replot();
+        }
         return true;
     }
     return false;
@@ -1,6 +1,7 @@
 #include "SASelectRegionEditor.h"
 #include "SAChart2D.h"
 #include "SAChart.h"
+#include "SAPlotCanvas.h"
 #include "SAAbstractRegionSelectEditor.h"
 #include "SAQtSeriesAlgorithm.h"
 #include <QHash>
@@ -173,6 +174,8 @@ bool SASelectRegionEditor::mouseMovedEvent(const QMouseEvent *e)
     {
         return false;
     }
+    //只有选区变化，背景和数据使用缓存
+    SAPlotCanvas::LayerUpdateScope scope(plot(), SAPlotCanvas::OverlayLayer);
     moveEdit(e->pos());
     plot()->replot();
     return true;
@@ -250,7 +253,10 @@ bool SASelectRegionEditor::keyPressEvent(const QKeyEvent *e)
         default:
             return false;
         }
-        plot()->replot();
+        {
+            SAPlotCanvas::LayerUpdateScope scope(plot(), SAPlotCanvas::OverlayLayer);
+            plot()->replot();
+        }
         return true;
     }
     else
@@ -320,7 +326,10 @@ bool SASelectRegionEditor::keyPressEvent(const QKeyEvent *e)
         default:
             return false;
         }
-        plot()->replot();
+        {
+            SAPlotCanvas::LayerUpdateScope scope(plot(), SAPlotCanvas::OverlayLayer);
+            plot()->replot();
+        }
         return true;
     }
     return false;
@@ -0,0 +1,224 @@
+#include "SASeriesDataReferenceResolver.h"
+#include "SASeriesAndDataPtrMapper.h"
+#include "SAAbstractDatas.h"
+#include "SADataConver.h"
+#include "SAValueManager.h"
+#include "qwt_plot_item.h"
+#include <QDataStream>
+#include <QStringList>
+
+SASeriesDataReferenceResolver::SASeriesDataReferenceResolver()
+{
+
+}
+///
+/// \brief 生成曲线样本的引用
+/// \param item
+/// \param sample 曲线的样本
+/// \return 无法引用时返回空
+///
+QByteArray SASeriesDataReferenceResolver::reference(const QwtPlotItem *item, const QVector<QPointF> &sample)
+{
+    const SASeriesAndDataPtrMapper* mapper = dynamic_cast<const SASeriesAndDataPtrMapper*>(item);
+    if(nullptr == mapper || sample.isEmpty())
+    {
+        return QByteArray();
+    }
+    QList<SAAbstractDatas*> datas = mapper->linkDatas().toList();
+    if(datas.isEmpty() || datas.size() > 2)
+    {
+        return QByteArray();
+    }
+    for(SAAbstractDatas* d : datas)
+    {
+        if(!isReferable(d))
+        {
+            return QByteArray();
+        }
+    }
+    //关联关系不记录x、y的顺序，两个数据时两种顺序都尝试
+    int type = 0;
+    double xStart = 0;
+    double xDetal = 0;
+    QVector<QPointF> tmp;
+    if(1 == datas.size())
+    {
+        if(makeSample(RefPoints,datas,0,0,tmp) && isSame(tmp,sample))
+        {
+            type = RefPoints;
+        }
+        else
+        {
+            xStart = sample[0].x();
+            xDetal = sample.size() > 1 ? (sample[1].x() - sample[0].x()) : 0;
+            if(makeSample(RefY,datas,xStart,xDetal,tmp) && isSame(tmp,sample))
+            {
+                type = RefY;
+            }
+        }
+    }
+    else
+    {
+        if(makeSample(RefXY,datas,0,0,tmp) && isSame(tmp,sample))
+        {
+            type = RefXY;
+        }
+        else
+        {
+            datas.swap(0,1);
+            if(makeSample(RefXY,datas,0,0,tmp) && isSame(tmp,sample))
+            {
+                type = RefXY;
+            }
+        }
+    }
+    if(0 == type)
+    {
+        return QByteArray();
+    }
+    QStringList names;
+    for(SAAbstractDatas* d : datas)
+    {
+        names.append(d->getName());
+    }
+    QByteArray ref;
+    QDataStream st(&ref,QIODevice::WriteOnly);
+    st << static_cast<qint8>(type) << names << xStart << xDetal;
+    return ref;
+}
+///
+/// \brief 由引用取回样本，并把曲线重新关联到引用的数据
+/// \param item
+/// \param ref
+/// \param sample
+/// \return 引用的数据不存在时返回false
+///
+bool SASeriesDataReferenceResolver::resolve(QwtPlotItem *item, const QByteArray &ref, QVector<QPointF> &sample)
+{
+    qint8 type;
+    QStringList names;
+    double xStart;
+    double xDetal;
+    QDataStream st(ref);
+    st >> type >> names >> xStart >> xDetal;
+    if(st.status() != QDataStream::Ok)
+    {
+        return false;
+    }
+    QList<SAAbstractDatas*> datas;
+    for(const QString& name : names)
+    {
+        SAAbstractDatas* d = saValueManager->findData(name);
+        if(nullptr == d)
+        {
+            return false;
+        }
+        datas.append(d);
+    }
+    if(!makeSample(type,datas,xStart,xDetal,sample))
+    {
+        return false;
+    }
+    SASeriesAndDataPtrMapper* mapper = dynamic_cast<SASeriesAndDataPtrMapper*>(item);
+    if(mapper)
+    {
+        mapper->clearDataPtrLink();
+        for(SAAbstractDatas* d : datas)
+        {
+            mapper->insertData(d);
+        }
+    }
+    return true;
+}
+
+bool SASeriesDataReferenceResolver::isReferable(SAAbstractDatas *d)
+{
+    if(nullptr == d || !saValueManager->isDataInManager(d))
+    {
+        return false;
+    }
+    const QString name = d->getName();
+    return (!name.isEmpty() && saValueManager->findData(name) == d);
+}
+///
+/// \brief 按生成方式由数据生成样本，和\sa SAXYSeries::setSamples 的计算一致
+/// \param type 生成方式
+/// \param datas 引用的数据，RefXY时依次为x、y
+/// \param xStart RefY时x的起始值
+/// \param xDetal RefY时x的间隔
+/// \param sample 生成的样本
+/// \return 数据个数或类型不符合时返回false
+///
+bool SASeriesDataReferenceResolver::makeSample(int type, const QList<SAAbstractDatas *> &datas
+                                               , double xStart, double xDetal, QVector<QPointF> &sample)
+{
+    sample.clear();
+    switch(type)
+    {
+    case RefPoints:
+    {
+        if(1 != datas.size())
+        {
+            return false;
+        }
+        return SADataConver::converToPointFVector(datas[0],sample);
+    }
+    case RefXY:
+    {
+        QVector<double> xd,yd;
+        if(2 != datas.size()
+                || !SADataConver::converToDoubleVector(datas[0],xd)
+                || !SADataConver::converToDoubleVector(datas[1],yd))
+        {
+            return false;
+        }
+        const int count = qMin(xd.size(),yd.size());
+        sample.resize(count);
+        for(int i=0;i<count;++i)
+        {
+            sample[i] = QPointF(xd[i],yd[i]);
+        }
+        return true;
+    }
+    case RefY:
+    {
+        QVector<double> yd;
+        if(1 != datas.size() || !SADataConver::converToDoubleVector(datas[0],yd))
+        {
+            return false;
+        }
+        sample.resize(yd.size());
+        for(int i=0;i<yd.size();++i)
+        {
+            sample[i] = QPointF(xStart + (i*xDetal),yd[i]);
+        }
+        return true;
+    }
+    default:
+        break;
+    }
+    return false;
+}
+///
+/// \brief 逐个比较，QPointF的==是模糊比较，这里要求完全一致
+/// \param a
+/// \param b
+/// \return
+///
+bool SASeriesDataReferenceResolver::isSame(const QVector<QPointF> &a, const QVector<QPointF> &b)
+{
+    if(a.size() != b.size())
+    {
+        return false;
+    }
+    const QPointF* pa = a.constData();
+    const QPointF* pb = b.constData();
+    for(int i=0;i<a.size();++i)
+    {
+        if(pa[i].x() != pb[i].x() || pa[i].y() != pb[i].y())
+        {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,42 @@
+#ifndef SASERIESDATAREFERENCERESOLVER_H
+#define SASERIESDATAREFERENCERESOLVER_H
+#include "SACommonUIGlobal.h"
+#include "SAQwtSerialize.h"
+class SAAbstractDatas;
+
+///
+/// \brief 通过\sa SASeriesAndDataPtrMapper 把曲线样本解析为变量管理器中数据的引用
+///
+/// 曲线关联的数据在变量管理器中，且由数据生成的样本和曲线的样本完全一致时，
+/// 引用记录数据名和样本的生成方式，支持的生成方式和\sa SAXYSeries::setSamples 对应：
+/// - 一个点序列数据
+/// - x、y两个序列数据
+/// - 一个y序列数据，x为等间隔序列（\sa SABarSeries 的一维数据也属于这种情况）
+///
+/// 工程先保存、加载变量再保存、加载窗口，因此加载窗口时引用的数据已经存在，
+/// 解析后曲线会重新关联这些数据
+///
+class SA_COMMON_UI_EXPORT SASeriesDataReferenceResolver : public sa::SASeriesDataResolver
+{
+public:
+    SASeriesDataReferenceResolver();
+    virtual QByteArray reference(const QwtPlotItem* item,const QVector<QPointF>& sample);
+    virtual bool resolve(QwtPlotItem* item,const QByteArray& ref,QVector<QPointF>& sample);
+private:
+    //引用的样本生成方式
+    enum ReferenceType
+    {
+        RefPoints = 1,///< 一个点序列
+        RefXY = 2,///< x、y两个序列
+        RefY = 3///< y序列，x等间隔
+    };
+    //数据是否能通过名字在变量管理器中唯一找到
+    static bool isReferable(SAAbstractDatas* d);
+    //按生成方式由数据生成样本
+    static bool makeSample(int type,const QList<SAAbstractDatas*>& datas,double xStart,double xDetal
+                           ,QVector<QPointF>& sample);
+    //两个样本序列是否完全一致
+    static bool isSame(const QVector<QPointF>& a,const QVector<QPointF>& b);
+};
+
+#endif // SASERIESDATAREFERENCERESOLVER_H
@@ -0,0 +1,235 @@
+#include "SASpectrogramSeries.h"
+#include "SALineGradientColorList.h"
+#include "SAParallel.h"
+#include <qmath.h>
+
+SASpectrogramSeries::SASpectrogramSeries(const QString &title)
+    :QwtPlotRasterItem(title)
+{
+    setCachePolicy(QwtPlotRasterItem::PaintCache);
+    setColorList(SALineGradientColorList(QColor(49,54,149),QColor(215,48,39),256));
+}
+
+SASpectrogramSeries::~SASpectrogramSeries()
+{
+
+}
+
+int SASpectrogramSeries::rtti() const
+{
+    return SA::RTTI_SASpectrogram;
+}
+///
+/// \brief 设置矩阵
+/// \param values 按行存放的矩阵，长度不足rows*cols时清空
+/// \param rows 行数，对应y
+/// \param cols 列数，对应x
+/// \param xInterval 矩阵在x方向覆盖的范围
+/// \param yInterval 矩阵在y方向覆盖的范围
+///
+void SASpectrogramSeries::setMatrix(const QVector<double> &values, int rows, int cols
+                                    , const QwtInterval &xInterval, const QwtInterval &yInterval)
+{
+    m_matrix.setValues(values,rows,cols);
+    m_xInterval = xInterval.normalized();
+    m_yInterval = yInterval.normalized();
+    updateMatrix();
+}
+
+void SASpectrogramSeries::setMatrix(const double *values, int rows, int cols
+                                    , const QwtInterval &xInterval, const QwtInterval &yInterval)
+{
+    m_matrix.setValues(values,rows,cols);
+    m_xInterval = xInterval.normalized();
+    m_yInterval = yInterval.normalized();
+    updateMatrix();
+}
+
+const SATiledMatrixData &SASpectrogramSeries::matrix() const
+{
+    return m_matrix;
+}
+///
+/// \brief 设置颜色映射的值范围
+/// \param range 无效时使用数据的值范围
+///
+void SASpectrogramSeries::setValueRange(const QwtInterval &range)
+{
+    m_valueRange = range.normalized();
+    invalidateCache();
+    itemChanged();
+}
+
+QwtInterval SASpectrogramSeries::valueRange() const
+{
+    return m_valueRange.isValid() ? m_valueRange : m_matrix.valueRange();
+}
+///
+/// \brief 设置颜色表
+/// \param clr 颜色从低到高排列
+///
+void SASpectrogramSeries::setColorList(const SALineGradientColorList &clr)
+{
+    const QVector<QColor>& colors = clr.colorlist();
+    if(colors.isEmpty())
+    {
+        return;
+    }
+    m_lut.resize(colors.size());
+    for(int i=0;i<colors.size();++i)
+    {
+        m_lut[i] = colors[i].rgba();
+    }
+    invalidateCache();
+    itemChanged();
+}
+
+QwtInterval SASpectrogramSeries::interval(Qt::Axis axis) const
+{
+    switch(axis)
+    {
+    case Qt::XAxis:
+        return m_xInterval;
+    case Qt::YAxis:
+        return m_yInterval;
+    case Qt::ZAxis:
+        return valueRange();
+    default:
+        break;
+    }
+    return QwtInterval();
+}
+///
+/// \brief 一个格子的位置和尺寸
+///
+/// QwtPlotRasterItem在格子大于屏幕像素时按格子分辨率渲染再缩放
+/// \return
+///
+QRectF SASpectrogramSeries::pixelHint(const QRectF &area) const
+{
+    Q_UNUSED(area);
+    if(m_matrix.isEmpty() || !m_xInterval.isValid() || !m_yInterval.isValid())
+    {
+        return QRectF();
+    }
+    return QRectF(m_xInterval.minValue(),m_yInterval.minValue()
+                  ,m_xInterval.width() / m_matrix.cols(),m_yInterval.width() / m_matrix.rows());
+}
+///
+/// \brief 渲染图片
+///
+/// 每列像素对应的格子只计算一次，所有行共用，每行只需查找一次分块，按行分段并行
+///
+QImage SASpectrogramSeries::renderImage(const QwtScaleMap &xMap, const QwtScaleMap &yMap
+                                        , const QRectF &area, const QSize &imageSize) const
+{
+    if(imageSize.isEmpty() || m_matrix.isEmpty() || m_lut.isEmpty())
+    {
+        return QImage();
+    }
+    QImage image(imageSize,QImage::Format_ARGB32);
+    image.fill(Qt::transparent);
+    const QwtInterval range = valueRange();
+    if(!range.isValid() || !m_xInterval.isValid() || !m_yInterval.isValid())
+    {
+        return image;
+    }
+    const int level = selectLevel(area,imageSize);
+    const int width = imageSize.width();
+    const int height = imageSize.height();
+    const int shift = SATiledMatrixData::tileShift();
+    const int mask = SATiledMatrixData::tileSize() - 1;
+    const int rows = m_matrix.rows();
+    const int cols = m_matrix.cols();
+    const double x0 = m_xInterval.minValue();
+    const double y0 = m_yInterval.minValue();
+    const double dx = m_xInterval.width() / cols;
+    const double dy = m_yInterval.width() / rows;
+    //每列像素对应的分块列和分块内的偏移，-1表示不在矩阵内
+    QVector<int> tileOfX(width,-1);
+    QVector<int> offsetOfX(width,0);
+    for(int x=0;x<width;++x)
+    {
+        const double c = qFloor((xMap.invTransform(x) - x0) / dx);
+        if(c >= 0 && c < cols)
+        {
+            const int lc = static_cast<int>(c) >> level;
+            tileOfX[x] = lc >> shift;
+            offsetOfX[x] = lc & mask;
+        }
+    }
+    const int* pTileOfX = tileOfX.constData();
+    const int* pOffsetOfX = offsetOfX.constData();
+    const int tileCols = m_matrix.tileCols(level);
+    const QRgb* lut = m_lut.constData();
+    const int last = m_lut.size() - 1;
+    const double vmin = range.minValue();
+    const double scale = range.width() > 0 ? last / range.width() : 0;
+    uchar* bits = image.bits();
+    const int bytesPerLine = image.bytesPerLine();
+    const int parts = qMin(SA::parallelPartCount(qint64(width) * height,SA_SPECTROGRAM_MIN_CHUNK),height);
+    SA::parallelFor(parts,[&](int p){
+        const int py0 = height * p / parts;
+        const int py1 = height * (p+1) / parts;
+        QVector<const float*> rowTiles(tileCols);
+        const float** pRowTiles = rowTiles.data();
+        for(int y=py0;y<py1;++y)
+        {
+            const double r = qFloor((yMap.invTransform(y) - y0) / dy);
+            if(!(r >= 0 && r < rows))
+            {
+                continue;
+            }
+            const int lr = static_cast<int>(r) >> level;
+            const int rowOffset = (lr & mask) << shift;
+            for(int tc=0;tc<tileCols;++tc)
+            {
+                pRowTiles[tc] = m_matrix.tile(level,lr >> shift,tc) + rowOffset;
+            }
+            QRgb* line = reinterpret_cast<QRgb*>(bits + y * bytesPerLine);
+            for(int x=0;x<width;++x)
+            {
+                const int t = pTileOfX[x];
+                if(t < 0)
+                {
+                    continue;
+                }
+                const float v = pRowTiles[t][pOffsetOfX[x]];
+                if(qIsNaN(v))
+                {
+                    continue;
+                }
+                const double f = (v - vmin) * scale;
+                line[x] = lut[f <= 0 ? 0 : (f >= last ? last : static_cast<int>(f + 0.5))];
+            }
+        }
+    });
+    return image;
+}
+///
+/// \brief 选择格子不大于一个像素的最粗一层
+/// \param area 图片对应的数据范围
+/// \param imageSize
+/// \return
+///
+int SASpectrogramSeries::selectLevel(const QRectF &area, const QSize &imageSize) const
+{
+    const double px = area.width() / imageSize.width();
+    const double py = area.height() / imageSize.height();
+    const double dx = m_xInterval.width() / m_matrix.cols();
+    const double dy = m_yInterval.width() / m_matrix.rows();
+    int level = 0;
+    while((level+1) < m_matrix.levelCount()
+          && dx * (1 << (level+1)) <= px
+          && dy * (1 << (level+1)) <= py)
+    {
+        ++level;
+    }
+    return level;
+}
+
+void SASpectrogramSeries::updateMatrix()
+{
+    invalidateCache();
+    itemChanged();
+}
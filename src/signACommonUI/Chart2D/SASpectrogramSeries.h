@@ -0,0 +1,64 @@
+#ifndef SASPECTROGRAMSERIES_H
+#define SASPECTROGRAMSERIES_H
+#include "SACommonUIGlobal.h"
+#include "qwt_plot_rasteritem.h"
+#include "SATiledMatrixData.h"
+#include <QRgb>
+#include <QVector>
+class SALineGradientColorList;
+
+///
+/// \def 并行渲染时每个任务至少处理的像素数
+///
+#ifndef SA_SPECTROGRAM_MIN_CHUNK
+#define SA_SPECTROGRAM_MIN_CHUNK 16384
+#endif
+
+///
+/// \brief 谱图（二维矩阵）
+///
+/// 用于显示短时傅里叶变换等时频分析的结果，矩阵的列对应x，行对应y，
+/// 数据保存在\sa SATiledMatrixData 的多分辨率分块中
+///
+/// 渲染时选择格子不大于一个像素的最粗一层，按图片的行分段在线程池中并行重采样，
+/// 再通过颜色表着色，NaN格子透明；放大到格子大于像素时由QwtPlotRasterItem按格子分辨率渲染后缩放，
+/// 坐标范围不变的重绘直接使用缓存的图片
+///
+class SA_COMMON_UI_EXPORT SASpectrogramSeries : public QwtPlotRasterItem
+{
+public:
+    explicit SASpectrogramSeries(const QString& title = QString());
+    virtual ~SASpectrogramSeries();
+    virtual int rtti() const;
+    //设置矩阵，values按行存放，第r行第c列为values[r*cols+c]，xInterval和yInterval为矩阵覆盖的范围
+    void setMatrix(const QVector<double>& values, int rows, int cols
+                   , const QwtInterval& xInterval, const QwtInterval& yInterval);
+    void setMatrix(const double* values, int rows, int cols
+                   , const QwtInterval& xInterval, const QwtInterval& yInterval);
+    const SATiledMatrixData& matrix() const;
+    //颜色映射的值范围，设置为无效范围时使用数据的值范围
+    void setValueRange(const QwtInterval& range);
+    QwtInterval valueRange() const;
+    //颜色表，从低到高
+    void setColorList(const SALineGradientColorList& clr);
+    //范围
+    virtual QwtInterval interval(Qt::Axis axis) const;
+    //一个格子的尺寸
+    virtual QRectF pixelHint(const QRectF& area) const;
+protected:
+    virtual QImage renderImage(const QwtScaleMap& xMap, const QwtScaleMap& yMap
+                               , const QRectF& area, const QSize& imageSize) const;
+private:
+    //选择渲染使用的层
+    int selectLevel(const QRectF& area, const QSize& imageSize) const;
+    //数据变化后清除缓存并通知重绘
+    void updateMatrix();
+private:
+    SATiledMatrixData m_matrix;
+    QwtInterval m_xInterval;
+    QwtInterval m_yInterval;
+    QwtInterval m_valueRange;///< 用户设置的值范围
+    QVector<QRgb> m_lut;///< 颜色表
+};
+
+#endif // SASPECTROGRAMSERIES_H
@@ -1,18 +1,104 @@
 ﻿#include "SAXYSeries.h"
 #include "SAAbstractDatas.h"
 #include "SADataConver.h"
+#include "SAMinMaxPyramid.h"
+#include "SAChartMainThreadPoster.h"
+#include "qwt_painter.h"
+#include "qwt_clipper.h"
+#include "qwt_scale_map.h"
+#include "qwt_point_data.h"
+#include <QPainter>
+#include <QRunnable>
+#include <QThreadPool>
+#include <qmath.h>
+
+///
+/// \brief 曲线降采样的状态
+///
+/// 数据每变化一次generation加1，金字塔对应的generation和当前一致时才能用于绘制，
+/// 后台构建完成后回到主线程比较generation，过期的结果直接丢弃
+///
+class SAXYSeriesLodState
+{
+public:
+    SAXYSeriesLodState(SAXYSeries* s)
+        :series(s)
+        ,enable(true)
+        ,generation(0)
+        ,pyramidGeneration(-1)
+        ,buildingGeneration(-1)
+    {
+    }
+    SAXYSeries* series;
+    bool enable;
+    int generation;///< 数据的代号
+    int pyramidGeneration;///< 金字塔对应的数据代号
+    int buildingGeneration;///< 正在后台构建的数据代号
+    std::shared_ptr<SAMinMaxPyramid> pyramid;
+};
+
+///
+/// \brief 在线程池中构建金字塔
+///
+/// 数据是通过隐式共享得到的快照，主线程替换数据不会影响构建
+///
+class SAXYSeriesLodBuilder : public QRunnable
+{
+public:
+    SAXYSeriesLodBuilder(QwtSeriesData<QPointF>* snapshot,int generation,const std::shared_ptr<SAXYSeriesLodState>& state)
+        :m_snapshot(snapshot)
+        ,m_generation(generation)
+        ,m_state(state)
+    {
+    }
+    virtual void run()
+    {
+        std::shared_ptr<SAMinMaxPyramid> pyramid = std::make_shared<SAMinMaxPyramid>();
+        pyramid->build(m_snapshot.get());
+        m_snapshot.reset();
+        std::weak_ptr<SAXYSeriesLodState> weakState = m_state;
+        const int generation = m_generation;
+        SAChartMainThreadPoster::post([weakState,pyramid,generation](){
+            std::shared_ptr<SAXYSeriesLodState> state = weakState.lock();
+            if(nullptr == state)
+            {
+                //曲线已经析构
+                return;
+            }
+            if(state->buildingGeneration == generation)
+            {
+                state->buildingGeneration = -1;
+            }
+            if(state->generation != generation)
+            {
+                //构建过程中数据又发生了变化
+                return;
+            }
+            state->pyramid = pyramid;
+            state->pyramidGeneration = generation;
+            state->series->itemChanged();
+        });
+    }
+private:
+    std::unique_ptr<QwtSeriesData<QPointF> > m_snapshot;
+    int m_generation;
+    std::weak_ptr<SAXYSeriesLodState> m_state;
+};
 
 SAXYSeries::SAXYSeries(const QString &title):QwtPlotCurve(title)
+  ,m_lod(std::make_shared<SAXYSeriesLodState>(this))
 {
 
 }
 
 SAXYSeries::SAXYSeries(const QwtText &title):QwtPlotCurve(title)
+  ,m_lod(std::make_shared<SAXYSeriesLodState>(this))
 {
 
 }
 
 SAXYSeries::SAXYSeries(const QString &title, SAAbstractDatas *dataPoints):QwtPlotCurve(title)
+  ,m_lod(std::make_shared<SAXYSeriesLodState>(this))
 {
     setSamples(dataPoints);
 }
@@ -83,8 +169,220 @@ bool SAXYSeries::setSamples(SAAbstractDatas *y, double xStart, double xDetal)
     QwtPlotCurve::setSamples(xd,yd);
     return true;
 }
-
-
-
-
-
+///
+/// \brief 降采样绘制的开关
+/// \param enable
+///
+void SAXYSeries::setLodEnable(bool enable)
+{
+    if(m_lod->enable == enable)
+    {
+        return;
+    }
+    m_lod->enable = enable;
+    if(!enable)
+    {
+        m_lod->pyramid.reset();
+        m_lod->pyramidGeneration = -1;
+    }
+    itemChanged();
+}
+///
+/// \brief 是否开启降采样绘制
+/// \return
+///
+bool SAXYSeries::isLodEnable() const
+{
+    return m_lod->enable;
+}
+///
+/// \brief 增量更新金字塔
+///
+/// 只有金字塔对应的是上一次的数据且数据长度没变时才进行增量更新，否则等待绘制时整体重建
+/// \param from 修改的起始索引
+/// \param to 修改的结束索引
+///
+void SAXYSeries::updateLodRange(int from, int to)
+{
+    if(nullptr == m_lod->pyramid || !m_lod->pyramid->isValid())
+    {
+        return;
+    }
+    if((m_lod->pyramidGeneration+1) != m_lod->generation
+            || m_lod->pyramid->size() != static_cast<int>(dataSize()))
+    {
+        return;
+    }
+    if(m_lod->pyramid->update(data(),from,to))
+    {
+        m_lod->pyramidGeneration = m_lod->generation;
+    }
+}
+///
+/// \brief 空间索引
+///
+/// 索引在第一次使用时构建，数据变化后释放，下次使用时重新构建
+/// \return
+///
+const SAXYSpatialIndex *SAXYSeries::getSpatialIndex() const
+{
+    if(nullptr == m_spatialIndex)
+    {
+        m_spatialIndex.reset(new SAXYSpatialIndex());
+        m_spatialIndex->build(data());
+    }
+    return m_spatialIndex.get();
+}
+///
+/// \brief 在界面线程中构建绘制用到的缓存
+///
+/// 金字塔平时在后台构建，构建完成前按原始方式绘制，且绘制时会修改降采样的状态，
+/// 因此在其它线程中绘制前需要先调用此函数同步构建金字塔，之后的绘制只读取缓存
+///
+void SAXYSeries::prepareForConcurrentDraw()
+{
+    if(!m_lod->enable
+            || dataSize() < SA_XYSERIES_LOD_THRESHOLD
+            || testCurveAttribute(Fitted))
+    {
+        return;
+    }
+    if(m_lod->pyramidGeneration == m_lod->generation && nullptr != m_lod->pyramid)
+    {
+        return;
+    }
+    std::shared_ptr<SAMinMaxPyramid> pyramid = std::make_shared<SAMinMaxPyramid>();
+    pyramid->build(data());
+    m_lod->pyramid = pyramid;
+    m_lod->pyramidGeneration = m_lod->generation;
+}
+///
+/// \brief 数据变化，金字塔过期
+///
+void SAXYSeries::dataChanged()
+{
+    ++(m_lod->generation);
+    m_spatialIndex.reset();
+    QwtPlotCurve::dataChanged();
+}
+///
+/// \brief 绘制线
+///
+/// 金字塔可用时只绘制可见范围内降采样后的点，否则按QwtPlotCurve的方式绘制
+///
+void SAXYSeries::drawLines(QPainter *painter, const QwtScaleMap &xMap, const QwtScaleMap &yMap, const QRectF &canvasRect, int from, int to) const
+{
+    if(!m_lod->enable
+            || dataSize() < SA_XYSERIES_LOD_THRESHOLD
+            || testCurveAttribute(Fitted))
+    {
+        QwtPlotCurve::drawLines(painter,xMap,yMap,canvasRect,from,to);
+        return;
+    }
+    if(m_lod->pyramidGeneration != m_lod->generation || nullptr == m_lod->pyramid)
+    {
+        //金字塔还没准备好，这一帧按原始方式绘制
+        scheduleLodBuild();
+        QwtPlotCurve::drawLines(painter,xMap,yMap,canvasRect,from,to);
+        return;
+    }
+    const SAMinMaxPyramid* pyramid = m_lod->pyramid.get();
+    if(!pyramid->isValid())
+    {
+        //x不单调
+        QwtPlotCurve::drawLines(painter,xMap,yMap,canvasRect,from,to);
+        return;
+    }
+    const QwtSeriesData<QPointF>* series = data();
+    double x1 = xMap.s1();
+    double x2 = xMap.s2();
+    if(x1 > x2)
+    {
+        qSwap(x1,x2);
+    }
+    //可见范围两侧各多取一个点，保证线能延伸到边界
+    const int first = qMax(from,SAMinMaxPyramid::lowerBound(series,x1)-1);
+    const int last = qMin(to,SAMinMaxPyramid::upperBound(series,x2));
+    if(first > last)
+    {
+        return;
+    }
+    QVector<int> indexs;
+    pyramid->selectIndexs(series,first,last,qMax(1,qCeil(qAbs(xMap.pDist()))),indexs);
+    const bool doAlign = QwtPainter::roundingAlignment( painter );
+    QPolygonF polyline(indexs.size());
+    QPointF* pp = polyline.data();
+    for(int i=0;i<indexs.size();++i)
+    {
+        const QPointF sample = series->sample(indexs[i]);
+        double px = xMap.transform(sample.x());
+        double py = yMap.transform(sample.y());
+        if(doAlign)
+        {
+            px = qRound(px);
+            py = qRound(py);
+        }
+        pp[i] = QPointF(px,py);
+    }
+    QRectF clipRect;
+    const bool doClip = testPaintAttribute(ClipPolygons);
+    if(doClip)
+    {
+        qreal pw = qMax( qreal( 1.0 ), painter->pen().widthF());
+        clipRect = canvasRect.adjusted(-pw, -pw, pw, pw);
+    }
+    const bool doFill = ( brush().style() != Qt::NoBrush )
+            && ( brush().color().alpha() > 0 );
+    if(doFill)
+    {
+        QPolygonF filled = polyline;
+        fillCurve( painter, xMap, yMap, canvasRect, filled );
+        if(painter->pen().style() == Qt::NoPen)
+        {
+            return;
+        }
+    }
+    if(doClip)
+    {
+        polyline = QwtClipper::clipPolygonF(clipRect, polyline, false);
+    }
+    QwtPainter::drawPolyline( painter, polyline );
+}
+///
+/// \brief 数据的快照
+///
+/// 只支持隐式共享的数据（QwtPointSeriesData和QwtPointArrayData），快照不复制数据，
+/// 主线程替换数据不会影响快照
+/// \return 其余数据类型返回nullptr，调用者负责删除
+///
+QwtSeriesData<QPointF> *SAXYSeries::createDataSnapshot() const
+{
+    if(const QwtPointSeriesData* d = dynamic_cast<const QwtPointSeriesData*>(data()))
+    {
+        return new QwtPointSeriesData(d->samples());
+    }
+    else if(const QwtPointArrayData* d = dynamic_cast<const QwtPointArrayData*>(data()))
+    {
+        return new QwtPointArrayData(d->xData(),d->yData());
+    }
+    return nullptr;
+}
+///
+/// \brief 在后台构建金字塔
+///
+/// 只支持隐式共享的数据，其余数据类型按原始方式绘制，见\sa createDataSnapshot
+///
+void SAXYSeries::scheduleLodBuild() const
+{
+    if(m_lod->buildingGeneration == m_lod->generation)
+    {
+        return;
+    }
+    QwtSeriesData<QPointF>* snapshot = createDataSnapshot();
+    if(nullptr == snapshot)
+    {
+        return;
+    }
+    m_lod->buildingGeneration = m_lod->generation;
+    QThreadPool::globalInstance()->start(new SAXYSeriesLodBuilder(snapshot,m_lod->generation,m_lod));
+}
@@ -3,8 +3,25 @@
 #include "SACommonUIGlobal.h"
 #include "SASeriesAndDataPtrMapper.h"
 #include "qwt_plot_curve.h"
+#include "SAXYSpatialIndex.h"
+#include <memory>
+///
+/// \def 数据点超过此数量时曲线启用最小/最大值金字塔降采样绘制
+///
+#ifndef SA_XYSERIES_LOD_THRESHOLD
+#define SA_XYSERIES_LOD_THRESHOLD 100000
+#endif
 class SAAbstractDatas;
-class SA_COMMON_UI_EXPORT SAXYSeries : public QwtPlotCurve,public SASeriesAndDataPtrMapper
+class SAXYSeriesLodState;
+///
+/// \brief sa的xy曲线
+///
+/// 数据量较大（超过SA_XYSERIES_LOD_THRESHOLD）且x单调时，曲线会在后台构建SAMinMaxPyramid，
+/// 绘制时只绘制可见范围内约像素宽度数倍的点，并保留峰值，金字塔构建完成前按原始方式绘制
+///
+/// 曲线同时按需构建空间索引SAXYSpatialIndex，选区提取数据时使用，数据变化后索引失效
+///
+class SA_COMMON_UI_EXPORT SAXYSeries : public QwtPlotCurve,public SASeriesAndDataPtrMapper,public SAXYSpatialIndexProvider
 {
 public:
     explicit SAXYSeries( const QString &title = QString() );
@@ -16,6 +33,28 @@ public:
     bool setSamples(SAAbstractDatas* dataPoints);
     bool setSamples(SAAbstractDatas* x,SAAbstractDatas* y);
     bool setSamples(SAAbstractDatas* y,double xStart,double xDetal);
+    //降采样绘制的开关，默认开启
+    void setLodEnable(bool enable);
+    bool isLodEnable() const;
+    //数据长度不变只修改了[from,to]区间时，在setSamples之后调用可增量更新金字塔，避免整体重建，表格的编辑和粘贴命令会调用
+    void updateLodRange(int from,int to);
+    //空间索引，第一次调用时构建
+    virtual const SAXYSpatialIndex* getSpatialIndex() const;
+    //在界面线程中构建绘制用到的缓存，之后可以在其它线程中绘制，见SAFigureWindow::renderToImage
+    virtual void prepareForConcurrentDraw();
+protected:
+    virtual void dataChanged();
+    virtual void drawLines( QPainter *p,
+        const QwtScaleMap &xMap, const QwtScaleMap &yMap,
+        const QRectF &canvasRect, int from, int to ) const;
+    //数据的快照，用于在后台构建缓存，只支持隐式共享的数据，其余返回nullptr
+    QwtSeriesData<QPointF>* createDataSnapshot() const;
+private:
+    //在后台构建金字塔
+    void scheduleLodBuild() const;
+private:
+    std::shared_ptr<SAXYSeriesLodState> m_lod;
+    mutable std::unique_ptr<SAXYSpatialIndex> m_spatialIndex;
 };
 
 
@@ -25,7 +25,8 @@ namespace SA {
 //        ,RTTI_SABoxSeries = QwtPlotItem::Rtti_PlotUserItem+12
 //        ,RTTI_SAHistogramSeries = QwtPlotItem::Rtti_PlotUserItem+13
 //        ,RTTI_SAScatterSeries = QwtPlotItem::Rtti_PlotUserItem+14
-        RTTI_SASelectRegionDataEditor = QwtPlotItem::Rtti_PlotUserItem+500
+        RTTI_SASpectrogram = QwtPlotItem::Rtti_PlotUserItem+15
+        ,RTTI_SASelectRegionDataEditor = QwtPlotItem::Rtti_PlotUserItem+500
         ,RTTI_SASelectRegionEditor = QwtPlotItem::Rtti_PlotUserItem+501
     };
 }
@@ -12,6 +12,8 @@ SADataTableModel::SADataTableModel(QObject *parent) : QAbstractTableModel(parent
     , m_columnCount(0)
     , m_columnShowMin(15)
     , m_rowShowMin(35)
+    , m_fetchedRowCount(0)
+    , m_displayCache(SA_DATA_TABLE_MODEL_CACHE_BLOCKS)
 {
 }
 
@@ -34,6 +36,7 @@ void SADataTableModel::setSADataPtrs(const QList<SAAbstractDatas *>& datas)
     }
 	beginResetModel();
     m_datas.clear();
+    m_fetchedRowCount = 0;
     for (auto i = datas.begin(); i != datas.end(); ++i)
     {
         if ((*i)->getDim() <= 2) {
@@ -103,10 +106,12 @@ void SADataTableModel::clear()
     beginResetModel();
     m_rowCount = 0;
     m_columnCount = 0;
+    m_fetchedRowCount = 0;
     m_datas.clear();
     m_col2Ptr.clear();
     m_ptr2Col.clear();
     m_ptr2ColMap.clear();
+    clearDisplayCache();
     endResetModel();
 }
 
@@ -183,7 +188,44 @@ const QList<SAAbstractDatas *>& SADataTableModel::getSADataPtrs() const
 int SADataTableModel::rowCount(const QModelIndex& parent) const
 {
     Q_UNUSED(parent);
-    return (m_rowCount > m_rowShowMin ? m_rowCount+m_rowShowMin : m_rowShowMin);
+    return (displayRowCount(m_fetchedRowCount));
+}
+
+
+///
+/// \brief 是否还有数据行没有提供给视图
+/// \param parent
+/// \return
+///
+bool SADataTableModel::canFetchMore(const QModelIndex& parent) const
+{
+    if (parent.isValid()) {
+        return (false);
+    }
+    return (m_fetchedRowCount < m_rowCount);
+}
+
+
+///
+/// \brief 视图滚动到底部时再提供一页数据行，最后一页时连同空白行一起插入
+/// \param parent
+///
+void SADataTableModel::fetchMore(const QModelIndex& parent)
+{
+    if (!canFetchMore(parent)) {
+        return;
+    }
+    const int fetched = qMin(m_rowCount, m_fetchedRowCount + SA_DATA_TABLE_MODEL_FETCH_ROWS);
+    const int first = displayRowCount(m_fetchedRowCount);
+    const int last = displayRowCount(fetched) - 1;
+
+    if (last < first) {
+        m_fetchedRowCount = fetched;
+        return;
+    }
+    beginInsertRows(QModelIndex(), first, last);
+    m_fetchedRowCount = fetched;
+    endInsertRows();
 }
 
 
@@ -291,11 +333,10 @@ QVariant SADataTableModel::dataToDim0(int row, int col, SAAbstractDatas *d) cons
 
 QVariant SADataTableModel::dataToDim1(int row, int col, SAAbstractDatas *d) const
 {
-    Q_UNUSED(col);
     if (row >= d->getSize(SA::Dim1)) {
         return (QVariant());
     }
-    return (d->displayAt(row));
+    return (cachedDisplay(row, col, 0, d));
 }
 
 
@@ -314,7 +355,7 @@ QVariant SADataTableModel::dataToDim2(int row, int col, SAAbstractDatas *d) cons
     if (iteSize == ite->end()) {
         return (QVariant());
     }
-    return (d->displayAt(row, *iteSize));
+    return (cachedDisplay(row, col, *iteSize, d));
 }
 
 
@@ -459,6 +500,9 @@ int SADataTableModel::dataColumnCount() const
 
 void SADataTableModel::reCalcRowAndColumnCount()
 {
+    const int oldRowCount = m_rowCount;
+
+    clearDisplayCache();
     //计算最大行数
     m_rowCount = 0;
     m_columnCount = 0;
@@ -519,4 +563,62 @@ void SADataTableModel::reCalcRowAndColumnCount()
         }
     }
     m_columnCount = col;
+    //之前已经全部提供给视图的保持全部提供，否则至少提供一页
+    if ((oldRowCount > 0) && (m_fetchedRowCount >= oldRowCount)) {
+        m_fetchedRowCount = m_rowCount;
+    }
+    m_fetchedRowCount = qBound(qMin(m_rowCount, SA_DATA_TABLE_MODEL_FETCH_ROWS), m_fetchedRowCount, m_rowCount);
+}
+
+
+///
+/// \brief 已提供fetchedRowCount行数据时显示的行数
+///
+/// 数据全部提供后在末尾附加空白行用于编辑
+/// \param fetchedRowCount
+/// \return
+///
+int SADataTableModel::displayRowCount(int fetchedRowCount) const
+{
+    if (fetchedRowCount < m_rowCount) {
+        return (fetchedRowCount);
+    }
+    return (m_rowCount > m_rowShowMin ? m_rowCount+m_rowShowMin : m_rowShowMin);
+}
+
+
+///
+/// \brief 从缓存获取显示内容
+///
+/// 缓存按列和SA_DATA_TABLE_MODEL_CACHE_BLOCK_ROWS行分块，块不存在时通过SAAbstractDatas::displayRange整块格式化
+/// \param row 行号
+/// \param col 表格的列号
+/// \param dataCol 数据自身的列号
+/// \param d 数据
+/// \return
+///
+QVariant SADataTableModel::cachedDisplay(int row, int col, int dataCol, SAAbstractDatas *d) const
+{
+    const int block = row / SA_DATA_TABLE_MODEL_CACHE_BLOCK_ROWS;
+    const int offset = row - block * SA_DATA_TABLE_MODEL_CACHE_BLOCK_ROWS;
+    const quint64 key = (quint64(col) << 32) | quint32(block);
+    QVector<QString> *texts = m_displayCache.object(key);
+
+    if (nullptr == texts) {
+        texts = new QVector<QString>(SA_DATA_TABLE_MODEL_CACHE_BLOCK_ROWS);
+        const int n = d->displayRange(block * SA_DATA_TABLE_MODEL_CACHE_BLOCK_ROWS, dataCol
+            , SA_DATA_TABLE_MODEL_CACHE_BLOCK_ROWS, texts->data());
+        texts->resize(n);
+        m_displayCache.insert(key, texts);
+    }
+    if (offset >= texts->size()) {
+        return (QVariant());
+    }
+    return (texts->at(offset));
+}
+
+
+void SADataTableModel::clearDisplayCache()
+{
+    m_displayCache.clear();
 }
@@ -8,9 +8,39 @@
 #include "SACommonUIGlobal.h"
 #include <QHash>
 #include <QMultiHash>
+#include <QCache>
 #include <functional>
 class SAAbstractDatas;
 
+///
+/// \def 视图每次向模型获取的数据行数
+///
+#ifndef SA_DATA_TABLE_MODEL_FETCH_ROWS
+#define SA_DATA_TABLE_MODEL_FETCH_ROWS 65536
+#endif
+
+///
+/// \def 显示内容缓存中每块的行数
+///
+#ifndef SA_DATA_TABLE_MODEL_CACHE_BLOCK_ROWS
+#define SA_DATA_TABLE_MODEL_CACHE_BLOCK_ROWS 256
+#endif
+
+///
+/// \def 显示内容缓存的最大块数，只需覆盖可见范围附近
+///
+#ifndef SA_DATA_TABLE_MODEL_CACHE_BLOCKS
+#define SA_DATA_TABLE_MODEL_CACHE_BLOCKS 256
+#endif
+
+///
+/// \brief 显示SAAbstractDatas的表格模型
+///
+/// 数据行按SA_DATA_TABLE_MODEL_FETCH_ROWS分页通过canFetchMore/fetchMore提供给视图，
+/// 显示内容按块通过SAAbstractDatas::displayRange批量格式化，并只缓存最近访问的块，
+/// 模型重置时缓存清空
+///
+
 class SA_COMMON_UI_EXPORT SADataTableModel : public QAbstractTableModel
 {
     Q_OBJECT
@@ -49,6 +79,8 @@ public:
     void enableCellColor(bool enable = true);
 public:
     int rowCount(const QModelIndex &parent=QModelIndex()) const;
+    bool canFetchMore(const QModelIndex &parent) const;
+    void fetchMore(const QModelIndex &parent);
     int columnCount(const QModelIndex &parent=QModelIndex()) const;
     QVariant headerData(int section, Qt::Orientation orientation,int role) const;
     QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
@@ -60,6 +92,11 @@ public:
     int dataColumnCount() const;
 private:
     void reCalcRowAndColumnCount();
+    //已提供fetchedRowCount行数据时显示的行数
+    int displayRowCount(int fetchedRowCount) const;
+    //从缓存获取显示内容，dataCol为数据自身的列号
+    QVariant cachedDisplay(int row, int col, int dataCol, SAAbstractDatas* d) const;
+    void clearDisplayCache();
 private:
     QVariant dataToDim0(int row,int col, SAAbstractDatas* d) const;
     QVariant dataToDim1(int row,int col, SAAbstractDatas* d) const;
@@ -73,11 +110,13 @@ private:
     int m_columnCount;
     int m_columnShowMin;
     int m_rowShowMin;
+    int m_fetchedRowCount;///< 已提供给视图的数据行数
     QList<SAAbstractDatas*> m_datas;
     QHash<int,SAAbstractDatas*> m_col2Ptr;
     QMultiHash<SAAbstractDatas*,int> m_ptr2Col;///记录指针对应的列表的所有列号，此用来加快删除速度
 
     QHash<SAAbstractDatas*,QHash<int,int> >m_ptr2ColMap;///< 记录指针对应的列号映射表
+    mutable QCache<quint64,QVector<QString> > m_displayCache;///< 显示内容缓存，键为列号和块号
 };
 
 #endif // SADATATABLEMODEL_H
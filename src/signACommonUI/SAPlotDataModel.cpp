@@ -50,9 +50,14 @@ SAPlotDataModel::~SAPlotDataModel()
 
 }
 
+///
+/// \brief 数据全部提供给视图后末尾附加一行用于编辑
+/// \param parent
+/// \return
+///
 int SAPlotDataModel::rowCount(const QModelIndex &parent) const
 {
-    return QwtPlotItemDataModel::rowCount(parent) + 1;
+    return QwtPlotItemDataModel::rowCount(parent) + (canFetchMore(parent) ? 0 : 1);
 }
 
 int SAPlotDataModel::columnCount(const QModelIndex &parent) const
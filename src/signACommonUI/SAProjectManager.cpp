@@ -11,6 +11,7 @@
 #include "SAFigureWindow.h"
 #include "SAMdiSubWindowSerializeHead.h"
 #include "SAMdiSubWindow.h"
+#include "SASeriesDataReferenceResolver.h"
 #include "SALog.h"
 #define VERSION_STRING "pro.0.0.1"
 #define PROJECT_DES_XML_FILE_NAME "saProject.prodes"
@@ -41,6 +42,9 @@ bool save_figure_wnd(QFile* file,QWidget* w,SAUIInterface* ui,QString* err)
     QDataStream out(file);
     out << header;
     out << w->windowTitle();
+    //曲线样本和已保存的变量一致时只保存引用
+    SASeriesDataReferenceResolver resolver;
+    sa::SASeriesDataResolverInstaller installer(&resolver);
     try {
         out << fig;
     } catch (std::exception e) {
@@ -79,6 +83,8 @@ QWidget* load_figure_wnd(QFile* file,SAUIInterface* ui,QString* err)
     }
     QString windowTitle;
     in >> windowTitle;
+    SASeriesDataReferenceResolver resolver;
+    sa::SASeriesDataResolverInstaller installer(&resolver);
     try {
         in >> w.get();
     } catch (std::exception e) {
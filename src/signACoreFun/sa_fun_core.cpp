@@ -11,7 +11,9 @@
 ///
 /// \brief 激记录错误信息
 ///
-static QString s_error_info = QString("");
+/// 每个线程独立记录，插件会在工作线程中调用计算函数
+///
+static thread_local QString s_error_info = QString("");
 
 #define TR(str)\
     QCoreApplication::translate("sa_fun_core", str, 0)
@@ -112,7 +112,7 @@ SA_CORE_FUN__EXPORT std::shared_ptr<SAAbstractDatas> double_transform(SAAbstract
         {
             return nullptr;
         }
-        res = std::static_pointer_cast<SAAbstractDatas>(SAValueManager::makeData<SAVariantDatas>(va+vb));
+        res = std::static_pointer_cast<SAAbstractDatas>(SAValueManager::makeData<SAVariantDatas>(fun(va,vb)));
         res->setName("tmp_double_transform");
         return res;
     }
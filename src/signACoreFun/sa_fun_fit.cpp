@@ -4,6 +4,9 @@
 #include "SAVectorPointF.h"
 #include "SAVectorDouble.h"
 #include "SAPolyFit.h"
+#include "SAPolyFitBatch.h"
+#include "SAParallel.h"
+#include <vector>
 #include "SATableVariant.h"
 #include "SAValueManager.h"
 #include <QCoreApplication>
@@ -100,6 +103,63 @@ saFun::polyfit(const QVector<double> &xs, const QVector<double> &ys, int n)
     return std::make_tuple(factor,info);
 }
 
+QList<std::tuple<std::shared_ptr<SAVectorDouble>, std::shared_ptr<SATableVariant> > >
+saFun::polyfit(const QVector<double> &xs, const QList<QVector<double> > &ys, int n)
+{
+    QList<std::tuple<std::shared_ptr<SAVectorDouble>, std::shared_ptr<SATableVariant> > > res;
+    if(ys.isEmpty())
+    {
+        return res;
+    }
+    SA::SAPolyFitBatch batch;
+    if(n < 0 || !batch.init(xs.data(),xs.size(),n))
+    {
+        //x无法分解时逐组拟合，由SAPolyFit处理奇异的情况
+        for(const QVector<double>& y : ys)
+        {
+            res.append(polyfit(xs,y,n));
+        }
+        return res;
+    }
+    const int count = ys.size();
+    std::vector<std::unique_ptr<SA::SAPolyFit> > fits(count);
+    const int parts = std::min(count,SA::parallelPartCount(static_cast<qint64>(count) * xs.size() * (n+1),1<<20));
+    const int step = (count + parts - 1) / qMax(parts,1);
+    SA::parallelFor(parts,[&](int part){
+        const int e = qMin(count,(part+1) * step);
+        for(int i=part * step;i<e;++i)
+        {
+            const QVector<double>& y = ys[i];
+            if(y.size() != xs.size())
+            {
+                continue;
+            }
+            std::unique_ptr<SA::SAPolyFit> fit(new SA::SAPolyFit);
+            if(fit->polyfit(batch,y.data()))
+            {
+                fits[i] = std::move(fit);
+            }
+        }
+    });
+    for(int i=0;i<count;++i)
+    {
+        const SA::SAPolyFit* fit = fits[i].get();
+        if(nullptr == fit)
+        {
+            saFun::setErrorString(TR("can not polyfit"));
+            res.append(std::make_tuple(nullptr,nullptr));
+            continue;
+        }
+        std::shared_ptr<SAVectorDouble> factor = SAValueManager::makeData<SAVectorDouble>();
+        const std::vector<double> f = fit->getFactors();
+        factor->setValueDatas(f.begin(),f.end());
+        std::shared_ptr<SATableVariant> info = SAValueManager::makeData<SATableVariant>();
+        setFitInfo(info.get(),fit);
+        res.append(std::make_tuple(factor,info));
+    }
+    return res;
+}
+
 
 std::tuple<std::shared_ptr<SAAbstractDatas> > saFun::polyval(const SAAbstractDatas *wave, const SAVectorDouble *factor)
 {
@@ -121,12 +181,11 @@ std::tuple<std::shared_ptr<SAAbstractDatas> > saFun::polyval(const SAAbstractDat
 
 void saFun::polyval(const QVector<double> &x, const SAVectorDouble *factor,SAVectorDouble* res)
 {
-    SA::SAPolyFit fit;
-    fit.setFactors(factor->cbegin(),factor->cend());
     if(res)
     {
+        const QVector<double>& f = factor->getValueDatas();
         res->resize(x.size());
-        fit.getYis(x.begin(),x.end(),res->begin());
+        SA::SAPolyFit::polyval(f.data(),f.size(),x.data(),res->getValueDatas().data(),x.size());
     }
 }
 
@@ -134,13 +193,12 @@ void saFun::polyval(const QVector<double> &x, const SAVectorDouble *factor,SAVec
 
 void saFun::polyval(const QVector<double> &x, const SAVectorDouble *factor, SAVectorPointF *res)
 {
-    SA::SAPolyFit fit;
-    fit.setFactors(factor->cbegin(),factor->cend());
     if(res)
     {
+        const QVector<double>& f = factor->getValueDatas();
         QVector<double> ys;
         ys.resize(x.size());
-        fit.getYis(x.begin(),x.end(),ys.begin());
+        SA::SAPolyFit::polyval(f.data(),f.size(),x.data(),ys.data(),x.size());
         res->setXYValueDatas(x,ys);
     }
 }
@@ -63,6 +63,22 @@ std::shared_ptr<SAVectorDouble>//拟合的系数
 ,std::shared_ptr<SATableVariant>//拟合的误差参数
 >
 polyfit(const QVector<double> &xs,const QVector<double> &ys,int n);
+
+///
+/// \brief 对共用同一组x的多组y进行多项式拟合
+///
+/// x只分解一次，各组y在线程池中并行拟合
+/// \param xs 拟合的x值
+/// \param ys 多组拟合的y值，每组的长度需和xs一致
+/// \param n 多项式阶次
+/// \return 每组y的拟合结果，顺序和ys一致，拟合失败的组tuple参数为nullptr
+///
+SA_CORE_FUN__EXPORT
+QList<std::tuple<
+std::shared_ptr<SAVectorDouble>//拟合的系数
+,std::shared_ptr<SATableVariant>//拟合的误差参数
+> >
+polyfit(const QVector<double> &xs,const QList<QVector<double> > &ys,int n);
 ///
 /// \brief 根据多项式拟合的系数，以及输入的x值，计算拟合的值
 /// \param x 输入的值，如果是单一数组向量，此值作为x值，如果是点集，此值提取点集的x值
@@ -1,21 +1,34 @@
 ﻿#include "sa_fun_num.h"
 #include <algorithm>
-#include "sa_fun_core_std.h"
 #include <QVector>
 #include <iterator>
 #include "SAValueManager.h"
 #include "SAAbstractDatas.h"
 #include "SAVectorDouble.h"
+#include "SAVectorExpression.h"
+#include "SAVectorPointF.h"
+#include "SAVectorKernel.h"
 #include "SAVariantDatas.h"
 #include "SATableVariant.h"
+#include "SATableDouble.h"
 #include <QCoreApplication>
 #include "SAVectorInterval.h"
 #include "SADataConver.h"
 #include "SAMath.h"
+#include "SARollingStatistics.h"
+#include "SAHistogram.h"
 
 #define TR(str)\
     QCoreApplication::translate("sa_fun_num", str, 0)
 
+static std::shared_ptr<SAAbstractDatas> expression_operand(SAAbstractDatas* d);
+static std::shared_ptr<SAAbstractDatas> binary_operate(SAVectorKernel::Operator op,SAAbstractDatas* a,SAAbstractDatas* b);
+template<typename FUN>
+static std::shared_ptr<SAAbstractDatas> unary_operate(SAAbstractDatas* data,const QString& suffix,FUN fun);
+static std::shared_ptr<SAVectorInterval> hist_datas(const SAAbstractDatas* wave,const SAAbstractDatas* weight,unsigned section);
+static std::shared_ptr<SAAbstractDatas> rolling_statistic(SAAbstractDatas* data,int window
+                                                          ,SA::SARollingStatistics::Statistic stat,double percentile
+                                                          ,const QString& suffix);
 
 ///
 /// \brief 求均值 mean(vector) -> mean
@@ -75,15 +88,16 @@ double saFun::sumPointY(const QVector<QPointF> &points)
 }
 ///
 /// \brief 加法
+///
+/// 有序列时返回延迟计算的\sa SAVectorExpression ，连续的四则运算在读取时一遍完成，
+/// 0维数据作为标量参与运算，点序列取y值
 /// \param a
 /// \param b
 /// \return a+b
 ///
 std::shared_ptr<SAAbstractDatas> saFun::add(SAAbstractDatas* a,SAAbstractDatas* b)
 {
-    return double_transform(a,b,
-                     [](const double& a,const double &b)->double{
-        return a+b;});
+    return binary_operate(SAVectorKernel::Add,a,b);
 }
 
 ///
@@ -94,9 +108,7 @@ std::shared_ptr<SAAbstractDatas> saFun::add(SAAbstractDatas* a,SAAbstractDatas*
 ///
 std::shared_ptr<SAAbstractDatas> saFun::subtract(SAAbstractDatas* a,SAAbstractDatas* b)
 {
-    return double_transform(a,b,
-                     [](const double& a,const double &b)->double{
-        return a-b;});
+    return binary_operate(SAVectorKernel::Subtract,a,b);
 }
 
 ///
@@ -107,9 +119,7 @@ std::shared_ptr<SAAbstractDatas> saFun::subtract(SAAbstractDatas* a,SAAbstractDa
 ///
 std::shared_ptr<SAAbstractDatas> saFun::multiplication(SAAbstractDatas* a,SAAbstractDatas* b)
 {
-    return double_transform(a,b,
-                     [](const double& a,const double &b)->double{
-        return a*b;});
+    return binary_operate(SAVectorKernel::Multiply,a,b);
 }
 
 ///
@@ -120,9 +130,69 @@ std::shared_ptr<SAAbstractDatas> saFun::multiplication(SAAbstractDatas* a,SAAbst
 ///
 std::shared_ptr<SAAbstractDatas> saFun::division(SAAbstractDatas* a,SAAbstractDatas* b)
 {
-    return double_transform(a,b,
-                     [](const double& a,const double &b)->double{
-        return a/b;});
+    return binary_operate(SAVectorKernel::Divide,a,b);
+}
+
+///
+/// \brief 线性变换a*k+bias
+///
+/// 点序列只变换y值，0维数据返回0维数据
+/// \param data
+/// \param k
+/// \param bias
+/// \return
+///
+std::shared_ptr<SAAbstractDatas> saFun::scale(SAAbstractDatas *data, double k, double bias)
+{
+    return unary_operate(data,"scale",[k,bias](SAVectorKernel::Span in,double* out,int outStride,int n){
+        SAVectorKernel::scale(in,k,bias,out,outStride,n);
+    });
+}
+///
+/// \brief 绝对值
+/// \param data
+/// \return
+///
+std::shared_ptr<SAAbstractDatas> saFun::absolute(SAAbstractDatas *data)
+{
+    return unary_operate(data,"abs",[](SAVectorKernel::Span in,double* out,int outStride,int n){
+        SAVectorKernel::abs(in,out,outStride,n);
+    });
+}
+///
+/// \brief 自然对数
+/// \param data
+/// \return
+///
+std::shared_ptr<SAAbstractDatas> saFun::naturalLog(SAAbstractDatas *data)
+{
+    return unary_operate(data,"log",[](SAVectorKernel::Span in,double* out,int outStride,int n){
+        SAVectorKernel::log(in,out,outStride,n);
+    });
+}
+///
+/// \brief 自然指数
+/// \param data
+/// \return
+///
+std::shared_ptr<SAAbstractDatas> saFun::exponential(SAAbstractDatas *data)
+{
+    return unary_operate(data,"exp",[](SAVectorKernel::Span in,double* out,int outStride,int n){
+        SAVectorKernel::exp(in,out,outStride,n);
+    });
+}
+///
+/// \brief 限幅，把数据限制在[lo,hi]
+/// \param data
+/// \param lo
+/// \param hi
+/// \return
+///
+std::shared_ptr<SAAbstractDatas> saFun::clip(SAAbstractDatas *data, double lo, double hi)
+{
+    return unary_operate(data,"clip",[lo,hi](SAVectorKernel::Span in,double* out,int outStride,int n){
+        SAVectorKernel::clip(in,lo,hi,out,outStride,n);
+    });
 }
 
 ///
@@ -143,7 +213,24 @@ std::shared_ptr<SAVectorDouble> saFun::diff(SAAbstractDatas *data, unsigned diff
     std::back_insert_iterator< QVector<double> > bi(dy);
     SA::difference(waveData.begin (),waveData.end (),bi,diffCount);
     QString name = QString("%1_diff%2").arg(data->getName()).arg(diffCount);
-    return SAValueManager::makeData<SAVectorDouble>(name,waveData);
+    return SAValueManager::makeData<SAVectorDouble>(name,dy);
+}
+
+///
+/// \brief 延迟计算的差分，结果和\sa diff 一致
+/// \param data 数据指针
+/// \param diffCount 差分次数
+/// \return 计算的表达式，失败返回nullptr
+///
+std::shared_ptr<SAVectorExpression> saFun::diffExpression(SAAbstractDatas *data, unsigned diffCount)
+{
+    std::shared_ptr<SAAbstractDatas> d = expression_operand(data);
+    std::shared_ptr<SAVectorExpression> res = (d ? SAVectorExpression::makeDiff(d,diffCount) : nullptr);
+    if(nullptr == res)
+    {
+        setErrorString(TR("can not conver data to double vector!"));
+    }
+    return res;
 }
 
 ///
@@ -180,33 +267,67 @@ std::shared_ptr<SATableVariant> saFun::statistics(SAAbstractDatas *data)
 
 std::shared_ptr<SAVectorInterval> saFun::hist(const SAAbstractDatas *wave, unsigned section)
 {
-    QVector<double> ys;
-    if(!saFun::getDoubleVector(wave,ys))
+    return hist_datas(wave,nullptr,section);
+}
+///
+/// \brief 带权重的频率统计计算
+/// \param wave 波形
+/// \param weight 权重，和波形等长
+/// \param section 统计段数，为0时自动确定
+/// \return 如果错误发生返回nullptr
+///
+std::shared_ptr<SAVectorInterval> saFun::hist(const SAAbstractDatas *wave, const SAAbstractDatas *weight, unsigned section)
+{
+    return hist_datas(wave,weight,section);
+}
+///
+/// \brief 二维频率统计计算
+/// \param x x数据
+/// \param y y数据
+/// \param xSection x方向段数
+/// \param ySection y方向段数
+/// \return std::tuple<count,xEdges,yEdges>
+///
+std::tuple<std::shared_ptr<SATableDouble>,std::shared_ptr<SAVectorDouble>,std::shared_ptr<SAVectorDouble> >
+saFun::hist2D(const SAAbstractDatas *x, const SAAbstractDatas *y, unsigned xSection, unsigned ySection)
+{
+    QVector<double> xs,ys;
+    if(!saFun::getDoubleVector(x,xs) || !saFun::getDoubleVector(y,ys))
     {
-        return nullptr;
+        saFun::setErrorString(TR("data can not conver to double vector"));
+        return std::make_tuple(nullptr,nullptr,nullptr);
     }
-    if(ys.size () == 0)
+    if(xs.size() != ys.size())
     {
-        saFun::setErrorString(TR("%1 size is to short").arg(wave->getName()));
-        return nullptr;
+        saFun::setErrorString(TR("%1 and %2 size not equal").arg(x->getName()).arg(y->getName()));
+        return std::make_tuple(nullptr,nullptr,nullptr);
     }
-    std::vector<double> sectionRang;
-    std::vector<int> freCount;
-    sectionRang.resize( section+1,0);
-    freCount.resize (section,0);
-    SA::count_frequency(ys.begin (),ys.end ()
-                               ,section
-                               ,sectionRang.begin()
-                               ,freCount.begin());
-    QVector< QwtIntervalSample > sample;
-    sample.reserve (section);
-    for(unsigned int j=0;j<section;++j)
+    SA::SAHistogram2D h;
+    if(!h.compute(xs.constData(),ys.constData(),xs.size(),xSection,ySection))
     {
-        sample.push_back(QwtIntervalSample(freCount[j],sectionRang[j],sectionRang[j+1]));
+        saFun::setErrorString(TR("section must be positive and data must have finite value"));
+        return std::make_tuple(nullptr,nullptr,nullptr);
     }
-    auto res = SAValueManager::makeData<SAVectorInterval>();
-    res->setValueDatas (sample);
-    return res;
+    auto count = SAValueManager::makeData<SATableDouble>(QString("%1_%2_hist2D").arg(x->getName()).arg(y->getName()));
+    for(int i=0;i<h.xbins();++i)
+    {
+        for(int j=0;j<h.ybins();++j)
+        {
+            count->setTableData(i,j,h.count(i,j));
+        }
+    }
+    QVector<double> xEdges(h.xbins() + 1),yEdges(h.ybins() + 1);
+    for(int i=0;i<xEdges.size();++i)
+    {
+        xEdges[i] = h.xedge(i);
+    }
+    for(int i=0;i<yEdges.size();++i)
+    {
+        yEdges[i] = h.yedge(i);
+    }
+    return std::make_tuple(count
+                           ,SAValueManager::makeData<SAVectorDouble>(QString("%1_hist2DXEdges").arg(x->getName()),xEdges)
+                           ,SAValueManager::makeData<SAVectorDouble>(QString("%1_hist2DYEdges").arg(y->getName()),yEdges));
 }
 
 QMap<QString, double> saFun::statistics(const QVector<double> &data)
@@ -227,6 +348,293 @@ QMap<QString, double> saFun::statistics(const QVector<double> &data)
     return res;
 }
 
+///
+/// \brief 滑动窗口均值
+///
+/// 结果和输入等长，第i个值是以第i个点结尾的窗口的统计值，开始不足一个窗口时按已有的点计算，
+/// nan不参与统计，点序列对y值统计并保留x值
+/// \param data 序列
+/// \param window 窗口长度
+/// \return 失败返回nullptr
+///
+std::shared_ptr<SAAbstractDatas> saFun::rollingMean(SAAbstractDatas *data, int window)
+{
+    return rolling_statistic(data,window,SA::SARollingStatistics::Mean,50,"rollingMean");
+}
+///
+/// \brief 滑动窗口方差，除以n-1
+/// \see rollingMean
+///
+std::shared_ptr<SAAbstractDatas> saFun::rollingVar(SAAbstractDatas *data, int window)
+{
+    return rolling_statistic(data,window,SA::SARollingStatistics::Variance,50,"rollingVar");
+}
+///
+/// \brief 滑动窗口均方根
+/// \see rollingMean
+///
+std::shared_ptr<SAAbstractDatas> saFun::rollingRms(SAAbstractDatas *data, int window)
+{
+    return rolling_statistic(data,window,SA::SARollingStatistics::RMS,50,"rollingRms");
+}
+///
+/// \brief 滑动窗口最小值
+/// \see rollingMean
+///
+std::shared_ptr<SAAbstractDatas> saFun::rollingMin(SAAbstractDatas *data, int window)
+{
+    return rolling_statistic(data,window,SA::SARollingStatistics::Min,50,"rollingMin");
+}
+///
+/// \brief 滑动窗口最大值
+/// \see rollingMean
+///
+std::shared_ptr<SAAbstractDatas> saFun::rollingMax(SAAbstractDatas *data, int window)
+{
+    return rolling_statistic(data,window,SA::SARollingStatistics::Max,50,"rollingMax");
+}
+///
+/// \brief 滑动窗口中位数
+/// \see rollingMean
+///
+std::shared_ptr<SAAbstractDatas> saFun::rollingMedian(SAAbstractDatas *data, int window)
+{
+    return rolling_statistic(data,window,SA::SARollingStatistics::Median,50,"rollingMedian");
+}
+///
+/// \brief 滑动窗口百分位数，相邻两个秩之间线性插值
+/// \param data 序列
+/// \param window 窗口长度
+/// \param percentile 百分位数，范围[0,100]
+/// \return 失败返回nullptr
+/// \see rollingMean
+///
+std::shared_ptr<SAAbstractDatas> saFun::rollingPercentile(SAAbstractDatas *data, int window, double percentile)
+{
+    return rolling_statistic(data,window,SA::SARollingStatistics::Percentile,percentile
+                             ,QString("rollingP%1_").arg(percentile));
+}
 
-
-
+///
+/// \brief 获取表达式的操作数
+///
+/// 变量管理器中的数据直接共享，否则复制一份，避免表达式持有调用者随时可能释放的内存
+/// \param d
+/// \return 不支持的数据返回nullptr
+///
+static std::shared_ptr<SAAbstractDatas> expression_operand(SAAbstractDatas* d)
+{
+    std::shared_ptr<SAAbstractDatas> res = saValueManager->fromNormalPtr(d);
+    if(res)
+    {
+        return res;
+    }
+    const SAVectorExpression* exp = dynamic_cast<const SAVectorExpression*>(d);
+    if(exp)
+    {
+        //表达式构造后不再改变，复制时共享表达式图
+        return SAValueManager::makeData<SAVectorExpression>(exp->getName(),exp->root());
+    }
+    if(SA::Dim0 == d->getDim())
+    {
+        return SAValueManager::makeData<SAVariantDatas>(d->getAt(0));
+    }
+    const SAVectorPointF* vp = dynamic_cast<const SAVectorPointF*>(d);
+    if(vp)
+    {
+        return SAValueManager::makeData<SAVectorPointF>(vp->getName(),vp->getValueDatas());
+    }
+    QVector<double> v;
+    if(!SADataConver::converToDoubleVector(d,v))
+    {
+        return nullptr;
+    }
+    return SAValueManager::makeData<SAVectorDouble>(d->getName(),v);
+}
+///
+/// \brief 二元运算，两个0维数据直接计算，有序列时构造表达式
+/// \param op
+/// \param a
+/// \param b
+/// \return
+///
+static std::shared_ptr<SAAbstractDatas> binary_operate(SAVectorKernel::Operator op,SAAbstractDatas* a,SAAbstractDatas* b)
+{
+    if(SA::Dim0 == a->getDim() && SA::Dim0 == b->getDim())
+    {
+        double va,vb,res;
+        if(!SADataConver::converToDouble(a,va) || !SADataConver::converToDouble(b,vb))
+        {
+            saFun::setErrorString(TR("data can not conver to double"));
+            return nullptr;
+        }
+        SAVectorKernel::binary(op,SAVectorKernel::scalar(&va),SAVectorKernel::scalar(&vb),&res,1,1);
+        std::shared_ptr<SAAbstractDatas> d = SAValueManager::makeData<SAVariantDatas>(res);
+        d->setName("tmp_double_transform");
+        return d;
+    }
+    std::shared_ptr<SAAbstractDatas> da = expression_operand(a);
+    std::shared_ptr<SAAbstractDatas> db = expression_operand(b);
+    if(nullptr == da || nullptr == db)
+    {
+        saFun::setErrorString(TR("data can not conver to double vector"));
+        return nullptr;
+    }
+    std::shared_ptr<SAVectorExpression> res = SAVectorExpression::makeBinary(op,da,db);
+    if(nullptr == res)
+    {
+        saFun::setErrorString(TR("data size not match"));
+        return nullptr;
+    }
+    return std::static_pointer_cast<SAAbstractDatas>(res);
+}
+///
+/// \brief 一元运算，直接读取源数据的内存
+///
+/// 点序列复制一次后原地变换y值，double数组直接写入结果，其它数据转换后原地计算
+/// \param data
+/// \param suffix 结果名的后缀
+/// \param fun 调用\sa SAVectorKernel 的函数，参数为(输入,输出,输出步长,个数)
+/// \return
+///
+template<typename FUN>
+static std::shared_ptr<SAAbstractDatas> unary_operate(SAAbstractDatas* data,const QString& suffix,FUN fun)
+{
+    const QString name = QString("%1_%2").arg(data->getName()).arg(suffix);
+    if(SA::Dim0 == data->getDim())
+    {
+        double v,res;
+        if(!SADataConver::converToDouble(data,v))
+        {
+            saFun::setErrorString(TR("data can not conver to double"));
+            return nullptr;
+        }
+        fun(SAVectorKernel::Span(&v),&res,1,1);
+        std::shared_ptr<SAAbstractDatas> d = SAValueManager::makeData<SAVariantDatas>(res);
+        d->setName(name);
+        return d;
+    }
+    const SAVectorPointF* vp = dynamic_cast<const SAVectorPointF*>(data);
+    if(vp)
+    {
+        QVector<QPointF> points = vp->getValueDatas();
+        if(!points.isEmpty())
+        {
+            QPointF* p = points.data();
+            fun(SAVectorKernel::yChannel(p),&(p->ry()),2,points.size());
+        }
+        return SAValueManager::makeData<SAVectorPointF>(name,points);
+    }
+    QVector<double> res;
+    const SAVectorDouble* vd = dynamic_cast<const SAVectorDouble*>(data);
+    if(vd)
+    {
+        const QVector<double>& in = vd->getValueDatas();
+        res.resize(in.size());
+        fun(SAVectorKernel::Span(in.constData()),res.data(),1,res.size());
+    }
+    else
+    {
+        if(!SADataConver::converToDoubleVector(data,res))
+        {
+            saFun::setErrorString(TR("data can not conver to double vector"));
+            return nullptr;
+        }
+        fun(SAVectorKernel::Span(res.constData()),res.data(),1,res.size());
+    }
+    return SAValueManager::makeData<SAVectorDouble>(name,res);
+}
+///
+/// \brief 滑动窗口统计的公共实现
+/// \param suffix 结果名称的后缀，后面接窗口长度
+///
+static std::shared_ptr<SAAbstractDatas> rolling_statistic(SAAbstractDatas* data,int window
+                                                          ,SA::SARollingStatistics::Statistic stat,double percentile
+                                                          ,const QString& suffix)
+{
+    SA::SARollingStatistics rs(window,stat,percentile);
+    if(!rs.isValid())
+    {
+        saFun::setErrorString(TR("window must be positive and percentile must be in [0,100]"));
+        return nullptr;
+    }
+    if(SA::Dim0 == data->getDim())
+    {
+        saFun::setErrorString(TR("rolling statistic need vector data"));
+        return nullptr;
+    }
+    const QString name = QString("%1_%2%3").arg(data->getName()).arg(suffix).arg(window);
+    const SAVectorPointF* vp = dynamic_cast<const SAVectorPointF*>(data);
+    if(vp)
+    {
+        QVector<QPointF> points = vp->getValueDatas();
+        QVector<double> y(points.size());
+        for(int i=0;i<points.size();++i)
+        {
+            y[i] = points[i].y();
+        }
+        rs.apply(y.constData(),y.data(),y.size());
+        for(int i=0;i<points.size();++i)
+        {
+            points[i].setY(y[i]);
+        }
+        return SAValueManager::makeData<SAVectorPointF>(name,points);
+    }
+    QVector<double> in,res;
+    if(!SADataConver::converToDoubleVector(data,in))
+    {
+        saFun::setErrorString(TR("data can not conver to double vector"));
+        return nullptr;
+    }
+    res.resize(in.size());
+    rs.apply(in.constData(),res.data(),res.size());
+    return SAValueManager::makeData<SAVectorDouble>(name,res);
+}
+///
+/// \brief 频率统计的公共实现
+/// \param weight 权重，nullptr时不带权重
+/// \param section 段数，为0时自动确定
+///
+static std::shared_ptr<SAVectorInterval> hist_datas(const SAAbstractDatas* wave,const SAAbstractDatas* weight,unsigned section)
+{
+    QVector<double> ys,ws;
+    if(!saFun::getDoubleVector(wave,ys))
+    {
+        return nullptr;
+    }
+    if(ys.size () == 0)
+    {
+        saFun::setErrorString(TR("%1 size is to short").arg(wave->getName()));
+        return nullptr;
+    }
+    if(weight)
+    {
+        if(!saFun::getDoubleVector(weight,ws))
+        {
+            return nullptr;
+        }
+        if(ws.size() != ys.size())
+        {
+            saFun::setErrorString(TR("%1 and %2 size not equal").arg(wave->getName()).arg(weight->getName()));
+            return nullptr;
+        }
+    }
+    SA::SAHistogram h;
+    const double* w = weight ? ws.constData() : nullptr;
+    const bool ok = (0 == section) ? h.computeAuto(ys.constData(),ys.size(),w)
+                                   : h.compute(ys.constData(),ys.size(),static_cast<int>(section),w);
+    if(!ok)
+    {
+        saFun::setErrorString(TR("%1 has no finite value").arg(wave->getName()));
+        return nullptr;
+    }
+    QVector< QwtIntervalSample > sample;
+    sample.reserve (h.bins());
+    for(int j=0;j<h.bins();++j)
+    {
+        sample.push_back(QwtIntervalSample(h.count(j),h.edge(j),h.edge(j+1)));
+    }
+    auto res = SAValueManager::makeData<SAVectorInterval>();
+    res->setValueDatas (sample);
+    return res;
+}
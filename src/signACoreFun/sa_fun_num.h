@@ -4,10 +4,13 @@
 #include "sa_fun_core.h"
 #include <QString>
 #include <QMap>
+#include <tuple>
 class SAAbstractDatas;
 class SAVariantDatas;
 class SAVectorDouble;
+class SAVectorExpression;
 class SATableVariant;
+class SATableDouble;
 class SAVectorInterval;
 
 #define IDS_SUM "sum"
@@ -31,12 +34,24 @@ SA_CORE_FUN__EXPORT std::shared_ptr<SAAbstractDatas> subtract(SAAbstractDatas* a
 SA_CORE_FUN__EXPORT std::shared_ptr<SAAbstractDatas> multiplication(SAAbstractDatas* a,SAAbstractDatas* b);
 //除法
 SA_CORE_FUN__EXPORT std::shared_ptr<SAAbstractDatas> division(SAAbstractDatas* a,SAAbstractDatas* b);
+//线性变换a*k+bias
+SA_CORE_FUN__EXPORT std::shared_ptr<SAAbstractDatas> scale(SAAbstractDatas* data,double k,double bias = 0);
+//绝对值
+SA_CORE_FUN__EXPORT std::shared_ptr<SAAbstractDatas> absolute(SAAbstractDatas* data);
+//自然对数
+SA_CORE_FUN__EXPORT std::shared_ptr<SAAbstractDatas> naturalLog(SAAbstractDatas* data);
+//自然指数
+SA_CORE_FUN__EXPORT std::shared_ptr<SAAbstractDatas> exponential(SAAbstractDatas* data);
+//限幅
+SA_CORE_FUN__EXPORT std::shared_ptr<SAAbstractDatas> clip(SAAbstractDatas* data,double lo,double hi);
 //求均值 mean(vector) -> mean
 SA_CORE_FUN__EXPORT std::shared_ptr<SAVariantDatas> mean(SAAbstractDatas* data);
 //求点集的y值的均值
 SA_CORE_FUN__EXPORT double meamPointY(const QVector<QPointF>& points);
 //差分
 SA_CORE_FUN__EXPORT std::shared_ptr<SAVectorDouble> diff(SAAbstractDatas* data,unsigned diffCount);
+//延迟计算的差分
+SA_CORE_FUN__EXPORT std::shared_ptr<SAVectorExpression> diffExpression(SAAbstractDatas* data,unsigned diffCount);
 //计算频率统计参数
 SA_CORE_FUN__EXPORT std::shared_ptr<SATableVariant> statistics(SAAbstractDatas* data);
 
@@ -44,10 +59,37 @@ SA_CORE_FUN__EXPORT QMap<QString,double> statistics(const QVector<double>& data)
 ///
 /// \brief 频率统计计算
 /// \param wave 波形
-/// \param section 统计段数
+/// \param section 统计段数，为0时按Freedman–Diaconis规则自动确定
 /// \return 如果错误发生返回nullptr
 ///
 SA_CORE_FUN__EXPORT std::shared_ptr<SAVectorInterval> hist(const SAAbstractDatas* wave,unsigned section);
+//带权重的频率统计，weight和wave等长，每段的值为落在该段的权重和
+SA_CORE_FUN__EXPORT std::shared_ptr<SAVectorInterval> hist(const SAAbstractDatas* wave,const SAAbstractDatas* weight,unsigned section);
+///
+/// \brief 二维频率统计
+/// \param x x数据
+/// \param y y数据，和x等长
+/// \param xSection x方向段数
+/// \param ySection y方向段数
+/// \return std::tuple<count,xEdges,yEdges>，count第i行第j列为第i个x段、第j个y段的计数，
+/// 边界长度为段数+1，如果错误发生返回的指针都为nullptr
+///
+SA_CORE_FUN__EXPORT std::tuple<std::shared_ptr<SATableDouble>,std::shared_ptr<SAVectorDouble>,std::shared_ptr<SAVectorDouble> >
+hist2D(const SAAbstractDatas* x,const SAAbstractDatas* y,unsigned xSection,unsigned ySection);
+//滑动窗口均值
+SA_CORE_FUN__EXPORT std::shared_ptr<SAAbstractDatas> rollingMean(SAAbstractDatas* data,int window);
+//滑动窗口方差
+SA_CORE_FUN__EXPORT std::shared_ptr<SAAbstractDatas> rollingVar(SAAbstractDatas* data,int window);
+//滑动窗口均方根
+SA_CORE_FUN__EXPORT std::shared_ptr<SAAbstractDatas> rollingRms(SAAbstractDatas* data,int window);
+//滑动窗口最小值
+SA_CORE_FUN__EXPORT std::shared_ptr<SAAbstractDatas> rollingMin(SAAbstractDatas* data,int window);
+//滑动窗口最大值
+SA_CORE_FUN__EXPORT std::shared_ptr<SAAbstractDatas> rollingMax(SAAbstractDatas* data,int window);
+//滑动窗口中位数
+SA_CORE_FUN__EXPORT std::shared_ptr<SAAbstractDatas> rollingMedian(SAAbstractDatas* data,int window);
+//滑动窗口百分位数，percentile∈[0,100]
+SA_CORE_FUN__EXPORT std::shared_ptr<SAAbstractDatas> rollingPercentile(SAAbstractDatas* data,int window,double percentile);
 
 }
 
@@ -1,7 +1,8 @@
 ﻿#include "sa_fun_preproc.h"
 #include "sa_fun_core.h"
 #include <QVector>
-#include "SASmooth.h"
+#include "SASavitzkyGolay.h"
+#include "SAHampelFilter.h"
 #include "SAMath.h"
 #include "SAValueManager.h"
 #include "SAAlgorithm.h"
@@ -10,6 +11,7 @@
 #define TR(str)\
     QCoreApplication::translate("sa_fun_preproc", str, 0)
 
+static bool sg_filter(const QVector<double>& orData,int points,int power,int derivative,double delta,QVector<double>& res);
 
 
 
@@ -47,26 +49,8 @@ bool saFun::pointSmooth(const SAAbstractDatas *wave, int points, int power, SAVe
     {
         return false;
     }
-    smoothY.resize (orData.size ());
-    if(3 == points && 1 == power)
-        SA::SASmooth::linearSmooth3 (orData.begin (),orData.end (),smoothY.begin ());
-    else if(5 == points && 1 == power)
-        SA::SASmooth::linearSmooth5 (orData.begin (),orData.end (),smoothY.begin ());
-    else if(7 == points && 1 == power)
-        SA::SASmooth::linearSmooth7 (orData.begin (),orData.end (),smoothY.begin ());
-    else if(5 == points && 2 == power)
-        SA::SASmooth::quadraticSmooth5 (orData.begin (),orData.end (),smoothY.begin ());
-    else if(7 == points && 2 == power)
-        SA::SASmooth::quadraticSmooth7 (orData.begin (),orData.end (),smoothY.begin ());
-    else if(5 == points && 3 == power)
-        SA::SASmooth::cubicSmooth5 (orData.begin (),orData.end (),smoothY.begin ());
-    else if(7 == points && 3 == power)
-        SA::SASmooth::cubicSmooth7 (orData.begin (),orData.end (),smoothY.begin ());
-    else
+    if(!sg_filter(orData,points,power,0,1.0,smoothY))
     {
-        saFun::setErrorString( (TR("can not deal [%1 points %2 power],"
-                                   "m,n should be set to"
-                                   " [m,n]={[3,1],[5,1],[7,1],[5,2],[7,2],[5,3],[7,3]").arg(points).arg(power)));
         return false;
     }
     if(output)
@@ -81,26 +65,8 @@ bool saFun::pointSmooth(const SAVectorPointF *wave, int points, int power, SAVec
     QVector<double> smoothY;
     orData.reserve(wave->getSize());
     SAVectorPointF::getYs(wave,std::back_inserter(orData));
-    smoothY.resize (orData.size ());
-    if(3 == points && 1 == power)
-        SA::SASmooth::linearSmooth3 (orData.begin (),orData.end (),smoothY.begin ());
-    else if(5 == points && 1 == power)
-        SA::SASmooth::linearSmooth5 (orData.begin (),orData.end (),smoothY.begin ());
-    else if(7 == points && 1 == power)
-        SA::SASmooth::linearSmooth7 (orData.begin (),orData.end (),smoothY.begin ());
-    else if(5 == points && 2 == power)
-        SA::SASmooth::quadraticSmooth5 (orData.begin (),orData.end (),smoothY.begin ());
-    else if(7 == points && 2 == power)
-        SA::SASmooth::quadraticSmooth7 (orData.begin (),orData.end (),smoothY.begin ());
-    else if(5 == points && 3 == power)
-        SA::SASmooth::cubicSmooth5 (orData.begin (),orData.end (),smoothY.begin ());
-    else if(7 == points && 3 == power)
-        SA::SASmooth::cubicSmooth7 (orData.begin (),orData.end (),smoothY.begin ());
-    else
+    if(!sg_filter(orData,points,power,0,1.0,smoothY))
     {
-        saFun::setErrorString( (TR("can not deal [%1 points %2 power],"
-                                   "m,n should be set to"
-                                   " [m,n]={[3,1],[5,1],[7,1],[5,2],[7,2],[5,3],[7,3]").arg(points).arg(power)));
         return false;
     }
     if(output)
@@ -109,6 +75,49 @@ bool saFun::pointSmooth(const SAVectorPointF *wave, int points, int power, SAVec
     }
     return true;
 }
+///
+/// \brief Savitzky-Golay平滑及求导
+/// \param wave 输入数据，点序列对y计算，导数按x的平均间隔换算
+/// \param points 窗口点数，正奇数
+/// \param power 拟合多项式的阶次，小于points
+/// \param derivative 导数阶次，0为平滑
+/// \return 成功返回计算结果指针,输入为点序列时返回SAVectorPointF，否则为SAVectorDouble
+///
+std::shared_ptr<SAAbstractDatas> saFun::savitzkyGolay(SAAbstractDatas *wave, int points, int power, int derivative)
+{
+    const QString name = QString("%1_SG%2P%3P%4D").arg(wave->getName()).arg(points).arg(power).arg(derivative);
+    QVector<double> ys;
+    QVector<double> res;
+    if(wave->getType() == SA::VectorPoint)
+    {
+        const SAVectorPointF* vp = static_cast<const SAVectorPointF*>(wave);
+        const QVector<QPointF>& pts = vp->getValueDatas();
+        double delta = 1.0;
+        if(pts.size() > 1)
+        {
+            delta = (pts.last().x() - pts.first().x()) / (pts.size() - 1);
+        }
+        ys.reserve(pts.size());
+        SAVectorPointF::getYs(vp,std::back_inserter(ys));
+        if(!sg_filter(ys,points,power,derivative,delta,res))
+        {
+            return nullptr;
+        }
+        auto ptr = SAValueManager::makeData<SAVectorPointF>(name,pts);
+        SAVectorPointF::replaceYs(ptr.get(),res.begin(),res.end());
+        return SAValueManager::castPointToBase(ptr);
+    }
+    if(!saFun::getDoubleVector(wave,ys))
+    {
+        return nullptr;
+    }
+    if(!sg_filter(ys,points,power,derivative,1.0,res))
+    {
+        return nullptr;
+    }
+    auto ptr = SAValueManager::makeData<SAVectorDouble>(name,res);
+    return SAValueManager::castPointToBase(ptr);
+}
 
 std::tuple<
     std::shared_ptr<SAAbstractDatas>
@@ -242,30 +251,145 @@ void saFun::sigmaDenoising(const QVector<double>& ys
 }
 
 
+///
+/// \brief Hampel异常值检测
+///
+/// 和\sa sigmaDenoising 的全局均值±nσ不同，每个点用它周围窗口的中位数和MAD判断，
+/// 能检测出非平稳信号中的局部尖峰
+/// \param wave 波形
+/// \param halfWindow 中心点两侧各取的点数
+/// \param sigma sigma值
+/// \return 出错时返回的指针都为nullptr
+///
+std::tuple<
+std::shared_ptr<SAAbstractDatas>
+,std::shared_ptr<SAAbstractDatas>
+,std::shared_ptr<SAVectorInt>
+,std::shared_ptr<SAVectorInt>
+>
+saFun::hampelDenoising(const SAAbstractDatas *wave, int halfWindow, double sigma)
+{
+    QVector<double> ys;
+    const SAVectorPointF* vp = (wave->getType() == SA::VectorPoint) ? static_cast<const SAVectorPointF*>(wave) : nullptr;
+    if(vp)
+    {
+        ys.reserve(vp->getSize());
+        SAVectorPointF::getYs(vp,std::back_inserter(ys));
+    }
+    else if(!saFun::getDoubleVector(wave,ys))
+    {
+        setErrorString(TR("data can not conver to double vector"));
+        return std::make_tuple(nullptr,nullptr,nullptr,nullptr);
+    }
+    QVector<int> indexOutRang;
+    if(!hampelDenoising(ys,halfWindow,sigma,indexOutRang))
+    {
+        return std::make_tuple(nullptr,nullptr,nullptr,nullptr);
+    }
+    QVector<int> indexInRang;
+    indexInRang.reserve(ys.size() - indexOutRang.size());
+    for(int i=0,j=0;i<ys.size();++i)
+    {
+        if(j < indexOutRang.size() && indexOutRang[j] == i)
+        {
+            ++j;
+        }
+        else
+        {
+            indexInRang.append(i);
+        }
+    }
+    std::shared_ptr<SAVectorInt> outRangIndex = SAValueManager::makeData<SAVectorInt>(QString("%1_hampelOutRangIndex").arg(wave->getName()));
+    std::shared_ptr<SAVectorInt> inRangIndex = SAValueManager::makeData<SAVectorInt>(QString("%1_hampelInRangIndex").arg(wave->getName()));
+    outRangIndex->setValueDatas(indexOutRang);
+    inRangIndex->setValueDatas(indexInRang);
+    if(vp)
+    {
+        QVector<QPointF> denoisingData,beRemoveData;
+        beRemoveData.reserve(indexOutRang.size());
+        denoisingData.reserve(indexInRang.size());
+        SA::split_with_indexs(vp->cbegin(),vp->cend()
+                           ,indexOutRang.begin(),indexOutRang.end()
+                           ,std::back_inserter(beRemoveData)
+                           ,std::back_inserter(denoisingData));
+        auto waveDenoising = SAValueManager::makeData<SAVectorPointF>(QString("%1_hampelDenoising").arg(wave->getName()),denoisingData);
+        auto waveRemove = SAValueManager::makeData<SAVectorPointF>(QString("%1_hampelRemove").arg(wave->getName()),beRemoveData);
+        return std::make_tuple(SAValueManager::castPointToBase(waveDenoising)
+                               ,SAValueManager::castPointToBase(waveRemove)
+                               ,outRangIndex,inRangIndex);
+    }
+    QVector<double> denoisingData,beRemoveData;
+    beRemoveData.reserve(indexOutRang.size());
+    denoisingData.reserve(indexInRang.size());
+    SA::split_with_indexs(ys.cbegin(),ys.cend()
+                       ,indexOutRang.begin(),indexOutRang.end()
+                       ,std::back_inserter(beRemoveData)
+                       ,std::back_inserter(denoisingData));
+    auto waveDenoising = SAValueManager::makeData<SAVectorDouble>(QString("%1_hampelDenoising").arg(wave->getName()),denoisingData);
+    auto waveRemove = SAValueManager::makeData<SAVectorDouble>(QString("%1_hampelRemove").arg(wave->getName()),beRemoveData);
+    return std::make_tuple(SAValueManager::castPointToBase(waveDenoising)
+                           ,SAValueManager::castPointToBase(waveRemove)
+                           ,outRangIndex,inRangIndex);
+}
+///
+/// \brief Hampel异常值检测
+///
+/// 一遍扫描数据，数据量大时分段并行
+/// \param ys 数据
+/// \param halfWindow 中心点两侧各取的点数
+/// \param sigma sigma值
+/// \param index 异常值的索引，按升序追加
+/// \return 参数不合法时返回false
+///
+bool saFun::hampelDenoising(const QVector<double> &ys, int halfWindow, double sigma, QVector<int> &index)
+{
+    SA::SAHampelFilter hampel(halfWindow,sigma);
+    if(!hampel.isValid())
+    {
+        setErrorString(TR("half window and sigma can not be negative"));
+        return false;
+    }
+    std::vector<size_t> outliers;
+    hampel.detect(ys.constData(),ys.size(),outliers);
+    index.reserve(index.size() + static_cast<int>(outliers.size()));
+    for(size_t i : outliers)
+    {
+        index.append(static_cast<int>(i));
+    }
+    return true;
+}
 
 bool saFun::pointSmooth(const QVector<double> &orData, int points, int power, QVector<double>& smoothY)
 {
-    smoothY.resize (orData.size ());
-    if(3 == points && 1 == power)
-        SA::SASmooth::linearSmooth3 (orData.cbegin (),orData.cend (),smoothY.begin ());
-    else if(5 == points && 1 == power)
-        SA::SASmooth::linearSmooth5 (orData.cbegin (),orData.cend (),smoothY.begin ());
-    else if(7 == points && 1 == power)
-        SA::SASmooth::linearSmooth7 (orData.cbegin (),orData.cend (),smoothY.begin ());
-    else if(5 == points && 2 == power)
-        SA::SASmooth::quadraticSmooth5 (orData.cbegin (),orData.cend (),smoothY.begin ());
-    else if(7 == points && 2 == power)
-        SA::SASmooth::quadraticSmooth7 (orData.cbegin (),orData.cend (),smoothY.begin ());
-    else if(5 == points && 3 == power)
-        SA::SASmooth::cubicSmooth5 (orData.cbegin (),orData.cend (),smoothY.begin ());
-    else if(7 == points && 3 == power)
-        SA::SASmooth::cubicSmooth7 (orData.cbegin (),orData.cend (),smoothY.begin ());
-    else
+    return sg_filter(orData,points,power,0,1.0,smoothY);
+}
+
+///
+/// \brief Savitzky-Golay滤波，参数不合法时设置错误信息
+///
+/// 平滑时数据比窗口短则原样输出，和\sa SA::SASmooth 一致
+///
+static bool sg_filter(const QVector<double>& orData,int points,int power,int derivative,double delta,QVector<double>& res)
+{
+    //系数在构造时计算，先检查参数和数据长度，窗口过大时不会计算系数
+    if(!SA::SASavitzkyGolay::isValidParameter(points,power,derivative))
+    {
+        saFun::setErrorString(TR("can not deal [%1 points %2 power],points should be odd and greater than power,power should not greater than %3")
+                              .arg(points).arg(power).arg(SA_SG_MAX_ORDER));
+        return false;
+    }
+    if(orData.size() < points)
     {
-        saFun::setErrorString( (TR("can not deal [%1 points %2 power],"
-                                   "m,n should be set to"
-                                   " [m,n]={[3,1],[5,1],[7,1],[5,2],[7,2],[5,3],[7,3]").arg(points).arg(power)));
+        if(0 == derivative)
+        {
+            res = orData;
+            return true;
+        }
+        saFun::setErrorString(TR("data size %1 is less than %2 points").arg(orData.size()).arg(points));
         return false;
     }
+    SA::SASavitzkyGolay sg(points,power,derivative);
+    res.resize(orData.size());
+    sg.apply(orData.constData(),res.data(),static_cast<size_t>(orData.size()),delta);
     return true;
 }
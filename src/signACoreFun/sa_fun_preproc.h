@@ -12,28 +12,28 @@ class SAVectorInt;
 class SAVectorPointF;
 
 namespace saFun {
-//m点n次滤波,m值和n值不能随便设置[m,n]={[3,1],[5,1],[7,1],[5,2],[7,2],[5,3],[7,3]}
+//m点n次滤波，即Savitzky-Golay平滑
 ///
 /// \brief m点n次滤波
 ///
 /// points:[int]m点n次平滑的n值
 /// power:[int]m点n次平滑的m值
 /// \param wave 输入数据
-/// \param points 点数，分别为3,5,7
-/// \param power 次数，分别为1,2,3
+/// \param points 点数，正奇数
+/// \param power 次数，小于点数
 /// \return 成功返回计算结果指针,如果输入可以转换为vector point返回的指针为SAVectorPointF，否则为SAVectorDouble
-/// \note m值和n值不能随便设置[m,n]={[3,1],[5,1],[7,1],[5,2],[7,2],[5,3],[7,3]}
+/// \note 数据比点数少时原样输出
 ///
 SA_CORE_FUN__EXPORT
 std::shared_ptr<SAAbstractDatas> pointSmooth(SAAbstractDatas* wave,int points,int power);
 ///
 /// \brief m点n次滤波
 /// \param wave 输入数据
-/// \param points 点数，分别为3,5,7
-/// \param power 次数，分别为1,2,3
+/// \param points 点数，正奇数
+/// \param power 次数，小于点数
 /// \param output 计算结果指针
 /// \return 计算成功返回true
-/// \note m值和n值不能随便设置[m,n]={[3,1],[5,1],[7,1],[5,2],[7,2],[5,3],[7,3]}
+/// \note 数据比点数少时原样输出
 /// \note 如果不清楚传入的数据是点数组还是数据数组，调用std::shared_ptr<SAAbstractDatas> pointSmooth(SAAbstractDatas* wave,int points,int power);
 ///
 SA_CORE_FUN__EXPORT
@@ -41,11 +41,11 @@ bool pointSmooth(const SAAbstractDatas* wave,int points,int power,SAVectorDouble
 ///
 /// \brief m点n次滤波
 /// \param wave 输入数据
-/// \param points 点数，分别为3,5,7
-/// \param power 次数，分别为1,2,3
+/// \param points 点数，正奇数
+/// \param power 次数，小于点数
 /// \param output 计算结果指针
 /// \return 计算成功返回true
-/// \note m值和n值不能随便设置[m,n]={[3,1],[5,1],[7,1],[5,2],[7,2],[5,3],[7,3]}
+/// \note 数据比点数少时原样输出
 /// \note 如果不清楚传入的数据是点数组还是数据数组，调用std::shared_ptr<SAAbstractDatas> pointSmooth(SAAbstractDatas* wave,int points,int power);
 ///
 SA_CORE_FUN__EXPORT
@@ -53,6 +53,9 @@ bool pointSmooth(const SAVectorPointF* wave, int points, int power, SAVectorPoin
 
 SA_CORE_FUN__EXPORT
 bool pointSmooth(const QVector<double>& orData, int points, int power, QVector<double> &smoothY);
+//Savitzky-Golay平滑及求导
+SA_CORE_FUN__EXPORT
+std::shared_ptr<SAAbstractDatas> savitzkyGolay(SAAbstractDatas* wave,int points,int power,int derivative = 0);
 ///
 /// \brief sigma异常值检测
 /// \param wave 传入数据波形，波形可为vectordouble或vectorpoint
@@ -111,6 +114,27 @@ SA_CORE_FUN__EXPORT
 void sigmaDenoising(const QVector<double>& ys
                     , double sigma
                     , QVector<int> &index);
+///
+/// \brief Hampel异常值检测，以滑动窗口的中位数和绝对中位差(MAD)判断局部异常值
+/// \param wave 传入数据波形，波形可为vectordouble或vectorpoint
+/// \param halfWindow 中心点两侧各取的点数，窗口长度为2*halfWindow+1
+/// \param sigma sigma值，|x-median| > sigma*1.4826*MAD 判为异常值
+/// \return std::tuple<waveDenoising,waveRemove,outRangIndex,inRangIndex>，含义和\sa sigmaDenoising 一致
+///
+SA_CORE_FUN__EXPORT
+std::tuple<
+std::shared_ptr<SAAbstractDatas>//waveDenoising
+,std::shared_ptr<SAAbstractDatas>//waveRemove
+,std::shared_ptr<SAVectorInt>//outRangIndex
+,std::shared_ptr<SAVectorInt> //inRangIndex
+>
+hampelDenoising(const SAAbstractDatas *wave,int halfWindow, double sigma);
+//Hampel异常值检测，index保存异常值的索引，参数不合法时返回false
+SA_CORE_FUN__EXPORT
+bool hampelDenoising(const QVector<double>& ys
+                     , int halfWindow
+                     , double sigma
+                     , QVector<int> &index);
 
 }
 
@@ -4,6 +4,8 @@
 #include "SACRC.h"
 #include "SATcpDataProcessSocket.h"
 #include "SAServerDefine.h"
+#include <algorithm>
+#include <cmath>
 
 
 /**
@@ -45,3 +47,162 @@ SAXMLProtocol xmlProtocol(int funid, const SAXMLProtocol& reqxml)
     res.setValue("key", key);
     return (res);
 }
+
+
+///
+/// \def describe_2d_points每处理这么多个点检查一次取消标记
+///
+#ifndef SA_DESCRIBE_CANCEL_CHECK_CHUNK
+#define SA_DESCRIBE_CANCEL_CHECK_CHUNK    (1<<16)
+#endif
+
+namespace {
+bool is_canceled(const std::atomic_bool *cancel)
+{
+    return (cancel && cancel->load());
+}
+
+
+/**
+ * @brief 把[first,last)中按comp排在最前的k个点合并到best中
+ * @param best 有序，最多保留k个
+ */
+template<typename Cmp>
+void merge_sorted_best(const QPointF *first, const QPointF *last, int k, QVector<QPointF>& best, Cmp comp)
+{
+    QVector<QPointF> part(std::min<int>(k, int(last - first)));
+
+    std::partial_sort_copy(first, last, part.begin(), part.end(), comp);
+    QVector<QPointF> merged(best.size() + part.size());
+
+    std::merge(best.begin(), best.end(), part.begin(), part.end(), merged.begin(), comp);
+    if (merged.size() > k) {
+        merged.resize(k);
+    }
+    best.swap(merged);
+}
+}
+
+/**
+ * @brief 计算2维点序列的描述
+ *
+ * 计算过程不修改points，因此points可以直接指向共享数据区，
+ * 只有求中位数时需要拷贝一份y值
+ *
+ * 每一遍遍历都按SA_DESCRIBE_CANCEL_CHECK_CHUNK分段，段之间检查cancel，
+ * 请求被取消后不需要等整个计算完成
+ * @param points 点序列
+ * @param n 点的数量
+ * @param sortcount 返回排序的前后n个值，超出[0,1000]按20处理
+ * @param res 结果
+ * @param cancel 取消标记，可以为nullptr
+ * @return points为空或被取消返回false
+ */
+bool describe_2d_points(const QPointF *points, int n, int sortcount, SA2DPointsDescribeResult& res
+    , const std::atomic_bool *cancel)
+{
+    if ((nullptr == points) || (n <= 0)) {
+        return (false);
+    }
+    if ((sortcount < 0) || (sortcount > 1000)) {
+        sortcount = 20;
+    }
+    const int chunk = SA_DESCRIBE_CANCEL_CHECK_CHUNK;
+    //第一遍：求和、最值，同时取出y值用于后续的计算
+    QVector<double> ys(n);
+    const QPointF *minIte = points;
+    const QPointF *maxIte = points;
+    double sum = 0;
+
+    for (int b = 0; b < n; b += chunk)
+    {
+        if (is_canceled(cancel)) {
+            return (false);
+        }
+        const int e = std::min(n, b + chunk);
+        for (int i = b; i < e; ++i)
+        {
+            const double y = points[i].y();
+            ys[i] = y;
+            sum += y;
+            //和std::minmax_element一致，最小取第一个，最大取最后一个
+            if (y < minIte->y()) {
+                minIte = points + i;
+            }
+            if (!(y < maxIte->y())) {
+                maxIte = points + i;
+            }
+        }
+    }
+    res.count = n;
+    res.sum = sum;
+    res.mean = sum / n;
+    //第二遍：方差、斜度、峭度
+    double d2 = 0, d3 = 0, d4 = 0;
+
+    for (int b = 0; b < n; b += chunk)
+    {
+        if (is_canceled(cancel)) {
+            return (false);
+        }
+        const int e = std::min(n, b + chunk);
+        for (int i = b; i < e; ++i)
+        {
+            const double t = ys[i] - res.mean;
+            const double t2 = t * t;
+            d2 += t2;
+            d3 += t2 * t;
+            d4 += t2 * t2;
+        }
+    }
+    res.var = (n > 1) ? (d2 / (n - 1)) : d2;    //随机序列的方差要减去1
+    res.stdVar = sqrt(res.var);
+    res.skewness = d3 / (n * res.stdVar * res.stdVar * res.stdVar);
+    res.kurtosis = d4 / (n * res.var * res.var);
+    res.minPoint = *minIte;
+    res.maxPoint = *maxIte;
+    res.min = res.minPoint.y();                                     //最小
+    res.max = res.maxPoint.y();                                     //最大
+    res.peak2peak = res.max - res.min;
+    //中位数
+    if (is_canceled(cancel)) {
+        return (false);
+    }
+    std::nth_element(ys.begin(), ys.begin() + n/2, ys.end());
+    res.mid = ys[n/2];
+    res.midPoint = res.minPoint;
+    int sortedcount = sortcount < n ? sortcount : n;
+    QVector<QPointF> tops, lows;
+    bool midFound = false;
+
+    tops.reserve(sortedcount);
+    lows.reserve(sortedcount);
+    //第三遍：中位数对应的点，tops和lows只做部分排序，每段的结果再合并
+    for (int b = 0; b < n; b += chunk)
+    {
+        if (is_canceled(cancel)) {
+            return (false);
+        }
+        const QPointF *first = points + b;
+        const QPointF *last = points + std::min(n, b + chunk);
+        if (!midFound) {
+            const double mid = res.mid;
+            const QPointF *midIte = std::find_if(first, last, [mid](const QPointF& p)->bool {
+                return (p.y() == mid);
+            });
+            if (midIte != last) {
+                res.midPoint = *midIte;
+                midFound = true;
+            }
+        }
+        merge_sorted_best(first, last, sortedcount, tops, [](const QPointF& a, const QPointF& b)->bool {
+            return (a.y() > b.y());
+        });
+        merge_sorted_best(first, last, sortedcount, lows, [](const QPointF& a, const QPointF& b)->bool {
+            return (a.y() < b.y());
+        });
+    }
+    res.tops = tops;
+    res.lows = lows;
+    return (true);
+}
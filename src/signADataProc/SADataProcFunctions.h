@@ -3,6 +3,10 @@
 #include <QFuture>
 #include "SAXMLProtocol.h"
 #include "SAProtocolHeader.h"
+#include <QVector>
+#include <QPointF>
+#include <QMetaType>
+#include <atomic>
 
 /**
  * @brief 通用函数
@@ -15,4 +19,31 @@ SAXMLProtocol xmlProtocol(int funid, const SAXMLProtocol& reqxml);
 //根据请求头创建回复头
 SAProtocolHeader createXMLReplyHeader(const SAProtocolHeader& requestHeader, const QByteArray& data, int Funid);
 
+/**
+ * @brief 2维点序列的描述结果
+ */
+struct SA2DPointsDescribeResult {
+    unsigned int count;
+    double sum;
+    double mean;
+    double var;
+    double stdVar;
+    double skewness;
+    double kurtosis;
+    double min;
+    double max;
+    double mid;
+    double peak2peak;
+    QPointF minPoint;
+    QPointF maxPoint;
+    QPointF midPoint;
+    QVector<QPointF> tops;
+    QVector<QPointF> lows;
+};
+Q_DECLARE_METATYPE(SA2DPointsDescribeResult)
+
+//计算2维点序列的描述，不修改points，cancel被置位时中止计算并返回false
+bool describe_2d_points(const QPointF *points, int n, int sortcount, SA2DPointsDescribeResult& res
+    , const std::atomic_bool *cancel = nullptr);
+
 #endif // SADATAPROCFUNCTIONS_H
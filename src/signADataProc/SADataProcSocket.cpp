@@ -3,22 +3,35 @@
 #include "SAServeHandleFun.h"
 #include "SADataProcFunctions.h"
 #include <QThreadPool>
+#include <limits>
 #include "SAMath.h"
+#include "SAServeSharedBuffer.h"
 #include "runnable/SADataStatisticRunable.h"
 
 SADataProcSocket::SADataProcSocket(QObject *p) : SATcpSocket(p)
+    , m_maxInflight(SA_DATAPROC_MAX_INFLIGHT)
 {
+    qRegisterMetaType<SAProtocolHeader>();
+    qRegisterMetaType<SA2DPointsDescribeResult>();
+    m_channel = std::make_shared<SADataProcTaskChannel>(this);
 }
 
 
 SADataProcSocket::~SADataProcSocket()
 {
+    //先关闭通道，工作线程的结果不再投递，之后取消所有任务
+    m_channel->close();
+    for (auto i = m_tasks.begin(); i != m_tasks.end(); ++i)
+    {
+        //共享数据区的引用由任务在结束时归还，这里不能释放，否则工作线程还在读取的内存会被回收
+        i.value().cancel->store(true);
+    }
 }
 
 
 bool SADataProcSocket::dealXmlProtocol(const SAProtocolHeader& header, const SAXMLProtocol& xml)
 {
-    qDebug() << "serve rec,header fun:" << header.protocolFunID << " type:" << header.protocolTypeID << xml.toString();
+    qDebug() << "serve rec,header fun:" << header.protocolFunID << " type:" << header.protocolTypeID << " seq:" << header.sequenceID;
     if (SATcpSocket::dealXmlProtocol(header, xml)) {
         qDebug() << "SATcpSocket::dealXmlProtocol return true";
         return (true);
@@ -29,6 +42,9 @@ bool SADataProcSocket::dealXmlProtocol(const SAProtocolHeader& header, const SAX
     case SA::ProtocolFunReq2DPointsDescribe:
         return (deal2DPointsDescribe(header, xml));
 
+    case SA::ProtocolFunReq2DPointsDescribeShm:
+        return (deal2DPointsDescribeShm(header, xml));
+
     default:
         break;
     }
@@ -36,99 +52,179 @@ bool SADataProcSocket::dealXmlProtocol(const SAProtocolHeader& header, const SAX
 }
 
 
+/**
+ * @brief 同时在处理的请求上限
+ * @return
+ */
+int SADataProcSocket::getMaxInflight() const
+{
+    return (m_maxInflight);
+}
+
+
+/**
+ * @brief 设置同时在处理的请求上限，超过上限的请求会回复ProtocolErrorBusy
+ * @param n 最小为1
+ */
+void SADataProcSocket::setMaxInflight(int n)
+{
+    m_maxInflight = qMax(1, n);
+}
+
+
+/**
+ * @brief 正在处理的请求数
+ * @return
+ */
+int SADataProcSocket::inflightCount() const
+{
+    return (m_tasks.size());
+}
+
+
+/**
+ * @brief 工作线程计算完成，写出回复
+ * @param header 请求的协议头
+ * @param res 计算结果
+ */
+void SADataProcSocket::onTaskFinished(const SAProtocolHeader& header, const SA2DPointsDescribeResult& res)
+{
+    finishTask(header.sequenceID);
+    SA::reply_2d_points_describe_xml(this, header
+        , res.count, res.sum, res.mean, res.var, res.stdVar, res.skewness, res.kurtosis
+        , res.min, res.max, res.mid, res.peak2peak, res.minPoint, res.maxPoint, res.midPoint
+        , res.tops, res.lows);
+#if 1
+    qDebug()	<< "reply_2d_points_describe_xml,seq:" << header.sequenceID << " sum:" << res.sum << " mean:"  << res.mean
+            << " var:" << res.var << " stdVar:"<< res.stdVar << " skewness:" << res.skewness
+            << " kurtosis:" << res.kurtosis << " min:"<< res.min << " max:" << res.max << " peak2peak:"<< res.peak2peak;
+#endif
+}
+
+
+/**
+ * @brief 工作线程计算失败，回复错误
+ * @param header 请求的协议头
+ * @param errcode 错误码
+ * @param msg 错误信息
+ */
+void SADataProcSocket::onTaskFailed(const SAProtocolHeader& header, int errcode, const QString& msg)
+{
+    finishTask(header.sequenceID);
+    replyError(header, msg, errcode);
+}
+
+
 /**
  * @brief 处理二维点的请求
+ *
+ * xml中点序列的解析和计算都在工作线程中进行
  * @param header 协议头
  * @param xml xml信息
  * @return
  */
 bool SADataProcSocket::deal2DPointsDescribe(const SAProtocolHeader& header, const SAXMLProtocol& xml)
 {
-    qDebug() << QStringLiteral("run _deal2DPointsDescribe");
-    //SADataStatisticRunable* runnable = new SADataStatisticRunable(shared_from_this(),header,xml);
-    //QThreadPool::globalInstance()->start(runnable);
-    return (_deal2DPointsDescribe(header, xml));
+    if (!checkInflight(header)) {
+        return (true);
+    }
+    Task task;
+
+    task.cancel = std::make_shared<std::atomic_bool>(false);
+    m_tasks.insert(header.sequenceID, task);
+    QThreadPool::globalInstance()->start(new SADataStatisticRunable(m_channel, header, xml, task.cancel));
+    return (true);
+}
+
+
+/**
+ * @brief 取消请求，正在计算的任务会在下一次检查取消标记时中止并回复ProtocolErrorCanceled
+ * @param header header.sequenceID为需要取消的请求
+ * @return
+ */
+bool SADataProcSocket::dealCancel(const SAProtocolHeader& header)
+{
+    auto i = m_tasks.find(header.sequenceID);
+
+    if (i == m_tasks.end()) {
+        //请求已经处理完，忽略
+        return (true);
+    }
+    i.value().cancel->store(true);
+    return (true);
 }
 
 
 /**
- * @brief 处理点序列的具体函数
+ * @brief 检查是否还能接收新的请求
  * @param header
- * @param xml
+ * @return 不能接收时会回复错误并返回false
+ */
+bool SADataProcSocket::checkInflight(const SAProtocolHeader& header)
+{
+    if (m_tasks.contains(header.sequenceID)) {
+        replyError(header, tr("sequence id is already in process"), SA::ProtocolErrorBusy);
+        return (false);
+    }
+    if (m_tasks.size() >= m_maxInflight) {
+        replyError(header, tr("too many requests in process"), SA::ProtocolErrorBusy);
+        return (false);
+    }
+    return (true);
+}
+
+
+/**
+ * @brief 任务结束后的清理
+ * @param sequenceID
+ */
+void SADataProcSocket::finishTask(int sequenceID)
+{
+    auto i = m_tasks.find(sequenceID);
+
+    if (i == m_tasks.end()) {
+        return;
+    }
+    m_tasks.erase(i);
+}
+
+
+/**
+ * @brief 处理二维点的请求，点序列位于共享数据区
+ *
+ * 计算直接在映射的内存上进行，这里持有的一次引用交给任务，任务在run结束时归还，
+ * 因此即使socket先析构，计算期间槽也不会被回收，单独的段也不会被解除映射
+ * @param header 协议头
+ * @param xml xml信息
  * @return
  */
-bool SADataProcSocket::_deal2DPointsDescribe(const SAProtocolHeader& header, const SAXMLProtocol& xml)
+bool SADataProcSocket::deal2DPointsDescribeShm(const SAProtocolHeader& header, const SAXMLProtocol& xml)
 {
-    if (SA::ProtocolFunReq2DPointsDescribe != xml.getFunctionID()) {
-        qDebug() << "unknow fun id";
-        replyError(header, tr("unknow fun id"), SA::ProtocolErrorUnknowFun);
+    if (!checkInflight(header)) {
         return (true);
     }
-    //获取points
-    QVector<double> ys;
-    QVector<QPointF> points;
+    SAServeSharedBufferHandle h;
     int sortcount = 20;
 
-    if (!SA::receive_request_2d_points_describe_xml(&xml, points, sortcount)) {
-        qDebug() << "receive_request_2d_points_describe_xml but xml content error";
+    if (!SA::receive_request_2d_points_describe_shm_xml(&xml, h, sortcount)
+        || (SAServeSharedBufferHandle::TypePointF != h.dtype)
+        || (h.elementCount() > std::numeric_limits<int>::max())) {
+        qDebug() << "receive_request_2d_points_describe_shm_xml but xml content error";
         replyError(header, tr("xml content error"), SA::ProtocolErrorContent);
         return (true);
     }
-    int count = points.size();
-
-    ys.reserve(points.size());
-    for (const QPointF& p : points)
-    {
-        ys.append(p.y());
+    if (nullptr == m_sharedBuffer) {
+        m_sharedBuffer = std::make_shared<SAServeSharedBuffer>();
     }
-    if ((sortcount < 0) || (sortcount > 1000)) {
-        sortcount = 20;
+    if (!m_sharedBuffer->retain(h)) {
+        qDebug() << "invalid shared buffer handle,slot:" << h.slotID << " generation:" << h.generation;
+        replyError(header, tr("invalid shared buffer handle"), SA::ProtocolErrorSharedBuffer);
+        return (true);
     }
-    //进行数据处理
-    double sum;
-    double mean;
-    double var;
-    double stdVar;
-    double skewness;
-    double kurtosis;
-    int n = ys.size();
-
-    SA::get_statistics(ys.begin(), ys.end()
-        , sum
-        , mean
-        , var
-        , stdVar
-        , skewness
-        , kurtosis);
-    std::sort(points.begin(), points.end()
-        , [](const QPointF& a, const QPointF& b)->bool {
-        return (a.y() < b.y());
-    });
-    double min = points.cbegin()->y();                              //最小
-    double max = (points.cend()-1)->y();                            //最大
-    double mid = n > 1 ? (points.cbegin() + int(n/2))->y() : min;   //中位数
-    double peak2peak = max - min;
-    QPointF minPoint = *points.cbegin();
-    QPointF maxPoint = *(points.cend()-1);
-    QPointF midPoint = n > 1 ? *(points.cbegin() + int(n/2)) : minPoint;//中位数
-    int sortedcount = sortcount < n ? sortcount : n;
-    QVector<QPointF> tops(sortedcount);
-    QVector<QPointF> lows(sortedcount);
-
-    //拷贝tops
-    std::copy(points.rbegin(), points.rbegin()+sortedcount, tops.begin());
-    //拷贝lows
-    std::copy(points.begin(), points.begin()+sortedcount, lows.begin());
+    Task task;
 
-    SA::reply_2d_points_describe_xml(this, header
-        , count, sum, mean, var, stdVar, skewness, kurtosis
-        , min, max, mid, peak2peak, minPoint, maxPoint, midPoint
-        , tops, lows);
-#if 1
-    qDebug()	<< "reply_2d_points_describe_xml,sum:" << sum << " mean:"  << mean
-            << " var:" << var << " stdVar:"<<stdVar << " skewness:" << skewness
-            << " kurtosis:" << kurtosis << " min:"<< min << " max:" << max << " peak2peak:"<<peak2peak
-            <<" minPoint:" << minPoint << " maxPoint:"<< maxPoint << " midPoint:"<<midPoint;
-#endif
+    task.cancel = std::make_shared<std::atomic_bool>(false);
+    m_tasks.insert(header.sequenceID, task);
+    QThreadPool::globalInstance()->start(new SADataStatisticRunable(m_channel, header, m_sharedBuffer, h, sortcount, task.cancel));
     return (true);
 }
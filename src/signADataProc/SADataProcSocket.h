@@ -2,14 +2,32 @@
 #define SADATAPROCSESSION_H
 #include "SATcpSocket.h"
 #include <memory>
+#include <atomic>
 #include <QFutureWatcher>
 #include <QMutex>
+#include <QHash>
+#include <QPointF>
+#include "SAServeSharedBuffer.h"
+#include "SADataProcFunctions.h"
+class SADataProcTaskChannel;
+
+///
+/// \def 每个连接同时在处理的请求上限
+///
+#ifndef SA_DATAPROC_MAX_INFLIGHT
+#define SA_DATAPROC_MAX_INFLIGHT    16
+#endif
 
 /**
  * @brief 处理数据的session
+ *
+ * 耗时的请求会投递到QThreadPool中处理，socket线程只负责收发，
+ * 因此心跳和其他请求不会被阻塞，同一个连接上可以流水线式的发送多个请求，
+ * 回复按完成的顺序写出，客户端通过sequenceID进行匹配
  */
 class SADataProcSocket : public SATcpSocket
 {
+    Q_OBJECT
 public:
     SADataProcSocket(QObject *p = nullptr);
     ~SADataProcSocket();
@@ -17,13 +35,47 @@ public:
     //处理xml相关请求
     virtual bool dealXmlProtocol(const SAProtocolHeader& header, const SAXMLProtocol& xml) override;
 
+    //同时在处理的请求上限
+    int getMaxInflight() const;
+    void setMaxInflight(int n);
+
+    //正在处理的请求数
+    int inflightCount() const;
+
+    //工作线程计算完成，由@ref SADataProcTaskChannel 以Qt::QueuedConnection在socket线程中调用
+    Q_INVOKABLE void onTaskFinished(const SAProtocolHeader& header, const SA2DPointsDescribeResult& res);
+
+    //工作线程计算失败，由@ref SADataProcTaskChannel 以Qt::QueuedConnection在socket线程中调用
+    Q_INVOKABLE void onTaskFailed(const SAProtocolHeader& header, int errcode, const QString& msg);
+
 protected:
     //处理2维点描述
     virtual bool deal2DPointsDescribe(const SAProtocolHeader& header, const SAXMLProtocol& xml);
 
+    //处理2维点描述，点序列位于共享数据区
+    virtual bool deal2DPointsDescribeShm(const SAProtocolHeader& header, const SAXMLProtocol& xml);
+
+    //处理取消请求
+    virtual bool dealCancel(const SAProtocolHeader& header) override;
+
+private:
+    //检查是否还能接收新的请求，不能接收时会回复错误
+    bool checkInflight(const SAProtocolHeader& header);
+
+    //任务结束后的清理
+    void finishTask(int sequenceID);
+
 private:
-    //处理点序列的具体函数
-    bool _deal2DPointsDescribe(const SAProtocolHeader& header, const SAXMLProtocol& xml);
+    /**
+     * @brief 正在处理的请求
+     */
+    struct Task {
+        std::shared_ptr<std::atomic_bool> cancel;
+    };
+    std::shared_ptr<SAServeSharedBuffer> m_sharedBuffer;   ///< 共享数据区的映射，任务也持有
+    std::shared_ptr<SADataProcTaskChannel> m_channel;
+    QHash<int, Task> m_tasks;   ///< 以sequenceID为key
+    int m_maxInflight;
 };
 
 #endif // SADATAPROCSECTION_H
@@ -12,6 +12,8 @@
 #include <QHostInfo>
 #include "SAMiniDump.h"
 #include "SAServeShareMemory.h"
+#include "SAServeSharedBuffer.h"
+#include "SAServerDefine.h"
 #include "SACsvStream.h"
 void myMessageOutput(QtMsgType type, const QMessageLogContext& context, const QString& msg)
 {
@@ -73,6 +75,11 @@ int main(int argc, char *argv[])
         qDebug() << QStringLiteral("共享内存初始化失败，已经有服务进程在运行，本进程退出");
         return (1);
     }
+    //大数据交换用的共享数据区，服务进程在整个生命周期持有，保证客户端attach时一直存在
+    SAServeSharedBuffer sharedBuffer;
+    if (!sharedBuffer.isAttach()) {
+        qDebug() << sharedBuffer.describe();
+    }
     //初始化服务
     qDebug() << QStringLiteral("开始初始化服务句柄");
 
@@ -109,6 +116,9 @@ int main(int argc, char *argv[])
             break;
         }
     }while(!islisten && port < 65536);
+    //同机的客户端优先通过本地socket连接
+    bool islocal = serve.listenLocal(SA_SERVE_LOCAL_SERVER_NAME);
+    qDebug() << "listen local:" << SA_SERVE_LOCAL_SERVER_NAME << " " << islocal;
     //监听成功后写入端口
     qDebug() << QStringLiteral("服务器建立完成，服务器状态写入共享内存");
     if (islisten) {
@@ -117,6 +127,7 @@ int main(int argc, char *argv[])
         sharemem.setServeState(SAServeShareMemory::ServeNotReady);
     }
     sharemem.setPort(port);
+    sharemem.setLocalServeEnabled(islocal);
     qDebug() << QStringLiteral("服务器正常运行，时间：") << QDateTime::currentDateTime();
     return (a.exec());
 }
@@ -1,148 +1,148 @@
 #include "SADataStatisticRunable.h"
 #include "SADataProcSocket.h"
-#include "SAMath.h"
 #include "SAServerDefine.h"
-#include "SADataProcFunctions.h"
-
-/*
- * SADataStatisticRunable::SADataStatisticRunable(std::weak_ptr<SADataProcSocket> session, const SAProtocolHeader& header, SASocketHandle::XMLDataPtr xml)
- * {
- *  setDatas(session, header, xml);
- * }
- *
- *
- * void SADataStatisticRunable::setDatas(std::weak_ptr<SADataProcSocket> session, const SAProtocolHeader& header, SASocketHandle::XMLDataPtr xml)
- * {
- *  m_session = session;
- *  m_header = header;
- *  m_xml = xml;
- * }
- *
- *
- * void SADataStatisticRunable::setup2DPointsDescribe()
- * {
- *  m_step.enqueue(TwoDPointsDescribe);
- * }
- *
- *
- * void SADataStatisticRunable::run()
- * {
- *  do
- *  {
- *      RunFun fun = m_step.dequeue();
- *      switch (fun)
- *      {
- *      case TwoDPointsDescribe:
- *          run2DPointsDescribe();
- *          break;
- *
- *      default:
- *          break;
- *      }
- *  }while(m_step.size() > 0);
- * }
- *
- *
- * void SADataStatisticRunable::run2DPointsDescribe()
- * {
- *  //返回的结果
- *  SASocketHandle::XMLDataPtr res = createXMLDataPtr(SA::ProtocolFunReply2DPointsDescribe, m_xml);
- *
- *  if (SA::ProtocolFunReq2DPointsDescribe != m_xml->getFunctionID()) {
- *      res->setValue("result", 0);//标记结果异常
- *      write(res, SA::ProtocolFunReply2DPointsDescribe);
- *      return;
- *  }
- *  //获取points
- *  QVector<double> ys;
- *  QVector<QPointF> points;
- *
- *  {
- *      QVariant pv = m_xml->getDefaultGroupValue("points");
- *      points = pv.value<QVector<QPointF> >();
- *  }
- *  ys.reserve(points.size());
- *  for (const QPointF& p : points)
- *  {
- *      ys.append(p.y());
- *  }
- *  //获取排序数
- *  int sortcount = m_xml->getDefaultGroupValue("sort-count").toInt();
- *
- *  if ((sortcount < 0) || (sortcount > 1000)) {
- *      sortcount = 20;
- *  }
- *  //进行数据处理
- *  double sum;
- *  double mean;
- *  double var;
- *  double stdVar;
- *  double skewness;
- *  double kurtosis;
- *  int n = ys.size();
- *
- *  SA::get_statistics(ys.begin(), ys.end()
- *      , sum
- *      , mean
- *      , var
- *      , stdVar
- *      , skewness
- *      , kurtosis);
- *  std::sort(points.begin(), points.end()
- *      , [](const QPointF& a, const QPointF& b)->bool {
- *      return (a.y() < b.y());
- *  });
- *  double min = points.cbegin()->y();                              //最小
- *  double max = (points.cend()-1)->y();                            //最大
- *  double mid = n > 1 ? (points.cbegin() + int(n/2))->y() : min;   //中位数
- *  double peak2peak = max - min;
- *  QPointF minPoint = *points.cbegin();
- *  QPointF maxPoint = *(points.cend()-1);
- *  QPointF midPoint = n > 1 ? *(points.cbegin() + int(n/2)) : minPoint;//中位数
- *
- *  //把结果写入结果xml
- *  res->setValue("sum", sum);
- *  res->setValue("mean", mean);
- *  res->setValue("var", var);
- *  res->setValue("stdVar", stdVar);
- *  res->setValue("skewness", skewness);
- *  res->setValue("kurtosis", kurtosis);
- *  res->setValue("min", min);
- *  res->setValue("max", max);
- *  res->setValue("mid", mid);
- *  res->setValue("peak2peak", peak2peak);
- *  res->setValue("min-point", minPoint);
- *  res->setValue("max-point", maxPoint);
- *  res->setValue("mid-point", midPoint);
- *  int sortedcount = sortcount < n ? sortcount : n;
- *  QVector<QPointF> tops(sortedcount);
- *  QVector<QPointF> lows(sortedcount);
- *
- *  //拷贝tops
- *  std::copy(points.rbegin(), points.rbegin()+sortedcount, tops.begin());
- *  //拷贝lows
- *  std::copy(points.begin(), points.begin()+sortedcount, lows.begin());
- *  res->setValue("sorted-lows", QVariant::fromValue(tops));
- *  res->setValue("sorted-lows", QVariant::fromValue(lows));
- *  write(res, SA::ProtocolFunReply2DPointsDescribe);
- * }
- */
+#include "SAServeHandleFun.h"
+#include "SAServeSharedBuffer.h"
+#include <QMetaObject>
+#include <QCoreApplication>
+
+SADataProcTaskChannel::SADataProcTaskChannel(SADataProcSocket *socket) : m_socket(socket)
+{
+}
+
+
+void SADataProcTaskChannel::close()
+{
+    QMutexLocker locker(&m_mutex);
+
+    m_socket = nullptr;
+}
+
 
 /**
- * @brief 发送答复结果
- * @param xml
- * @param funid
+ * @brief 把计算结果投递回socket所在线程
+ * @param header 请求的协议头
+ * @param res 计算结果
  */
+void SADataProcTaskChannel::post(const SAProtocolHeader& header, const SA2DPointsDescribeResult& res)
+{
+    QMutexLocker locker(&m_mutex);
 
-/*
- * void SADataStatisticRunable::write(SASocketHandle::XMLDataPtr xml, int funid)
- * {
- *  QByteArray data = xml->toByteArray();
- *  SAProtocolHeader header = createXMLReplyHeader(m_header, data, funid);
- *  std::shared_ptr<SADataProcSocket> ptr = m_session.lock();
- *
- *  if (ptr) {
- *      ptr->ensureWrite(header, data);
- *  }
- * }
+    if (nullptr == m_socket) {
+        return;
+    }
+    QMetaObject::invokeMethod(m_socket, "onTaskFinished", Qt::QueuedConnection
+        , Q_ARG(SAProtocolHeader, header)
+        , Q_ARG(SA2DPointsDescribeResult, res));
+}
+
+
+/**
+ * @brief 把错误投递回socket所在线程
+ * @param header 请求的协议头
+ * @param errcode 错误码 \sa SA::ServeProtocolErrorCode
+ * @param msg 错误信息
  */
+void SADataProcTaskChannel::postError(const SAProtocolHeader& header, int errcode, const QString& msg)
+{
+    QMutexLocker locker(&m_mutex);
+
+    if (nullptr == m_socket) {
+        return;
+    }
+    QMetaObject::invokeMethod(m_socket, "onTaskFailed", Qt::QueuedConnection
+        , Q_ARG(SAProtocolHeader, header)
+        , Q_ARG(int, errcode)
+        , Q_ARG(QString, msg));
+}
+
+
+SADataStatisticRunable::SADataStatisticRunable(std::shared_ptr<SADataProcTaskChannel> channel
+    , const SAProtocolHeader& header
+    , const SAXMLProtocol& xml
+    , CancelFlag cancel)
+    : m_channel(channel)
+    , m_header(header)
+    , m_xml(xml)
+    , m_sortcount(20)
+    , m_cancel(cancel)
+{
+    setAutoDelete(true);
+}
+
+
+SADataStatisticRunable::SADataStatisticRunable(std::shared_ptr<SADataProcTaskChannel> channel
+    , const SAProtocolHeader& header
+    , std::shared_ptr<SAServeSharedBuffer> buffer
+    , const SAServeSharedBufferHandle& shm
+    , int sortcount
+    , CancelFlag cancel)
+    : m_channel(channel)
+    , m_header(header)
+    , m_buffer(buffer)
+    , m_shm(shm)
+    , m_sortcount(sortcount)
+    , m_cancel(cancel)
+{
+    setAutoDelete(true);
+}
+
+
+void SADataStatisticRunable::run()
+{
+    describe();
+    //计算结束后才归还共享数据区的引用，之后槽可以被对方复用，单独的段可以被解除映射
+    if (m_shm.isValid() && m_buffer) {
+        m_buffer->release(m_shm);
+    }
+}
+
+
+void SADataStatisticRunable::describe()
+{
+    SA2DPointsDescribeResult res;
+
+    if (isCanceled()) {
+        m_channel->postError(m_header, SA::ProtocolErrorCanceled, QCoreApplication::translate("SADataStatisticRunable", "request canceled"));
+        return;
+    }
+    QVector<QPointF> points;
+    const QPointF *p = nullptr;
+    int n = 0;
+
+    if (m_shm.isValid()) {
+        p = static_cast<const QPointF *>(m_buffer->constData(m_shm));
+        n = int(m_shm.elementCount());
+        if (nullptr == p) {
+            m_channel->postError(m_header, SA::ProtocolErrorSharedBuffer, QCoreApplication::translate("SADataStatisticRunable", "invalid shared buffer handle"));
+            return;
+        }
+    }else {
+        //xml协议的点序列在工作线程解析
+        if (!SA::receive_request_2d_points_describe_xml(&m_xml, points, m_sortcount)) {
+            m_channel->postError(m_header, SA::ProtocolErrorContent, QCoreApplication::translate("SADataStatisticRunable", "xml content error"));
+            return;
+        }
+        p = points.constData();
+        n = points.size();
+    }
+    if (!describe_2d_points(p, n, m_sortcount, res, m_cancel.get())) {
+        if (isCanceled()) {
+            m_channel->postError(m_header, SA::ProtocolErrorCanceled, QCoreApplication::translate("SADataStatisticRunable", "request canceled"));
+        }else {
+            m_channel->postError(m_header, SA::ProtocolErrorContent, QCoreApplication::translate("SADataStatisticRunable", "empty points"));
+        }
+        return;
+    }
+    if (isCanceled()) {
+        m_channel->postError(m_header, SA::ProtocolErrorCanceled, QCoreApplication::translate("SADataStatisticRunable", "request canceled"));
+        return;
+    }
+    m_channel->post(m_header, res);
+}
+
+
+bool SADataStatisticRunable::isCanceled() const
+{
+    return (m_cancel && m_cancel->load());
+}
@@ -1,39 +1,79 @@
 #ifndef SADATASTATISTICRUNABLE_H
 #define SADATASTATISTICRUNABLE_H
 #include <QRunnable>
-#include <QQueue>
+#include <QMutex>
+#include <QPointF>
+#include <atomic>
 #include <memory>
 #include "SAProtocolHeader.h"
+#include "SAXMLProtocol.h"
+#include "SADataProcFunctions.h"
+#include "SAServeSharedBuffer.h"
 class SADataProcSocket;
 
 /**
- * @brief 数据分析用的runable
- * 此runable设计成一种链式计算，一开始需要制定计算的内容，通过各种setup打头的函数，建立计算步骤和计算参数，
+ * @brief socket和工作线程之间的通道
+ *
+ * 工作线程只能通过通道把结果投递回socket所在线程，socket析构时会先关闭通道，
+ * 此时工作线程的结果直接丢弃，避免向已经销毁的socket投递事件
  */
-/*
- * class SADataStatisticRunable : public QRunnable
- * {
- * public:
- *  SADataStatisticRunable(std::weak_ptr<SADataProcSocket> session,
- *                         const SAProtocolHeader &header,
- *                         SASocketHandle::XMLDataPtr xml);
- *  //设置值
- *  void setDatas(std::weak_ptr<SADataProcSocket> session,const SAProtocolHeader &header,SASocketHandle::XMLDataPtr xml);
- *  //2维点的数据描述，计算和、均值、方程等，同时包含最大最小值
- *  void setup2DPointsDescribe();
- * public:
- *  void run() override;
- * protected:
- *   void run2DPointsDescribe();
- *   void write(SASocketHandle::XMLDataPtr xml, int funid);
- * private:
- *  enum RunFun{
- *      TwoDPointsDescribe ///< 对应setup2DPointsDescribe
- *  };
- *  QQueue<RunFun> m_step;
- *  std::weak_ptr<SADataProcSocket> m_session;
- *  SAProtocolHeader m_header;
- *  SASocketHandle::XMLDataPtr m_xml;
- * };
+class SADataProcTaskChannel
+{
+public:
+    SADataProcTaskChannel(SADataProcSocket *socket);
+    //关闭通道，socket析构时调用
+    void close();
+
+    //把计算结果投递回socket所在线程
+    void post(const SAProtocolHeader& header, const SA2DPointsDescribeResult& res);
+
+    //把错误投递回socket所在线程
+    void postError(const SAProtocolHeader& header, int errcode, const QString& msg);
+
+private:
+    QMutex m_mutex;
+    SADataProcSocket *m_socket;
+};
+
+/**
+ * @brief 数据分析用的runable
+ *
+ * 在QThreadPool的工作线程中完成xml解析和统计计算，结果通过@ref SADataProcTaskChannel 回到socket线程写出，
+ * 因此回复是按照完成顺序写出的，客户端通过sequenceID进行匹配
+ *
+ * 取消标记会传入@ref describe_2d_points ，计算过程中分段检查，被取消的任务尽快结束并回复ProtocolErrorCanceled
  */
+class SADataStatisticRunable : public QRunnable
+{
+public:
+    typedef std::shared_ptr<std::atomic_bool> CancelFlag;
+    //点序列位于xml协议中
+    SADataStatisticRunable(std::shared_ptr<SADataProcTaskChannel> channel
+        , const SAProtocolHeader& header
+        , const SAXMLProtocol& xml
+        , CancelFlag cancel);
+    //点序列位于共享数据区，shm为已经retain的句柄，引用的所有权转移给任务，在run结束时release
+    SADataStatisticRunable(std::shared_ptr<SADataProcTaskChannel> channel
+        , const SAProtocolHeader& header
+        , std::shared_ptr<SAServeSharedBuffer> buffer
+        , const SAServeSharedBufferHandle& shm
+        , int sortcount
+        , CancelFlag cancel);
+    void run() override;
+
+private:
+    //计算并投递结果
+    void describe();
+    bool isCanceled() const;
+
+private:
+    std::shared_ptr<SADataProcTaskChannel> m_channel;
+    SAProtocolHeader m_header;
+    SAXMLProtocol m_xml;
+    std::shared_ptr<SAServeSharedBuffer> m_buffer;
+    SAServeSharedBufferHandle m_shm;  ///< 任务持有引用的共享数据区，无效代表点序列位于xml中
+    int m_sortcount;
+    CancelFlag m_cancel;
+};
+
 #endif // SADATASTATISTICRUNABLE_H
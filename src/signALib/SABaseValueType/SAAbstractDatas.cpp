@@ -7,11 +7,13 @@
 #include <QDebug>
 
 SAAbstractDatas::SAAbstractDatas():SAItem()
+  ,m_revision(0)
 {
 
 }
 
 SAAbstractDatas::SAAbstractDatas(const QString &text):SAItem(text)
+  ,m_revision(0)
 {
 
 }
@@ -67,6 +69,38 @@ QString SAAbstractDatas::displayAt(size_t dim1, size_t dim2) const
     return displayAt({dim1,dim2});
 }
 ///
+/// \brief 批量获取用于显示的内容
+///
+/// 用于表格一次性格式化一段数据，默认逐个调用displayAt，连续存放的数据可以重载以避免逐个虚函数调用
+/// \param row 开始的行，0维数据只有第0行
+/// \param col 列，1维数据忽略
+/// \param count 最多获取的个数
+/// \param out 输出，长度至少为count
+/// \return 实际写入的个数
+///
+int SAAbstractDatas::displayRange(size_t row, size_t col, int count, QString *out) const
+{
+    const int dim = getDim();
+    const int rows = (SA::Dim0 == dim) ? 1 : getSize(SA::Dim1);
+    const int n = qBound(0,rows - static_cast<int>(row),count);
+    for(int i=0;i<n;++i)
+    {
+        switch(dim)
+        {
+        case SA::Dim0:
+            out[i] = displayAt(row);
+            break;
+        case SA::Dim1:
+            out[i] = displayAt(row+i);
+            break;
+        default:
+            out[i] = displayAt(row+i,col);
+            break;
+        }
+    }
+    return n;
+}
+///
 /// \brief 用于编辑，默认SAAbstractDatas返回false不接受编辑
 /// \param val 需要设置的值
 /// \param index 索引序列
@@ -81,6 +115,22 @@ bool SAAbstractDatas::setAt(const QVariant &val, const std::initializer_list<siz
 
 
 
+///
+/// \brief 修改计数
+///
+/// 只保证数据变更后计数和之前不同，修改后没有调用setDirty(true)的数据（如直接修改getValueDatas的引用）计数不变
+/// \return
+///
+unsigned int SAAbstractDatas::getRevision() const
+{
+    return m_revision;
+}
+
+void SAAbstractDatas::increaseRevision()
+{
+    ++m_revision;
+}
+
 void SAAbstractDatas::read(QDataStream &in)
 {
     QIcon icon;
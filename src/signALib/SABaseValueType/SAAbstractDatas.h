@@ -70,6 +70,9 @@ public:
     //用于显示,相当于displayAt({dim1,dim2});适用2维表数据
     QString displayAt(size_t dim1, size_t dim2) const;
 
+    //批量获取用于显示的内容，从第row行开始取count行第col列的内容写入out，返回实际写入的个数
+    virtual int displayRange(size_t row, size_t col, int count, QString* out) const;
+
     //用于编辑-返回true设置成功，返回false设置失败，默认SAAbstractDatas返回false不接受编辑
     virtual bool setAt(const QVariant& val, const std::initializer_list<size_t>& index);
 
@@ -86,6 +89,16 @@ public:
 
     //设置内存有变更
     virtual void setDirty(bool dirty) = 0;
+
+    //修改计数，数据每次标记为有变更时增加，派生数据据此判断源数据是否变化
+    virtual unsigned int getRevision() const;
+
+protected:
+    //增加修改计数，子类在setDirty(true)时调用
+    void increaseRevision();
+
+private:
+    unsigned int m_revision;
 };
 
 #endif // SAABSTRACTDATAS
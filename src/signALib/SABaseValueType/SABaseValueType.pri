@@ -7,6 +7,7 @@ HEADERS += \
     $$PWD/SAVectorDatas.h \
     $$PWD/SAVectorInt.h \
     $$PWD/SAVectorDouble.h \
+    $$PWD/SAVectorExpression.h \
     $$PWD/SAVectorVariant.h \
     $$PWD/SAVectorInterval.h \
     $$PWD/SAVectorPointF.h \
@@ -23,6 +24,7 @@ SOURCES += \
     $$PWD/SAAbstractDatas.cpp \
     $$PWD/SAVectorInt.cpp \
     $$PWD/SAVectorDouble.cpp \
+    $$PWD/SAVectorExpression.cpp \
     $$PWD/SAVectorVariant.cpp \
     $$PWD/SAVectorInterval.cpp \
     $$PWD/SAVectorPointF.cpp \
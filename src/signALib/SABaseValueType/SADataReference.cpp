@@ -82,6 +82,13 @@ void SADataReference::setDirty(bool dirty)
         m_linkData->setDirty (dirty);
 }
 
+unsigned int SADataReference::getRevision() const
+{
+    if(m_linkData)
+        return m_linkData->getRevision ();
+    return SAAbstractDatas::getRevision ();
+}
+
 bool SADataReference::isEmpty() const
 {
     if(m_linkData)
@@ -24,6 +24,7 @@ public:
     virtual void write(QDataStream & out) const;
     virtual bool isDirty() const;
     virtual void setDirty(bool dirty);
+    virtual unsigned int getRevision() const;
     virtual bool isEmpty() const;
 public:
     void disLink();
@@ -124,6 +124,10 @@ template<typename DATA_TYPE>
 void SASingleDatas<DATA_TYPE>::setDirty(bool dirty)
 {
     m_isDirty = dirty;
+    if(dirty)
+    {
+        this->increaseRevision();
+    }
 }
 
 template<typename DATA_TYPE>
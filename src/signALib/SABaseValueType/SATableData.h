@@ -257,6 +257,10 @@ template<typename T>
 void SATableData<T>::setDirty(bool dirty)
 {
     m_isDirty = dirty;
+    if(dirty)
+    {
+        this->increaseRevision();
+    }
 }
 template<typename T>
 bool SATableData<T>::isEmpty() const
@@ -196,6 +196,10 @@ template<typename T>
 void SAVectorDatas<T>::setDirty(bool dirty)
 {
     m_isDirty = dirty;
+    if(dirty)
+    {
+        this->increaseRevision();
+    }
 }
 template<typename T>
 bool SAVectorDatas<T>::isEmpty() const
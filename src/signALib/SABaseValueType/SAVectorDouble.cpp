@@ -2,6 +2,7 @@
 #include "SADataHeader.h"
 #include <memory>
 #include "SAValueManager.h"
+#include "SAVectorExpression.h"
 
 ///
 /// \brief 转换为double vector
@@ -69,6 +70,28 @@ void SAVectorDouble::write(QDataStream &out) const
     out << getValueDatas();
 }
 ///
+/// \brief 批量获取用于显示的内容，格式和displayAt一致
+/// \param row
+/// \param col 只有第0列
+/// \param count
+/// \param out
+/// \return 实际写入的个数
+///
+int SAVectorDouble::displayRange(size_t row, size_t col, int count, QString *out) const
+{
+    if(0 != col)
+    {
+        return 0;
+    }
+    const int n = qBound(0,m_datas.size() - static_cast<int>(row),count);
+    const double* p = m_datas.constData() + row;
+    for(int i=0;i<n;++i)
+    {
+        out[i] = QVariant(p[i]).toString();
+    }
+    return n;
+}
+///
 /// \brief 转换为double数组
 /// \param ptr SAAbstractDatas指针
 /// \param res 结果
@@ -98,6 +121,13 @@ bool SAVectorDouble::toDoubleVector(const SAAbstractDatas *ptr, QVector<double>
         }
         return true;
     }
+    const SAVectorExpression* expVector = dynamic_cast <const SAVectorExpression*>(ptr);
+    if(expVector)
+    {
+        //表达式直接按块计算，不逐点调用getAt
+        expVector->getValues(data);
+        return true;
+    }
 
     //处理其它情况
     bool isSuccess = false;
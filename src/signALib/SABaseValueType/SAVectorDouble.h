@@ -19,6 +19,8 @@ public:
     virtual int getSize(int dim=SA::Dim1) const;
     virtual QString getTypeName() const{return QString("double Vector");}
     virtual void write(QDataStream & out) const;
+    //批量获取用于显示的内容
+    virtual int displayRange(size_t row, size_t col, int count, QString* out) const;
     //转换为double数组
     static bool toDoubleVector(const SAAbstractDatas* ptr,QVector<double>& data);
 };
@@ -0,0 +1,564 @@
+#include "SAVectorExpression.h"
+#include "SAVectorDouble.h"
+#include "SAVectorInt.h"
+#include "SAVectorPointF.h"
+#include <QHash>
+#include <algorithm>
+#include <limits>
+
+///
+/// \brief 表达式图的节点，构造后不再修改，可以被多个表达式共享
+///
+class SAVectorExpressionNode
+{
+public:
+    enum Kind
+    {
+        Vector///< 一维源数据
+        ,Scalar///< 0维源数据，参与运算时作为标量
+        ,Binary///< 二元运算
+        ,Diff///< n阶差分
+    };
+    SAVectorExpressionNode(Kind k):kind(k),op(SAVectorKernel::Add),n(0)
+    {
+
+    }
+    Kind kind;
+    std::shared_ptr<SAAbstractDatas> data;///< Vector、Scalar的源数据，点序列作为Vector时取y值
+    SAVectorExpression::Operator op;///< Binary的运算
+    unsigned int n;///< Diff的阶次
+    SAVectorExpression::NodePtr a;
+    SAVectorExpression::NodePtr b;
+};
+
+///
+/// \brief 一次计算的上下文，记录叶子数据的地址和中间节点的块缓存
+///
+/// 每次计算单独构造，计算过程不修改表达式，因此同一个表达式可以同时在多个线程中计算
+///
+class SAVectorExpressionContext
+{
+public:
+    SAVectorExpressionContext(const SAVectorExpressionNode* root,int bufferSize)
+        :m_bufferSize(bufferSize)
+    {
+        prepare(root);
+    }
+    SAVectorKernel::Span vector(const SAVectorExpressionNode* node) const
+    {
+        return m_vector.value(node);
+    }
+    SAVectorKernel::Span scalar(const SAVectorExpressionNode* node) const
+    {
+        return SAVectorKernel::scalar(&(m_scalar.constFind(node).value()));
+    }
+    double* buffer(const SAVectorExpressionNode* node)
+    {
+        return m_buffer[node].data();
+    }
+private:
+    void prepare(const SAVectorExpressionNode* node)
+    {
+        switch(node->kind)
+        {
+        case SAVectorExpressionNode::Vector:
+        {
+            if(m_vector.contains(node))
+            {
+                return;
+            }
+            //double数组和点序列的y直接使用源数据的内存，其它数组转换一次
+            const SAVectorDouble* vd = dynamic_cast<const SAVectorDouble*>(node->data.get());
+            if(vd)
+            {
+                m_vector[node] = SAVectorKernel::Span(vd->getValueDatas().constData());
+                return;
+            }
+            const SAVectorPointF* vp = dynamic_cast<const SAVectorPointF*>(node->data.get());
+            if(vp)
+            {
+                m_vector[node] = SAVectorKernel::yChannel(vp->getValueDatas().constData());
+                return;
+            }
+            QVector<double> v;
+            if(!SAVectorDouble::toDoubleVector(node->data.get(),v))
+            {
+                v.fill(std::numeric_limits<double>::quiet_NaN(),node->data->getSize(SA::Dim1));
+            }
+            m_converted.append(v);
+            m_vector[node] = SAVectorKernel::Span(m_converted.last().constData());
+            return;
+        }
+        case SAVectorExpressionNode::Scalar:
+        {
+            bool isOK = false;
+            double v = node->data->getAt(0).toDouble(&isOK);
+            m_scalar[node] = isOK ? v : std::numeric_limits<double>::quiet_NaN();
+            return;
+        }
+        default:
+            break;
+        }
+        if(!m_buffer.contains(node))
+        {
+            m_buffer[node].resize(m_bufferSize);
+        }
+        if(node->a)
+        {
+            prepare(node->a.get());
+        }
+        if(node->b)
+        {
+            prepare(node->b.get());
+        }
+    }
+private:
+    int m_bufferSize;
+    QHash<const SAVectorExpressionNode*,SAVectorKernel::Span> m_vector;
+    QHash<const SAVectorExpressionNode*,double> m_scalar;///< 构造后不再插入，值的地址不变
+    QHash<const SAVectorExpressionNode*,QVector<double> > m_buffer;
+    QList<QVector<double> > m_converted;
+};
+
+static SAVectorExpression::NodePtr make_leaf(const std::shared_ptr<SAAbstractDatas>& d);
+static int node_size(const SAVectorExpressionNode* node);
+static int node_halo(const SAVectorExpressionNode* node);
+static QString node_string(const SAVectorExpressionNode* node);
+static void collect_sources(const SAVectorExpressionNode* node,QList<std::shared_ptr<SAAbstractDatas> >& sources);
+static SAVectorKernel::Span eval_block(const SAVectorExpressionNode* node,int start,int count,SAVectorExpressionContext& ctx);
+
+///
+/// \brief 构造二元运算
+/// \param op 运算
+/// \param a 可以是一维数据、点序列、0维数据或另一个表达式
+/// \param b 可以是一维数据、点序列、0维数据或另一个表达式
+/// \return 两个都是0维数据、序列长度不一致或数据无法转换为double时返回nullptr
+///
+std::shared_ptr<SAVectorExpression> SAVectorExpression::makeBinary(SAVectorExpression::Operator op
+                                                                   , const std::shared_ptr<SAAbstractDatas> &a
+                                                                   , const std::shared_ptr<SAAbstractDatas> &b)
+{
+    NodePtr na = make_leaf(a);
+    NodePtr nb = make_leaf(b);
+    if(nullptr == na || nullptr == nb)
+    {
+        return nullptr;
+    }
+    const int sa = node_size(na.get());
+    const int sb = node_size(nb.get());
+    if((sa < 0 && sb < 0) || (sa >= 0 && sb >= 0 && sa != sb))
+    {
+        return nullptr;
+    }
+    std::shared_ptr<SAVectorExpressionNode> node = std::make_shared<SAVectorExpressionNode>(SAVectorExpressionNode::Binary);
+    node->op = op;
+    node->a = na;
+    node->b = nb;
+    return std::make_shared<SAVectorExpression>(QString("tmp_double_transform"),node);
+}
+///
+/// \brief 构造n阶差分，结果长度为源数据长度-n
+/// \param a 一维数据、点序列或另一个表达式
+/// \param n 阶次
+/// \return 数据不是一维或无法转换为double时返回nullptr
+///
+std::shared_ptr<SAVectorExpression> SAVectorExpression::makeDiff(const std::shared_ptr<SAAbstractDatas> &a, unsigned int n)
+{
+    NodePtr na = make_leaf(a);
+    if(nullptr == na || node_size(na.get()) < 0)
+    {
+        return nullptr;
+    }
+    std::shared_ptr<SAVectorExpressionNode> node = std::make_shared<SAVectorExpressionNode>(SAVectorExpressionNode::Diff);
+    node->n = n;
+    node->a = na;
+    return std::make_shared<SAVectorExpression>(QString("%1_diff%2").arg(a->getName()).arg(n),node);
+}
+
+SAVectorExpression::SAVectorExpression(const QString &name, SAVectorExpression::NodePtr root)
+    :SAAbstractDatas(name)
+    ,m_root(root)
+    ,m_cacheRevision(0)
+    ,m_hasCache(false)
+    ,m_writeRevision(0)
+    ,m_isDirty(true)
+{
+    setProperty(SA::VectorExpression,SA_ROLE_DATA_TYPE);
+    if(m_root)
+    {
+        collect_sources(m_root.get(),m_sources);
+    }
+}
+
+SAVectorExpression::~SAVectorExpression()
+{
+
+}
+
+int SAVectorExpression::getSize(int dim) const
+{
+    if(SA::Dim1 == dim)
+    {
+        return m_root ? qMax(0,node_size(m_root.get())) : 0;
+    }
+    else if(SA::Dim2 == dim)
+    {
+        return 1;
+    }
+    return 0;
+}
+
+int SAVectorExpression::getDim() const
+{
+    return SA::Dim1;
+}
+///
+/// \brief 获取值，会物化结果
+/// \param index
+/// \return
+///
+QVariant SAVectorExpression::getAt(const std::initializer_list<size_t> &index) const
+{
+    if(0 == index.size())
+    {
+        return QVariant();
+    }
+    for(auto i=(index.begin()+1);i!=index.end();++i)
+    {
+        if(0 != (*i))
+        {
+            return QVariant();
+        }
+    }
+    const QVector<double>& v = materialize();
+    const size_t row = *index.begin();
+    if(row >= static_cast<size_t>(v.size()))
+    {
+        return QVariant();
+    }
+    return QVariant(v[static_cast<int>(row)]);
+}
+
+QString SAVectorExpression::displayAt(const std::initializer_list<size_t> &index) const
+{
+    return getAt(index).toString();
+}
+///
+/// \brief 批量获取用于显示的内容，格式和displayAt一致，会物化结果
+/// \param row
+/// \param col 只有第0列
+/// \param count
+/// \param out
+/// \return 实际写入的个数
+///
+int SAVectorExpression::displayRange(size_t row, size_t col, int count, QString *out) const
+{
+    if(0 != col)
+    {
+        return 0;
+    }
+    const QVector<double>& v = materialize();
+    const int n = qBound(0,v.size() - static_cast<int>(row),count);
+    const double* p = v.constData() + row;
+    for(int i=0;i<n;++i)
+    {
+        out[i] = QVariant(p[i]).toString();
+    }
+    return n;
+}
+
+bool SAVectorExpression::isEmpty() const
+{
+    return (0 == getSize(SA::Dim1));
+}
+///
+/// \brief 物化后按\sa SAVectorDouble 的格式写入，读取时为普通数组
+/// \param out
+///
+void SAVectorExpression::write(QDataStream &out) const
+{
+    SAVectorDouble d(getName(),materialize());
+    d.write(out);
+    m_writeRevision = getRevision();
+}
+///
+/// \brief 上次写入后自身或源数据有变更时返回true
+/// \return
+///
+bool SAVectorExpression::isDirty() const
+{
+    return (m_isDirty || m_writeRevision != getRevision());
+}
+
+void SAVectorExpression::setDirty(bool dirty)
+{
+    m_isDirty = dirty;
+    if(!dirty)
+    {
+        m_writeRevision = getRevision();
+    }
+}
+///
+/// \brief 修改计数为所有源数据修改计数之和，任意源数据变化后都会不同
+/// \return
+///
+unsigned int SAVectorExpression::getRevision() const
+{
+    unsigned int r = 0;
+    for(const std::shared_ptr<SAAbstractDatas>& d : m_sources)
+    {
+        r += d->getRevision();
+    }
+    return r;
+}
+
+SAVectorExpression::NodePtr SAVectorExpression::root() const
+{
+    return m_root;
+}
+///
+/// \brief 表达式的文本，如(a-b)*c
+/// \return
+///
+QString SAVectorExpression::expressionString() const
+{
+    return m_root ? node_string(m_root.get()) : QString();
+}
+///
+/// \brief 获取计算结果
+///
+/// 已物化时直接复制缓存（隐式共享），否则按块单遍计算，不修改缓存
+/// \param values
+///
+void SAVectorExpression::getValues(QVector<double> &values) const
+{
+    if(isMaterialized())
+    {
+        values = m_cache;
+        return;
+    }
+    const int size = getSize(SA::Dim1);
+    values.resize(size);
+    if(size <= 0)
+    {
+        return;
+    }
+    SAVectorExpressionContext ctx(m_root.get(),SA_EXPRESSION_BLOCK_SIZE + node_halo(m_root.get()));
+    double* p = values.data();
+    for(int start=0;start<size;start+=SA_EXPRESSION_BLOCK_SIZE)
+    {
+        const int count = qMin(SA_EXPRESSION_BLOCK_SIZE,size - start);
+        const SAVectorKernel::Span r = eval_block(m_root.get(),start,count,ctx);
+        std::copy(r.data,r.data+count,p+start);
+    }
+}
+///
+/// \brief 物化，计算结果缓存到源数据变化为止
+/// \return
+///
+const QVector<double> &SAVectorExpression::materialize() const
+{
+    if(!isMaterialized())
+    {
+        m_hasCache = false;
+        getValues(m_cache);
+        m_cacheRevision = getRevision();
+        m_hasCache = true;
+    }
+    return m_cache;
+}
+
+bool SAVectorExpression::isMaterialized() const
+{
+    return (m_hasCache && m_cacheRevision == getRevision());
+}
+
+void SAVectorExpression::releaseCache()
+{
+    m_cache = QVector<double>();
+    m_hasCache = false;
+}
+
+///
+/// \brief 由数据生成表达式的叶子，表达式直接使用其表达式图
+/// \param d
+/// \return 不支持的数据返回nullptr
+///
+static SAVectorExpression::NodePtr make_leaf(const std::shared_ptr<SAAbstractDatas>& d)
+{
+    if(nullptr == d)
+    {
+        return nullptr;
+    }
+    const SAVectorExpression* exp = dynamic_cast<const SAVectorExpression*>(d.get());
+    if(exp)
+    {
+        return exp->root();
+    }
+    if(SA::Dim0 == d->getDim())
+    {
+        bool isOK = false;
+        d->getAt(0).toDouble(&isOK);
+        if(!isOK)
+        {
+            return nullptr;
+        }
+        std::shared_ptr<SAVectorExpressionNode> node = std::make_shared<SAVectorExpressionNode>(SAVectorExpressionNode::Scalar);
+        node->data = d;
+        return node;
+    }
+    std::shared_ptr<SAVectorExpressionNode> node = std::make_shared<SAVectorExpressionNode>(SAVectorExpressionNode::Vector);
+    node->data = d;
+    if(dynamic_cast<const SAVectorPointF*>(d.get()))
+    {
+        return node;
+    }
+    if(SA::Dim1 != d->getDim())
+    {
+        return nullptr;
+    }
+    if(nullptr == dynamic_cast<const SAVectorDouble*>(d.get())
+            && nullptr == dynamic_cast<const SAVectorInt*>(d.get()))
+    {
+        QVector<double> tmp;
+        if(!SAVectorDouble::toDoubleVector(d.get(),tmp))
+        {
+            return nullptr;
+        }
+    }
+    return node;
+}
+///
+/// \brief 节点的长度
+/// \return 标量返回-1
+///
+static int node_size(const SAVectorExpressionNode* node)
+{
+    switch(node->kind)
+    {
+    case SAVectorExpressionNode::Vector:
+        return node->data->getSize(SA::Dim1);
+    case SAVectorExpressionNode::Binary:
+    {
+        const int sa = node_size(node->a.get());
+        const int sb = node_size(node->b.get());
+        if(sa < 0)
+        {
+            return sb;
+        }
+        if(sb < 0)
+        {
+            return sa;
+        }
+        //源数据构造后可能改变长度，取较短的
+        return qMin(sa,sb);
+    }
+    case SAVectorExpressionNode::Diff:
+        return qMax(0,node_size(node->a.get()) - static_cast<int>(node->n));
+    default:
+        break;
+    }
+    return -1;
+}
+///
+/// \brief 计算一块结果时节点需要多算的长度，即下游所有差分的阶次之和
+///
+static int node_halo(const SAVectorExpressionNode* node)
+{
+    switch(node->kind)
+    {
+    case SAVectorExpressionNode::Binary:
+        return qMax(node_halo(node->a.get()),node_halo(node->b.get()));
+    case SAVectorExpressionNode::Diff:
+        return static_cast<int>(node->n) + node_halo(node->a.get());
+    default:
+        break;
+    }
+    return 0;
+}
+
+static QString node_string(const SAVectorExpressionNode* node)
+{
+    switch(node->kind)
+    {
+    case SAVectorExpressionNode::Binary:
+    {
+        static const char* s_op[] = {"+","-","*","/"};
+        return QString("(%1%2%3)").arg(node_string(node->a.get())).arg(s_op[node->op]).arg(node_string(node->b.get()));
+    }
+    case SAVectorExpressionNode::Diff:
+        return QString("diff(%1,%2)").arg(node_string(node->a.get())).arg(node->n);
+    default:
+        break;
+    }
+    return node->data->getName();
+}
+
+static void collect_sources(const SAVectorExpressionNode* node,QList<std::shared_ptr<SAAbstractDatas> >& sources)
+{
+    if(node->data)
+    {
+        if(!sources.contains(node->data))
+        {
+            sources.append(node->data);
+        }
+        return;
+    }
+    if(node->a)
+    {
+        collect_sources(node->a.get(),sources);
+    }
+    if(node->b)
+    {
+        collect_sources(node->b.get(),sources);
+    }
+}
+
+///
+/// \brief 计算节点在[start,start+count)的结果
+///
+/// 同一块内节点可能被计算多次（共享的子表达式），每次的起点相同，结果一致
+/// \return 结果的序列，源数据直接返回其内存，中间节点返回其块缓存
+///
+static SAVectorKernel::Span eval_block(const SAVectorExpressionNode* node,int start,int count,SAVectorExpressionContext& ctx)
+{
+    switch(node->kind)
+    {
+    case SAVectorExpressionNode::Vector:
+    {
+        const SAVectorKernel::Span v = ctx.vector(node);
+        return SAVectorKernel::Span(v.data + start * v.stride,v.stride);
+    }
+    case SAVectorExpressionNode::Scalar:
+        return ctx.scalar(node);
+    case SAVectorExpressionNode::Binary:
+    {
+        const SAVectorKernel::Span a = eval_block(node->a.get(),start,count,ctx);
+        const SAVectorKernel::Span b = eval_block(node->b.get(),start,count,ctx);
+        double* out = ctx.buffer(node);
+        SAVectorKernel::binary(node->op,a,b,out,1,count);
+        return SAVectorKernel::Span(out);
+    }
+    case SAVectorExpressionNode::Diff:
+    {
+        //n阶差分的count个结果需要输入的count+n个值
+        const int len = count + static_cast<int>(node->n);
+        const SAVectorKernel::Span in = eval_block(node->a.get(),start,len,ctx);
+        double* out = ctx.buffer(node);
+        for(int i=0;i<len;++i)
+        {
+            out[i] = in.data[i*in.stride];
+        }
+        for(unsigned int k=0;k<node->n;++k)
+        {
+            const int m = len - 1 - static_cast<int>(k);
+            //out[i] = out[i+1] - out[i]，输出不超前于输入，可以原地计算
+            SAVectorKernel::binary(SAVectorKernel::Subtract,SAVectorKernel::Span(out+1),SAVectorKernel::Span(out),out,1,m);
+        }
+        return SAVectorKernel::Span(out);
+    }
+    default:
+        break;
+    }
+    return SAVectorKernel::Span();
+}
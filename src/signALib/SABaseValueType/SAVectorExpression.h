@@ -0,0 +1,81 @@
+#ifndef SAVECTOREXPRESSION_H
+#define SAVECTOREXPRESSION_H
+#include "SAAbstractDatas.h"
+#include "SAVectorKernel.h"
+#include <QVector>
+#include <memory>
+class SAVectorExpressionNode;
+
+///
+/// \def 表达式分块计算的块长度，每个中间节点只占用一块的缓存
+///
+#ifndef SA_EXPRESSION_BLOCK_SIZE
+#define SA_EXPRESSION_BLOCK_SIZE 1024
+#endif
+
+///
+/// \brief 延迟计算的派生数组
+///
+/// 记录以源数据为叶子的表达式图（四则运算和差分），而不是计算结果，如(a-b)*c，点序列作为叶子时取其y值：
+/// - 读取时按块单遍计算，中间结果只占用一块的缓存，不生成和源数据等长的中间数组，
+/// 块内的运算由\sa SAVectorKernel 完成
+/// - 以派生数组为输入构造新的表达式时直接复用其表达式图，整条链在一遍中完成
+/// - 随机访问（getAt、displayAt）时物化，结果缓存到源数据变化为止，源数据的变化通过\sa SAAbstractDatas::getRevision 判断
+/// - 保存时写为\sa SAVectorDouble ，加载后是普通数组
+///
+/// 源数据通过智能指针持有，从变量管理器移除后表达式依然有效
+///
+class SALIB_EXPORT SAVectorExpression : public SAAbstractDatas
+{
+public:
+    typedef SAVectorKernel::Operator Operator;
+    typedef std::shared_ptr<const SAVectorExpressionNode> NodePtr;
+
+    //二元运算，0维数据作为标量，两个序列的长度需要一致，无法构造时返回nullptr
+    static std::shared_ptr<SAVectorExpression> makeBinary(Operator op
+                                                          ,const std::shared_ptr<SAAbstractDatas>& a
+                                                          ,const std::shared_ptr<SAAbstractDatas>& b);
+    //n阶差分，无法构造时返回nullptr
+    static std::shared_ptr<SAVectorExpression> makeDiff(const std::shared_ptr<SAAbstractDatas>& a,unsigned int n);
+
+    SAVectorExpression(const QString& name,NodePtr root);
+    virtual ~SAVectorExpression();
+
+    virtual int getType() const {return SA::VectorExpression;}
+    virtual QString getTypeName() const{return QString("double Vector Expression");}
+    virtual int getSize(int dim=SA::Dim1) const;
+    virtual int getDim() const;
+    virtual QVariant getAt(const std::initializer_list<size_t>& index) const;
+    virtual QString displayAt(const std::initializer_list<size_t>& index) const;
+    virtual int displayRange(size_t row, size_t col, int count, QString* out) const;
+    virtual bool isEmpty() const;
+    virtual void write(QDataStream & out) const;
+    virtual bool isDirty() const;
+    virtual void setDirty(bool dirty);
+    virtual unsigned int getRevision() const;
+
+    //表达式图的根节点
+    NodePtr root() const;
+    //表达式的文本，叶子为源数据名
+    QString expressionString() const;
+
+    //获取计算结果，不修改缓存，可以在工作线程调用
+    void getValues(QVector<double>& values) const;
+    //物化，计算并缓存结果
+    const QVector<double>& materialize() const;
+    //结果是否已物化且源数据没有变化
+    bool isMaterialized() const;
+    //释放物化的结果
+    void releaseCache();
+
+private:
+    NodePtr m_root;
+    QList<std::shared_ptr<SAAbstractDatas> > m_sources;///< 表达式的所有叶子数据
+    mutable QVector<double> m_cache;
+    mutable unsigned int m_cacheRevision;
+    mutable bool m_hasCache;
+    mutable unsigned int m_writeRevision;///< 上次写入时的修改计数
+    bool m_isDirty;
+};
+
+#endif // SAVECTOREXPRESSION_H
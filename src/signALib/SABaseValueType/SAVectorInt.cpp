@@ -28,4 +28,25 @@ void SAVectorInt::write(QDataStream &out) const
     SAAbstractDatas::write(out);
     out << getValueDatas();
 }
-
+///
+/// \brief 批量获取用于显示的内容，格式和displayAt一致
+/// \param row
+/// \param col 只有第0列
+/// \param count
+/// \param out
+/// \return 实际写入的个数
+///
+int SAVectorInt::displayRange(size_t row, size_t col, int count, QString *out) const
+{
+    if(0 != col)
+    {
+        return 0;
+    }
+    const int n = qBound(0,m_datas.size() - static_cast<int>(row),count);
+    const int* p = m_datas.constData() + row;
+    for(int i=0;i<n;++i)
+    {
+        out[i] = QString::number(p[i]);
+    }
+    return n;
+}
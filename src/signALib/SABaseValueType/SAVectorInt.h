@@ -15,6 +15,8 @@ public:
     virtual int getType() const   {return SA::VectorInt;}
     virtual QString getTypeName() const{return QString("int Array");}
     virtual void write(QDataStream & out) const;
+    //批量获取用于显示的内容
+    virtual int displayRange(size_t row, size_t col, int count, QString* out) const;
 };
 
 #endif // SAVECTORINT_H
@@ -118,6 +118,28 @@ QString SAVectorPointF::displayAt(const std::initializer_list<size_t> &index) co
     return QString();
 }
 ///
+/// \brief 批量获取用于显示的内容，格式和displayAt({row,col})一致
+/// \param row
+/// \param col 0对应x，1对应y
+/// \param count
+/// \param out
+/// \return 实际写入的个数
+///
+int SAVectorPointF::displayRange(size_t row, size_t col, int count, QString *out) const
+{
+    if(col > 1)
+    {
+        return 0;
+    }
+    const int n = qBound(0,m_datas.size() - static_cast<int>(row),count);
+    const QPointF* p = m_datas.constData() + row;
+    for(int i=0;i<n;++i)
+    {
+        out[i] = QString::number((0 == col) ? p[i].x() : p[i].y());
+    }
+    return n;
+}
+///
 /// \brief setAt(double,{row,col})此时可以作为一个二维表格设置double
 /// \param val
 /// \param index
@@ -39,6 +39,8 @@ public:
     //返回点序列值,若调调用dim1，将返回QVariant(QPointF),若调用(dim1,dim2)将返回QVariant(double)
     virtual QVariant getAt(const std::initializer_list<size_t>& index) const;
     virtual QString displayAt(const std::initializer_list<size_t>& index) const;
+    //批量获取用于显示的内容，col为0对应x，为1对应y
+    virtual int displayRange(size_t row, size_t col, int count, QString* out) const;
     virtual bool setAt(const QVariant &val, const std::initializer_list<size_t> &index);
     void getYs(QVector<double>& data) const;
     void getXs(QVector<double>& data) const;
@@ -0,0 +1,419 @@
+#include "SAVectorKernel.h"
+#include <cmath>
+#include <type_traits>
+
+///
+/// \def 定义此宏关闭simd，全部逐点计算
+///
+//#define SA_KERNEL_NO_SIMD
+
+#if !defined(SA_KERNEL_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define SA_KERNEL_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(SA_KERNEL_SSE2) && (defined(__GNUC__) || defined(__clang__) || defined(_MSC_VER))
+#define SA_KERNEL_AVX2
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+//gcc/clang需要给使用avx指令的函数单独指定目标，msvc不需要
+#if defined(__GNUC__) || defined(__clang__)
+#define SA_KERNEL_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define SA_KERNEL_TARGET_AVX2
+#endif
+
+static_assert(std::is_same<qreal,double>::value,"SAVectorKernel need qreal to be double");
+
+namespace {
+
+struct OpAdd
+{
+    static double s(double a,double b){return a+b;}
+#ifdef SA_KERNEL_SSE2
+    static __m128d v(__m128d a,__m128d b){return _mm_add_pd(a,b);}
+#endif
+#ifdef SA_KERNEL_AVX2
+    SA_KERNEL_TARGET_AVX2 static __m256d v(__m256d a,__m256d b){return _mm256_add_pd(a,b);}
+#endif
+};
+
+struct OpSubtract
+{
+    static double s(double a,double b){return a-b;}
+#ifdef SA_KERNEL_SSE2
+    static __m128d v(__m128d a,__m128d b){return _mm_sub_pd(a,b);}
+#endif
+#ifdef SA_KERNEL_AVX2
+    SA_KERNEL_TARGET_AVX2 static __m256d v(__m256d a,__m256d b){return _mm256_sub_pd(a,b);}
+#endif
+};
+
+struct OpMultiply
+{
+    static double s(double a,double b){return a*b;}
+#ifdef SA_KERNEL_SSE2
+    static __m128d v(__m128d a,__m128d b){return _mm_mul_pd(a,b);}
+#endif
+#ifdef SA_KERNEL_AVX2
+    SA_KERNEL_TARGET_AVX2 static __m256d v(__m256d a,__m256d b){return _mm256_mul_pd(a,b);}
+#endif
+};
+
+struct OpDivide
+{
+    static double s(double a,double b){return a/b;}
+#ifdef SA_KERNEL_SSE2
+    static __m128d v(__m128d a,__m128d b){return _mm_div_pd(a,b);}
+#endif
+#ifdef SA_KERNEL_AVX2
+    SA_KERNEL_TARGET_AVX2 static __m256d v(__m256d a,__m256d b){return _mm256_div_pd(a,b);}
+#endif
+};
+
+struct OpScale
+{
+    OpScale(double k,double bias):m_k(k),m_bias(bias){}
+    double s(double a) const{return a*m_k+m_bias;}
+#ifdef SA_KERNEL_SSE2
+    __m128d v(__m128d a) const{return _mm_add_pd(_mm_mul_pd(a,_mm_set1_pd(m_k)),_mm_set1_pd(m_bias));}
+#endif
+#ifdef SA_KERNEL_AVX2
+    SA_KERNEL_TARGET_AVX2 __m256d v(__m256d a) const{return _mm256_add_pd(_mm256_mul_pd(a,_mm256_set1_pd(m_k)),_mm256_set1_pd(m_bias));}
+#endif
+    double m_k;
+    double m_bias;
+};
+
+struct OpAbs
+{
+    double s(double a) const{return std::fabs(a);}
+#ifdef SA_KERNEL_SSE2
+    __m128d v(__m128d a) const{return _mm_andnot_pd(_mm_set1_pd(-0.0),a);}
+#endif
+#ifdef SA_KERNEL_AVX2
+    SA_KERNEL_TARGET_AVX2 __m256d v(__m256d a) const{return _mm256_andnot_pd(_mm256_set1_pd(-0.0),a);}
+#endif
+};
+
+///
+/// \brief 限幅，min/max指令在有nan时返回第二个操作数，把a放在第二个使nan保持不变
+///
+struct OpClip
+{
+    OpClip(double lo,double hi):m_lo(lo),m_hi(hi){}
+    double s(double a) const{return (a < m_lo) ? m_lo : ((a > m_hi) ? m_hi : a);}
+#ifdef SA_KERNEL_SSE2
+    __m128d v(__m128d a) const{return _mm_min_pd(_mm_set1_pd(m_hi),_mm_max_pd(_mm_set1_pd(m_lo),a));}
+#endif
+#ifdef SA_KERNEL_AVX2
+    SA_KERNEL_TARGET_AVX2 __m256d v(__m256d a) const{return _mm256_min_pd(_mm256_set1_pd(m_hi),_mm256_max_pd(_mm256_set1_pd(m_lo),a));}
+#endif
+    double m_lo;
+    double m_hi;
+};
+
+struct OpLog
+{
+    double s(double a) const{return std::log(a);}
+};
+
+struct OpExp
+{
+    double s(double a) const{return std::exp(a);}
+};
+
+///
+/// \brief 带步长的逐点计算，步长为0时即为广播
+///
+template<typename OP>
+void binary_plain(SAVectorKernel::Span a,SAVectorKernel::Span b,double* out,int outStride,int n)
+{
+    for(int i=0;i<n;++i)
+    {
+        out[i*outStride] = OP::s(a.data[i*a.stride],b.data[i*b.stride]);
+    }
+}
+
+template<typename OP>
+void unary_plain(const OP& op,SAVectorKernel::Span a,double* out,int outStride,int n)
+{
+    for(int i=0;i<n;++i)
+    {
+        out[i*outStride] = op.s(a.data[i*a.stride]);
+    }
+}
+
+#ifdef SA_KERNEL_SSE2
+///
+/// \brief 连续序列的sse2计算，VA、VB为false时对应的输入是标量
+///
+template<typename OP,bool VA,bool VB>
+void binary_sse2(const double* a,const double* b,double* out,int n)
+{
+    const __m128d ca = _mm_set1_pd(a[0]);
+    const __m128d cb = _mm_set1_pd(b[0]);
+    int i = 0;
+    for(;i+2<=n;i+=2)
+    {
+        const __m128d va = VA ? _mm_loadu_pd(a+i) : ca;
+        const __m128d vb = VB ? _mm_loadu_pd(b+i) : cb;
+        _mm_storeu_pd(out+i,OP::v(va,vb));
+    }
+    for(;i<n;++i)
+    {
+        out[i] = OP::s(VA ? a[i] : a[0],VB ? b[i] : b[0]);
+    }
+}
+
+template<typename OP>
+void unary_sse2(const OP& op,const double* a,double* out,int n)
+{
+    int i = 0;
+    for(;i+2<=n;i+=2)
+    {
+        _mm_storeu_pd(out+i,op.v(_mm_loadu_pd(a+i)));
+    }
+    for(;i<n;++i)
+    {
+        out[i] = op.s(a[i]);
+    }
+}
+#endif
+
+#ifdef SA_KERNEL_AVX2
+template<typename OP,bool VA,bool VB>
+SA_KERNEL_TARGET_AVX2 void binary_avx2(const double* a,const double* b,double* out,int n)
+{
+    const __m256d ca = _mm256_set1_pd(a[0]);
+    const __m256d cb = _mm256_set1_pd(b[0]);
+    int i = 0;
+    for(;i+4<=n;i+=4)
+    {
+        const __m256d va = VA ? _mm256_loadu_pd(a+i) : ca;
+        const __m256d vb = VB ? _mm256_loadu_pd(b+i) : cb;
+        _mm256_storeu_pd(out+i,OP::v(va,vb));
+    }
+    for(;i<n;++i)
+    {
+        out[i] = OP::s(VA ? a[i] : a[0],VB ? b[i] : b[0]);
+    }
+}
+
+template<typename OP>
+SA_KERNEL_TARGET_AVX2 void unary_avx2(const OP& op,const double* a,double* out,int n)
+{
+    int i = 0;
+    for(;i+4<=n;i+=4)
+    {
+        _mm256_storeu_pd(out+i,op.v(_mm256_loadu_pd(a+i)));
+    }
+    for(;i<n;++i)
+    {
+        out[i] = op.s(a[i]);
+    }
+}
+
+bool cpu_support_avx2()
+{
+#if !defined(_MSC_VER)
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#else
+    int info[4];
+    __cpuid(info,0);
+    if(info[0] < 7)
+    {
+        return false;
+    }
+    //需要cpu支持avx且系统开启了ymm寄存器的保存(osxsave)
+    __cpuid(info,1);
+    if(0 == (info[2] & (1<<27)) || 0 == (info[2] & (1<<28)))
+    {
+        return false;
+    }
+    if(0x6 != (_xgetbv(0) & 0x6))
+    {
+        return false;
+    }
+    __cpuidex(info,7,0);
+    return (0 != (info[1] & (1<<5)));
+#endif
+}
+#endif
+
+SAVectorKernel::Isa detect_isa()
+{
+#ifdef SA_KERNEL_AVX2
+    if(cpu_support_avx2())
+    {
+        return SAVectorKernel::IsaAVX2;
+    }
+#endif
+#ifdef SA_KERNEL_SSE2
+    return SAVectorKernel::IsaSSE2;
+#else
+    return SAVectorKernel::IsaScalar;
+#endif
+}
+
+///
+/// \brief 连续或标量输入的二元运算，按指令集分派
+///
+template<typename OP,bool VA,bool VB>
+void binary_contiguous(const double* a,const double* b,double* out,int n)
+{
+#ifdef SA_KERNEL_AVX2
+    if(SAVectorKernel::IsaAVX2 == SAVectorKernel::isa())
+    {
+        binary_avx2<OP,VA,VB>(a,b,out,n);
+        return;
+    }
+#endif
+#ifdef SA_KERNEL_SSE2
+    binary_sse2<OP,VA,VB>(a,b,out,n);
+#else
+    binary_plain<OP>(SAVectorKernel::Span(a,VA ? 1 : 0),SAVectorKernel::Span(b,VB ? 1 : 0),out,1,n);
+#endif
+}
+
+template<typename OP>
+void binary_dispatch(SAVectorKernel::Span a,SAVectorKernel::Span b,double* out,int outStride,int n)
+{
+    if(1 == outStride)
+    {
+        if(1 == a.stride && 1 == b.stride)
+        {
+            binary_contiguous<OP,true,true>(a.data,b.data,out,n);
+            return;
+        }
+        else if(1 == a.stride && 0 == b.stride)
+        {
+            binary_contiguous<OP,true,false>(a.data,b.data,out,n);
+            return;
+        }
+        else if(0 == a.stride && 1 == b.stride)
+        {
+            binary_contiguous<OP,false,true>(a.data,b.data,out,n);
+            return;
+        }
+    }
+    binary_plain<OP>(a,b,out,outStride,n);
+}
+///
+/// \brief 一元运算，按指令集分派，带步长的序列逐点计算
+///
+template<typename OP>
+void unary_dispatch(const OP& op,SAVectorKernel::Span a,double* out,int outStride,int n)
+{
+    if(1 == outStride && 1 == a.stride)
+    {
+#ifdef SA_KERNEL_AVX2
+        if(SAVectorKernel::IsaAVX2 == SAVectorKernel::isa())
+        {
+            unary_avx2(op,a.data,out,n);
+            return;
+        }
+#endif
+#ifdef SA_KERNEL_SSE2
+        unary_sse2(op,a.data,out,n);
+        return;
+#endif
+    }
+    unary_plain(op,a,out,outStride,n);
+}
+
+}
+
+SAVectorKernel::Span SAVectorKernel::xChannel(const QPointF *p)
+{
+    return Span(reinterpret_cast<const double*>(p),2);
+}
+
+SAVectorKernel::Span SAVectorKernel::yChannel(const QPointF *p)
+{
+    return Span(reinterpret_cast<const double*>(p)+1,2);
+}
+///
+/// \brief 当前使用的指令集，第一次调用时检测cpu
+/// \return
+///
+SAVectorKernel::Isa SAVectorKernel::isa()
+{
+    static const Isa s_isa = detect_isa();
+    return s_isa;
+}
+
+const char *SAVectorKernel::isaName()
+{
+    switch(isa())
+    {
+    case IsaAVX2:
+        return "avx2";
+    case IsaSSE2:
+        return "sse2";
+    default:
+        break;
+    }
+    return "scalar";
+}
+///
+/// \brief 二元运算out[i] = a[i] op b[i]
+/// \param op 运算
+/// \param a 输入，步长为0时作为标量
+/// \param b 输入，步长为0时作为标量
+/// \param out 输出
+/// \param outStride 输出的步长
+/// \param n 元素个数
+///
+void SAVectorKernel::binary(SAVectorKernel::Operator op, SAVectorKernel::Span a, SAVectorKernel::Span b, double *out, int outStride, int n)
+{
+    if(n <= 0)
+    {
+        return;
+    }
+    switch(op)
+    {
+    case Add:
+        binary_dispatch<OpAdd>(a,b,out,outStride,n);
+        break;
+    case Subtract:
+        binary_dispatch<OpSubtract>(a,b,out,outStride,n);
+        break;
+    case Multiply:
+        binary_dispatch<OpMultiply>(a,b,out,outStride,n);
+        break;
+    case Divide:
+        binary_dispatch<OpDivide>(a,b,out,outStride,n);
+        break;
+    }
+}
+
+void SAVectorKernel::scale(SAVectorKernel::Span a, double k, double bias, double *out, int outStride, int n)
+{
+    unary_dispatch(OpScale(k,bias),a,out,outStride,n);
+}
+
+void SAVectorKernel::abs(SAVectorKernel::Span a, double *out, int outStride, int n)
+{
+    unary_dispatch(OpAbs(),a,out,outStride,n);
+}
+
+void SAVectorKernel::log(SAVectorKernel::Span a, double *out, int outStride, int n)
+{
+    unary_plain(OpLog(),a,out,outStride,n);
+}
+
+void SAVectorKernel::exp(SAVectorKernel::Span a, double *out, int outStride, int n)
+{
+    unary_plain(OpExp(),a,out,outStride,n);
+}
+
+void SAVectorKernel::clip(SAVectorKernel::Span a, double lo, double hi, double *out, int outStride, int n)
+{
+    unary_dispatch(OpClip(lo,hi),a,out,outStride,n);
+}
@@ -0,0 +1,66 @@
+#ifndef SAVECTORKERNEL_H
+#define SAVECTORKERNEL_H
+#include "SALibGlobal.h"
+#include <QPointF>
+
+/**
+ * @brief 逐元素运算的向量化内核
+ *
+ * 输入输出都是带步长的double序列：
+ * - 步长为0的输入作为标量广播到每个元素
+ * - 步长为2可以直接读写点序列(QPointF)的x或y通道，不需要先复制成数组
+ *
+ * 连续序列使用SSE2/AVX2指令计算，AVX2在运行时检测cpu支持后启用，其余情况逐点计算。
+ * 输出可以和输入是同一块内存（原地计算）
+ * @note log、exp没有向量化指令，逐点调用标准库
+ */
+class SALIB_EXPORT SAVectorKernel
+{
+public:
+    /**
+     * @brief 带步长的只读序列
+     */
+    struct Span
+    {
+        Span(const double* d = nullptr,int s = 1):data(d),stride(s){}
+        const double* data;
+        int stride;///< 相邻元素间隔的double数，0表示标量
+    };
+    enum Operator
+    {
+        Add///< a+b
+        ,Subtract///< a-b
+        ,Multiply///< a*b
+        ,Divide///< a/b
+    };
+    enum Isa
+    {
+        IsaScalar///< 逐点计算
+        ,IsaSSE2
+        ,IsaAVX2
+    };
+    //以标量构造序列
+    static Span scalar(const double* v){return Span(v,0);}
+    //点序列的x通道
+    static Span xChannel(const QPointF* p);
+    //点序列的y通道
+    static Span yChannel(const QPointF* p);
+    //当前使用的指令集
+    static Isa isa();
+    static const char* isaName();
+
+    //out = a op b
+    static void binary(Operator op,Span a,Span b,double* out,int outStride,int n);
+    //out = a*k+bias
+    static void scale(Span a,double k,double bias,double* out,int outStride,int n);
+    //out = |a|
+    static void abs(Span a,double* out,int outStride,int n);
+    //out = ln(a)
+    static void log(Span a,double* out,int outStride,int n);
+    //out = e^a
+    static void exp(Span a,double* out,int outStride,int n);
+    //把a限制在[lo,hi]，nan保持不变
+    static void clip(Span a,double lo,double hi,double* out,int outStride,int n);
+};
+
+#endif // SAVECTORKERNEL_H
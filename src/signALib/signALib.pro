@@ -31,6 +31,7 @@ HEADERS += \
     SAPoint.h \
     SATable.h \
     SAThreadPool.h \
+    SAVectorKernel.h \
     SAValueManager.h \
     SAValueManagerModel.h \
     SARandColorMaker.h \
@@ -54,6 +55,7 @@ SOURCES += \
     SALineGradientColorList.cpp \
     SAPoint.cpp \
     SAThreadPool.cpp \
+    SAVectorKernel.cpp \
     SAValueManager.cpp \
     SAValueManagerModel.cpp \
     SARandColorMaker.cpp \
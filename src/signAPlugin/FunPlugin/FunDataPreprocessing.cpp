@@ -17,17 +17,26 @@
 #include "SAChart.h"
 #include "qwt_symbol.h"
 #include <QMdiSubWindow>
+#include <climits>
 #include "SAMdiSubWindow.h"
 #include "SAGUIGlobalConfig.h"
 #include "ui_opt.h"
+#include "SAFunTask.h"
 #include "SAAlgorithm.h"
 #include "SARandColorMaker.h"
+#include "SASavitzkyGolay.h"
 #include <QApplication>
 #define TR(str)\
     QApplication::translate("FunDataPreprocessing", str, 0)
 void sigmaDetectInValue(SAUIInterface* ui);
 bool getSigmaDetectPorperty(double &sigma, bool *isMark, bool *isChangPlot,SAUIInterface* ui);
-bool getPointSmoothPorperty(int &m, int& n, SAUIInterface *ui);
+bool getHampelDetectPorperty(int &halfWindow,double &sigma, bool *isMark, bool *isChangPlot,SAUIInterface* ui);
+void apply_out_range_indexs(SAUIInterface* ui,SAChart2D* chart
+                            ,const QList<SAXYSeriesData>& curves
+                            ,const QList<QVector<int> >& outIndexs
+                            ,const QString& name
+                            ,bool isMark,bool isChangedPlot);
+bool getPointSmoothPorperty(int &m, int& n, int maxPoints, SAUIInterface *ui);
 
 void sigmaDetect(SAUIInterface* ui)
 {
@@ -35,7 +44,7 @@ void sigmaDetect(SAUIInterface* ui)
     SAChart2D* chart = filter_xy_series(ui,curs);
     if(nullptr == chart || curs.size() <= 0)
     {
-        saUI->showMessageInfo(TR("unsupport chart items"),SA::WarningMessage);
+        ui->showMessageInfo(TR("unsupport chart items"),SA::WarningMessage);
         return;
     }
     double sigma;
@@ -48,102 +57,87 @@ void sigmaDetect(SAUIInterface* ui)
     {
         return;
     }
-    QStringList infos;
-    QScopedPointer<SAFigureOptCommand> topCmd(new SAFigureOptCommand(chart,QString("sigma %1").arg(sigma)));
-    for (int i = 0;i<curs.size();++i)
-    {
-        QwtPlotItem* item = curs[i];
-        switch(item->rtti())
+    auto curves = std::make_shared<QList<SAXYSeriesData> >(get_xy_series_datas(chart,curs,true,false));
+    //每条曲线超出sigma范围的索引
+    auto outIndexs = std::make_shared<QList<QVector<int> > >();
+    const QString name = QString("sigma %1").arg(sigma);
+    runFunTask(ui,name,xy_series_data_count(*curves)
+               ,[curves,outIndexs,sigma](SAFunTaskContext& ctx)->bool{
+        for(int i=0;i<curves->size() && !ctx.isCanceled();++i)
         {
-        case QwtPlotItem::Rtti_PlotCurve:
+            QVector<int> indexs;
+            saFun::sigmaDenoising(curves->at(i).ys,sigma,indexs);
+            outIndexs->append(indexs);
+            ctx.setProgress(i+1,curves->size());
+        }
+        return true;
+    },[ui,chart,curves,outIndexs,name,isMark,isChangedPlot](){
+        apply_out_range_indexs(ui,chart,*curves,*outIndexs,name,isMark,isChangedPlot);
+    });
+}
+///
+/// \brief Hampel异常值判断，用滑动窗口的中位数和MAD检测局部异常值
+///
+void hampelDetect(SAUIInterface* ui)
+{
+    QList<QwtPlotItem*> curs;
+    SAChart2D* chart = filter_xy_series(ui,curs);
+    if(nullptr == chart || curs.size() <= 0)
+    {
+        ui->showMessageInfo(TR("unsupport chart items"),SA::WarningMessage);
+        return;
+    }
+    int halfWindow;
+    double sigma;
+    bool isMark,isChangedPlot;
+    if(!getHampelDetectPorperty(halfWindow,sigma,&isMark,&isChangedPlot,ui))
+    {
+        return;
+    }
+    if(!isMark && !isChangedPlot)
+    {
+        return;
+    }
+    auto curves = std::make_shared<QList<SAXYSeriesData> >(get_xy_series_datas(chart,curs,true,false));
+    //每条曲线异常值的索引
+    auto outIndexs = std::make_shared<QList<QVector<int> > >();
+    const QString name = QString("hampel %1 %2").arg(halfWindow).arg(sigma);
+    runFunTask(ui,name,xy_series_data_count(*curves)
+               ,[curves,outIndexs,halfWindow,sigma](SAFunTaskContext& ctx)->bool{
+        for(int i=0;i<curves->size() && !ctx.isCanceled();++i)
         {
-            QVector<double> xs,ys;
-            {
-                QVector<QPointF> wave;
-                SAChart::getPlotCurveSample(item,wave);
-                xs.reserve(wave.size());
-                ys.reserve(wave.size());
-                std::for_each(wave.begin(),wave.end(),[&xs](const QPointF& p){xs.push_back(p.x());});
-                std::for_each(wave.begin(),wave.end(),[&ys](const QPointF& p){ys.push_back(p.y());});
-            }
-            QString info;
-            QString title = item->title().text();
             QVector<int> indexs;
-            saFun::sigmaDenoising(ys,sigma,indexs);
-            info = QString("sigma(\"%1\") out range datas count:%2").arg(title).arg(indexs.size());
-            infos.append(info);
-            if(0 == indexs.size())
-            {
-                continue;
-            }
-            if(isMark)
-            {
-                QVector<double> oxs,oys;
-                SA::copy_inner_indexs(xs.begin(),indexs.begin(),indexs.end(),std::back_inserter(oxs));
-                SA::copy_inner_indexs(ys.begin(),indexs.begin(),indexs.end(),std::back_inserter(oys));
-                QwtPlotCurve* curs = new QwtPlotCurve(QString("%1_outSigmaMarker").arg(title));
-                curs->setSamples(oxs,oys);
-                SAChart::setCurvePenStyle(curs,Qt::NoPen);
-                QwtSymbol* sym = new QwtSymbol(QwtSymbol::XCross);
-                sym->setColor(SARandColorMaker::getCurveColor());
-                sym->setSize(QSize(6,6));
-                curs->setSymbol(sym);
-                new SAFigureChartItemAddCommand(chart
-                                                ,curs
-                                                ,QString("%1 - sigma out rang").arg(title)
-                                                ,topCmd.data());
-            }
-            if(isChangedPlot)
+            if(!saFun::hampelDenoising(curves->at(i).ys,halfWindow,sigma,indexs))
             {
-                QVector<int> allIndex;
-                QVector<int> innerIndex;
-                const int count = xs.size();
-                innerIndex.resize(count);
-                allIndex.reserve(count);
-                for(int i=0;i<count;++i)
-                {
-                    allIndex.append(i);
-                }
-                SA::copy_out_of_indexs(allIndex.begin(),allIndex.end(),indexs.begin(),indexs.end(),std::back_inserter(innerIndex));
-                QVector<double> oxs,oys;
-                SA::copy_inner_indexs(xs.begin(),innerIndex.begin(),innerIndex.end(),std::back_inserter(oxs));
-                SA::copy_inner_indexs(ys.begin(),innerIndex.begin(),innerIndex.end(),std::back_inserter(oys));
-                QVector<QPointF> oxys;
-                saFun::makeVectorPointF(oxs,oys,oxys);;
-
-                new SAFigureReplaceAllDatasCommand<QPointF,QwtPlotCurve,decltype(&SAChart::setPlotCurveSample)>
-                        (chart
-                       ,item
-                       ,oxys
-                       ,TR("%1 sigma %2").arg(title).arg(sigma)
-                       ,&SAChart::setPlotCurveSample
-                       ,&SAChart::getPlotCurveSample
-                       ,topCmd.data()
-                       );
-
+                return false;
             }
-            break;
+            outIndexs->append(indexs);
+            ctx.setProgress(i+1,curves->size());
         }
-        }
-
-        /*
-        QwtSeriesStore<QPointF>* series = dynamic_cast<QwtSeriesStore<QPointF>*>(item);
-        if(nullptr == series)
-        {
-            continue;
-        }
-        QVector<double> xs,ys;
-        if(!chart->getXYData(&xs,&ys,item))
-        {
-            continue;
-        }
-
-        QString info;
-        QString title = item->title().text();
-        QVector<int> indexs;
-        saFun::sigmaDenoising(xs,ys,sigma,indexs);
-        info = QString("sigma(\"%1\") out range datas count:%2").arg(title).arg(indexs.size());
-        infos.append(info);
+        return true;
+    },[ui,chart,curves,outIndexs,name,isMark,isChangedPlot](){
+        apply_out_range_indexs(ui,chart,*curves,*outIndexs,name,isMark,isChangedPlot);
+    });
+}
+///
+/// \brief 把异常值检测的结果应用到图表，标记异常值或用去掉异常值的数据替换曲线，作为一个可撤销的命令
+/// \param curves 检测的曲线
+/// \param outIndexs 每条曲线异常值的索引，升序
+/// \param name 命令名
+///
+void apply_out_range_indexs(SAUIInterface* ui,SAChart2D* chart
+                            ,const QList<SAXYSeriesData>& curves
+                            ,const QList<QVector<int> >& outIndexs
+                            ,const QString& name
+                            ,bool isMark,bool isChangedPlot)
+{
+    QStringList infos;
+    QScopedPointer<SAFigureOptCommand> topCmd(new SAFigureOptCommand(chart,name));
+    for(int i=0;i<curves.size() && i<outIndexs.size();++i)
+    {
+        const SAXYSeriesData& d = curves.at(i);
+        const QVector<int>& indexs = outIndexs.at(i);
+        infos.append(QString("%1(\"%2\") out range datas count:%3").arg(name).arg(d.title).arg(indexs.size()));
         if(0 == indexs.size())
         {
             continue;
@@ -151,53 +145,44 @@ void sigmaDetect(SAUIInterface* ui)
         if(isMark)
         {
             QVector<double> oxs,oys;
-            czy::copy_inner_indexs(xs.begin(),indexs.begin(),indexs.end(),std::back_inserter(oxs));
-            czy::copy_inner_indexs(ys.begin(),indexs.begin(),indexs.end(),std::back_inserter(oys));
-            QwtPlotCurve* curs = new QwtPlotCurve(QString("%1_outSigmaMarker").arg(title));
-            curs->setSamples(oxs,oys);
-            SAChart::setCurvePenStyle(curs,Qt::NoPen);
+            SA::copy_inner_indexs(d.xs.begin(),indexs.begin(),indexs.end(),std::back_inserter(oxs));
+            SA::copy_inner_indexs(d.ys.begin(),indexs.begin(),indexs.end(),std::back_inserter(oys));
+            QwtPlotCurve* cur = new QwtPlotCurve(QString("%1_outRangMarker").arg(d.title));
+            cur->setSamples(oxs,oys);
+            SAChart::setCurvePenStyle(cur,Qt::NoPen);
             QwtSymbol* sym = new QwtSymbol(QwtSymbol::XCross);
             sym->setColor(SARandColorMaker::getCurveColor());
             sym->setSize(QSize(6,6));
-            curs->setSymbol(sym);
+            cur->setSymbol(sym);
             new SAFigureChartItemAddCommand(chart
-                                            ,curs
-                                            ,QString("%1 - sigma out rang").arg(title)
+                                            ,cur
+                                            ,QString("%1 - %2 out rang").arg(d.title).arg(name)
                                             ,topCmd.data());
         }
         if(isChangedPlot)
         {
             QVector<int> allIndex;
             QVector<int> innerIndex;
-            const int count = xs.size();
-            innerIndex.resize(count);
+            const int count = d.xs.size();
             allIndex.reserve(count);
-            for(int i=0;i<count;++i)
+            for(int j=0;j<count;++j)
             {
-                allIndex.append(i);
+                allIndex.append(j);
             }
-            czy::copy_out_of_indexs(allIndex.begin(),allIndex.end(),indexs.begin(),indexs.end(),std::back_inserter(innerIndex));
+            SA::copy_out_of_indexs(allIndex.begin(),allIndex.end(),indexs.begin(),indexs.end(),std::back_inserter(innerIndex));
             QVector<double> oxs,oys;
-            czy::copy_inner_indexs(xs.begin(),innerIndex.begin(),innerIndex.end(),std::back_inserter(oxs));
-            czy::copy_inner_indexs(ys.begin(),innerIndex.begin(),innerIndex.end(),std::back_inserter(oys));
+            SA::copy_inner_indexs(d.xs.begin(),innerIndex.begin(),innerIndex.end(),std::back_inserter(oxs));
+            SA::copy_inner_indexs(d.ys.begin(),innerIndex.begin(),innerIndex.end(),std::back_inserter(oys));
             QVector<QPointF> oxys;
             saFun::makeVectorPointF(oxs,oys,oxys);
-            new SAFigureChangeXYSeriesDataCommand(chart
-                                                 ,series
-                                                 ,TR("%1 sigma %2").arg(title).arg(sigma)
-                                                 ,oxys
-                                                 ,topCmd.data());
-
-            new SAFigureReplaceAllDatasCommand<>(chart
-                                              ,series
-                                              ,);
+            append_replace_curve_datas_command(chart,d.item,oxys
+                                               ,QString("%1 %2").arg(d.title).arg(name),topCmd.data());
         }
-        */
     }
     if(topCmd->childCount() > 0)
     {
         chart->appendCommand(topCmd.take());
-        saUI->showNormalMessageInfo(infos.join('\n'));
+        ui->showNormalMessageInfo(infos.join('\n'));
     }
 }
 
@@ -210,90 +195,57 @@ void pointSmooth(SAUIInterface* ui)
         ui->showMessageInfo(TR("unsupport chart items"),SA::WarningMessage);
         return;
     }
+    //计算后ys为滤波结果，滤波失败的曲线被移除
+    auto curves = std::make_shared<QList<SAXYSeriesData> >(get_xy_series_datas(chart,curs,true,false));
+    int maxPoints = 0;
+    for(const SAXYSeriesData& d : *curves)
+    {
+        maxPoints = qMax(maxPoints,d.ys.size());
+    }
     int m,n;
-    if(!getPointSmoothPorperty(m,n,ui))
+    if(!getPointSmoothPorperty(m,n,maxPoints,ui))
     {
         return;
     }
-    QStringList infos;
-    QScopedPointer<SAFigureOptCommand> topCmd(new SAFigureOptCommand(chart,QString("%1 point %2 power").arg(m).arg(n)));
-    for (int i = 0;i<curs.size();++i)
-    {
-        QwtPlotItem* item = curs[i];
-        QString title = item->title().text();
-
-        switch(item->rtti())
+    runFunTask(ui,QString("%1 point %2 power").arg(m).arg(n),xy_series_data_count(*curves)
+               ,[curves,m,n](SAFunTaskContext& ctx)->bool{
+        const int count = curves->size();
+        for(int i=0;i<count && !ctx.isCanceled();++i)
         {
-        case QwtPlotItem::Rtti_PlotCurve:
-        {
-            QVector<double> xs,ys;
+            SAXYSeriesData& d = (*curves)[i];
+            QVector<double> res;
+            if(saFun::pointSmooth(d.ys,m,n,res))
             {
-                QVector<QPointF> wave;
-                SAChart::getPlotCurveSample(item,wave);
-                xs.reserve(wave.size());
-                ys.reserve(wave.size());
-                std::for_each(wave.begin(),wave.end(),[&xs](const QPointF& p){xs.push_back(p.x());});
-                std::for_each(wave.begin(),wave.end(),[&ys](const QPointF& p){ys.push_back(p.y());});
+                d.ys.swap(res);
             }
-            QVector<double> res;
-            if(!saFun::pointSmooth(ys,m,n,res))
+            else
             {
-                continue;
+                d.ys.clear();
             }
-            QVector<QPointF> xys;
-            saFun::makeVectorPointF(xs,res,xys);
-
-            new SAFigureReplaceAllDatasCommand<QPointF,QwtPlotCurve,decltype(&SAChart::setPlotCurveSample)>
-                    (chart
-                   ,item
-                   ,xys
-                   ,TR("%1 m%2n%3").arg(title).arg(m).arg(n)
-                   ,&SAChart::setPlotCurveSample
-                   ,&SAChart::getPlotCurveSample
-                   ,topCmd.data()
-                   );
-            infos.append(TR("%1 m%2n%3 smooth").arg(title).arg(m).arg(n));
-            break;
-        }
+            ctx.setProgress(i+1,count);
         }
-
-        /*
-        QwtSeriesStore<QPointF>* series = dynamic_cast<QwtSeriesStore<QPointF>*>(item);
-        if(nullptr == series)
-        {
-            continue;
-        }
-        QVector<double> xs,ys;
-
-        if(!chart->getXYData(&xs,&ys,item))
+        return true;
+    },[ui,chart,curves,m,n](){
+        QStringList infos;
+        QScopedPointer<SAFigureOptCommand> topCmd(new SAFigureOptCommand(chart,QString("%1 point %2 power").arg(m).arg(n)));
+        for(const SAXYSeriesData& d : *curves)
         {
-            continue;
-        }
-        if(!chart->getXYData(&xs,&ys,item))
-        {
-            continue;
+            if(d.ys.isEmpty())
+            {
+                continue;
+            }
+            QVector<QPointF> xys;
+            saFun::makeVectorPointF(d.xs,d.ys,xys);
+            append_replace_curve_datas_command(chart,d.item,xys
+                                               ,TR("%1 m%2n%3").arg(d.title).arg(m).arg(n),topCmd.data());
+            infos.append(TR("%1 m%2n%3 smooth").arg(d.title).arg(m).arg(n));
         }
-        QVector<double> res;
-        if(!saFun::pointSmooth(ys,m,n,res))
+        if(topCmd->childCount() > 0)
         {
-            continue;
+            chart->appendCommand(topCmd.take());
+            ui->showNormalMessageInfo(infos.join('\n'));
         }
-        QVector<QPointF> xys;
-        saFun::makeVectorPointF(xs,res,xys);
-        new SAFigureChangeXYSeriesDataCommand(chart
-                                             ,series
-                                             ,TR("%1 m%2n%3").arg(title).arg(m).arg(n)
-                                             ,xys
-                                             ,topCmd.data());
-
-        infos.append(TR("%1 m%2n%3 smooth").arg(title).arg(m).arg(n));
-        */
-    }
-    if(topCmd->childCount() > 0)
-    {
-        chart->appendCommand(topCmd.take());
-        ui->showNormalMessageInfo(infos.join('\n'));
-    }
+    });
 }
 
 
@@ -499,45 +451,42 @@ void sigmaDetectInValue(SAUIInterface* ui)
 }
 ///
 /// \brief m点n次滤波的设置
+///
+/// 点数不超过数据长度，次数不超过SA_SG_MAX_ORDER，点数和次数的关系在确认后检查
 /// \param m m值
 /// \param n n值
-/// \param isNewPlotOrChangPlot 是否新建绘图或者改变原来绘图
+/// \param maxPoints 数据长度，即点数的上限
 /// \return
 ///
-bool getPointSmoothPorperty(int &m, int &n,SAUIInterface* ui)
+bool getPointSmoothPorperty(int &m, int &n,int maxPoints,SAUIInterface* ui)
 {
+    if(maxPoints <= 0)
+    {
+        ui->showWarningMessageInfo(TR("no data to smooth"));
+        return false;
+    }
     SAPropertySetDialog dlg(ui->getMainWindowPtr(),SAPropertySetDialog::GroupBoxType);
     dlg.appendGroup(TR("property set"));
-    dlg.appendEnumProperty("m",TR("points")
-                           ,{"3","5","7"}
-                           ,0
-                           ,TR("set smooth points"));
-    dlg.appendEnumProperty("n",TR("power")
-                           ,{"1","2","3"}
-                           ,0
-                           ,TR("set smooth power"));
+    dlg.appendIntProperty("m",TR("points")
+                          ,1,maxPoints
+                          ,qMin(3,maxPoints)
+                          ,TR("set smooth points,odd number"));
+    dlg.appendIntProperty("n",TR("power")
+                          ,0,qMin(SA_SG_MAX_ORDER,maxPoints-1)
+                          ,qMin(1,maxPoints-1)
+                          ,TR("set smooth power,less than points"));
 
     if(QDialog::Accepted != dlg.exec())
     {
         return false;
     }
-    m = 3;
-    switch(dlg.getDataByID<int>("m"))
+    m = dlg.getDataByID<int>("m");
+    n = dlg.getDataByID<int>("n");
+    if(!SA::SASavitzkyGolay::isValidParameter(m,n,0))
     {
-    case 0:m = 3;break;
-    case 1:m = 5;break;
-    case 2:m = 7;break;
-    default:m = 3;
-    }
-    n = 1;
-    switch(dlg.getDataByID<int>("n"))
-    {
-    case 0:n = 1;break;
-    case 1:n = 2;break;
-    case 2:n = 3;break;
-    default:n = 1;
+        ui->showWarningMessageInfo(TR("points should be odd and greater than power"));
+        return false;
     }
-
     return true;
 }
 ///
@@ -550,19 +499,25 @@ void FunDataPreprocessing::pointSmoothInValue()
     {
         return;
     }
+    const int maxPoints = data->getSize();
+    if(maxPoints <= 0)
+    {
+        saUI->showWarningMessageInfo(TR("no data to smooth"));
+        return;
+    }
     const QString idPoint = "points";
     const QString idPower = "power";
     const QString idIsPlot = "isPlot";
     SAPropertySetDialog dlg(saUI->getMainWindowPtr(),SAPropertySetDialog::GroupBoxType);
     dlg.appendGroup(TR("property set"));
-    dlg.appendEnumProperty(idPoint,TR("points")
-                           ,{"3","5","7"}
-                           ,0
-                           ,TR("set smooth points"));
-    dlg.appendEnumProperty(idPower,TR("power")
-                           ,{"1","2","3"}
-                           ,0
-                           ,TR("set smooth power"));
+    dlg.appendIntProperty(idPoint,TR("points")
+                          ,1,maxPoints
+                          ,qMin(3,maxPoints)
+                          ,TR("set smooth points,odd number"));
+    dlg.appendIntProperty(idPower,TR("power")
+                          ,0,qMin(SA_SG_MAX_ORDER,maxPoints-1)
+                          ,qMin(1,maxPoints-1)
+                          ,TR("set smooth power,less than points"));
     dlg.appendGroup(TR("plot set"));
     dlg.appendBoolProperty(idIsPlot,TR("is plot")
                            ,true
@@ -571,21 +526,12 @@ void FunDataPreprocessing::pointSmoothInValue()
     {
         return;
     }
-    int point = 3;
-    switch(dlg.getDataByID<int>(idPoint))
-    {
-    case 0:point = 3;break;
-    case 1:point = 5;break;
-    case 2:point = 7;break;
-    default:point = 3;
-    }
-    int power = 1;
-    switch(dlg.getDataByID<int>(idPower))
+    const int point = dlg.getDataByID<int>(idPoint);
+    const int power = dlg.getDataByID<int>(idPower);
+    if(!SA::SASavitzkyGolay::isValidParameter(point,power,0))
     {
-    case 0:power = 1;break;
-    case 1:power = 2;break;
-    case 2:power = 3;break;
-    default:power = 1;
+        saUI->showWarningMessageInfo(TR("points should be odd and greater than power"));
+        return;
     }
     std::shared_ptr<SAAbstractDatas> res = saFun::pointSmooth(data,point,power);
     if(nullptr == res)
@@ -647,6 +593,47 @@ bool getSigmaDetectPorperty(double &sigma,bool* isMark,bool* isChangPlot,SAUIInt
         *isChangPlot = dlg.getDataByID<double>("isChangPlot");
     return true;
 }
+///
+/// \brief Hampel异常值判断的参数
+///
+bool getHampelDetectPorperty(int &halfWindow,double &sigma,bool* isMark,bool* isChangPlot,SAUIInterface* ui)
+{
+    SAPropertySetDialog dlg(ui->getMainWindowPtr(),SAPropertySetDialog::GroupBoxType);
+    dlg.appendGroup(TR("property set"));
+    dlg.appendIntProperty("halfWindow",TR("half window")
+                          ,1,INT_MAX/2
+                          ,10
+                          ,TR("points taken on each side of the center point"));
+    dlg.appendDoubleProperty("sigma",TR("sigma")
+                             ,0,std::numeric_limits<double>::max()
+                             ,3
+                           ,TR("set sigma value,the data out of median±sigma*1.4826*MAD will be detected"));
+    if(isChangPlot)
+    {
+        dlg.appendBoolProperty("isChangPlot"
+                               ,TR("is modify plot curve")
+                               ,true
+                               ,TR("if checked,will use the new datas chang the curve"));
+    }
+    if(isMark)
+    {
+        dlg.appendBoolProperty("isMark"
+                               ,TR("is mark out rang datas")
+                               ,false
+                               ,TR("if checked,will plot the out range datas"));
+    }
+    if(QDialog::Accepted != dlg.exec())
+    {
+        return false;
+    }
+    halfWindow = dlg.getDataByID<int>("halfWindow");
+    sigma = dlg.getDataByID<double>("sigma");
+    if(isMark)
+        *isMark = dlg.getDataByID<bool>("isMark");
+    if(isChangPlot)
+        *isChangPlot = dlg.getDataByID<bool>("isChangPlot");
+    return true;
+}
 
 
 
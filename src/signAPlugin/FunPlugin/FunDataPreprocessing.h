@@ -13,6 +13,8 @@ private:
 };
 //sigma异常值判断
 void sigmaDetect(SAUIInterface* ui);
+//Hampel异常值判断
+void hampelDetect(SAUIInterface* ui);
    //m点n次滤波
 void pointSmooth(SAUIInterface* ui);
 #endif // DATA_PREPROCESSING_H
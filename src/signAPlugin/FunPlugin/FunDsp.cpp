@@ -2,6 +2,8 @@
 #include <QApplication>
 #include <QVariant>
 #include <QMdiSubWindow>
+#include <QScopedPointer>
+#include <QStringList>
 #include "sa_fun_dsp.h"
 #include "SAPropertySetDialog.h"
 #include <qtvariantproperty.h>
@@ -19,6 +21,7 @@
 #include "SAFigureReplaceDatasCommand.h"
 #include "SAMath.h"
 #include "ui_opt.h"
+#include "SAFunTask.h"
 #include <QApplication>
 #include "SADsp.h"
 #define TR(str)\
@@ -61,6 +64,10 @@ bool getWindowProperty(SA::SADsp::WindowType &windowType
                        , SAUIInterface *ui
                        );
 QString windowTypeToString(SA::SADsp::WindowType windowType);
+bool preprocessWave(SAAbstractDatas* data,bool isDetrend,SA::SADsp::WindowType window
+                    ,std::shared_ptr<SAAbstractDatas>& wave);
+QStringList plotInNewFigure(SAUIInterface* ui,const QString& figureTitle,const QList<SAXYSeriesData>& curves
+                            ,const QString& titleFormat,QStringList& lineNameList);
 QString magTypeToString(SA::SADsp::SpectrumType magType);
 QString psdTypeToString(SA::SADsp::PowerDensityWay psd);
 
@@ -75,15 +82,15 @@ void detrendDirectInValue(SAUIInterface* ui)
     {
         return;
     }
-    std::shared_ptr<SAAbstractDatas> res = saFun::detrendDirect(data);
-    if(nullptr == res)
-    {
-        ui->showErrorMessageInfo(saFun::getLastErrorString());
-        return;
-    }
-    QString info = TR("direct detrend :%1").arg(data->getName());
-    saValueManager->addData(res);
-    ui->showMessageInfo(info,SA::NormalMessage);
+    auto res = std::make_shared<std::shared_ptr<SAAbstractDatas> >();
+    runFunTask(ui,TR("direct detrend"),data->getSize()
+               ,[data,res](SAFunTaskContext&)->bool{
+        *res = saFun::detrendDirect(data);
+        return (nullptr != *res);
+    },[ui,data,res](){
+        saValueManager->addData(*res);
+        ui->showMessageInfo(TR("direct detrend :%1").arg(data->getName()),SA::NormalMessage);
+    });
 }
 ///
 /// \brief 应用于图表的去趋势
@@ -98,97 +105,33 @@ void detrendDirectInChart(SAUIInterface* ui)
         ui->showMessageInfo(TR("unsupport chart items"),SA::WarningMessage);
         return;
     }
-    QString info = TR("direct detrend :");
-    SAFigureOptCommand* topCmd = new SAFigureOptCommand(chart,TR("detrend Direct"));
-    for (int i = 0;i<curs.size();++i)
-    {
-        QwtPlotItem* item = curs[i];
-        switch(item->rtti())
-        {
-        case QwtPlotItem::Rtti_PlotCurve:
-        {
-            QVector<QPointF> newData;
-            QwtPlotCurve* cur = static_cast<QwtPlotCurve*>(item);
-            SAChart::getXYDatas(newData,cur);
-            SA::sub_mean(newData.begin(),newData.end()
-                                ,[](QPointF& p)->double&{return p.ry();});
-            new SAFigureReplaceAllDatasCommand<QPointF,QwtPlotCurve,decltype(&SAChart::setPlotCurveSample)>
-                    (chart
-                   ,item
-                   ,newData
-                   ,TR("detrend Direct %1").arg(item->title().text())
-                   ,&SAChart::setPlotCurveSample
-                   ,&SAChart::getPlotCurveSample
-                   ,topCmd
-                   );
-            break;
-        }
-        }
-
-
-
-
-
-
-
-/*
-        QwtSeriesStore<QPointF>* series = dynamic_cast<QwtSeriesStore<QPointF>*>(item);
-        if(nullptr == series)
+    auto curves = std::make_shared<QList<SAXYSeriesData> >(get_xy_series_datas(chart,curs,true,false));
+    runFunTask(ui,TR("detrend Direct"),xy_series_data_count(*curves)
+               ,[curves](SAFunTaskContext& ctx)->bool{
+        for(int i=0;i<curves->size() && !ctx.isCanceled();++i)
         {
-            continue;
+            saFun::detrendDirect((*curves)[i].ys);
+            ctx.setProgress(i+1,curves->size());
         }
-
-        QVector<QPointF> newData;
-        if(chart->isRegionVisible())
+        return true;
+    },[ui,chart,curves](){
+        QString info = TR("direct detrend :");
+        QScopedPointer<SAFigureOptCommand> topCmd(new SAFigureOptCommand(chart,TR("detrend Direct")));
+        for(const SAXYSeriesData& d : *curves)
         {
-            QVector<double> xs,ys;
-            QVector<int> index;
-            if(!chart->getXYDataInRange(&xs,&ys,&index,item))
-            {
-                continue;
-            }
-
-            if(!chart->getXYData(newData,item))
-            {
-                continue;
-            }
-            const int dataSize = newData.size();
-            const int indexSize = index.size();
-            const int ysSize = ys.size();
-            if(indexSize <= 0)
-            {
-                continue;
-            }
-            saFun::detrendDirect(ys);
-            for(int i=0;i<indexSize && i<ysSize;++i)
-            {
-                if(index[i] < dataSize)
-                {
-                    newData[index[i]].ry() = ys[i];
-                }
-            }
+            QVector<QPointF> newData;
+            saFun::makeVectorPointF(d.xs,d.ys,newData);
+            append_replace_curve_datas_command(chart,d.item,newData
+                                               ,TR("detrend Direct %1").arg(d.title),topCmd.data());
+            info += d.title;
+            info += " ";
         }
-        else
+        if(topCmd->childCount() > 0)
         {
-            QVector<double> xs,ys;
-            if(!chart->getXYData(&xs,&ys,item))
-            {
-                continue;
-            }
-            saFun::detrendDirect(ys);
-            saFun::makeVectorPointF(xs,ys,newData);
+            chart->appendCommand(topCmd.take());
+            ui->showMessageInfo(info,SA::NormalMessage);
         }
-        new SAFigureChangeXYSeriesDataCommand(chart
-                                             ,series
-                                             ,TR("detrend Direct %1").arg(item->title().text())
-                                             ,newData
-                                             ,topCmd);
-        info += item->title().text();
-        info += " ";
-        */
-    }
-    chart->appendCommand(topCmd);
-    ui->showMessageInfo(info,SA::NormalMessage);
+    });
 }
 
 ///
@@ -196,51 +139,37 @@ void detrendDirectInChart(SAUIInterface* ui)
 ///
 void setWindowToWaveInValue(SAUIInterface* ui)
 {
-    SAAbstractDatas* data = ui->getSelectSingleData();
+    SAAbstractDatas* data = get_select_wave(ui,TR("set window"));
     if(nullptr == data)
     {
         return;
     }
-    if(data->getDim() != 1)
-    {
-        ui->showWarningMessageInfo(TR("data:[\"%1\"] type is not accept to set window").arg(data->getName()));
-        return;
-    }
-    int dataSize = data->getSize(SA::Dim1);
-    if(dataSize <= 1)
-    {
-        ui->showWarningMessageInfo(TR("data:[\"%1\"] size is too short").arg(data->getName()));
-        return;
-    }
-
     bool isDetrend = false;
     SA::SADsp::WindowType window = SA::SADsp::WindowRect;
     if(!getWindowProperty(window,isDetrend,ui))
     {
         return;
     }
-    std::shared_ptr<SAAbstractDatas> res;
-    if(isDetrend)
-    {
-        res = saFun::detrendDirect(data);
-        res = saFun::setWindow(res.get(),window);
-    }
-    else
-    {
-        res = saFun::setWindow(data,window);
-    }
-
-    if(nullptr == res)
-    {
-        ui->showErrorMessageInfo(saFun::getLastErrorString());
-        ui->raiseMessageInfoDock();
-        return;
-    }
-    saValueManager->addData(res);
-    ui->showNormalMessageInfo(TR("data:[\"%1\"] set window(%2)] -> [\"%3\"]")
-                                .arg(data->getName())
-                                .arg(windowTypeToString(window))
-                                .arg(res->getName()));
+    auto res = std::make_shared<std::shared_ptr<SAAbstractDatas> >();
+    runFunTask(ui,TR("set window"),data->getSize()
+               ,[data,isDetrend,window,res](SAFunTaskContext&)->bool{
+        if(isDetrend)
+        {
+            *res = saFun::detrendDirect(data);
+            *res = (*res) ? saFun::setWindow(res->get(),window) : nullptr;
+        }
+        else
+        {
+            *res = saFun::setWindow(data,window);
+        }
+        return (nullptr != *res);
+    },[ui,data,window,res](){
+        saValueManager->addData(*res);
+        ui->showNormalMessageInfo(TR("data:[\"%1\"] set window(%2)] -> [\"%3\"]")
+                                    .arg(data->getName())
+                                    .arg(windowTypeToString(window))
+                                    .arg((*res)->getName()));
+    });
 }
 ///
 /// \brief 信号设置窗
@@ -261,69 +190,39 @@ void setWindowToWaveInChart(SAUIInterface* ui)
         return;
     }
     QString windowName = windowTypeToString(window);
-    QString info = TR("Set %1 ").arg(windowName);
-    SAFigureOptCommand* topCmd = new SAFigureOptCommand(chart,info);
-    info += ":";
-    for (int i = 0;i<curs.size();++i)
-    {
-        QwtPlotItem* item = curs[i];
-        switch(item->rtti())
+    auto curves = std::make_shared<QList<SAXYSeriesData> >(get_xy_series_datas(chart,curs,true,false));
+    runFunTask(ui,TR("Set %1").arg(windowName),xy_series_data_count(*curves)
+               ,[curves,isDetrend,window](SAFunTaskContext& ctx)->bool{
+        for(int i=0;i<curves->size() && !ctx.isCanceled();++i)
         {
-        case QwtPlotItem::Rtti_PlotCurve:
-        {
-
-            QwtPlotCurve* cur = static_cast<QwtPlotCurve*>(item);
-            QVector<QPointF> newData;
+            QVector<double>& ys = (*curves)[i].ys;
+            if(isDetrend)
             {
-                QVector<double> xs,ys;
-                SAChart::getXYDatas(&xs,&ys,cur);
-                saFun::setWindow(ys,window);
-                if(isDetrend)
-                {
-                    saFun::detrendDirect(ys);
-                }
-                saFun::setWindow(ys,window);
-                saFun::makeVectorPointF(xs,ys,newData);
+                saFun::detrendDirect(ys);
             }
-            new SAFigureReplaceAllDatasCommand<QPointF,QwtPlotCurve,decltype(&SAChart::setPlotCurveSample)>
-                    (chart
-                   ,item
-                   ,newData
-                   ,TR("%1 set %2").arg(item->title().text()).arg(windowName)
-                   ,&SAChart::setPlotCurveSample
-                   ,&SAChart::getPlotCurveSample
-                   ,topCmd
-                   );
-            break;
-        }
+            saFun::setWindow(ys,window);
+            ctx.setProgress(i+1,curves->size());
         }
-        /*
-        QwtPlotItem* item = curs[i];
-        QwtSeriesStore<QPointF>* series = dynamic_cast<QwtSeriesStore<QPointF>*>(item);
-        if(nullptr == series)
+        return true;
+    },[ui,chart,curves,windowName](){
+        QString info = TR("Set %1 ").arg(windowName);
+        QScopedPointer<SAFigureOptCommand> topCmd(new SAFigureOptCommand(chart,info));
+        info += ":";
+        for(const SAXYSeriesData& d : *curves)
         {
-            continue;
+            QVector<QPointF> newData;
+            saFun::makeVectorPointF(d.xs,d.ys,newData);
+            append_replace_curve_datas_command(chart,d.item,newData
+                                               ,TR("%1 set %2").arg(d.title).arg(windowName),topCmd.data());
+            info += d.title;
+            info += " ";
         }
-        QVector<double> xs,ys;
-        SAChart::getXYDatas(&xs,&ys,series);
-        if(isDetrend)
+        if(topCmd->childCount() > 0)
         {
-            saFun::detrendDirect(ys);
+            chart->appendCommand(topCmd.take());
+            ui->showMessageInfo(info,SA::NormalMessage);
         }
-        saFun::setWindow(ys,window);
-        QVector<QPointF> xys;
-        saFun::makeVectorPointF(xs,ys,xys);
-        new SAFigureChangeXYSeriesDataCommand(chart
-                                             ,series
-                                             ,TR("%1 set %2").arg(item->title().text()).arg(windowName)
-                                             ,xys
-                                             ,topCmd);
-        info += item->title().text();
-        info += " ";
-        */
-    }
-    chart->appendCommand(topCmd);
-    ui->showMessageInfo(info,SA::NormalMessage);
+    });
 }
 
 
@@ -342,24 +241,12 @@ void powerSpectrum(SAUIInterface* ui)
 
 void spectrumInValue(SAUIInterface* ui)
 {
-    SAAbstractDatas* data = ui->getSelectSingleData();
+    SAAbstractDatas* data = get_select_wave(ui,TR("spectrum"));
     if(nullptr == data)
     {
         return;
     }
-    if(data->getDim() != 1)
-    {
-        ui->showWarningMessageInfo(TR("data:[\"%1\"] type is not accept to spectrum").arg(data->getName()));
-        ui->raiseMessageInfoDock();
-        return;
-    }
-    int dataSize = data->getSize(SA::Dim1);
-    if(dataSize <= 1)
-    {
-        ui->showWarningMessageInfo(TR("data:[\"%1\"] size is too short").arg(data->getName()));
-        ui->raiseMessageInfoDock();
-        return;
-    }
+    const int dataSize = data->getSize(SA::Dim1);
     int fftsize = 100;
     double fs=100;
     bool isDetrend = false;
@@ -369,55 +256,35 @@ void spectrumInValue(SAUIInterface* ui)
     {
         return;
     }
-
-
-    std::shared_ptr<SAAbstractDatas> preTrendData = nullptr;
-    if(isDetrend)//dlg.getData(3).toBool())
-    {
-        preTrendData = saFun::detrendDirect(preTrendData.get() ? preTrendData.get() : data);
-        if(nullptr == preTrendData)
-        {
-            ui->showErrorMessageInfo(saFun::getLastErrorString());
-            ui->raiseMessageInfoDock();
-            return;
-        }
-    }
-    if(SA::SADsp::WindowRect != window)//窗函数设置
+    struct Result
     {
-        preTrendData = saFun::setWindow(preTrendData.get() ? preTrendData.get() : data
-                                                             ,window);
-        if(nullptr == preTrendData)
+        std::shared_ptr<SAVectorDouble> fre;
+        std::shared_ptr<SAVectorDouble> mag;
+    };
+    auto res = std::make_shared<Result>();
+    runFunTask(ui,TR("spectrum"),qMax(dataSize,fftsize)
+               ,[=](SAFunTaskContext&)->bool{
+        std::shared_ptr<SAAbstractDatas> wave;
+        if(!preprocessWave(data,isDetrend,window,wave))
         {
-            ui->showErrorMessageInfo(saFun::getLastErrorString());
-            ui->raiseMessageInfoDock();
-            return;
+            return false;
         }
-    }
-    std::shared_ptr<SAVectorDouble> fre = nullptr;
-    std::shared_ptr<SAVectorDouble> mag = nullptr;
-
-    std::tie(fre,mag) = saFun::spectrum( preTrendData.get() ? preTrendData.get() : data
-                                             ,fs//dlg.getData(0).toDouble()
-                                             ,fftsize//dlg.getData(1).toInt()
-                                             ,magType
-                                             );
-    if(nullptr == fre || nullptr == mag)
-    {
-        ui->showErrorMessageInfo(saFun::getLastErrorString());
-        return;
-    }
-    saValueManager->addData(fre);
-    saValueManager->addData(mag);
-    QString info = TR("fft(data=[\"%1\"], fftsize=%2,fs=%3,magType=%4,window=%5) -> [fre=\"%6\",mag=\"%7\"]")
-            .arg(data->getName())
-            .arg(fftsize)
-            .arg(fs)
-            .arg(magTypeToString(magType))
-            .arg(windowTypeToString(window))
-            .arg(fre->getName())
-            .arg(mag->getName())
-            ;
-    ui->showNormalMessageInfo(info);
+        std::tie(res->fre,res->mag) = saFun::spectrum(wave ? wave.get() : data,fs,fftsize,magType);
+        return (nullptr != res->fre && nullptr != res->mag);
+    },[=](){
+        saValueManager->addData(res->fre);
+        saValueManager->addData(res->mag);
+        QString info = TR("fft(data=[\"%1\"], fftsize=%2,fs=%3,magType=%4,window=%5) -> [fre=\"%6\",mag=\"%7\"]")
+                .arg(data->getName())
+                .arg(fftsize)
+                .arg(fs)
+                .arg(magTypeToString(magType))
+                .arg(windowTypeToString(window))
+                .arg(res->fre->getName())
+                .arg(res->mag->getName())
+                ;
+        ui->showNormalMessageInfo(info);
+    });
 }
 
 void spectrumInChart(SAUIInterface* ui)
@@ -439,83 +306,39 @@ void spectrumInChart(SAUIInterface* ui)
     {
         return;
     }
-    QStringList lineNameList,newLineNameList;
-    ui->raiseMainDock();
-    SAMdiSubWindow* sub = ui->createFigureWindow(QString("%1-fft").arg(ui->getCurrentActiveSubWindow()->windowTitle()));
-    SAFigureWindow* w = ui->getFigureWidgetFromMdiSubWindow(sub);
-    chart = w->create2DPlot();
-
-
-
-    for (int i = 0;i<curs.size();++i)
-    {
-        QwtPlotItem* item = curs[i];
-        QString title = item->title().text();
-        switch(item->rtti())
-        {
-        case QwtPlotItem::Rtti_PlotCurve:
+    const QString figureTitle = QString("%1-fft").arg(ui->getCurrentActiveSubWindow()->windowTitle());
+    //计算后ys为幅值，xs为频率
+    auto curves = std::make_shared<QList<SAXYSeriesData> >(get_xy_series_datas(chart,curs,true,false));
+    runFunTask(ui,TR("spectrum"),xy_series_data_count(*curves)
+               ,[=](SAFunTaskContext& ctx)->bool{
+        for(int i=0;i<curves->size() && !ctx.isCanceled();++i)
         {
-            QVector<double> ys;
-            {
-                QVector<QPointF> wave;
-                SAChart::getPlotCurveSample(item,wave);
-                ys.reserve(wave.size());
-                std::for_each(wave.begin(),wave.end(),[&ys](const QPointF& p){ys.push_back(p.y());});
-            }
+            SAXYSeriesData& d = (*curves)[i];
             if(isDetrend)
             {
-                saFun::detrendDirect(ys);
+                saFun::detrendDirect(d.ys);
             }
+            saFun::setWindow(d.ys,window);
+            int fftsize = SA::SADsp::nextPow2Value(d.ys.size());//获取最优的fft尺寸
             QVector<double> mag,fre;
-            saFun::setWindow(ys,window);
-            int fftsize = SA::SADsp::nextPow2Value(ys.size());//获取最优的fft尺寸
-            saFun::spectrum(ys,fs,fftsize,magType,fre,mag);
-            QwtPlotCurve * c = chart->addCurve(fre,mag);
-            if(c)
-            {
-                c->setTitle(QString("%1-fft").arg(title));
-                newLineNameList.append(c->title().text());
-            }
-            lineNameList.append(title);
-            break;
-        }
-        }
-
-        /*
-        QwtSeriesStore<QPointF>* series = dynamic_cast<QwtSeriesStore<QPointF>*>(item);
-        if(nullptr == series)
-        {
-            continue;
-        }
-        QString title = item->title().text();
-        QVector<double> ys;
-        SAChart::getXYDatas(nullptr,&ys,series);
-        if(isDetrend)
-        {
-            saFun::detrendDirect(ys);
+            saFun::spectrum(d.ys,fs,fftsize,magType,fre,mag);
+            d.xs.swap(fre);
+            d.ys.swap(mag);
+            ctx.setProgress(i+1,curves->size());
         }
-        QVector<double> mag,fre;
-        saFun::setWindow(ys,window);
-        int fftsize = czy::SADsp::nextPow2Value(ys.size());//获取最优的fft尺寸
-        saFun::spectrum(ys,fs,fftsize,magType,fre,mag);
-        QwtPlotCurve * c = chart->addCurve(fre,mag);
-        if(c)
-        {
-            c->setTitle(QString("%1-fft").arg(title));
-            newLineNameList.append(c->title().text());
-        }
-        lineNameList.append(title);
-        */
-    }
-    QString info = TR("fft(data=[\"%1\"],fs=%2,magType=%3,window=%4) -> [figure=\"%5\"]")
-            .arg(lineNameList.join(","))
-            .arg(fs)
-            .arg(magTypeToString(magType))
-            .arg(windowTypeToString(window))
-            .arg(newLineNameList.join(","))
-            ;
-    ui->showNormalMessageInfo(info);
-    sub->show();
+        return true;
+    },[=](){
+        QStringList lineNameList;
+        QStringList newLineNameList = plotInNewFigure(ui,figureTitle,*curves,"%1-fft",lineNameList);
+        QString info = TR("fft(data=[\"%1\"],fs=%2,magType=%3,window=%4) -> [figure=\"%5\"]")
+                .arg(lineNameList.join(","))
+                .arg(fs)
+                .arg(magTypeToString(magType))
+                .arg(windowTypeToString(window))
+                .arg(newLineNameList.join(","))
+                ;
+        ui->showNormalMessageInfo(info);
+    });
 }
 ///
 /// \brief 获取频谱分析的设置
@@ -611,27 +434,12 @@ bool getSpectrumProperty(double* samFre
 ///
 void powerSpectrumInValue(SAUIInterface* ui)
 {
-    SAAbstractDatas* data = ui->getSelectSingleData();
+    SAAbstractDatas* data = get_select_wave(ui,TR("psd"));
     if(nullptr == data)
     {
         return;
     }
-    if(data->getDim() != 1)
-    {
-        ui->showWarningMessageInfo(TR("data:[\"%1\"] type is not accept to psd").arg(data->getName()));
-        ui->raiseMessageInfoDock();
-        return;
-    }
-    int dataSize = data->getSize(SA::Dim1);
-    if(dataSize <= 1)
-    {
-        ui->showWarningMessageInfo(TR("data:[\"%1\"] size is too short").arg(data->getName()));
-        ui->raiseMessageInfoDock();
-        return;
-    }
-
-
-
+    const int dataSize = data->getSize(SA::Dim1);
     SA::SADsp::PowerDensityWay dspType = SA::SADsp::MSA;
     SA::SADsp::WindowType window = SA::SADsp::WindowRect;
     double fs=100;
@@ -642,70 +450,52 @@ void powerSpectrumInValue(SAUIInterface* ui)
     {
         return;
     }
-    std::shared_ptr<SAAbstractDatas> preTrendData = nullptr;
-    if(isDetrend)
+    struct Result
     {
-        preTrendData = saFun::detrendDirect(preTrendData.get() ? preTrendData.get() : data);
-        if(nullptr == preTrendData)
+        std::shared_ptr<SAVectorDouble> fre;
+        std::shared_ptr<SAVectorDouble> mag;
+    };
+    auto res = std::make_shared<Result>();
+    runFunTask(ui,TR("psd"),qMax(dataSize,fftsize)
+               ,[=](SAFunTaskContext&)->bool{
+        std::shared_ptr<SAAbstractDatas> wave;
+        if(!preprocessWave(data,isDetrend,window,wave))
         {
-            ui->showErrorMessageInfo(saFun::getLastErrorString());
-            ui->raiseMessageInfoDock();
-            return;
+            return false;
         }
-    }
-    if(SA::SADsp::WindowRect != window)//窗函数设置
-    {
-        preTrendData = saFun::setWindow(preTrendData.get() ? preTrendData.get() : data
-                                                             ,window);
-        if(nullptr == preTrendData)
+        std::tie(res->fre,res->mag) = saFun::powerSpectrum(wave ? wave.get() : data,fs,fftsize,dspType,ti);
+        return (nullptr != res->fre && nullptr != res->mag);
+    },[=](){
+        saValueManager->addData(res->fre);
+        saValueManager->addData(res->mag);
+        QString info;
+        if(SA::SADsp::TISA == dspType)
         {
-            ui->showErrorMessageInfo(saFun::getLastErrorString());
-            ui->raiseMessageInfoDock();
-            return;
+            info = TR("psd(data=[\"%1\"], fftsize=%2,fs=%3,window=%4,psdType=%5,ti=%6) -> [fre=\"%7\",mag=\"%8\"]")
+                    .arg(data->getName())
+                    .arg(fftsize)
+                    .arg(fs)
+                    .arg(windowTypeToString(window))
+                    .arg(psdTypeToString(dspType))
+                    .arg(ti)
+                    .arg(res->fre->getName())
+                    .arg(res->mag->getName())
+                    ;
         }
-    }
-    std::shared_ptr<SAVectorDouble> fre = nullptr;
-    std::shared_ptr<SAVectorDouble> mag = nullptr;
-    std::tie(fre,mag) = saFun::powerSpectrum(preTrendData.get() ? preTrendData.get() : data
-                                             ,fs
-                                             ,fftsize
-                                             ,dspType
-                                             ,ti);
-    if(nullptr == fre || nullptr == mag)
-    {
-        ui->showErrorMessageInfo(saFun::getLastErrorString());
-        ui->raiseMessageInfoDock();
-        return;
-    }
-    saValueManager->addData(fre);
-    saValueManager->addData(mag);
-    QString info;
-    if(SA::SADsp::TISA == dspType)
-    {
-        info = TR("psd(data=[\"%1\"], fftsize=%2,fs=%3,window=%4,psdType=%5,ti=%6) -> [fre=\"%7\",mag=\"%8\"]")
-                .arg(data->getName())
-                .arg(fftsize)
-                .arg(fs)
-                .arg(windowTypeToString(window))
-                .arg(psdTypeToString(dspType))
-                .arg(ti)
-                .arg(fre->getName())
-                .arg(mag->getName())
-                ;
-    }
-    else
-    {
-        info = TR("psd(data=[\"%1\"], fftsize=%2,fs=%3,window=%4,psdType=%5) -> [fre=\"%6\",mag=\"%7\"]")
-                .arg(data->getName())
-                .arg(fftsize)
-                .arg(fs)
-                .arg(windowTypeToString(window))
-                .arg(psdTypeToString(dspType))
-                .arg(fre->getName())
-                .arg(mag->getName())
-                ;
-    }
-    ui->showNormalMessageInfo(info);
+        else
+        {
+            info = TR("psd(data=[\"%1\"], fftsize=%2,fs=%3,window=%4,psdType=%5) -> [fre=\"%6\",mag=\"%7\"]")
+                    .arg(data->getName())
+                    .arg(fftsize)
+                    .arg(fs)
+                    .arg(windowTypeToString(window))
+                    .arg(psdTypeToString(dspType))
+                    .arg(res->fre->getName())
+                    .arg(res->mag->getName())
+                    ;
+        }
+        ui->showNormalMessageInfo(info);
+    });
 }
 
 void powerSpectrumInChart(SAUIInterface* ui)
@@ -726,94 +516,54 @@ void powerSpectrumInChart(SAUIInterface* ui)
     {
         return;
     }
-    QStringList lineNameList,newLineNameList;
-    ui->raiseMainDock();
-    SAMdiSubWindow* sub = ui->createFigureWindow(QString("%1-fft").arg(ui->getCurrentActiveSubWindow()->windowTitle()));
-    SAFigureWindow* w = ui->getFigureWidgetFromMdiSubWindow(sub);
-    chart = w->create2DPlot();
-    for (int i = 0;i<curs.size();++i)
-    {
-        QwtPlotItem* item = curs[i];
-        QString title = item->title().text();
-        switch(item->rtti())
-        {
-        case QwtPlotItem::Rtti_PlotCurve:
+    const QString figureTitle = QString("%1-fft").arg(ui->getCurrentActiveSubWindow()->windowTitle());
+    //计算后ys为功率谱，xs为频率
+    auto curves = std::make_shared<QList<SAXYSeriesData> >(get_xy_series_datas(chart,curs,true,false));
+    runFunTask(ui,TR("psd"),xy_series_data_count(*curves)
+               ,[=](SAFunTaskContext& ctx)->bool{
+        for(int i=0;i<curves->size() && !ctx.isCanceled();++i)
         {
-            QVector<double> ys;
-            {
-                QVector<QPointF> wave;
-                SAChart::getPlotCurveSample(item,wave);
-                ys.reserve(wave.size());
-                std::for_each(wave.begin(),wave.end(),[&ys](const QPointF& p){ys.push_back(p.y());});
-            }
+            SAXYSeriesData& d = (*curves)[i];
             if(isDetrend)
             {
-                saFun::detrendDirect(ys);
+                saFun::detrendDirect(d.ys);
             }
+            saFun::setWindow(d.ys,window);
+            int fftsize = SA::SADsp::nextPow2Value(d.ys.size());//获取最优的fft尺寸
             QVector<double> mag,fre;
-            saFun::setWindow(ys,window);
-            int fftsize = SA::SADsp::nextPow2Value(ys.size());//获取最优的fft尺寸
-            saFun::powerSpectrum(ys,fs,fftsize,dspType,fre,mag,ti);
-            QwtPlotCurve * c = chart->addCurve(fre,mag);
-            if(c)
-            {
-                c->setTitle(QString("%1-psd").arg(title));
-                newLineNameList.append(c->title().text());
-            }
-            lineNameList.append(title);
-            break;
-        }
+            saFun::powerSpectrum(d.ys,fs,fftsize,dspType,fre,mag,ti);
+            d.xs.swap(fre);
+            d.ys.swap(mag);
+            ctx.setProgress(i+1,curves->size());
         }
-        /*
-        QwtSeriesStore<QPointF>* series = dynamic_cast<QwtSeriesStore<QPointF>*>(item);
-        if(nullptr == series)
+        return true;
+    },[=](){
+        QStringList lineNameList;
+        QStringList newLineNameList = plotInNewFigure(ui,figureTitle,*curves,"%1-psd",lineNameList);
+        QString info;
+        if(SA::SADsp::TISA == dspType)
         {
-            continue;
+            info = TR("psd(data=[\"%1\"],fs=%2,window=%3,psdType=%4,ti=%5) -> [figure=\"%6\"]")
+                    .arg(lineNameList.join(","))
+                    .arg(fs)
+                    .arg(windowTypeToString(window))
+                    .arg(psdTypeToString(dspType))
+                    .arg(ti)
+                    .arg(newLineNameList.join(","))
+                    ;
         }
-        QString title = item->title().text();
-        QVector<double> ys;
-        SAChart::getXYDatas(nullptr,&ys,series);
-        if(isDetrend)
-        {
-            saFun::detrendDirect(ys);
-        }
-        QVector<double> mag,fre;
-        saFun::setWindow(ys,window);
-        int fftsize = czy::SADsp::nextPow2Value(ys.size());//获取最优的fft尺寸
-        saFun::powerSpectrum(ys,fs,fftsize,dspType,fre,mag,ti);
-        QwtPlotCurve * c = chart->addCurve(fre,mag);
-        if(c)
+        else
         {
-            c->setTitle(QString("%1-psd").arg(title));
-            newLineNameList.append(c->title().text());
+            info = TR("psd(data=[\"%1\"],fs=%2,window=%3,psdType=%4) -> [figure=\"%5\"]")
+                    .arg(lineNameList.join(","))
+                    .arg(fs)
+                    .arg(windowTypeToString(window))
+                    .arg(psdTypeToString(dspType))
+                    .arg(newLineNameList.join(","))
+                    ;
         }
-        lineNameList.append(title);
-        */
-    }
-    QString info;
-    if(SA::SADsp::TISA == dspType)
-    {
-        info = TR("psd(data=[\"%1\"],fs=%2,window=%3,psdType=%4,ti=%5) -> [figure=\"%6\"]")
-                .arg(lineNameList.join(","))
-                .arg(fs)
-                .arg(windowTypeToString(window))
-                .arg(psdTypeToString(dspType))
-                .arg(ti)
-                .arg(newLineNameList.join(","))
-                ;
-    }
-    else
-    {
-        info = TR("psd(data=[\"%1\"],fs=%2,window=%3,psdType=%4) -> [figure=\"%5\"]")
-                .arg(lineNameList.join(","))
-                .arg(fs)
-                .arg(windowTypeToString(window))
-                .arg(psdTypeToString(dspType))
-                .arg(newLineNameList.join(","))
-                ;
-    }
-    ui->showNormalMessageInfo(info);
-    sub->show();
+        ui->showNormalMessageInfo(info);
+    });
 }
 
 bool getPowerSpectrumProperty(double *samFre
@@ -976,6 +726,67 @@ bool getWindowProperty(SA::SADsp::WindowType & windowType, bool &isDetrend, SAUI
     return true;
 }
 
+///
+/// \brief 频谱分析前对数据去趋势和加窗
+/// \param data 原始数据
+/// \param isDetrend 是否去趋势
+/// \param window 窗类型，矩形窗不处理
+/// \param wave 处理后的数据，不需要处理时为nullptr
+/// \return 处理失败返回false
+///
+bool preprocessWave(SAAbstractDatas *data, bool isDetrend, SA::SADsp::WindowType window
+                    , std::shared_ptr<SAAbstractDatas> &wave)
+{
+    wave = nullptr;
+    if(isDetrend)
+    {
+        wave = saFun::detrendDirect(data);
+        if(nullptr == wave)
+        {
+            return false;
+        }
+    }
+    if(SA::SADsp::WindowRect != window)//窗函数设置
+    {
+        wave = saFun::setWindow(wave ? wave.get() : data,window);
+        if(nullptr == wave)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+///
+/// \brief 在新的绘图窗口中绘制曲线的计算结果
+/// \param ui
+/// \param figureTitle 绘图窗口的标题
+/// \param curves 计算结果，xs、ys为绘制的数据
+/// \param titleFormat 新曲线标题的格式，%1为原曲线标题
+/// \param lineNameList 原曲线的标题
+/// \return 新曲线的标题
+///
+QStringList plotInNewFigure(SAUIInterface *ui, const QString &figureTitle, const QList<SAXYSeriesData> &curves
+                            , const QString &titleFormat, QStringList &lineNameList)
+{
+    QStringList newLineNameList;
+    ui->raiseMainDock();
+    SAMdiSubWindow* sub = ui->createFigureWindow(figureTitle);
+    SAFigureWindow* w = ui->getFigureWidgetFromMdiSubWindow(sub);
+    SAChart2D* chart = w->create2DPlot();
+    for(const SAXYSeriesData& d : curves)
+    {
+        QwtPlotCurve * c = chart->addCurve(d.xs,d.ys);
+        if(c)
+        {
+            c->setTitle(titleFormat.arg(d.title));
+            newLineNameList.append(c->title().text());
+        }
+        lineNameList.append(d.title);
+    }
+    sub->show();
+    return newLineNameList;
+}
+
 QString windowTypeToString(SA::SADsp::WindowType windowType)
 {
     return saFun::windowName(windowType);
@@ -14,6 +14,7 @@
 #include "qwt_series_store.h"
 #include "SAGUIGlobalConfig.h"
 #include "ui_opt.h"
+#include "SAFunTask.h"
 #include <QApplication>
 #include "SADataConver.h"
 #define TR(str)\
@@ -21,6 +22,21 @@
 void polyfitInChart(SAUIInterface* ui);
 void polyfitInValue(SAUIInterface* ui);
 bool getPolyfitConfig(int &order,SAUIInterface* ui);
+QString polyfitDescription(const QString& title,int order,const SAVectorDouble* factor,const SATableVariant* info);
+///
+/// \brief 一组数据的拟合结果
+///
+struct PolyfitResult
+{
+    QString title;
+    std::shared_ptr<SAVectorDouble> factor;///< 拟合的系数
+    std::shared_ptr<SATableVariant> info;///< 拟合的误差参数
+    std::shared_ptr<SAVectorPointF> value;///< 拟合值
+};
+bool polyfitXY(const QString& title,const QVector<double>& xs,const QVector<double>& ys,int order,PolyfitResult& res);
+bool polyfitValue(const QString& title,const QVector<double>& xs,int order,PolyfitResult& res);
+QList<QList<int> > groupSameXs(const QList<SAXYSeriesData>& datas);
+void commitPolyfitResult(const PolyfitResult& res,int order,QString& des);
 void splitPointF(const QVector<QPointF>& xys,QVector<double>& xs,QVector<double>& ys);
 void splitPointF(const QVector<QPointF>& xys,QVector<double>& xs,QVector<double>& ys)
 {
@@ -61,97 +77,54 @@ void polyfitInChart(SAUIInterface* ui)
     {
         return;
     }
-
-    QString strDes("");
-    for (int i = 0;i<curs.size();++i)
-    {
-        QwtPlotItem* item = curs[i];
-        QVector<double> xs,ys;
-        if(chart->isRegionVisible())
+    auto curves = std::make_shared<QList<SAXYSeriesData> >(get_xy_series_datas(chart,curs,false,true));
+    auto results = std::make_shared<QList<PolyfitResult> >();
+    runFunTask(ui,TR("Polynomial Fittin"),xy_series_data_count(*curves)
+               ,[curves,results,order](SAFunTaskContext& ctx)->bool{
+        //x相同的曲线为一组，一组只分解一次x，组内并行拟合
+        const QList<QList<int> > groups = groupSameXs(*curves);
+        QVector<PolyfitResult> fits(curves->size());
+        QVector<bool> isOK(curves->size(),false);
+        int finished = 0;
+        for(int g=0;g<groups.size() && !ctx.isCanceled();++g)
         {
-            if(!chart->getXYDataInRange(&xs,&ys,nullptr,item))
+            const QList<int>& group = groups[g];
+            const QVector<double>& xs = curves->at(group.first()).xs;
+            QList<QVector<double> > yss;
+            for(int i : group)
             {
-                continue;
+                yss.append(curves->at(i).ys);
             }
+            const auto factors = saFun::polyfit(xs,yss,order);
+            for(int k=0;k<group.size();++k)
+            {
+                const int i = group[k];
+                std::tie(fits[i].factor,fits[i].info) = factors[k];
+                isOK[i] = polyfitValue(curves->at(i).title,xs,order,fits[i]);
+            }
+            finished += group.size();
+            ctx.setProgress(finished,curves->size());
         }
-        else
+        for(int i=0;i<fits.size();++i)
         {
-            if(!chart->getXYData(&xs,&ys,item))
+            if(isOK[i])
             {
-                continue;
+                results->append(fits[i]);
             }
         }
-        QString title = item->title().text();
-
-        std::shared_ptr<SAVectorDouble> factor;//拟合的系数
-        std::shared_ptr<SATableVariant> info;//拟合的误差参数
-        std::tie(factor,info) = saFun::polyfit(xs,ys,order);
-        if(nullptr == factor)
+        return true;
+    },[ui,chart,results,order](){
+        QString strDes;
+        for(const PolyfitResult& res : *results)
         {
-            continue;
+            commitPolyfitResult(res,order,strDes);
+            chart->addCurve(res.value.get());
         }
-        info->setName(QString("%1_%2PolyFitInfo").arg(title).arg(order));
-        std::shared_ptr<SAVectorPointF> pfitVal = SAValueManager::makeData<SAVectorPointF>(QString("%1_%2PolyFit").arg(title).arg(order));
-        saFun::polyval(xs,factor.get(),pfitVal.get());
-        saValueManager->addData(info);
-        saValueManager->addData(pfitVal);
-        //
-        strDes += "<p>";
-        strDes += TR("%1-Polynomial Fittin, order:%2 ")
-                .arg(title).arg(order);
-        strDes += "<br/>";
-        const size_t factorSize = factor->getSize();
-        QString fun;
-        for (size_t j = 0;j<factorSize;++j)
+        if(!strDes.isEmpty())
         {
-            double f = factor->getAt({j}).toDouble();
-            if (0 == j)
-            {
-                fun = QString("y = %1").arg(factor->getAt({j}).toString());
-                continue;
-            }
-            if (1 == j)
-            {
-                if (f>0)
-                    fun += QString("+%1x").arg(f);
-                else
-                    fun += QString("%1x").arg(f);
-                continue;
-            }
-            if(f>0)
-                fun += QString("+%1x^%2").arg(f).arg(j);
-            else
-                fun += QString("%1x^%2").arg(f).arg(j);
+            ui->showNormalMessageInfo(strDes);
         }
-        strDes += (TR("fitting results:")+fun);
-        strDes += "<br/>";
-        //残差,残差平方和,回归平方和,均方根误差
-
-        strDes += TR("error:");
-        strDes += "<br/>";
-
-        strDes += TR("SSR(Regression Square Sum)=%1").arg(info->getAt({0,1}).toString());
-        strDes += "<br/>";
-
-        strDes += TR("SSE(Sum of Squares for Error)=%1").arg(info->getAt({1,1}).toString());
-        strDes += "<br/>";
-
-        strDes += TR("SST=%1").arg(info->getAt({2,1}).toString());
-        strDes += "<br/>";
-
-        strDes += TR("RMSE(Root mean square error)=%1").arg(info->getAt({3,1}).toString());
-        strDes += "<br/>";
-
-        strDes += TR("R-square(coefficient of determination)=%1").arg(info->getAt({4,1}).toString());
-        strDes += "<br/>";
-
-        strDes += TR("Goodness=%1").arg(info->getAt({5,1}).toString());
-        strDes += "</p>";
-
-        chart->addCurve(pfitVal.get());
-        saUI->showNormalMessageInfo(strDes);
-    }
-
+    });
 }
 
 void polyfitInValue(SAUIInterface* ui)
@@ -161,34 +134,110 @@ void polyfitInValue(SAUIInterface* ui)
     {
         return;
     }
-    QVector<QPointF> xys;
-    if(!SADataConver::converToPointFVector(data,xys))
-    {
-        ui->showWarningMessageInfo(TR("data:[\"%1\"] can not to conver to points array").arg(data->getName()));
-        ui->raiseMessageInfoDock();
-        return;
-    }
     int order = 1;
     if(!getPolyfitConfig(order,ui))
     {
         return;
     }
-    QVector<double> xs,ys;
-    splitPointF(xys,xs,ys);
-    std::shared_ptr<SAVectorDouble> factor;//拟合的系数
-    std::shared_ptr<SATableVariant> info;//拟合的误差参数
-    std::tie(factor,info) = saFun::polyfit(xs,ys,order);
-    if(nullptr == factor)
+    auto res = std::make_shared<PolyfitResult>();
+    runFunTask(ui,TR("Polynomial Fittin"),data->getSize()
+               ,[data,res,order](SAFunTaskContext& ctx)->bool{
+        QVector<QPointF> xys;
+        if(!SADataConver::converToPointFVector(data,xys))
+        {
+            ctx.setErrorString(TR("data:[\"%1\"] can not to conver to points array").arg(data->getName()));
+            return false;
+        }
+        QVector<double> xs,ys;
+        splitPointF(xys,xs,ys);
+        return polyfitXY(data->getName(),xs,ys,order,*res);
+    },[ui,res,order](){
+        QString strDes;
+        commitPolyfitResult(*res,order,strDes);
+        ui->showNormalMessageInfo(strDes);
+    });
+}
+///
+/// \brief 拟合一组数据并计算拟合值，在工作线程中执行
+/// \param title 数据名，用于命名结果
+/// \param xs
+/// \param ys
+/// \param order 阶数
+/// \param res 结果
+/// \return 拟合失败返回false
+///
+bool polyfitXY(const QString &title, const QVector<double> &xs, const QVector<double> &ys, int order, PolyfitResult &res)
+{
+    std::tie(res.factor,res.info) = saFun::polyfit(xs,ys,order);
+    return polyfitValue(title,xs,order,res);
+}
+///
+/// \brief 根据已拟合的系数命名结果并计算拟合值，在工作线程中执行
+/// \param title 数据名，用于命名结果
+/// \param xs
+/// \param order 阶数
+/// \param res 已设置factor和info的结果
+/// \return 拟合失败(factor或info为nullptr)返回false
+///
+bool polyfitValue(const QString &title, const QVector<double> &xs, int order, PolyfitResult &res)
+{
+    res.title = title;
+    if(nullptr == res.factor || nullptr == res.info)
     {
-        return;
+        return false;
+    }
+    res.info->setName(QString("%1_%2PolyFitInfo").arg(title).arg(order));
+    res.value = SAValueManager::makeData<SAVectorPointF>(QString("%1_%2PolyFit").arg(title).arg(order));
+    saFun::polyval(xs,res.factor.get(),res.value.get());
+    return true;
+}
+///
+/// \brief 按x分组，x完全相同的曲线为一组
+/// \param datas
+/// \return 每组的曲线索引，按第一次出现的顺序
+///
+QList<QList<int> > groupSameXs(const QList<SAXYSeriesData> &datas)
+{
+    QList<QList<int> > groups;
+    for(int i=0;i<datas.size();++i)
+    {
+        const QVector<double>& xs = datas[i].xs;
+        auto ite = std::find_if(groups.begin(),groups.end(),[&datas,&xs](const QList<int>& g)->bool{
+            return datas[g.first()].xs == xs;
+        });
+        if(ite == groups.end())
+        {
+            groups.append(QList<int>() << i);
+        }
+        else
+        {
+            ite->append(i);
+        }
     }
-    QString title = data->getName();
-    info->setName(QString("%1_%2PolyFitInfo").arg(title).arg(order));
-    std::shared_ptr<SAVectorPointF> pfitVal = SAValueManager::makeData<SAVectorPointF>(QString("%1_%2PolyFit").arg(title).arg(order));
-    saFun::polyval(xs,factor.get(),pfitVal.get());
-    saValueManager->addData(info);
-    saValueManager->addData(pfitVal);
-    //
+    return groups;
+}
+///
+/// \brief 把拟合结果加入变量管理器，并追加结果描述
+/// \param res
+/// \param order
+/// \param des
+///
+void commitPolyfitResult(const PolyfitResult &res, int order, QString &des)
+{
+    saValueManager->addData(res.info);
+    saValueManager->addData(res.value);
+    des += polyfitDescription(res.title,order,res.factor.get(),res.info.get());
+}
+///
+/// \brief 拟合结果的描述
+/// \param title
+/// \param order
+/// \param factor
+/// \param info
+/// \return
+///
+QString polyfitDescription(const QString &title, int order, const SAVectorDouble *factor, const SATableVariant *info)
+{
     QString strDes;
     strDes += "<p>";
     strDes += TR("%1-Polynomial Fittin, order:%2 ")
@@ -241,8 +290,7 @@ void polyfitInValue(SAUIInterface* ui)
 
     strDes += TR("Goodness=%1").arg(info->getAt({5,1}).toString());
     strDes += "</p>";
-
-    saUI->showNormalMessageInfo(strDes);
+    return strDes;
 }
 
 bool getPolyfitConfig(int &order,SAUIInterface* ui)
@@ -16,6 +16,7 @@
 #include "SAGUIGlobalConfig.h"
 #include "SAMdiSubWindow.h"
 #include "ui_opt.h"
+#include "SAFunTask.h"
 #include <QMdiSubWindow>
 #include <QTextStream>
 #include <QApplication>
@@ -35,17 +36,16 @@ void statisticsInValue(SAUIInterface* ui)
     {
         return;
     }
-    std::shared_ptr<SATableVariant> res = saFun::statistics(data);
-    if(nullptr == res)
-    {
-        ui->showErrorMessageInfo(saFun::getLastErrorString());
-        ui->raiseMessageInfoDock();
-        return;
-    }
-    res->setName(TR("%1_statistics").arg(data->getName()));
-    saValueManager->addData(res);
-    ui->showNormalMessageInfo(TR("%1 sum is %2").arg(data->getName()).arg(res->getName()));
-
+    auto res = std::make_shared<std::shared_ptr<SATableVariant> >();
+    runFunTask(ui,TR("statistics"),data->getSize()
+               ,[data,res](SAFunTaskContext&)->bool{
+        *res = saFun::statistics(data);
+        return (nullptr != *res);
+    },[ui,data,res](){
+        (*res)->setName(TR("%1_statistics").arg(data->getName()));
+        saValueManager->addData(*res);
+        ui->showNormalMessageInfo(TR("%1 sum is %2").arg(data->getName()).arg((*res)->getName()));
+    });
 }
 void statisticsInChart(SAUIInterface* ui)
 {
@@ -56,50 +56,37 @@ void statisticsInChart(SAUIInterface* ui)
         ui->showMessageInfo(TR("unsupport chart items"),SA::WarningMessage);
         return;
     }
-
-    QStringList infos;
-    for (int i = 0;i<curs.size();++i)
-    {
-        QwtPlotItem* item = curs[i];
-        QVector<double> ys;
-        if(chart->isRegionVisible())
+    auto curves = std::make_shared<QList<SAXYSeriesData> >(get_xy_series_datas(chart,curs,false,true));
+    auto infos = std::make_shared<QStringList>();
+    runFunTask(ui,TR("statistics"),xy_series_data_count(*curves)
+               ,[curves,infos](SAFunTaskContext& ctx)->bool{
+        for(int i=0;i<curves->size() && !ctx.isCanceled();++i)
         {
-            if(!chart->getXYDataInRange(nullptr,&ys,nullptr,item))
-            {
-                continue;
-            }
+            const SAXYSeriesData& d = curves->at(i);
+            QMap<QString,double> res = saFun::statistics(d.ys);
+            QString resultReport;
+            QTextStream st(&resultReport,QIODevice::Text|QIODevice::ReadWrite);
+            st << "<div>" << TR("statistics([\"") << d.title <<"\"])" << "</div>"
+               << "<div>" << TR("sum:") << res[IDS_SUM] << "</div>"
+               << "<div>" << TR("mean:")<<res[IDS_MEAN]<<"</div>"
+               << "<div>" << TR("var:")<<res[IDS_VAR]<<"</div>"
+               << "<div>" << TR("std:")<<res[IDS_STD]<<"</div>"
+               << "<div>" << TR("skewness:")<<res[IDS_SKEWNESS]<<"</div>"
+               << "<div>" << TR("kurtosis:")<<res[IDS_KURTOSIS]<<"</div>"
+               << "<div>" << TR("peak to peak:")<<res[IDS_PEAK2PEAK]<<"</div>"
+                                ;
+            st.flush();
+            infos->append(resultReport);
+            ctx.setProgress(i+1,curves->size());
         }
-        else
+        return true;
+    },[ui,infos](){
+        if(infos->size() > 0)
         {
-            if(!chart->getXYData(nullptr,&ys,item))
-            {
-                continue;
-            }
-        }
-        if(0 == ys.size())
-        {
-            continue;
+            ui->showNormalMessageInfo(infos->join("================\n"));
+            ui->raiseMessageInfoDock();
         }
-        QMap<QString,double> res = saFun::statistics(ys);
-        QString resultReport;
-        QTextStream st(&resultReport,QIODevice::Text|QIODevice::ReadWrite);
-        st << "<div>" << TR("statistics([\"") <<item->title().text() <<"\"])" << "</div>"
-           << "<div>" << TR("sum:") << res[IDS_SUM] << "</div>"
-           << "<div>" << TR("mean:")<<res[IDS_MEAN]<<"</div>"
-           << "<div>" << TR("var:")<<res[IDS_VAR]<<"</div>"
-           << "<div>" << TR("std:")<<res[IDS_STD]<<"</div>"
-           << "<div>" << TR("skewness:")<<res[IDS_SKEWNESS]<<"</div>"
-           << "<div>" << TR("kurtosis:")<<res[IDS_KURTOSIS]<<"</div>"
-           << "<div>" << TR("peak to peak:")<<res[IDS_PEAK2PEAK]<<"</div>"
-                            ;
-
-        infos.append(resultReport);
-    }
-    if(infos.size() > 0)
-    {
-        ui->showNormalMessageInfo(infos.join("================\n"));
-        ui->raiseMessageInfoDock();
-    }
+    });
 }
 
 void sum(SAUIInterface *ui)
@@ -109,17 +96,16 @@ void sum(SAUIInterface *ui)
     {
         return;
     }
-    std::shared_ptr<SAVariantDatas> res = saFun::sum(data);
-    if(nullptr == res)
-    {
-        ui->showErrorMessageInfo(saFun::getLastErrorString());
-        ui->raiseMessageInfoDock();
-        return;
-    }
-    res->setName(TR("%1-sum").arg(data->getName()));
-    saValueManager->addData(res);
-    saUI->showNormalMessageInfo(TR("%1 sum is %2").arg(data->getName()).arg(res->toData<double>()));
-
+    auto res = std::make_shared<std::shared_ptr<SAVariantDatas> >();
+    runFunTask(ui,TR("sum"),data->getSize()
+               ,[data,res](SAFunTaskContext&)->bool{
+        *res = saFun::sum(data);
+        return (nullptr != *res);
+    },[ui,data,res](){
+        (*res)->setName(TR("%1-sum").arg(data->getName()));
+        saValueManager->addData(*res);
+        ui->showNormalMessageInfo(TR("%1 sum is %2").arg(data->getName()).arg((*res)->toData<double>()));
+    });
 }
 
 void mean(SAUIInterface *ui)
@@ -129,16 +115,16 @@ void mean(SAUIInterface *ui)
     {
         return;
     }
-    std::shared_ptr<SAVariantDatas> res = saFun::mean(data);
-    if(nullptr == res)
-    {
-        ui->showErrorMessageInfo(saFun::getLastErrorString());
-        ui->raiseMessageInfoDock();
-        return;
-    }
-    res->setName(TR("%1-mean").arg(data->getName()));
-    saValueManager->addData(res);
-    ui->showNormalMessageInfo(TR("%1 sum is %2").arg(data->getName()).arg(res->toData<double>()));
+    auto res = std::make_shared<std::shared_ptr<SAVariantDatas> >();
+    runFunTask(ui,TR("mean"),data->getSize()
+               ,[data,res](SAFunTaskContext&)->bool{
+        *res = saFun::mean(data);
+        return (nullptr != *res);
+    },[ui,data,res](){
+        (*res)->setName(TR("%1-mean").arg(data->getName()));
+        saValueManager->addData(*res);
+        ui->showNormalMessageInfo(TR("%1 sum is %2").arg(data->getName()).arg((*res)->toData<double>()));
+    });
 }
 
 void hist(SAUIInterface *ui)
@@ -153,8 +139,8 @@ void hist(SAUIInterface *ui)
     SAPropertySetDialog dlg(ui->getMainWindowPtr(),SAPropertySetDialog::GroupBoxType);
     dlg.appendGroup(TR("property set"));
     dlg.appendIntProperty(idHistCount,TR("hist count")
-                          ,1,std::numeric_limits<int>::max()
-                          ,100,TR("set hist count"));
+                          ,0,std::numeric_limits<int>::max()
+                          ,100,TR("set hist count,0 means auto(Freedman-Diaconis)"));
     dlg.appendGroup(TR("plot set"));
     dlg.appendBoolProperty(idIsPlot,TR("is plot")
                            ,true
@@ -163,26 +149,28 @@ void hist(SAUIInterface *ui)
     {
         return;
     }
-    auto res = saFun::hist(data,dlg.getDataByID<int>(idHistCount));
-    if(nullptr == res)
-    {
-        ui->showErrorMessageInfo(saFun::getLastErrorString());
-        ui->raiseMessageInfoDock();
-        return;
-    }
-    saValueManager->addData(res);
-    if(dlg.getDataByID<bool>(idIsPlot))
-    {
-        SAMdiSubWindow* sub = ui->createFigureWindow();
-        SAFigureWindow* fig = ui->getFigureWidgetFromMdiSubWindow(sub);
-        SAChart2D* chart = fig->create2DPlot();
-        if(chart)
+    const int histCount = dlg.getDataByID<int>(idHistCount);
+    const bool isPlot = dlg.getDataByID<bool>(idIsPlot);
+    auto res = std::make_shared<std::shared_ptr<SAVectorInterval> >();
+    runFunTask(ui,TR("hist"),data->getSize()
+               ,[data,histCount,res](SAFunTaskContext&)->bool{
+        *res = saFun::hist(data,histCount);
+        return (nullptr != *res);
+    },[ui,isPlot,res](){
+        saValueManager->addData(*res);
+        if(isPlot)
         {
-            chart->addHistogram(res.get());
+            SAMdiSubWindow* sub = ui->createFigureWindow();
+            SAFigureWindow* fig = ui->getFigureWidgetFromMdiSubWindow(sub);
+            SAChart2D* chart = fig->create2DPlot();
+            if(chart)
+            {
+                chart->addHistogram(res->get());
+            }
+            ui->raiseMainDock();
+            sub->show();
         }
-        ui->raiseMainDock();
-        sub->show();
-    }
+    });
 }
 
 void diff(SAUIInterface *ui)
@@ -199,19 +187,19 @@ void diff(SAUIInterface *ui)
                              ,1,TR("diff count"));
     dlg.recorder("diff",tmp);
     int diffCount = dlg.getDataByID<int>("diff");
-    std::shared_ptr<SAVectorDouble> res = saFun::diff(data,diffCount);
-    if(nullptr == res)
-    {
-        ui->showErrorMessageInfo(saFun::getLastErrorString());
-        ui->raiseMessageInfoDock();
-        return;
-    }
-    res->setName(TR("%1_diff%2").arg(data->getName()).arg(diffCount));
-    saValueManager->addData(res);
-    ui->showNormalMessageInfo(TR("%1 diff(%2) is %3")
-                                .arg(data->getName())
-                                .arg(diffCount)
-                                .arg(res->getName()));
+    auto res = std::make_shared<std::shared_ptr<SAVectorDouble> >();
+    runFunTask(ui,TR("diff"),data->getSize()
+               ,[data,diffCount,res](SAFunTaskContext&)->bool{
+        *res = saFun::diff(data,diffCount);
+        return (nullptr != *res);
+    },[ui,data,diffCount,res](){
+        (*res)->setName(TR("%1_diff%2").arg(data->getName()).arg(diffCount));
+        saValueManager->addData(*res);
+        ui->showNormalMessageInfo(TR("%1 diff(%2) is %3")
+                                    .arg(data->getName())
+                                    .arg(diffCount)
+                                    .arg((*res)->getName()));
+    });
 }
 
 void statistics(SAUIInterface *ui)
@@ -43,7 +43,8 @@ HEADERS += \
     FunNum.h \
     FunFit.h \
     FitParamSetDialog.h \
-    ui_opt.h
+    ui_opt.h \
+    SAFunTask.h
 
 SOURCES += \
     SAFunPlugin.cpp \
@@ -53,7 +54,8 @@ SOURCES += \
     FunNum.cpp \
     FunFit.cpp \
     FitParamSetDialog.cpp \
-    ui_opt.cpp
+    ui_opt.cpp \
+    SAFunTask.cpp
 
 include($$PWD/Dialog/Dialog.pri)
 
@@ -220,6 +220,10 @@ void SAFunPlugin::setupDataPreprocessingMenu()
     m_sigmaDetectAction = m_dataPreprocessing->addAction(ICON_sigmaDetect,tr("sigma detect"));
     m_sigmaDetectAction->setObjectName("sigmaDetectAction");
     connect(m_sigmaDetectAction,&QAction::triggered,this,&SAFunPlugin::on_sigmaDetectAction);
+    //Hampel检测
+    m_hampelDetectAction = m_dataPreprocessing->addAction(ICON_sigmaDetect,tr("hampel detect"));
+    m_hampelDetectAction->setObjectName("hampelDetectAction");
+    connect(m_hampelDetectAction,&QAction::triggered,this,&SAFunPlugin::on_hampelDetectAction);
 
     //m点n次滤波
     m_pointSmoothAction = m_dataPreprocessing->addAction(ICON_mPointnPow,tr("m points n pow smooth"));
@@ -356,6 +360,8 @@ void SAFunPlugin::retranslateUI()
     m_dataPreprocessing->setTitle(tr("data preprocessing"));
     m_sigmaDetectAction->setText(tr("sigma detect"));
     m_sigmaDetectAction->setToolTip(tr("detect the datas out of sigma rang"));
+    m_hampelDetectAction->setText(tr("hampel detect"));
+    m_hampelDetectAction->setToolTip(tr("detect the local outliers by rolling median and MAD"));
     m_pointSmoothAction->setText(tr("m points n pow smooth"));
     m_pointSmoothAction->setToolTip(tr("m points n pow smooth"));
     //
@@ -380,6 +386,7 @@ void SAFunPlugin::retranslateUI()
                ;
     m_category2actionList[m_dataPreprocessing->title()] = QList<QAction*>()
             << m_sigmaDetectAction
+            << m_hampelDetectAction
             << m_pointSmoothAction
                ;
     m_category2actionList[m_dataFitting->title()] = QList<QAction*>()
@@ -477,6 +484,13 @@ void SAFunPlugin::on_sigmaDetectAction()
     sigmaDetect(m_ui);
 }
 ///
+/// \brief Hampel异常值判断
+///
+void SAFunPlugin::on_hampelDetectAction()
+{
+    hampelDetect(m_ui);
+}
+///
 /// \brief m点n次滤波
 ///
 void SAFunPlugin::on_pointSmoothAction()
@@ -79,6 +79,8 @@ private slots:
     //=====数据预处理相关菜单========================================
     //sigma异常值判断
     void on_sigmaDetectAction();
+    //Hampel异常值判断
+    void on_hampelDetectAction();
     //m点n次滤波
     void on_pointSmoothAction();
 private slots:
@@ -98,6 +100,7 @@ private:
     std::unique_ptr<QMenu> m_dataFitting;///< 拟合相关菜单
     //=====数据预处理相关菜单========================================
     QAction* m_sigmaDetectAction;///< sigma异常值判断
+    QAction* m_hampelDetectAction;///< Hampel异常值判断
     QAction* m_pointSmoothAction;///< m点n次滤波
     //=====信号处理相关菜单========================================
     QAction* m_detrendDirectAction;///< 去趋势(去直流)
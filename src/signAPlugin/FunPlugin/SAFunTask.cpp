@@ -0,0 +1,176 @@
+#include "SAFunTask.h"
+#include <QApplication>
+#include <QProgressDialog>
+#include <QRunnable>
+#include <QThreadPool>
+#include "SAUIInterface.h"
+#include "sa_fun_core.h"
+#define TR(str)\
+    QApplication::translate("SAFunTask", str, 0)
+
+bool call_fun_task_compute(const SAFunTaskCompute& compute,SAFunTaskContext& ctx);
+
+///
+/// \brief 在线程池中执行计算，结束时通过监视者的finished信号回到GUI线程
+///
+class SAFunTaskRunnable : public QRunnable
+{
+public:
+    SAFunTaskRunnable(SAFunTaskWatcher* watcher,const SAFunTaskCompute& compute)
+        :m_watcher(watcher)
+        ,m_compute(compute)
+    {
+    }
+    virtual void run()
+    {
+        SAFunTaskContext ctx(m_watcher);
+        bool isSuccess = call_fun_task_compute(m_compute,ctx);
+        //发射后监视者随时可能被删除，不能再访问
+        emit m_watcher->finished(isSuccess,ctx.errorString());
+    }
+private:
+    SAFunTaskWatcher* m_watcher;
+    SAFunTaskCompute m_compute;
+};
+
+///
+/// \brief 执行计算函数，失败时补充错误信息
+/// \param compute
+/// \param ctx
+/// \return
+///
+bool call_fun_task_compute(const SAFunTaskCompute &compute, SAFunTaskContext &ctx)
+{
+    bool isSuccess = false;
+    try
+    {
+        isSuccess = compute(ctx);
+    }
+    catch(const std::exception& e)
+    {
+        ctx.setErrorString(QString::fromLocal8Bit(e.what()));
+        return false;
+    }
+    if(!isSuccess && ctx.errorString().isEmpty())
+    {
+        ctx.setErrorString(saFun::getLastErrorString());
+    }
+    return isSuccess;
+}
+
+SAFunTaskContext::SAFunTaskContext(SAFunTaskWatcher *watcher)
+    :m_watcher(watcher)
+{
+
+}
+
+bool SAFunTaskContext::isCanceled() const
+{
+    return (m_watcher && m_watcher->isCanceled());
+}
+
+void SAFunTaskContext::setProgress(int value, int maximum)
+{
+    if(m_watcher)
+    {
+        emit m_watcher->progressChanged(value,maximum);
+    }
+}
+
+void SAFunTaskContext::setErrorString(const QString &err)
+{
+    m_errorString = err;
+}
+
+QString SAFunTaskContext::errorString() const
+{
+    return m_errorString;
+}
+
+SAFunTaskWatcher::SAFunTaskWatcher(SAUIInterface *ui, const QString &title, const SAFunTaskCommit &commit)
+    :QObject(nullptr)
+    ,m_ui(ui)
+    ,m_title(title)
+    ,m_commit(commit)
+    ,m_progress(nullptr)
+    ,m_isCanceled(0)
+{
+    m_progress = new QProgressDialog(title,TR("Cancel"),0,0,ui->getMainWindowPtr());
+    m_progress->setWindowTitle(title);
+    m_progress->setWindowModality(Qt::WindowModal);
+    m_progress->setAutoClose(false);
+    m_progress->setAutoReset(false);
+    m_progress->setMinimumDuration(0);
+    connect(m_progress,&QProgressDialog::canceled,this,&SAFunTaskWatcher::onCanceled);
+    connect(this,&SAFunTaskWatcher::progressChanged,this,&SAFunTaskWatcher::onProgressChanged);
+    connect(this,&SAFunTaskWatcher::finished,this,&SAFunTaskWatcher::onFinished);
+    m_progress->show();
+}
+
+SAFunTaskWatcher::~SAFunTaskWatcher()
+{
+    delete m_progress;
+}
+
+bool SAFunTaskWatcher::isCanceled() const
+{
+    return (0 != m_isCanceled.load());
+}
+
+void SAFunTaskWatcher::onProgressChanged(int value, int maximum)
+{
+    if(isCanceled())
+    {
+        return;
+    }
+    m_progress->setMaximum(maximum);
+    m_progress->setValue(value);
+}
+
+void SAFunTaskWatcher::onFinished(bool isSuccess, const QString &err)
+{
+    m_progress->hide();
+    if(isCanceled())
+    {
+        m_ui->showWarningMessageInfo(TR("%1 is canceled").arg(m_title));
+    }
+    else if(!isSuccess)
+    {
+        m_ui->showErrorMessageInfo(err);
+        m_ui->raiseMessageInfoDock();
+    }
+    else if(m_commit)
+    {
+        m_commit();
+    }
+    deleteLater();
+}
+
+void SAFunTaskWatcher::onCanceled()
+{
+    m_isCanceled.store(1);
+    m_progress->setLabelText(TR("canceling %1 ...").arg(m_title));
+}
+
+
+void runFunTask(SAUIInterface *ui, const QString &title, qint64 work
+                , const SAFunTaskCompute &compute, const SAFunTaskCommit &commit)
+{
+    if(work < SA_FUN_TASK_ASYNC_MIN_WORK)
+    {
+        SAFunTaskContext ctx(nullptr);
+        if(!call_fun_task_compute(compute,ctx))
+        {
+            ui->showErrorMessageInfo(ctx.errorString());
+            ui->raiseMessageInfoDock();
+            return;
+        }
+        if(commit)
+        {
+            commit();
+        }
+        return;
+    }
+    SAFunTaskWatcher* watcher = new SAFunTaskWatcher(ui,title,commit);
+    QThreadPool::globalInstance()->start(new SAFunTaskRunnable(watcher,compute));
+}
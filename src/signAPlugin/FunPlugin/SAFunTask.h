@@ -0,0 +1,91 @@
+#ifndef SAFUNTASK_H
+#define SAFUNTASK_H
+#include <QObject>
+#include <QAtomicInt>
+#include <QString>
+#include <functional>
+class SAUIInterface;
+class QProgressDialog;
+class SAFunTaskWatcher;
+
+///
+/// \def 计算量（数据点数）不小于此值时在工作线程中计算，否则直接在GUI线程计算
+///
+#ifndef SA_FUN_TASK_ASYNC_MIN_WORK
+#define SA_FUN_TASK_ASYNC_MIN_WORK 100000
+#endif
+
+///
+/// \brief 计算过程中使用的上下文，用于查询取消和汇报进度
+///
+/// 在工作线程中使用，不能访问任何界面对象
+///
+class SAFunTaskContext
+{
+public:
+    SAFunTaskContext(SAFunTaskWatcher* watcher);
+    //用户是否已取消，计算应在合适的位置检查并尽快返回
+    bool isCanceled() const;
+    //汇报进度
+    void setProgress(int value,int maximum);
+    //错误信息，计算失败时显示
+    void setErrorString(const QString& err);
+    QString errorString() const;
+private:
+    SAFunTaskWatcher* m_watcher;///< 直接在GUI线程计算时为nullptr
+    QString m_errorString;
+};
+
+///
+/// \brief 计算函数，在工作线程执行，返回false表示失败
+///
+typedef std::function<bool(SAFunTaskContext&)> SAFunTaskCompute;
+///
+/// \brief 提交函数，计算成功后在GUI线程执行，负责把结果加入变量管理器、图表和撤销栈
+///
+typedef std::function<void()> SAFunTaskCommit;
+
+///
+/// \brief 后台计算的监视者，位于GUI线程
+///
+/// 显示窗口模态的进度对话框，计算期间用户不能修改数据和图表，但界面保持响应，
+/// 点击取消后计算结束时放弃结果；计算结束后执行提交函数并删除自身
+///
+class SAFunTaskWatcher : public QObject
+{
+    Q_OBJECT
+public:
+    SAFunTaskWatcher(SAUIInterface* ui,const QString& title,const SAFunTaskCommit& commit);
+    ~SAFunTaskWatcher();
+    bool isCanceled() const;
+signals:
+    //以下信号在工作线程发射
+    void progressChanged(int value,int maximum);
+    void finished(bool isSuccess,const QString& err);
+private slots:
+    void onProgressChanged(int value,int maximum);
+    void onFinished(bool isSuccess,const QString& err);
+    void onCanceled();
+private:
+    SAUIInterface* m_ui;
+    QString m_title;
+    SAFunTaskCommit m_commit;
+    QProgressDialog* m_progress;
+    QAtomicInt m_isCanceled;
+};
+
+///
+/// \brief 执行一个计算任务
+///
+/// 计算量小时直接计算并提交，否则在全局线程池中计算，完成后回到GUI线程提交；
+/// 计算失败且没有设置错误信息时使用saFun::getLastErrorString
+/// \param ui
+/// \param title 任务名，显示在进度对话框和提示信息中
+/// \param work 计算量，一般为参与计算的数据点数
+/// \param compute 计算函数
+/// \param commit 提交函数
+///
+void runFunTask(SAUIInterface* ui,const QString& title,qint64 work
+                ,const SAFunTaskCompute& compute,const SAFunTaskCommit& commit);
+
+#endif // SAFUNTASK_H
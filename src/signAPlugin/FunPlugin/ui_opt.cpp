@@ -2,6 +2,9 @@
 #include "SAChart2D.h"
 #include "SAUIReflection.h"
 #include "SAUIInterface.h"
+#include "SAAbstractDatas.h"
+#include "SAChart.h"
+#include "SAFigureReplaceDatasCommand.h"
 #include "QApplication"
 
 #define TR(str)\
@@ -28,3 +31,94 @@ SAChart2D* filter_xy_series(SAUIInterface *ui, QList<QwtPlotItem*>& res)
     res = curs;
     return chart;
 }
+
+///
+/// \brief 取出曲线的数据
+/// \param chart
+/// \param items
+/// \param isOnlyCurve 只取QwtPlotCurve，用于会替换曲线数据的操作
+/// \param isInRange 图表显示选区时只取选区内的数据
+/// \return
+///
+QList<SAXYSeriesData> get_xy_series_datas(SAChart2D *chart, const QList<QwtPlotItem *> &items
+                                          , bool isOnlyCurve, bool isInRange)
+{
+    QList<SAXYSeriesData> res;
+    const bool isRegion = isInRange && chart->isRegionVisible();
+    for(QwtPlotItem* item : items)
+    {
+        if(isOnlyCurve && QwtPlotItem::Rtti_PlotCurve != item->rtti())
+        {
+            continue;
+        }
+        SAXYSeriesData d;
+        d.item = item;
+        d.title = item->title().text();
+        const bool isOK = isRegion ? chart->getXYDataInRange(&d.xs,&d.ys,nullptr,item)
+                                   : chart->getXYData(&d.xs,&d.ys,item);
+        if(!isOK || d.ys.isEmpty())
+        {
+            continue;
+        }
+        res.append(d);
+    }
+    return res;
+}
+
+qint64 xy_series_data_count(const QList<SAXYSeriesData> &datas)
+{
+    qint64 count = 0;
+    for(const SAXYSeriesData& d : datas)
+    {
+        count += d.ys.size();
+    }
+    return count;
+}
+///
+/// \brief 添加替换曲线全部数据的命令，原数据在构造命令时从曲线取出用于撤销
+/// \param chart
+/// \param item 曲线，必须为QwtPlotCurve
+/// \param datas 新数据
+/// \param cmdName
+/// \param parent
+///
+void append_replace_curve_datas_command(SAChart2D *chart, QwtPlotItem *item, const QVector<QPointF> &datas
+                                        , const QString &cmdName, QUndoCommand *parent)
+{
+    new SAFigureReplaceAllDatasCommand<QPointF,QwtPlotCurve,decltype(&SAChart::setPlotCurveSample)>
+            (chart
+           ,item
+           ,datas
+           ,cmdName
+           ,&SAChart::setPlotCurveSample
+           ,&SAChart::getPlotCurveSample
+           ,parent
+           );
+}
+///
+/// \brief 获取选中的一维数据
+/// \param ui
+/// \param funName 功能名，用于提示
+/// \return 没有选中、不是一维或长度不足2时返回nullptr
+///
+SAAbstractDatas *get_select_wave(SAUIInterface *ui, const QString &funName)
+{
+    SAAbstractDatas* data = ui->getSelectSingleData();
+    if(nullptr == data)
+    {
+        return nullptr;
+    }
+    if(data->getDim() != 1)
+    {
+        ui->showWarningMessageInfo(TR("data:[\"%1\"] type is not accept to %2").arg(data->getName()).arg(funName));
+        ui->raiseMessageInfoDock();
+        return nullptr;
+    }
+    if(data->getSize(SA::Dim1) <= 1)
+    {
+        ui->showWarningMessageInfo(TR("data:[\"%1\"] size is too short").arg(data->getName()));
+        ui->raiseMessageInfoDock();
+        return nullptr;
+    }
+    return data;
+}
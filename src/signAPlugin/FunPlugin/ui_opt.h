@@ -1,12 +1,40 @@
 ﻿#ifndef UI_OPT_H
 #define UI_OPT_H
 #include <QList>
+#include <QVector>
+#include <QPointF>
+#include <QString>
 class QwtPlotItem;
 class SAChart2D;
 class SAUIInterface;
+class SAAbstractDatas;
+class QUndoCommand;
 
 SAChart2D* filter_xy_series(SAUIInterface* ui,QList<QwtPlotItem*>& res);
 
+///
+/// \brief 图表中一条曲线的数据
+///
+/// 在GUI线程取出后交给后台计算，计算期间不再访问图表
+///
+struct SAXYSeriesData
+{
+    QwtPlotItem* item;
+    QString title;
+    QVector<double> xs;
+    QVector<double> ys;
+};
+//取出曲线的数据，isOnlyCurve为true时只取QwtPlotCurve，isInRange为true且图表显示选区时只取选区内的数据
+QList<SAXYSeriesData> get_xy_series_datas(SAChart2D* chart,const QList<QwtPlotItem*>& items
+                                          ,bool isOnlyCurve,bool isInRange);
+//曲线数据的总点数，用于估计计算量
+qint64 xy_series_data_count(const QList<SAXYSeriesData>& datas);
+//添加替换曲线全部数据的命令
+void append_replace_curve_datas_command(SAChart2D* chart,QwtPlotItem* item,const QVector<QPointF>& datas
+                                        ,const QString& cmdName,QUndoCommand* parent);
+//获取选中的一维数据，类型或长度不符合时提示并返回nullptr
+SAAbstractDatas* get_select_wave(SAUIInterface* ui,const QString& funName);
+
 
 
 #endif // UI_OPT_H
@@ -21,6 +21,25 @@ bool SAProtocolHeader::isValid() const
 }
 
 
+/**
+ * @brief 数据区编码
+ * @return \sa SAProtocolHeader::PayloadCodec
+ */
+int SAProtocolHeader::getCodec() const
+{
+    return ((this->extendValue >> 24) & 0xFF);
+}
+
+/**
+ * @brief 设置数据区编码，不影响extendValue的低24位
+ * @param codec \sa SAProtocolHeader::PayloadCodec
+ */
+void SAProtocolHeader::setCodec(int codec)
+{
+    this->extendValue = (this->extendValue & 0x00FFFFFF) | ((uint32_t(codec) & 0xFF) << 24);
+}
+
+
 QDataStream &operator <<(QDataStream &io, const SAProtocolHeader &d)
 {
     io.writeRawData((const char*)(&d),sizeof(SAProtocolHeader));
@@ -3,6 +3,7 @@
 #include "SAProtocolGlobal.h"
 #include <QDataStream>
 #include <QDebug>
+#include <QMetaType>
 /// \def 定义魔数头
 #ifndef SA_PROTOCOL_HEADER_MAGIC_START
 #define SA_PROTOCOL_HEADER_MAGIC_START (0xCC880307)
@@ -14,26 +15,44 @@
 #endif
 
 
+/// \def 超过此尺寸(byte)的数据区才会压缩
+#ifndef SA_PROTOCOL_COMPRESS_THRESHOLD
+#define SA_PROTOCOL_COMPRESS_THRESHOLD (64*1024)
+#endif
+
 /**
  * @brief sa 协议的帧头，固定长度
  * 固定36字节
+ *
+ * extendValue的最高字节用于标记数据区的编码 \sa PayloadCodec ，低24位为用户的扩展值
  */
 struct SA_PROTOCOL_EXPORT SAProtocolHeader
 {
+    /**
+     * @brief 数据区的编码
+     */
+    enum PayloadCodec {
+        CodecNone = 0   ///< 不压缩
+        , CodecZlib = 1 ///< qCompress压缩
+    };
     uint32_t magic_start;///< 开始魔数，理论恒等于 \sa SA_PROTOCOL_HEADER_MAGIC_START
     int32_t sequenceID;///< 流水编号，对于多个同类型请求的区分
     int32_t protocolTypeID;///< 分类号，区分协议
     int32_t protocolFunID;///< 功能号，区分协议功能
     uint32_t dataSize;///< 标记数据包的尺寸
-    uint32_t extendValue;///< 扩展值，目前无用
-    uint32_t dataCrc32;///< 标记数据区的crc32值
+    uint32_t extendValue;///< 扩展值，最高字节为数据区编码，低24位由用户使用
+    uint32_t dataCrc32;///< 标记数据区的crc32值，数据区压缩时为压缩后数据的crc32
     uint32_t magic_end;///< 结束魔数，理论恒等于 \sa SA_PROTOCOL_HEADER_MAGIC_END
     void init();
     bool isValid() const;
+    //数据区编码
+    int getCodec() const;
+    void setCodec(int codec);
 };
 //用于判断是否是一个正确的协议头，此函数会读取p指针位置后32字节，需要确保字节有效
 SA_PROTOCOL_EXPORT bool is_valid_sa_protocol_header(const char * p);
 SA_PROTOCOL_EXPORT QDataStream& operator <<(QDataStream& io,const SAProtocolHeader& d);
 SA_PROTOCOL_EXPORT QDataStream& operator >>(QDataStream& io,SAProtocolHeader& d);
 SA_PROTOCOL_EXPORT QDebug& operator<<(QDebug& debug, const SAProtocolHeader &d);
+Q_DECLARE_METATYPE(SAProtocolHeader)
 #endif // SAPROTOCOLHEADER_H
@@ -37,6 +37,9 @@ public:
     //解析
     bool parser(const QString& str);
 
+    //解析已经加载的文档
+    bool parser(const QDomDocument& doc);
+
 public:
     int mClassID;
     int mFunID;
@@ -75,10 +78,22 @@ void SAXMLProtocolPrivate::copy(const SAXMLProtocolPrivate *other)
 }
 
 
+/**
+ * @brief 直接从utf8字节解析，不经过QString中转
+ *
+ * data可以是QByteArray::fromRawData构造的视图，解析过程不会拷贝data
+ * @param data
+ * @return
+ */
 bool SAXMLProtocolPrivate::fromByteArray(const QByteArray& data)
 {
     clear();
-    return (parser(QString(data)));
+    QDomDocument doc;
+
+    if (!doc.setContent(data, &(this->mErrorMsg))) {
+        return (false);
+    }
+    return (parser(doc));
 }
 
 
@@ -96,6 +111,12 @@ bool SAXMLProtocolPrivate::parser(const QString& str)
     if (!doc.setContent(str, &(this->mErrorMsg))) {
         return (false);
     }
+    return (parser(doc));
+}
+
+
+bool SAXMLProtocolPrivate::parser(const QDomDocument& doc)
+{
     QDomElement rootele = doc.documentElement();
 
     if (rootele.isNull()) {
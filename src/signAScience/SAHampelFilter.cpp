@@ -0,0 +1,555 @@
+#include "SAHampelFilter.h"
+#include "SAParallel.h"
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+///
+/// \def 窗口长度不小于此值时用跳表保存窗口数据，否则用有序数组
+///
+/// 有序数组插入删除是连续内存的移动，MAD的二分查找是O(1)的随机访问，窗口上万时跳表才更快
+///
+#ifndef SA_HAMPEL_SKIPLIST_WINDOW
+#define SA_HAMPEL_SKIPLIST_WINDOW 16384
+#endif
+
+///
+/// \def 每个并行分段至少处理的数据个数，数据量小时不分段
+///
+#ifndef SA_HAMPEL_PARALLEL_CHUNK
+#define SA_HAMPEL_PARALLEL_CHUNK (1<<16)
+#endif
+
+///
+/// \def 正态分布下MAD换算为标准差的系数
+///
+#define SA_HAMPEL_MAD_SCALE 1.4826
+
+namespace SA {
+///
+/// \brief 有序数组保存的窗口，插入删除需要移动数据
+///
+class SASortedWindow
+{
+public:
+    SASortedWindow(int capacity)
+    {
+        m_data.reserve(capacity);
+    }
+    void insert(double v)
+    {
+        m_data.insert(std::upper_bound(m_data.begin(),m_data.end(),v),v);
+    }
+    //v必须在窗口中
+    void erase(double v)
+    {
+        m_data.erase(std::lower_bound(m_data.begin(),m_data.end(),v));
+    }
+    int size() const
+    {
+        return static_cast<int>(m_data.size());
+    }
+    //第k小的数，k从0开始
+    double at(int k) const
+    {
+        return m_data[k];
+    }
+    void clear()
+    {
+        m_data.clear();
+    }
+private:
+    std::vector<double> m_data;
+};
+
+///
+/// \brief 可按秩索引的跳表
+///
+/// 每层链接记录跨过的第0层节点数(宽度)，按秩查找时沿宽度累加，插入、删除、按秩查找都是O(log n)。
+/// 节点预先按容量分配，层数为log2(容量)+1，同一节点各层的链接连续存放
+///
+class SAIndexableSkipList
+{
+public:
+    SAIndexableSkipList(int capacity)
+        :m_levels(1)
+        ,m_size(0)
+        ,m_seed(0x9E3779B9u)
+    {
+        while((1 << m_levels) < capacity && m_levels < 30)
+        {
+            ++m_levels;
+        }
+        //节点0为表头，宽度计到表尾之后一个位置
+        const int nodes = capacity + 1;
+        m_value.assign(nodes,0.0);
+        m_height.assign(nodes,0);
+        m_links.assign(static_cast<size_t>(nodes) * m_levels,Link());
+        m_height[0] = m_levels;
+        m_free.reserve(capacity);
+        for(int i=nodes-1;i>0;--i)
+        {
+            m_free.push_back(i);
+        }
+    }
+    void insert(double v)
+    {
+        int chain[32];
+        int steps[32];
+        int node = 0;
+        for(int l=m_levels-1;l>=0;--l)
+        {
+            steps[l] = 0;
+            for(int nx = next(node,l);nx != NIL && m_value[nx] <= v;nx = next(node,l))
+            {
+                steps[l] += width(node,l);
+                node = nx;
+            }
+            chain[l] = node;
+        }
+        const int h = randomHeight();
+        const int nn = m_free.back();
+        m_free.pop_back();
+        m_value[nn] = v;
+        m_height[nn] = h;
+        int s = 0;
+        for(int l=0;l<h;++l)
+        {
+            const int prev = chain[l];
+            next(nn,l) = next(prev,l);
+            next(prev,l) = nn;
+            width(nn,l) = width(prev,l) - s;
+            width(prev,l) = s + 1;
+            s += steps[l];
+        }
+        for(int l=h;l<m_levels;++l)
+        {
+            ++width(chain[l],l);
+        }
+        ++m_size;
+    }
+    //删除一个等于v的数，v必须在表中
+    void erase(double v)
+    {
+        int chain[32];
+        int node = 0;
+        for(int l=m_levels-1;l>=0;--l)
+        {
+            for(int nx = next(node,l);nx != NIL && m_value[nx] < v;nx = next(node,l))
+            {
+                node = nx;
+            }
+            chain[l] = node;
+        }
+        const int del = next(chain[0],0);
+        const int h = m_height[del];
+        for(int l=0;l<h;++l)
+        {
+            const int prev = chain[l];
+            width(prev,l) += width(del,l) - 1;
+            next(prev,l) = next(del,l);
+        }
+        for(int l=h;l<m_levels;++l)
+        {
+            --width(chain[l],l);
+        }
+        for(int l=0;l<h;++l)
+        {
+            next(del,l) = NIL;
+            width(del,l) = 1;
+        }
+        m_free.push_back(del);
+        --m_size;
+    }
+    int size() const
+    {
+        return m_size;
+    }
+    double at(int k) const
+    {
+        int node = 0;
+        int i = k + 1;
+        for(int l=m_levels-1;l>=0;--l)
+        {
+            while(width(node,l) <= i)
+            {
+                i -= width(node,l);
+                node = next(node,l);
+            }
+        }
+        return m_value[node];
+    }
+    void clear()
+    {
+        const int nodes = static_cast<int>(m_value.size());
+        std::fill(m_links.begin(),m_links.end(),Link());
+        m_free.clear();
+        for(int i=nodes-1;i>0;--i)
+        {
+            m_free.push_back(i);
+        }
+        m_size = 0;
+    }
+private:
+    enum { NIL = -1 };
+    ///
+    /// \brief 一层链接，后继和宽度放在一起，查找时一次访存
+    ///
+    struct Link
+    {
+        Link():next(NIL),width(1){}
+        int next;
+        int width;
+    };
+    int& next(int node,int l){return m_links[static_cast<size_t>(node) * m_levels + l].next;}
+    int next(int node,int l) const{return m_links[static_cast<size_t>(node) * m_levels + l].next;}
+    int& width(int node,int l){return m_links[static_cast<size_t>(node) * m_levels + l].width;}
+    int width(int node,int l) const{return m_links[static_cast<size_t>(node) * m_levels + l].width;}
+    //几何分布的层高，每层概率1/2
+    int randomHeight()
+    {
+        m_seed ^= m_seed << 13;
+        m_seed ^= m_seed >> 17;
+        m_seed ^= m_seed << 5;
+        int h = 1;
+        unsigned int r = m_seed;
+        while((r & 1u) && h < m_levels)
+        {
+            ++h;
+            r >>= 1;
+        }
+        return h;
+    }
+private:
+    int m_levels;
+    int m_size;
+    unsigned int m_seed;
+    std::vector<double> m_value;
+    std::vector<int> m_height;
+    std::vector<Link> m_links;
+    std::vector<int> m_free;
+};
+
+///
+/// \brief 有序窗口的中位数和绝对中位差
+///
+/// 中位数两侧的点到中位数的距离各自是有序的，MAD就是两个有序序列合并后的中位数，
+/// 用二分查找第k小的数，只需要O(log n)次按秩访问
+///
+template<typename W>
+static void window_median_mad(const W& w,double& med,double& mad)
+{
+    const int n = w.size();
+    const int h = n / 2;
+    med = (n & 1) ? w.at(h) : 0.5 * (w.at(h - 1) + w.at(h));
+    const double m = med;
+    //左侧距离a(i)=m-w[h-1-i]，i∈[0,h)；右侧距离b(j)=w[h+j]-m，j∈[0,n-h)，都是升序
+    const int la = h;
+    const int lb = n - h;
+    auto a = [&w,h,m](int i){return m - w.at(h - 1 - i);};
+    auto b = [&w,h,m](int j){return w.at(h + j) - m;};
+    auto kth = [&](int k)->double{
+        //合并后前k+1个数中取自左侧的个数
+        int lo = std::max(0,k + 1 - lb);
+        int hi = std::min(k + 1,la);
+        while(lo < hi)
+        {
+            const int i = (lo + hi) / 2;
+            const int j = k + 1 - i;
+            if(i < la && j > 0 && a(i) < b(j - 1))
+            {
+                lo = i + 1;
+            }
+            else
+            {
+                hi = i;
+            }
+        }
+        const int j = k + 1 - lo;
+        if(0 == lo)
+        {
+            return b(j - 1);
+        }
+        if(0 == j)
+        {
+            return a(lo - 1);
+        }
+        return std::max(a(lo - 1),b(j - 1));
+    };
+    mad = (n & 1) ? kth(h) : 0.5 * (kth(h - 1) + kth(h));
+}
+
+///
+/// \brief Hampel检测的流式状态
+///
+/// 保存最近2k+1个数据，推入第t个数据后判断第t-k个点，此时窗口为[t-2k,t]
+///
+class SAHampelState
+{
+public:
+    SAHampelState(int k,double nSigma)
+        :m_k(k)
+        ,m_nSigma(nSigma)
+        ,m_ring(2 * k + 1,0.0)
+        ,m_count(0)
+        ,m_next(0)
+    {
+    }
+    virtual ~SAHampelState(){}
+    bool push(double v,SAHampelFilter::Result* res)
+    {
+        const long long t = m_count++;
+        m_ring[t % m_ring.size()] = v;
+        if(!std::isnan(v))
+        {
+            insert(v);
+        }
+        if(t < m_k)
+        {
+            return false;
+        }
+        decide(res);
+        return true;
+    }
+    bool flush(SAHampelFilter::Result* res)
+    {
+        if(m_next >= m_count)
+        {
+            return false;
+        }
+        decide(res);
+        return true;
+    }
+    void reset()
+    {
+        m_count = 0;
+        m_next = 0;
+        clear();
+    }
+protected:
+    virtual void insert(double v) = 0;
+    virtual void erase(double v) = 0;
+    virtual void clear() = 0;
+    virtual int size() const = 0;
+    virtual void medianMad(double& med,double& mad) const = 0;
+private:
+    //判断第m_next个点，然后把窗口左端移出
+    void decide(SAHampelFilter::Result* res)
+    {
+        const long long c = m_next++;
+        const double v = m_ring[c % m_ring.size()];
+        res->index = c;
+        res->value = v;
+        res->isOutlier = false;
+        if(size() > 0)
+        {
+            double mad;
+            medianMad(res->median,mad);
+            res->sigma = SA_HAMPEL_MAD_SCALE * mad;
+            res->isOutlier = (std::fabs(v - res->median) > m_nSigma * res->sigma);//nan比较为false
+        }
+        else
+        {
+            res->median = res->sigma = std::numeric_limits<double>::quiet_NaN();
+        }
+        if(c >= m_k)
+        {
+            const double old = m_ring[(c - m_k) % m_ring.size()];
+            if(!std::isnan(old))
+            {
+                erase(old);
+            }
+        }
+    }
+private:
+    const int m_k;
+    const double m_nSigma;
+    std::vector<double> m_ring;
+    long long m_count;///< 已推入的数据个数
+    long long m_next;///< 下一个要判断的点
+};
+
+template<typename W>
+class SAHampelStateImpl : public SAHampelState
+{
+public:
+    SAHampelStateImpl(int k,double nSigma):SAHampelState(k,nSigma),m_window(2 * k + 1){}
+protected:
+    virtual void insert(double v){m_window.insert(v);}
+    virtual void erase(double v){m_window.erase(v);}
+    virtual void clear(){m_window.clear();}
+    virtual int size() const{return m_window.size();}
+    virtual void medianMad(double& med,double& mad) const
+    {
+        window_median_mad(m_window,med,mad);
+    }
+private:
+    W m_window;
+};
+
+static SAHampelState* create_hampel_state(int k,double nSigma)
+{
+    if(2 * k + 1 >= SA_HAMPEL_SKIPLIST_WINDOW)
+    {
+        return new SAHampelStateImpl<SAIndexableSkipList>(k,nSigma);
+    }
+    return new SAHampelStateImpl<SASortedWindow>(k,nSigma);
+}
+
+///
+/// \brief 构造
+/// \param halfWindow 中心点两侧各取的点数，窗口长度为2*halfWindow+1
+/// \param nSigma 判定为异常值的σ倍数
+///
+SAHampelFilter::SAHampelFilter(int halfWindow, double nSigma)
+    :m_halfWindow(halfWindow)
+    ,m_nSigma(nSigma)
+{
+    if(isValid())
+    {
+        m_state.reset(create_hampel_state(m_halfWindow,m_nSigma));
+    }
+}
+
+SAHampelFilter::~SAHampelFilter()
+{
+
+}
+
+bool SAHampelFilter::isValid() const
+{
+    return (m_halfWindow >= 0) && (m_halfWindow < (1 << 28)) && (m_nSigma >= 0);
+}
+
+int SAHampelFilter::halfWindow() const
+{
+    return m_halfWindow;
+}
+
+double SAHampelFilter::nSigma() const
+{
+    return m_nSigma;
+}
+///
+/// \brief 推入一个数据
+///
+/// 推入第t个数据后得到第t-halfWindow个点的结果，结果按序号顺序给出
+/// \param v 数据
+/// \param res 得到结果时写入
+/// \return 得到了结果返回true，参数无效时返回false
+///
+bool SAHampelFilter::push(double v, Result *res)
+{
+    if(!m_state)
+    {
+        return false;
+    }
+    return m_state->push(v,res);
+}
+///
+/// \brief 数据结束后取出剩余点的结果，右侧窗口不完整
+///
+/// \code
+/// SA::SAHampelFilter::Result r;
+/// while(hampel.flush(&r))
+/// {
+///     ...
+/// }
+/// \endcode
+///
+bool SAHampelFilter::flush(Result *res)
+{
+    if(!m_state)
+    {
+        return false;
+    }
+    return m_state->flush(res);
+}
+
+void SAHampelFilter::reset()
+{
+    if(m_state)
+    {
+        m_state->reset();
+    }
+}
+///
+/// \brief 批量检测
+///
+/// 用独立的状态计算，不影响\sa push 的数据
+/// \param in 输入
+/// \param n 数据长度
+/// \param outliers 异常值的索引，按升序追加
+/// \param filtered 不为nullptr时输出滤波结果，异常值替换为窗口中位数，可以和in是同一块内存
+/// \return 参数无效时返回false
+///
+bool SAHampelFilter::detect(const double *in, size_t n, std::vector<size_t> &outliers, double *filtered) const
+{
+    if(!isValid())
+    {
+        return false;
+    }
+    if(0 == n)
+    {
+        return true;
+    }
+    const size_t k = static_cast<size_t>(m_halfWindow);
+    //原地输出时分段会读到相邻段已经改写的数据
+    const int parts = (filtered == in) ? 1 : parallelPartCount(static_cast<qint64>(n)
+                                                               ,qMax<qint64>(SA_HAMPEL_PARALLEL_CHUNK,8 * static_cast<qint64>(k)));
+    const size_t step = (n + parts - 1) / parts;
+    std::vector<std::vector<size_t> > partOutliers(parts);
+    const double nSigma = m_nSigma;
+    parallelFor(parts,[&](int part){
+        const size_t b = std::min(n,part * step);
+        const size_t e = std::min(n,b + step);
+        //从b-k开始推入，序号相对于s
+        const size_t s = (b >= k) ? (b - k) : 0;
+        const size_t last = std::min(n,e + k);
+        std::unique_ptr<SAHampelState> state(create_hampel_state(static_cast<int>(k),nSigma));
+        std::vector<size_t>& out = partOutliers[part];
+        SAHampelFilter::Result r;
+        auto take = [&](){
+            const size_t i = s + static_cast<size_t>(r.index);
+            if(i < b || i >= e)
+            {
+                return;
+            }
+            if(r.isOutlier)
+            {
+                out.push_back(i);
+            }
+            if(filtered)
+            {
+                filtered[i] = r.isOutlier ? r.median : r.value;
+            }
+        };
+        for(size_t i=s;i<last;++i)
+        {
+            if(state->push(in[i],&r))
+            {
+                take();
+            }
+        }
+        if(last == n)
+        {
+            while(state->flush(&r))
+            {
+                take();
+            }
+        }
+    });
+    size_t total = outliers.size();
+    for(const std::vector<size_t>& p : partOutliers)
+    {
+        total += p.size();
+    }
+    outliers.reserve(total);
+    for(const std::vector<size_t>& p : partOutliers)
+    {
+        outliers.insert(outliers.end(),p.begin(),p.end());
+    }
+    return true;
+}
+
+}
@@ -0,0 +1,67 @@
+#ifndef SAHAMPELFILTER_H
+#define SAHAMPELFILTER_H
+#include <stddef.h>
+#include <memory>
+#include <vector>
+#include "SAScienceGlobal.h"
+namespace SA {
+class SAHampelState;
+///
+/// \brief Hampel异常值检测
+///
+/// 对每个点取以它为中心、两侧各halfWindow个点的窗口，计算窗口的中位数m和绝对中位差MAD，
+/// 以σ=1.4826·MAD作为稳健的标准差估计，|x-m| > nSigma·σ 的点判为异常值。
+/// 和全局的均值±nσ（\sa SA::get_n_sigma_rang ）相比，对非平稳信号的局部尖峰敏感，且不受异常值本身影响。
+///
+/// - 窗口数据保存在有序结构中，小窗口用有序数组，大窗口用可按秩索引的跳表，每个点O(log w)更新中位数，
+///   MAD在两个有序的距离序列上二分查找，不需要排序
+/// - 边缘不足半个窗口的点用已有的点计算
+/// - nan不参与统计，也不会被判为异常值
+/// - 批量计算只遍历一遍数据，数据量大时分段并行，每段读取两侧半个窗口的重叠数据
+///
+/// 实时采集时逐个\sa push ，右侧窗口凑满后得到中心点的结果，结束时调用\sa flush 取出剩余点的结果
+///
+/// \code
+/// SA::SAHampelFilter hampel(10,3);
+/// std::vector<size_t> outliers;
+/// hampel.detect(ys.data(),ys.size(),outliers);
+/// \endcode
+///
+class SASCIENCE_API SAHampelFilter
+{
+public:
+    ///
+    /// \brief 一个点的判断结果
+    ///
+    struct Result
+    {
+        long long index;///< 数据序号，从0开始
+        double value;///< 原始值
+        double median;///< 窗口中位数
+        double sigma;///< 1.4826·MAD
+        bool isOutlier;
+    };
+    SAHampelFilter(int halfWindow,double nSigma = 3);
+    ~SAHampelFilter();
+    //参数是否有效，半窗口非负且nSigma非负
+    bool isValid() const;
+    int halfWindow() const;
+    double nSigma() const;
+    //推入一个数据，得到了某个点的结果时返回true
+    bool push(double v,Result* res);
+    //数据结束，取出一个剩余点的结果，没有剩余点时返回false
+    bool flush(Result* res);
+    //清空
+    void reset();
+    //批量检测，outliers按升序保存异常值索引，filtered不为nullptr时输出把异常值替换为窗口中位数的结果
+    bool detect(const double* in,size_t n,std::vector<size_t>& outliers,double* filtered = nullptr) const;
+private:
+    SAHampelFilter(const SAHampelFilter&) = delete;
+    SAHampelFilter& operator=(const SAHampelFilter&) = delete;
+private:
+    std::unique_ptr<SAHampelState> m_state;
+    int m_halfWindow;
+    double m_nSigma;
+};
+}
+#endif // SAHAMPELFILTER_H
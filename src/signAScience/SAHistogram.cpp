@@ -0,0 +1,608 @@
+#include "SAHistogram.h"
+#include "SAParallel.h"
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+///
+/// \def 定义此宏关闭求最值的simd
+///
+//#define SA_HIST_NO_SIMD
+
+#if !defined(SA_HIST_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define SA_HIST_SSE2
+#include <emmintrin.h>
+#endif
+
+///
+/// \def 每个并行分段至少处理的数据个数，数据量小时不分段
+///
+#ifndef SA_HIST_PARALLEL_CHUNK
+#define SA_HIST_PARALLEL_CHUNK (1<<16)
+#endif
+
+///
+/// \def 可扩展直方图默认的段数上限
+///
+#ifndef SA_HIST_MAX_BINS
+#define SA_HIST_MAX_BINS (1<<20)
+#endif
+
+namespace SA {
+
+static void minmax_part(const double* x,size_t n,double& lo,double& hi);
+static void minmax_finite_part(const double* x,size_t n,double& lo,double& hi);
+static bool range_of(const double* x,size_t n,double& lo,double& hi);
+
+SAHistogram::SAHistogram()
+    :m_lower(0)
+    ,m_upper(0)
+    ,m_width(0)
+    ,m_underflow(0)
+    ,m_overflow(0)
+    ,m_maxBins(SA_HIST_MAX_BINS)
+    ,m_extendable(true)
+{
+
+}
+
+bool SAHistogram::setRange(double lo, double hi, int bins)
+{
+    if(bins <= 0 || !(hi > lo) || !std::isfinite(lo) || !std::isfinite(hi))
+    {
+        return false;
+    }
+    m_counts.assign(bins,0.0);
+    m_lower = lo;
+    m_upper = hi;
+    m_width = (hi - lo) / bins;
+    m_underflow = m_overflow = 0;
+    return true;
+}
+
+bool SAHistogram::hasRange() const
+{
+    return !m_counts.empty();
+}
+
+void SAHistogram::setExtendable(bool on)
+{
+    m_extendable = on;
+}
+
+bool SAHistogram::isExtendable() const
+{
+    return m_extendable;
+}
+
+void SAHistogram::setMaxBins(int maxBins)
+{
+    m_maxBins = std::max(maxBins,1);
+}
+
+int SAHistogram::maxBins() const
+{
+    return m_maxBins;
+}
+
+int SAHistogram::bins() const
+{
+    return static_cast<int>(m_counts.size());
+}
+
+double SAHistogram::lower() const
+{
+    return m_lower;
+}
+
+double SAHistogram::upper() const
+{
+    return m_upper;
+}
+
+double SAHistogram::binWidth() const
+{
+    return m_width;
+}
+
+double SAHistogram::edge(int i) const
+{
+    //上限单独保存，避免舍入误差使最大值落在范围外
+    return (i == bins()) ? m_upper : (m_lower + i * m_width);
+}
+
+double SAHistogram::count(int i) const
+{
+    return m_counts[i];
+}
+
+const std::vector<double> &SAHistogram::counts() const
+{
+    return m_counts;
+}
+
+double SAHistogram::total() const
+{
+    double s = 0;
+    for(double c : m_counts)
+    {
+        s += c;
+    }
+    return s;
+}
+
+double SAHistogram::underflow() const
+{
+    return m_underflow;
+}
+
+double SAHistogram::overflow() const
+{
+    return m_overflow;
+}
+
+void SAHistogram::clear()
+{
+    std::fill(m_counts.begin(),m_counts.end(),0.0);
+    m_underflow = m_overflow = 0;
+}
+
+void SAHistogram::reset()
+{
+    m_counts.clear();
+    m_lower = m_upper = m_width = 0;
+    m_underflow = m_overflow = 0;
+}
+///
+/// \brief 按数据的范围分bins段统计
+/// \param x 数据
+/// \param n 数据长度
+/// \param bins 段数
+/// \param w 权重，nullptr时每个点权重为1
+/// \return 段数不合法或没有有效数据时返回false
+///
+bool SAHistogram::compute(const double *x, size_t n, int bins, const double *w)
+{
+    double lo,hi;
+    if(bins <= 0 || !range_of(x,n,lo,hi))
+    {
+        return false;
+    }
+    setRange(lo,hi,bins);
+    accumulate(x,n,w);
+    return true;
+}
+///
+/// \brief 按Freedman–Diaconis规则确定段数后统计
+/// \see compute
+///
+bool SAHistogram::computeAuto(const double *x, size_t n, const double *w)
+{
+    return compute(x,n,freedmanDiaconisBins(x,n,m_maxBins),w);
+}
+///
+/// \brief 追加数据
+///
+/// 可扩展时先扩展范围覆盖新数据再计数，只扫描新数据
+/// \return 没有范围且新数据中没有有效数据时返回false
+///
+bool SAHistogram::append(const double *x, size_t n, const double *w)
+{
+    if(!hasRange())
+    {
+        return computeAuto(x,n,w);
+    }
+    double lo,hi;
+    if(m_extendable && minmax(x,n,lo,hi))
+    {
+        extend(lo,hi);
+    }
+    accumulate(x,n,w);
+    return true;
+}
+
+int SAHistogram::freedmanDiaconisBins(const double *x, size_t n, int maxBins)
+{
+    std::vector<double> v;
+    v.reserve(n);
+    for(size_t i=0;i<n;++i)
+    {
+        if(std::isfinite(x[i]))
+        {
+            v.push_back(x[i]);
+        }
+    }
+    if(v.size() < 2)
+    {
+        return 1;
+    }
+    const size_t m = v.size();
+    std::vector<double>::iterator q1 = v.begin() + (m - 1) / 4;
+    std::nth_element(v.begin(),q1,v.end());
+    const double v1 = *q1;
+    std::vector<double>::iterator q3 = v.begin() + (3 * (m - 1)) / 4;
+    std::nth_element(q1,q3,v.end());
+    const double v3 = *q3;
+    const double lo = *std::min_element(v.begin(),q1 + 1);
+    const double hi = *std::max_element(q3,v.end());
+    const double h = 2.0 * (v3 - v1) / std::cbrt(static_cast<double>(m));
+    double bins;
+    if(h > 0 && hi > lo)
+    {
+        bins = std::ceil((hi - lo) / h);
+    }
+    else
+    {
+        bins = std::ceil(std::log2(static_cast<double>(m))) + 1;
+    }
+    return static_cast<int>(std::min<double>(std::max(bins,1.0),std::max(maxBins,1)));
+}
+///
+/// \brief 最小最大值，忽略nan，数据量大时分段并行
+///
+bool SAHistogram::minmax(const double *x, size_t n, double &lo, double &hi)
+{
+    const int parts = parallelPartCount(static_cast<qint64>(n),SA_HIST_PARALLEL_CHUNK);
+    const size_t step = (n + parts - 1) / parts;
+    std::vector<double> los(parts),his(parts);
+    parallelFor(parts,[&](int part){
+        const size_t b = std::min(n,part * step);
+        const size_t e = std::min(n,b + step);
+        minmax_part(x + b,e - b,los[part],his[part]);
+    });
+    lo = *std::min_element(los.begin(),los.end());
+    hi = *std::max_element(his.begin(),his.end());
+    return lo <= hi;
+}
+///
+/// \brief 扩展范围覆盖[lo,hi]
+///
+/// 段宽不变，两侧补整数个段；段数超过上限时先把相邻两段合并
+///
+void SAHistogram::extend(double lo, double hi)
+{
+    if(!std::isfinite(lo) || !std::isfinite(hi))
+    {
+        return;
+    }
+    long long below,above;
+    for(;;)
+    {
+        below = 0;
+        above = 0;
+        if(lo < m_lower)
+        {
+            below = static_cast<long long>(std::ceil((m_lower - lo) / m_width));
+            while(m_lower - below * m_width > lo)
+            {
+                ++below;
+            }
+        }
+        if(hi > m_upper)
+        {
+            above = static_cast<long long>(std::ceil((hi - m_upper) / m_width));
+            while(m_lower + (bins() + above) * m_width < hi)
+            {
+                ++above;
+            }
+        }
+        if(bins() + below + above <= m_maxBins)
+        {
+            break;
+        }
+        //合并相邻两段，段数为奇数时在上侧补一个空段
+        if(m_counts.size() & 1)
+        {
+            m_counts.push_back(0.0);
+        }
+        const size_t half = m_counts.size() / 2;
+        for(size_t i=0;i<half;++i)
+        {
+            m_counts[i] = m_counts[2 * i] + m_counts[2 * i + 1];
+        }
+        m_counts.resize(half);
+        m_width *= 2;
+        m_upper = std::max(m_upper,m_lower + bins() * m_width);
+    }
+    if(below > 0)
+    {
+        m_counts.insert(m_counts.begin(),static_cast<size_t>(below),0.0);
+        m_lower -= below * m_width;
+    }
+    if(above > 0)
+    {
+        m_counts.insert(m_counts.end(),static_cast<size_t>(above),0.0);
+        m_upper = std::max(hi,m_lower + bins() * m_width);
+    }
+}
+///
+/// \brief 计数，每个线程统计到私有数组再合并
+///
+void SAHistogram::accumulate(const double *x, size_t n, const double *w)
+{
+    const int bins = this->bins();
+    const int parts = parallelPartCount(static_cast<qint64>(n)
+                                        ,qMax<qint64>(SA_HIST_PARALLEL_CHUNK,4 * static_cast<qint64>(bins)));
+    const size_t step = (n + parts - 1) / parts;
+    const double lo = m_lower;
+    const double hi = upper();
+    const double inv = 1.0 / m_width;
+    std::vector<std::vector<double> > partCounts(parts);
+    std::vector<double> partUnder(parts,0.0),partOver(parts,0.0);
+    parallelFor(parts,[&](int part){
+        const size_t b = std::min(n,part * step);
+        const size_t e = std::min(n,b + step);
+        std::vector<double>& c = partCounts[part];
+        c.assign(bins,0.0);
+        double under = 0,over = 0;
+        for(size_t i=b;i<e;++i)
+        {
+            const double v = x[i];
+            const double wi = w ? w[i] : 1.0;
+            if(v >= lo && v <= hi)
+            {
+                const int k = static_cast<int>((v - lo) * inv);
+                c[(k < bins) ? k : (bins - 1)] += wi;
+            }
+            else if(v < lo)
+            {
+                under += wi;
+            }
+            else if(v > hi)
+            {
+                over += wi;
+            }
+        }
+        partUnder[part] = under;
+        partOver[part] = over;
+    });
+    for(int p=0;p<parts;++p)
+    {
+        const std::vector<double>& c = partCounts[p];
+        for(int i=0;i<bins;++i)
+        {
+            m_counts[i] += c[i];
+        }
+        m_underflow += partUnder[p];
+        m_overflow += partOver[p];
+    }
+}
+
+SAHistogram2D::SAHistogram2D()
+    :m_xlower(0)
+    ,m_xupper(0)
+    ,m_xwidth(0)
+    ,m_xbins(0)
+    ,m_ylower(0)
+    ,m_yupper(0)
+    ,m_ywidth(0)
+    ,m_ybins(0)
+    ,m_outside(0)
+{
+
+}
+
+bool SAHistogram2D::setRange(double xlo, double xhi, int xbins, double ylo, double yhi, int ybins)
+{
+    if(xbins <= 0 || ybins <= 0 || !(xhi > xlo) || !(yhi > ylo)
+            || !std::isfinite(xlo) || !std::isfinite(xhi) || !std::isfinite(ylo) || !std::isfinite(yhi))
+    {
+        return false;
+    }
+    m_counts.assign(static_cast<size_t>(xbins) * ybins,0.0);
+    m_xlower = xlo;
+    m_xupper = xhi;
+    m_xwidth = (xhi - xlo) / xbins;
+    m_xbins = xbins;
+    m_ylower = ylo;
+    m_yupper = yhi;
+    m_ywidth = (yhi - ylo) / ybins;
+    m_ybins = ybins;
+    m_outside = 0;
+    return true;
+}
+
+bool SAHistogram2D::hasRange() const
+{
+    return !m_counts.empty();
+}
+
+int SAHistogram2D::xbins() const
+{
+    return m_xbins;
+}
+
+int SAHistogram2D::ybins() const
+{
+    return m_ybins;
+}
+
+double SAHistogram2D::xedge(int i) const
+{
+    return (i == m_xbins) ? m_xupper : (m_xlower + i * m_xwidth);
+}
+
+double SAHistogram2D::yedge(int i) const
+{
+    return (i == m_ybins) ? m_yupper : (m_ylower + i * m_ywidth);
+}
+
+double SAHistogram2D::count(int ix, int iy) const
+{
+    return m_counts[static_cast<size_t>(ix) * m_ybins + iy];
+}
+
+const std::vector<double> &SAHistogram2D::counts() const
+{
+    return m_counts;
+}
+
+double SAHistogram2D::outside() const
+{
+    return m_outside;
+}
+
+void SAHistogram2D::clear()
+{
+    std::fill(m_counts.begin(),m_counts.end(),0.0);
+    m_outside = 0;
+}
+///
+/// \brief 按数据的范围统计
+/// \param x x数据
+/// \param y y数据
+/// \param n 数据长度
+/// \param xbins x方向段数
+/// \param ybins y方向段数
+/// \param w 权重，nullptr时每个点权重为1
+/// \return 段数不合法或没有有效数据时返回false
+///
+bool SAHistogram2D::compute(const double *x, const double *y, size_t n, int xbins, int ybins, const double *w)
+{
+    double xlo,xhi,ylo,yhi;
+    if(xbins <= 0 || ybins <= 0 || !range_of(x,n,xlo,xhi) || !range_of(y,n,ylo,yhi))
+    {
+        return false;
+    }
+    setRange(xlo,xhi,xbins,ylo,yhi,ybins);
+    return append(x,y,n,w);
+}
+
+bool SAHistogram2D::append(const double *x, const double *y, size_t n, const double *w)
+{
+    if(!hasRange())
+    {
+        return false;
+    }
+    const size_t cells = m_counts.size();
+    const int parts = parallelPartCount(static_cast<qint64>(n)
+                                        ,qMax<qint64>(SA_HIST_PARALLEL_CHUNK,4 * static_cast<qint64>(cells)));
+    const size_t step = (n + parts - 1) / parts;
+    const double xlo = m_xlower,xhi = xedge(m_xbins),xinv = 1.0 / m_xwidth;
+    const double ylo = m_ylower,yhi = yedge(m_ybins),yinv = 1.0 / m_ywidth;
+    const int nx = m_xbins,ny = m_ybins;
+    std::vector<std::vector<double> > partCounts(parts);
+    std::vector<double> partOutside(parts,0.0);
+    parallelFor(parts,[&](int part){
+        const size_t b = std::min(n,part * step);
+        const size_t e = std::min(n,b + step);
+        std::vector<double>& c = partCounts[part];
+        c.assign(cells,0.0);
+        double outside = 0;
+        for(size_t i=b;i<e;++i)
+        {
+            const double vx = x[i];
+            const double vy = y[i];
+            if(std::isnan(vx) || std::isnan(vy))
+            {
+                continue;
+            }
+            const double wi = w ? w[i] : 1.0;
+            if(vx >= xlo && vx <= xhi && vy >= ylo && vy <= yhi)
+            {
+                int kx = static_cast<int>((vx - xlo) * xinv);
+                int ky = static_cast<int>((vy - ylo) * yinv);
+                kx = (kx < nx) ? kx : (nx - 1);
+                ky = (ky < ny) ? ky : (ny - 1);
+                c[static_cast<size_t>(kx) * ny + ky] += wi;
+            }
+            else
+            {
+                outside += wi;
+            }
+        }
+        partOutside[part] = outside;
+    });
+    for(int p=0;p<parts;++p)
+    {
+        const std::vector<double>& c = partCounts[p];
+        for(size_t i=0;i<cells;++i)
+        {
+            m_counts[i] += c[i];
+        }
+        m_outside += partOutside[p];
+    }
+    return true;
+}
+
+///
+/// \brief 统计用的范围，忽略nan和inf，所有数据相等时以该值为中心取宽度为1的范围
+///
+bool range_of(const double* x,size_t n,double& lo,double& hi)
+{
+    if(!SAHistogram::minmax(x,n,lo,hi))
+    {
+        return false;
+    }
+    if(!std::isfinite(lo) || !std::isfinite(hi))
+    {
+        minmax_finite_part(x,n,lo,hi);
+        if(!(lo <= hi))
+        {
+            return false;
+        }
+    }
+    if(lo == hi)
+    {
+        lo -= 0.5;
+        hi += 0.5;
+    }
+    return true;
+}
+
+void minmax_part(const double* x,size_t n,double& lo,double& hi)
+{
+    size_t i = 0;
+    lo = std::numeric_limits<double>::infinity();
+    hi = -std::numeric_limits<double>::infinity();
+#ifdef SA_HIST_SSE2
+    //minpd/maxpd在有nan时返回第二个操作数，累加值放在第二个操作数即可跳过nan
+    __m128d mn0 = _mm_set1_pd(lo),mn1 = mn0;
+    __m128d mx0 = _mm_set1_pd(hi),mx1 = mx0;
+    for(;i+4<=n;i+=4)
+    {
+        const __m128d a = _mm_loadu_pd(x + i);
+        const __m128d b = _mm_loadu_pd(x + i + 2);
+        mn0 = _mm_min_pd(a,mn0);
+        mn1 = _mm_min_pd(b,mn1);
+        mx0 = _mm_max_pd(a,mx0);
+        mx1 = _mm_max_pd(b,mx1);
+    }
+    mn0 = _mm_min_pd(mn0,mn1);
+    mx0 = _mm_max_pd(mx0,mx1);
+    double buf[2];
+    _mm_storeu_pd(buf,mn0);
+    lo = std::min(buf[0],buf[1]);
+    _mm_storeu_pd(buf,mx0);
+    hi = std::max(buf[0],buf[1]);
+#endif
+    for(;i<n;++i)
+    {
+        const double v = x[i];
+        if(v < lo)
+        {
+            lo = v;
+        }
+        if(v > hi)
+        {
+            hi = v;
+        }
+    }
+}
+
+void minmax_finite_part(const double* x,size_t n,double& lo,double& hi)
+{
+    lo = std::numeric_limits<double>::infinity();
+    hi = -std::numeric_limits<double>::infinity();
+    for(size_t i=0;i<n;++i)
+    {
+        const double v = x[i];
+        if(std::isfinite(v))
+        {
+            lo = std::min(lo,v);
+            hi = std::max(hi,v);
+        }
+    }
+}
+
+}
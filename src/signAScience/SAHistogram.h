@@ -0,0 +1,122 @@
+#ifndef SAHISTOGRAM_H
+#define SAHISTOGRAM_H
+#include <stddef.h>
+#include <vector>
+#include "SAScienceGlobal.h"
+namespace SA {
+///
+/// \brief 一维直方图
+///
+/// - 分段为等宽区间，数据等于上限时计入最后一段
+/// - 每个线程统计到私有的计数数组，最后合并，计数是权重之和，不带权重时每个点的权重为1
+/// - 范围由数据决定时，先用simd并行求最小最大值，再分段计数
+/// - 支持固定段数和Freedman–Diaconis自动段数
+/// - 增量追加数据时，可扩展的直方图保持段宽不变，在两侧增加段覆盖新数据，
+///   段数超过上限时相邻两段合并，段宽加倍，段边界始终对齐，计数是精确的；
+///   不可扩展时超出范围的数据计入下溢/上溢
+/// - nan不参与统计
+///
+/// \code
+/// SA::SAHistogram h;
+/// h.compute(ys.data(),ys.size(),100);
+/// for(int i=0;i<h.bins();++i)
+/// {
+///     qDebug() << h.edge(i) << h.edge(i+1) << h.count(i);
+/// }
+/// \endcode
+///
+class SASCIENCE_API SAHistogram
+{
+public:
+    SAHistogram();
+    //设置范围[lo,hi]等分为bins段，并清空计数
+    bool setRange(double lo,double hi,int bins);
+    //是否已有范围
+    bool hasRange() const;
+    //追加的数据超出范围时是否扩展范围，默认扩展
+    void setExtendable(bool on);
+    bool isExtendable() const;
+    //扩展时段数的上限
+    void setMaxBins(int maxBins);
+    int maxBins() const;
+    int bins() const;
+    double lower() const;
+    double upper() const;
+    double binWidth() const;
+    //第i段的下边界，i∈[0,bins]
+    double edge(int i) const;
+    double count(int i) const;
+    const std::vector<double>& counts() const;
+    //落在范围内的权重和
+    double total() const;
+    double underflow() const;
+    double overflow() const;
+    //清空计数，保留范围
+    void clear();
+    //清空计数和范围
+    void reset();
+    //按数据的范围分bins段统计
+    bool compute(const double* x,size_t n,int bins,const double* w = nullptr);
+    //按Freedman–Diaconis规则确定段数后统计
+    bool computeAuto(const double* x,size_t n,const double* w = nullptr);
+    //追加数据，没有范围时相当于computeAuto
+    bool append(const double* x,size_t n,const double* w = nullptr);
+    //Freedman–Diaconis规则的段数，段宽为2·IQR/n^(1/3)，IQR为0时用Sturges规则
+    static int freedmanDiaconisBins(const double* x,size_t n,int maxBins);
+    //最小最大值，忽略nan，没有有效数据时返回false
+    static bool minmax(const double* x,size_t n,double& lo,double& hi);
+private:
+    void extend(double lo,double hi);
+    void accumulate(const double* x,size_t n,const double* w);
+private:
+    std::vector<double> m_counts;
+    double m_lower;
+    double m_upper;
+    double m_width;
+    double m_underflow;
+    double m_overflow;
+    int m_maxBins;
+    bool m_extendable;
+};
+
+///
+/// \brief 二维直方图
+///
+/// 计数按行优先保存，第ix个x段、第iy个y段的计数为counts()[ix*ybins()+iy]，
+/// 超出范围的点计入outside，x或y为nan的点不参与统计
+///
+class SASCIENCE_API SAHistogram2D
+{
+public:
+    SAHistogram2D();
+    //设置范围并清空计数
+    bool setRange(double xlo,double xhi,int xbins,double ylo,double yhi,int ybins);
+    bool hasRange() const;
+    int xbins() const;
+    int ybins() const;
+    //x方向第i段的下边界，i∈[0,xbins]
+    double xedge(int i) const;
+    //y方向第i段的下边界，i∈[0,ybins]
+    double yedge(int i) const;
+    double count(int ix,int iy) const;
+    const std::vector<double>& counts() const;
+    double outside() const;
+    void clear();
+    //按数据的范围统计
+    bool compute(const double* x,const double* y,size_t n,int xbins,int ybins,const double* w = nullptr);
+    //在当前范围内追加数据
+    bool append(const double* x,const double* y,size_t n,const double* w = nullptr);
+private:
+    std::vector<double> m_counts;
+    double m_xlower;
+    double m_xupper;
+    double m_xwidth;
+    int m_xbins;
+    double m_ylower;
+    double m_yupper;
+    double m_ywidth;
+    int m_ybins;
+    double m_outside;
+};
+}
+#endif // SAHISTOGRAM_H
@@ -1,21 +1,34 @@
 #include "SAInterpolation.h"
+#include "SAParallel.h"
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
+#include <limits>
 
 
 
 
 #include "gsl/gsl_errno.h"
-#include "gsl/gsl_vector.h" /* 提供了向量结构*/
 #include "gsl/gsl_interp.h"
-#include "gsl/gsl_spline.h" /* 样条插值支持 */
 
+///
+/// \def 批量插值时每个并行分段至少计算的点数，数据量小时不分段
+///
+#ifndef SA_INTERP_PARALLEL_CHUNK
+#define SA_INTERP_PARALLEL_CHUNK (1<<14)
+#endif
 
+///
+/// \def 查找样本区间时先顺序向前查找的次数，超过后改为二分查找
+///
+#ifndef SA_INTERP_LINEAR_STEPS
+#define SA_INTERP_LINEAR_STEPS 8
+#endif
 
-
-#include "gsl/gsl_spline.h"
+namespace SA {
+static size_t interp_locate(const double* x,size_t n,double q,size_t i);
+}
 
 class SA::SAInterpolationPrivate
 {
@@ -23,25 +36,113 @@ class SA::SAInterpolationPrivate
 public:
     SAInterpolationPrivate(SAInterpolation* p);
     ~SAInterpolationPrivate();
-    gsl_spline* m_spline;
-    gsl_interp_accel *m_accel;
+    //检查样本是否可以插值
+    static bool check(const double* x,size_t length,SAInterpolation::InterpType type);
+    //根据样本建立插值，样本需先通过check
+    bool setup(const double* x,const double* y,size_t length,SAInterpolation::InterpType type);
+    //计算插值，acc为调用线程自己的加速器
+    double eval(double q,gsl_interp_accel* acc) const;
+    //批量计算，query(k)得到第k个x，out(k,y)写出结果
+    template<typename QUERY,typename OUT>
+    void evalRange(size_t n,QUERY query,OUT out) const;
+    gsl_interp* m_interp;
+    gsl_interp_accel m_accel;///< getY使用的加速器
+    std::vector<double> m_xs;///< 复制或接管的样本，initView时为空
+    std::vector<double> m_ys;
+    const double* m_x;
+    const double* m_y;
+    size_t m_size;
+    SAInterpolation::InterpType m_type;
     static const gsl_interp_type* castInterpType2GslInterpType(INPUT SAInterpolation::InterpType type);
 };
 
 SA::SAInterpolationPrivate::SAInterpolationPrivate(SAInterpolation *p)
     :q_ptr(p),
-     m_spline(nullptr),
-     m_accel(nullptr)
+     m_interp(nullptr),
+     m_x(nullptr),
+     m_y(nullptr),
+     m_size(0),
+     m_type(SAInterpolation::LINEAR)
 {
-
+    gsl_interp_accel_reset(&m_accel);
 }
 
 SA::SAInterpolationPrivate::~SAInterpolationPrivate()
 {
-    if(m_spline != nullptr)
-        gsl_spline_free (m_spline);
-    if(m_accel != nullptr)
-        gsl_interp_accel_free (m_accel);
+    if(m_interp != nullptr)
+        gsl_interp_free (m_interp);
+}
+
+bool SA::SAInterpolationPrivate::check(const double *x, size_t length, SAInterpolation::InterpType type)
+{
+    const gsl_interp_type* t = castInterpType2GslInterpType(type);
+    if(nullptr == t || length < 2 || length < t->min_size)
+    {
+        return false;
+    }
+    //x必须严格递增，同时排除了nan
+    for(size_t i=1;i<length;++i)
+    {
+        if(!(x[i-1] < x[i]))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool SA::SAInterpolationPrivate::setup(const double *x, const double *y, size_t length, SAInterpolation::InterpType type)
+{
+    gsl_interp* interp = gsl_interp_alloc(castInterpType2GslInterpType(type),length);
+    if(nullptr == interp)
+    {
+        return false;
+    }
+    if(m_interp != nullptr)
+    {
+        gsl_interp_free (m_interp);
+    }
+    m_interp = interp;
+    gsl_interp_init(m_interp,x,y,length);//计算插值的系数，不复制x,y
+    m_x = x;
+    m_y = y;
+    m_size = length;
+    m_type = type;
+    gsl_interp_accel_reset(&m_accel);
+    return true;
+}
+
+double SA::SAInterpolationPrivate::eval(double q, gsl_interp_accel *acc) const
+{
+    if(!(q >= m_x[0] && q <= m_x[m_size-1]))
+    {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    const size_t i = interp_locate(m_x,m_size,q,acc->cache);
+    acc->cache = i;
+    if(SAInterpolation::LINEAR == m_type)
+    {
+        return m_y[i] + (m_y[i+1] - m_y[i]) * ((q - m_x[i]) / (m_x[i+1] - m_x[i]));
+    }
+    //加速器已指向所在区间，gsl不会再二分查找
+    return gsl_interp_eval(m_interp,m_x,m_y,q,acc);
+}
+
+template<typename QUERY,typename OUT>
+void SA::SAInterpolationPrivate::evalRange(size_t n, QUERY query, OUT out) const
+{
+    const int parts = parallelPartCount(static_cast<qint64>(n),SA_INTERP_PARALLEL_CHUNK);
+    const size_t step = (n + parts - 1) / parts;
+    parallelFor(parts,[&](int part){
+        const size_t b = std::min(n,part * step);
+        const size_t e = std::min(n,b + step);
+        gsl_interp_accel acc;
+        gsl_interp_accel_reset(&acc);
+        for(size_t k=b;k<e;++k)
+        {
+            out(k,eval(query(k),&acc));
+        }
+    });
 }
 
 const gsl_interp_type *SA::SAInterpolationPrivate::castInterpType2GslInterpType(SAInterpolation::InterpType type)
@@ -64,6 +165,40 @@ const gsl_interp_type *SA::SAInterpolationPrivate::castInterpType2GslInterpType(
     return nullptr;
 }
 
+/**
+ * @brief 查找q所在的样本区间
+ *
+ * 从上一次的区间i开始，q在其后时先顺序向前查找几步，仍未找到再二分查找，q在其前时二分查找
+ * @param x 样本x，严格递增
+ * @param n 样本点数
+ * @param q 查询值，需在[x[0],x[n-1]]内
+ * @param i 上一次的区间
+ * @return 区间序号i，满足x[i]<=q<x[i+1]，q等于x[n-1]时返回n-2
+ */
+size_t SA::interp_locate(const double *x, size_t n, double q, size_t i)
+{
+    if(i > n - 2)
+    {
+        i = n - 2;
+    }
+    if(q < x[i])
+    {
+        return (std::upper_bound(x,x + i,q) - x) - 1;
+    }
+    for(int s=0;s<SA_INTERP_LINEAR_STEPS && i < n - 2;++s,++i)
+    {
+        if(q < x[i+1])
+        {
+            return i;
+        }
+    }
+    if(i == n - 2 || q < x[i+1])
+    {
+        return i;
+    }
+    return (std::upper_bound(x + i + 1,x + n - 1,q) - x) - 1;
+}
+
 SA::SAInterpolation::SAInterpolation():d_ptr(new SAInterpolationPrivate(this))
 {
 
@@ -76,69 +211,219 @@ SA::SAInterpolation::~SAInterpolation()
 
 /**
  * @brief 初始化，根据样本和插值的类型进行初始化
- * @param x 样本的x值
+ * @param x 样本的x值，必须严格递增
  * @param y 样本的y值
  * @param length 长度
  * @param type 插值的形式
- * @return
+ * @return 样本不满足插值条件时返回false，此时保持原来的插值
+ * @note 样本数据会复制一份，如果能保证样本在插值期间有效，可使用\sa initView 避免复制
  */
 bool SA::SAInterpolation::init(const double *x,
                                const double *y,
                                const size_t length,
                                SA::SAInterpolation::InterpType type)
 {
-    if(length <= 0)
+    if(!SAInterpolationPrivate::check(x,length,type))
     {
         return false;
     }
+    std::vector<double> xs(x,x + length),ys(y,y + length);
+    return init(std::move(xs),std::move(ys),type);
+}
 
-    gsl_spline* spl = gsl_spline_alloc (d_ptr->castInterpType2GslInterpType(type), length);
-    if(nullptr == spl)
+/**
+ * @brief 以float样本初始化，样本转换为double保存
+ * @param x 样本的x值，必须严格递增
+ * @param y 样本的y值
+ * @param length 长度
+ * @param type 插值的形式
+ * @return 样本不满足插值条件时返回false
+ */
+bool SA::SAInterpolation::init(const float *x,
+                               const float *y,
+                               const size_t length,
+                               SA::SAInterpolation::InterpType type)
+{
+    std::vector<double> xs(x,x + length),ys(y,y + length);
+    return init(std::move(xs),std::move(ys),type);
+}
+
+/**
+ * @brief 初始化，接管样本数据，不复制
+ * @param x 样本的x值，必须严格递增
+ * @param y 样本的y值，长度和x不一致时取较短的长度
+ * @param type 插值的形式
+ * @return 样本不满足插值条件时返回false，此时x,y不会被移走
+ */
+bool SA::SAInterpolation::init(std::vector<double> &&x,
+                               std::vector<double> &&y,
+                               SA::SAInterpolation::InterpType type)
+{
+    const size_t length = std::min(x.size(),y.size());
+    if(!SAInterpolationPrivate::check(x.data(),length,type))
     {
         return false;
     }
-
-    gsl_interp_accel* accel = gsl_interp_accel_alloc();//插值加速，用在gsl_spline_eval里
-    if(nullptr == accel)
+    std::vector<double> oldx,oldy;
+    oldx.swap(d_ptr->m_xs);
+    oldy.swap(d_ptr->m_ys);
+    d_ptr->m_xs.swap(x);
+    d_ptr->m_ys.swap(y);
+    if(!d_ptr->setup(d_ptr->m_xs.data(),d_ptr->m_ys.data(),length,type))
     {
+        //恢复原来的样本，原来的插值仍引用它们
+        d_ptr->m_xs.swap(x);
+        d_ptr->m_ys.swap(y);
+        d_ptr->m_xs.swap(oldx);
+        d_ptr->m_ys.swap(oldy);
         return false;
     }
+    return true;
+}
 
-    //样条插值初始化，根据插值的样式和长度分配空间
-    if(d_ptr->m_spline != nullptr)
+/**
+ * @brief 初始化，直接引用样本数据，不复制
+ * @param x 样本的x值，必须严格递增
+ * @param y 样本的y值
+ * @param length 长度
+ * @param type 插值的形式
+ * @return 样本不满足插值条件时返回false
+ * @note 调用者需保证x,y在插值期间有效且不被修改
+ */
+bool SA::SAInterpolation::initView(const double *x,
+                                   const double *y,
+                                   const size_t length,
+                                   SA::SAInterpolation::InterpType type)
+{
+    if(!SAInterpolationPrivate::check(x,length,type))
     {
-        gsl_spline_free (d_ptr->m_spline);//说明spline已经分配了内存
+        return false;
     }
-    d_ptr->m_spline = spl;
-    if(d_ptr->m_accel != nullptr)
+    if(!d_ptr->setup(x,y,length,type))
     {
-        gsl_interp_accel_free (d_ptr->m_accel);
+        return false;
     }
-    d_ptr->m_accel = accel;//插值加速，用在gsl_spline_eval里
-
-    gsl_spline_init (d_ptr->m_spline, x, y, length);
+    d_ptr->m_xs.clear();
+    d_ptr->m_xs.shrink_to_fit();
+    d_ptr->m_ys.clear();
+    d_ptr->m_ys.shrink_to_fit();
     return true;
 }
 
+/**
+ * @brief 是否已初始化
+ * @return
+ */
+bool SA::SAInterpolation::isValid() const
+{
+    return d_ptr->m_interp != nullptr;
+}
+
+/**
+ * @brief 样本点数
+ * @return 未初始化时返回0
+ */
+size_t SA::SAInterpolation::size() const
+{
+    return d_ptr->m_size;
+}
+
+/**
+ * @brief 样本x的最小值
+ * @return 未初始化时返回nan
+ */
+double SA::SAInterpolation::xMin() const
+{
+    return isValid() ? d_ptr->m_x[0] : std::numeric_limits<double>::quiet_NaN();
+}
+
+/**
+ * @brief 样本x的最大值
+ * @return 未初始化时返回nan
+ */
+double SA::SAInterpolation::xMax() const
+{
+    return isValid() ? d_ptr->m_x[d_ptr->m_size-1] : std::numeric_limits<double>::quiet_NaN();
+}
+
 /**
  * @brief 根据x，插值计算y值
  * @param x需要计算的x值
- * @return 返回插值得到的y值
- * @note 此函数运行前，需要先确保运行了init函数
+ * @return 返回插值得到的y值，x超出样本范围或未初始化时返回nan
+ * @note 此函数使用对象内部的插值加速器，多线程计算请使用\sa getYs
  */
 double SA::SAInterpolation::getY(double x) const
 {
-    return gsl_spline_eval(d_ptr->m_spline, x, d_ptr->m_accel);
+    if(!isValid())
+    {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    return d_ptr->eval(x,&(d_ptr->m_accel));
+}
+
+/**
+ * @brief 批量获取插值结果
+ * @param x 需要计算的x值，有序时最快
+ * @param n 点数
+ * @param y 插值结果，x超出样本范围时为nan
+ */
+void SA::SAInterpolation::getYs(const double *x, size_t n, double *y) const
+{
+    if(!isValid())
+    {
+        std::fill(y,y + n,std::numeric_limits<double>::quiet_NaN());
+        return;
+    }
+    d_ptr->evalRange(n
+                     ,[x](size_t k)->double{return x[k];}
+                     ,[y](size_t k,double v){y[k] = v;});
+}
+
+/**
+ * @brief 批量获取插值结果，float版本
+ * @param x 需要计算的x值，有序时最快
+ * @param n 点数
+ * @param y 插值结果，x超出样本范围时为nan
+ */
+void SA::SAInterpolation::getYs(const float *x, size_t n, float *y) const
+{
+    if(!isValid())
+    {
+        std::fill(y,y + n,std::numeric_limits<float>::quiet_NaN());
+        return;
+    }
+    d_ptr->evalRange(n
+                     ,[x](size_t k)->double{return x[k];}
+                     ,[y](size_t k,double v){y[k] = static_cast<float>(v);});
+}
+
+/**
+ * @brief 按等间隔的x重采样
+ * @param x0 第一个点的x
+ * @param dx x的间隔
+ * @param n 点数
+ * @param y 重采样结果，第i个点对应x0+i*dx，超出样本范围时为nan
+ */
+void SA::SAInterpolation::resample(double x0, double dx, size_t n, double *y) const
+{
+    if(!isValid())
+    {
+        std::fill(y,y + n,std::numeric_limits<double>::quiet_NaN());
+        return;
+    }
+    d_ptr->evalRange(n
+                     ,[x0,dx](size_t k)->double{return x0 + static_cast<double>(k) * dx;}
+                     ,[y](size_t k,double v){y[k] = v;});
 }
 
 /**
  * @brief 插值计算
- * @param x 初始的x值
+ * @param x 初始的x值，必须严格递增
  * @param y 初始的y值
  * @param type 插值的形式 @see SA::SAInterpolation::InterpType
  * @param newx 要插值的x值
- * @param newy 根据插值样式计算的插值结果
- * @return
+ * @param newy 根据插值样式计算的插值结果，超出样本范围时为nan
+ * @return 样本不满足插值条件时返回false
  */
 bool SA::SAInterpolation::interp(const double *x,
                                  const double *y,
@@ -149,21 +434,11 @@ bool SA::SAInterpolation::interp(const double *x,
                                  double *newy
                                  )
 {
-    //样条插值初始化，根据插值的样式和长度分配空间
-    gsl_spline *spline = gsl_spline_alloc (SAInterpolationPrivate::castInterpType2GslInterpType(type), len);
-    if(nullptr == spline)
-        return false;
-    gsl_interp_accel *acc = gsl_interp_accel_alloc();//插值加速，用在gsl_spline_eval里
-    gsl_spline_init(spline,x,y,len);//计算插值的系数
-    for(size_t i = 0; i<newlen; ++i)
+    SAInterpolation interpolation;
+    if(!interpolation.initView(x,y,len,type))
     {
-        newy[i] = gsl_spline_eval (spline, newx[i], acc);
+        return false;
     }
-    gsl_spline_free (spline);
-    gsl_interp_accel_free (acc);
+    interpolation.getYs(newx,newlen,newy);
     return true;
 }
-
-
-
-
@@ -2,11 +2,26 @@
 #define SAINTERPOLATION_H
 #include "SAScienceGlobal.h"
 #include <algorithm>
+#include <iterator>
 #include <vector>
 namespace SA {
 
 SA_IMPL_FORWARD_DECL(SAInterpolation)
-
+///
+/// \brief 插值
+///
+/// - 样本的x必须严格递增
+/// - 批量计算\sa getYs \sa resample 时每个线程使用自己的插值加速器，数据量大时分段并行；
+///   每段沿着查询点顺序向前查找样本区间，查询点有序时不需要二分查找，无序时退化为二分查找
+/// - 超出样本范围的x结果为nan
+/// - \sa initView 直接引用调用者的样本数据，不复制，调用者需保证插值期间数据有效
+///
+/// \code
+/// SA::SAInterpolation interp;
+/// interp.initView(xs.data(),ys.data(),xs.size(),SA::SAInterpolation::CSPLINE);
+/// interp.getYs(newxs.data(),newxs.size(),newys.data());
+/// \endcode
+///
 class SASCIENCE_API SAInterpolation
 {
     SA_IMPL(SAInterpolation)
@@ -20,22 +35,48 @@ public:
                    };
     SAInterpolation();
     ~SAInterpolation();
-    //初始化插值
+    //初始化插值，会复制样本数据
     bool init(INPUT const double* x
               ,INPUT const double* y
               ,INPUT const size_t length
               ,INPUT InterpType type);
-    //此函数会创建临时空间，如果是能直接获取double指针，直接使用第一种方法
+    //初始化插值，float样本转换为double保存
+    bool init(INPUT const float* x
+              ,INPUT const float* y
+              ,INPUT const size_t length
+              ,INPUT InterpType type);
+    //初始化插值，接管样本数据，不复制
+    bool init(INPUT std::vector<double>&& x
+              ,INPUT std::vector<double>&& y
+              ,INPUT InterpType type);
+    //迭代器版本，样本数据复制一次
     template<typename ITE_DOUBLELIKE_X,typename ITE_DOUBLELIKE_Y>
     bool init(INPUT ITE_DOUBLELIKE_X xbegin,INPUT ITE_DOUBLELIKE_X xend
               ,INPUT ITE_DOUBLELIKE_Y ybegin,INPUT ITE_DOUBLELIKE_Y yend
               ,INPUT InterpType type);
-    //根据x，插值计算y值
+    //初始化插值，直接引用样本数据，不复制
+    bool initView(INPUT const double* x
+                  ,INPUT const double* y
+                  ,INPUT const size_t length
+                  ,INPUT InterpType type);
+    //是否已初始化
+    bool isValid() const;
+    //样本点数
+    size_t size() const;
+    //样本x的范围
+    double xMin() const;
+    double xMax() const;
+    //根据x，插值计算y值，使用对象内部的插值加速器，不能多线程同时调用
     double getY(double x) const;
-    //批量获取插值结果
+    //批量获取插值结果，可以多线程同时调用
+    void getYs(INPUT const double* x,INPUT size_t n,OUTPUT double* y) const;
+    void getYs(INPUT const float* x,INPUT size_t n,OUTPUT float* y) const;
+    //迭代器版本的批量获取插值结果
     template<typename ITE_DOUBLELIKE_X,typename ITE_DOUBLELIKE_Y>
     void getYs(INPUT ITE_DOUBLELIKE_X xbegin,INPUT ITE_DOUBLELIKE_X xend
-               ,OUTPUT ITE_DOUBLELIKE_Y ybegin);
+               ,OUTPUT ITE_DOUBLELIKE_Y ybegin) const;
+    //按等间隔的x重采样，第i个点的x为x0+i*dx
+    void resample(INPUT double x0,INPUT double dx,INPUT size_t n,OUTPUT double* y) const;
 public:
     //插值的静态函数
     static bool interp(INPUT const double* x,
@@ -55,21 +96,19 @@ bool SA::SAInterpolation::init(ITE_DOUBLELIKE_X xbegin, ITE_DOUBLELIKE_X xend, I
 {
     auto len = std::min(std::distance(xbegin,xend),std::distance(ybegin,yend));
     std::vector<double> xs(len),ys(len);
-    std::copy(xbegin,xbegin+len,xs.begin());
-    std::copy(ybegin,ybegin+len,ys.begin());
-    return init(xs.data(),ys.data(),len,type);
+    std::copy(xbegin,std::next(xbegin,len),xs.begin());
+    std::copy(ybegin,std::next(ybegin,len),ys.begin());
+    return init(std::move(xs),std::move(ys),type);
 }
 
 
 template<typename ITE_DOUBLELIKE_X, typename ITE_DOUBLELIKE_Y>
-void SA::SAInterpolation::getYs(ITE_DOUBLELIKE_X xbegin, ITE_DOUBLELIKE_X xend, ITE_DOUBLELIKE_Y ybegin)
+void SA::SAInterpolation::getYs(ITE_DOUBLELIKE_X xbegin, ITE_DOUBLELIKE_X xend, ITE_DOUBLELIKE_Y ybegin) const
 {
-    while(xbegin < xend)
-    {
-        *ybegin = getY(*xbegin);
-        ++xbegin;
-        ++ybegin;
-    }
+    std::vector<double> xs(xbegin,xend);
+    std::vector<double> ys(xs.size());
+    getYs(xs.data(),xs.size(),ys.data());
+    std::copy(ys.begin(),ys.end(),ybegin);
 }
 
 #endif // SAINTERPOLATION_H
@@ -642,6 +642,7 @@ size_t count_frequency(INPUT IT in_begin,INPUT IT in_end,OUTPUT std::map<DATA_TY
 /// \param sectionRange 分段结果，长度是section+1
 /// \param frequencyCount 频率统计结果，长度是section
 /// \return 统计的个数
+/// \note 数据量大时用\sa SAHistogram ，可以并行计算及增量统计
 ///
 template <typename IT_INPUT,typename IT_OUTPUT1,typename IT_OUTPUT2>
 void count_frequency(INPUT IT_INPUT in_begin
@@ -662,15 +663,20 @@ void count_frequency(INPUT IT_INPUT in_begin
         ++sectionIte;
         *sectionIte = last+detal;
     }
-    IT_OUTPUT1 sectionEnd=sectionIte+1;
+    //等宽分段直接计算段号，等于最大值的数计入最后一段
+    const double lo = *ite_pp.first;
+    const double inv = (detal > 0) ? (1.0/detal) : 0.0;
+    if(0 == section)
+        return;
     for(IT_INPUT i = in_begin;i!=in_end;++i)
     {
-        sectionIte = std::lower_bound(sectionRange_begin,sectionEnd,*i);
-        if(sectionIte!=sectionEnd)
+        const double v = *i;
+        if(v >= lo)
         {
-            size_t dis = std::distance(sectionRange_begin,sectionIte);
-            if(dis<section)
-                ++(*(frequencyCount_begin+dis));
+            size_t dis = static_cast<size_t>((v-lo)*inv);
+            if(dis>=section)
+                dis = section-1;
+            ++(*(frequencyCount_begin+dis));
         }
     }
 }
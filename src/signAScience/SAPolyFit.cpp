@@ -1,6 +1,9 @@
 #include "SAPolyFit.h"
+#include "SAPolyFitBatch.h"
+#include "SAParallel.h"
 #include <map>
 namespace gsl{
+    #include <gsl/gsl_errno.h>
     #include <gsl/gsl_fit.h>
     #include <gsl/gsl_cdf.h>    // 提供了 gammaq 函数
     #include <gsl/gsl_vector.h> // 提供了向量结构
@@ -9,12 +12,36 @@ namespace gsl{
 }
 using namespace gsl;
 
+///
+/// \def 定义此宏关闭多项式求值的simd
+///
+//#define SA_POLYVAL_NO_SIMD
+
+#if !defined(SA_POLYVAL_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define SA_POLYVAL_SSE2
+#include <emmintrin.h>
+#endif
+
+///
+/// \def 批量多项式求值时每个并行分段至少处理的乘加次数，数据量小时不分段
+///
+#ifndef SA_POLYVAL_PARALLEL_WORK
+#define SA_POLYVAL_PARALLEL_WORK (1<<20)
+#endif
+
+static int polyfit_svd(const double *x,const double *y,size_t xyLength,unsigned poly_n
+                       ,std::vector<double> &out_factor,double &out_chisq);
+static void polyval_part(const double* factor,size_t factorSize,const double* x,double* y,size_t n);
+
 class SA::SAPolyFitPrivate
 {
     SA_IMPL_PUBLIC(SAPolyFit)
 public:
     SAPolyFitPrivate(SAPolyFit* p);
+    //根据m_factor更新按升幂排列的系数
+    void updateFactors();
     std::map<SAPolyFit::FACTOR_TYPE,double> m_factor;//记录各个点的系数，key中0是0次方，1是1次方，value是对应的系数
+    std::vector<double> m_factors;//按升幂排列的系数，没有设置的次幂为0，m_factor变化时同步更新，求值时直接使用
     std::map<SAPolyFit::FACTOR_TYPE,double> m_err;
     double m_cov;//相关度
     double m_ssr;//回归平方和
@@ -30,6 +57,20 @@ SA::SAPolyFitPrivate::SAPolyFitPrivate(SAPolyFit *p):q_ptr(p)
 
 }
 
+void SA::SAPolyFitPrivate::updateFactors()
+{
+    m_factors.clear();
+    if(m_factor.empty())
+    {
+        return;
+    }
+    m_factors.resize(m_factor.rbegin()->first + 1,0.0);
+    for(auto ite = m_factor.begin();ite != m_factor.end();++ite)
+    {
+        m_factors[ite->first] = ite->second;
+    }
+}
+
 SA::SAPolyFit::SAPolyFit():d_ptr(new SAPolyFitPrivate(this))
 {
 
@@ -71,6 +112,17 @@ size_t SA::SAPolyFit::getFactorSize() const
     return d_ptr->m_factor.size();
 }
 
+/**
+ * @brief 按升幂获取全部系数
+ *
+ * 系数在拟合或设置时已经整理好，获取不需要分配内存
+ * @return 长度为最高次幂+1，没有设置的次幂为0
+ */
+const std::vector<double>& SA::SAPolyFit::getFactors() const
+{
+    return d_ptr->m_factors;
+}
+
 ///
 /// \brief  线性拟合
 /// \param x 拟合的x值
@@ -87,6 +139,7 @@ bool SA::SAPolyFit::linearFit(const double *x, const double *y, size_t n)
     d_ptr->m_err[1]=0;
     int r = linearFit(x,1,y,1,n
         ,d_ptr->m_factor[0],d_ptr->m_factor[1],d_ptr->m_err[0],d_ptr->m_err[1],d_ptr->m_cov,d_ptr->m_wssr);
+    d_ptr->updateFactors();
     if (0 != r)
         return false;
     d_ptr->m_goodness = gsl_cdf_chisq_Q(d_ptr->m_wssr/2.0,(n-2)/2.0);//计算优度
@@ -102,13 +155,15 @@ bool SA::SAPolyFit::linearFit(const double *x, const double *y, size_t n)
 
 /**
  * @brief 多项式拟合
+ *
+ * 使用\sa SAPolyFitBatch 的QR分解求解，x中不同的值少于poly_n+1个时退回gsl的奇异值分解求最小范数解
  * @param x
  * @param y
  * @param xyLength
  * @param poly_n 阶次如c0+C1x是1，若c0+c1x+c2x^2则poly_n是2
  * @param out_factor
  * @param out_chisq
- * @return
+ * @return 0为成功
  */
 int SA::SAPolyFit::polyfit(const double *x, const double *y,
                            size_t xyLength,
@@ -116,35 +171,17 @@ int SA::SAPolyFit::polyfit(const double *x, const double *y,
                            std::vector<double> &out_factor,
                            double &out_chisq)
 {
-    gsl_matrix *XX = gsl_matrix_alloc(xyLength, poly_n + 1);
-    gsl_vector *c = gsl_vector_alloc(poly_n + 1);
-    gsl_matrix *cov = gsl_matrix_alloc(poly_n + 1, poly_n + 1);
-    gsl_vector *vY = gsl_vector_alloc(xyLength);
-
-    for(size_t i = 0; i < xyLength; i++)
+    SAPolyFitBatch batch;
+    if(!batch.init(x,xyLength,poly_n))
     {
-        gsl_matrix_set(XX, i, 0, 1.0);
-        gsl_vector_set (vY, i, y[i]);
-        for(unsigned j = 1; j <= poly_n; j++)
-        {
-            gsl_matrix_set(XX, i, j, pow(x[i], int(j) ));
-        }
+        return polyfit_svd(x,y,xyLength,poly_n,out_factor,out_chisq);
     }
-    gsl_multifit_linear_workspace *workspace = gsl_multifit_linear_alloc(xyLength, poly_n + 1);
-    int r = gsl_multifit_linear(XX, vY, c, cov, &out_chisq, workspace);
-    gsl_multifit_linear_free(workspace);
-    out_factor.resize(c->size,0);
-    for (size_t i=0;i<c->size;++i)
+    out_factor.resize(batch.factorSize(),0);
+    if(!batch.fit(y,out_factor.data(),&out_chisq))
     {
-        out_factor[i] = gsl_vector_get(c,i);
+        return GSL_EDOM;
     }
-
-    gsl_vector_free(vY);
-    gsl_matrix_free(XX);
-    gsl_matrix_free(cov);
-    gsl_vector_free(c);
-
-    return r;
+    return GSL_SUCCESS;
 }
 /**
  * @brief SA::SAPolyFit::polyfit
@@ -163,19 +200,32 @@ bool SA::SAPolyFit::polyfit(const double *x, const double *y,
     int r = polyfit(x,y,xyLength,poly_n,factor,chisq);
     if (0 != r)
         return false;
-    d_ptr->m_goodness = gsl_cdf_chisq_Q(chisq/2.0,(xyLength-2)/2.0);//计算优度
-
-    clearAll();
-    for (unsigned i=0;i<poly_n+1;++i)
-    {
-        d_ptr->m_factor[i]=factor[i];
-    }
     std::vector<double> yi;
     yi.resize(xyLength);
-    getYis(x,x+xyLength,yi.begin());
-    double t;//由于没用到，所以都用t代替
-    getDeterminateOfCoefficient(y,&yi[0],xyLength,d_ptr->m_ssr,d_ptr->m_sse,t,d_ptr->m_rmse,t);
+    polyval(factor.data(),factor.size(),x,yi.data(),xyLength);
+    setPolyfitResult(factor.data(),factor.size(),chisq,y,yi.data(),xyLength);
+    return true;
+}
 
+/**
+ * @brief 使用已分解的x进行多项式拟合
+ *
+ * 多组y共用同一组x时只需分解一次，batch只读，不同线程可以共用同一个batch
+ * @param batch 已初始化的分解
+ * @param y 拟合的y值，长度为batch.size()
+ * @return
+ */
+bool SA::SAPolyFit::polyfit(const SAPolyFitBatch &batch, const double *y)
+{
+    const size_t n = batch.size();
+    double chisq;
+    std::vector<double> factor(batch.factorSize(),0.0);
+    std::vector<double> yi(n);
+    if(!batch.fit(y,factor.data(),&chisq,yi.data()))
+    {
+        return false;
+    }
+    setPolyfitResult(factor.data(),factor.size(),chisq,y,yi.data(),n);
     return true;
 }
 
@@ -186,12 +236,8 @@ bool SA::SAPolyFit::polyfit(const double *x, const double *y,
  */
 double SA::SAPolyFit::getYi(double x) const
 {
-    double ans(0);
-    for (auto ite = d_ptr->m_factor.begin();ite != d_ptr->m_factor.end();++ite)
-    {
-        ans += (ite->second)*pow(x,ite->first);
-    }
-    return ans;
+    const std::vector<double>& factor = getFactors();
+    return polyval(factor.data(),factor.size(),x);
 }
 
 /**
@@ -200,7 +246,7 @@ double SA::SAPolyFit::getYi(double x) const
  */
 double SA::SAPolyFit::getSlope() const
 {
-    return d_ptr->m_factor[1];
+    return getFactor(1);
 }
 
 /**
@@ -209,7 +255,7 @@ double SA::SAPolyFit::getSlope() const
  */
 double SA::SAPolyFit::getIntercept() const
 {
-    return d_ptr->m_factor[0];
+    return getFactor(0);
 }
 
 double SA::SAPolyFit::getSSR() const
@@ -245,6 +291,11 @@ double SA::SAPolyFit::getGoodness() const
 void SA::SAPolyFit::setFactor(SA::SAPolyFit::FACTOR_TYPE order, double f)
 {
     d_ptr->m_factor[order] = f;
+    if(order >= d_ptr->m_factors.size())
+    {
+        d_ptr->m_factors.resize(order + 1,0.0);
+    }
+    d_ptr->m_factors[order] = f;
 }
 
 /**
@@ -268,6 +319,7 @@ void SA::SAPolyFit::getDeterminateOfCoefficient(const double *y, const double *y
 {
     double y_mean = SA::mean(y,y+length);
     out_ssr = 0.0;
+    out_sse = 0.0;
     for (size_t i =0;i<length;++i)
     {
         out_ssr += ((yi[i]-y_mean)*(yi[i]-y_mean));
@@ -309,15 +361,156 @@ int SA::SAPolyFit::linearFit(const double *x,
         ,&out_intercept,&out_slope,&out_interceptErr,&out_slopeErr,&out_cov,&out_wssr);
 }
 
+/**
+ * @brief 多项式求值，秦九韶算法
+ * @param factor 系数，按升幂保存
+ * @param factorSize 系数个数
+ * @param x
+ * @return
+ */
+double SA::SAPolyFit::polyval(const double *factor, size_t factorSize, double x)
+{
+    double res = 0.0;
+    for(size_t k=factorSize;k-- > 0;)
+    {
+        res = res*x + factor[k];
+    }
+    return res;
+}
+
+/**
+ * @brief 批量多项式求值
+ *
+ * 秦九韶算法，simd一次计算4个点，数据量大时分段并行
+ * @param factor 系数，按升幂保存
+ * @param factorSize 系数个数
+ * @param x
+ * @param y 求值结果，可以和x是同一块内存
+ * @param n 点数
+ */
+void SA::SAPolyFit::polyval(const double *factor, size_t factorSize, const double *x, double *y, size_t n)
+{
+    const int parts = parallelPartCount(static_cast<qint64>(n * std::max<size_t>(factorSize,1)),SA_POLYVAL_PARALLEL_WORK);
+    const size_t step = (n + parts - 1) / parts;
+    parallelFor(parts,[&](int part){
+        const size_t b = std::min(n,part * step);
+        const size_t e = std::min(n,b + step);
+        polyval_part(factor,factorSize,x + b,y + b,e - b);
+    });
+}
+
+/**
+ * @brief 设置拟合的结果，计算拟合的显著性
+ * @param factor 拟合的系数
+ * @param factorSize
+ * @param chisq 残差平方和
+ * @param y 拟合的y值
+ * @param yi 拟合值
+ * @param n
+ */
+void SA::SAPolyFit::setPolyfitResult(const double *factor, size_t factorSize, double chisq,
+                                     const double *y, const double *yi, size_t n)
+{
+    d_ptr->m_goodness = gsl_cdf_chisq_Q(chisq/2.0,(n-2)/2.0);//计算优度
+    clearAll();
+    for (size_t i=0;i<factorSize;++i)
+    {
+        d_ptr->m_factor[i]=factor[i];
+    }
+    d_ptr->m_factors.assign(factor,factor + factorSize);
+    double t;//由于没用到，所以都用t代替
+    getDeterminateOfCoefficient(y,yi,n,d_ptr->m_ssr,d_ptr->m_sse,t,d_ptr->m_rmse,t);
+}
+
 void SA::SAPolyFit::clearAll()
 {
     d_ptr->m_factor.clear();
+    d_ptr->m_factors.clear();
     d_ptr->m_err.clear();
 }
 
 void SA::SAPolyFit::clearFactor()
 {
     d_ptr->m_factor.clear();
+    d_ptr->m_factors.clear();
 }
 
 
+
+/**
+ * @brief gsl的多项式拟合，使用奇异值分解，矩阵奇异时给出最小范数解
+ */
+int polyfit_svd(const double *x, const double *y,
+                size_t xyLength,
+                unsigned poly_n,
+                std::vector<double> &out_factor,
+                double &out_chisq)
+{
+    gsl_matrix *XX = gsl_matrix_alloc(xyLength, poly_n + 1);
+    gsl_vector *c = gsl_vector_alloc(poly_n + 1);
+    gsl_matrix *cov = gsl_matrix_alloc(poly_n + 1, poly_n + 1);
+    gsl_vector *vY = gsl_vector_alloc(xyLength);
+
+    for(size_t i = 0; i < xyLength; i++)
+    {
+        gsl_matrix_set(XX, i, 0, 1.0);
+        gsl_vector_set (vY, i, y[i]);
+        for(unsigned j = 1; j <= poly_n; j++)
+        {
+            gsl_matrix_set(XX, i, j, pow(x[i], int(j) ));
+        }
+    }
+    gsl_multifit_linear_workspace *workspace = gsl_multifit_linear_alloc(xyLength, poly_n + 1);
+    int r = gsl_multifit_linear(XX, vY, c, cov, &out_chisq, workspace);
+    gsl_multifit_linear_free(workspace);
+    out_factor.resize(c->size,0);
+    for (size_t i=0;i<c->size;++i)
+    {
+        out_factor[i] = gsl_vector_get(c,i);
+    }
+
+    gsl_vector_free(vY);
+    gsl_matrix_free(XX);
+    gsl_matrix_free(cov);
+    gsl_vector_free(c);
+
+    return r;
+}
+
+void polyval_part(const double *factor, size_t factorSize, const double *x, double *y, size_t n)
+{
+    if(0 == factorSize)
+    {
+        std::fill(y,y + n,0.0);
+        return;
+    }
+    const double top = factor[factorSize-1];
+    size_t i = 0;
+#ifdef SA_POLYVAL_SSE2
+    for(;i + 4 <= n;i += 4)
+    {
+        const __m128d x0 = _mm_loadu_pd(x + i);
+        const __m128d x1 = _mm_loadu_pd(x + i + 2);
+        __m128d r0 = _mm_set1_pd(top);
+        __m128d r1 = r0;
+        for(size_t k=factorSize-1;k-- > 0;)
+        {
+            const __m128d c = _mm_set1_pd(factor[k]);
+            r0 = _mm_add_pd(_mm_mul_pd(r0,x0),c);
+            r1 = _mm_add_pd(_mm_mul_pd(r1,x1),c);
+        }
+        _mm_storeu_pd(y + i,r0);
+        _mm_storeu_pd(y + i + 2,r1);
+    }
+#endif
+    for(;i<n;++i)
+    {
+        const double xi = x[i];
+        double r = top;
+        for(size_t k=factorSize-1;k-- > 0;)
+        {
+            r = r*xi + factor[k];
+        }
+        y[i] = r;
+    }
+}
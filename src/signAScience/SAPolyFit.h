@@ -4,6 +4,7 @@
 #include "SAScienceGlobal.h"
 
 namespace SA {
+class SAPolyFitBatch;
 SA_IMPL_FORWARD_DECL(SAPolyFit)
 /**
  * @brief 多项式拟合相关类，内部使用gsl进行拟合
@@ -42,6 +43,17 @@ SA_IMPL_FORWARD_DECL(SAPolyFit)
  * fit.getYis(xs.begin(),xs.end(),ys.begin());
  * //ys
  * @endcode
+ *
+ * 多组y共用同一组x时，用\sa SAPolyFitBatch 只做一次分解：
+ *
+ * @code
+ * SA::SAPolyFitBatch batch(xs.data(),xs.size(),n);
+ * for(const QVector<double>& ys : yss)
+ * {
+ *  SA::SAPolyFit fit;
+ *  fit.polyfit(batch,ys.data());
+ * }
+ * @endcode
  */
 class SASCIENCE_API SAPolyFit
 {
@@ -56,6 +68,8 @@ public:
     double getFactor(FACTOR_TYPE n) const;
     //获取系数的个数
     size_t getFactorSize() const;
+    //按升幂获取全部系数，没有设置的次幂为0
+    const std::vector<double>& getFactors() const;
     //线性拟合
     bool linearFit(const double *x,const double *y,size_t n);
     ///
@@ -78,6 +92,8 @@ public:
     //多项式拟合
     bool polyfit(const double *x,const double *y
         ,size_t xyLength,unsigned poly_n);
+    //使用已分解的x进行多项式拟合，y的长度为batch.size()
+    bool polyfit(const SAPolyFitBatch& batch,const double *y);
     //获取y值
     double getYi(double x) const;
     //根据拟合的系数，传入x值，计算y值
@@ -109,6 +125,10 @@ public:
     static void getDeterminateOfCoefficient(
         const double* y,const double* yi,size_t length
         ,double& out_ssr,double& out_sse,double& out_sst,double& out_rmse,double& out_RSquare);
+    //多项式求值，factor按升幂保存
+    static double polyval(const double* factor,size_t factorSize,double x);
+    //批量多项式求值，数据量大时并行
+    static void polyval(const double* factor,size_t factorSize,const double* x,double* y,size_t n);
     //linearFit 线性拟合的静态函数
     static int linearFit(const double *x
                          ,const size_t xstride
@@ -122,6 +142,8 @@ public:
                          ,double& out_cov
                          ,double& out_wssr);
 private:
+    void setPolyfitResult(const double* factor,size_t factorSize,double chisq
+                          ,const double* y,const double* yi,size_t n);
     void clearAll();
     void clearFactor();
 
@@ -141,9 +163,10 @@ void SAPolyFit::setFactors(ITFactorFirst first, ITFactorEnd end)
 template<typename ITX, typename ITY>
 void SAPolyFit::getYis(ITX x_first, ITX x_end, ITY res_fisrt) const
 {
+    const std::vector<double>& factor = getFactors();
     while(x_first != x_end)
     {
-        *res_fisrt = getYi(*x_first);
+        *res_fisrt = polyval(factor.data(),factor.size(),*x_first);
         ++x_first;
         ++res_fisrt;
     }
@@ -0,0 +1,452 @@
+#include "SAPolyFitBatch.h"
+#include "SAParallel.h"
+#include <atomic>
+#include <cmath>
+#include <algorithm>
+
+///
+/// \def 批量拟合时每个并行分段至少处理的乘加次数，数据量小时不分段
+///
+#ifndef SA_POLYFIT_PARALLEL_WORK
+#define SA_POLYFIT_PARALLEL_WORK (1<<20)
+#endif
+
+///
+/// \def 判断列线性相关/方程奇异的相对阈值
+///
+#ifndef SA_POLYFIT_RANK_EPS
+#define SA_POLYFIT_RANK_EPS 1e-12
+#endif
+
+namespace SA {
+static void poly_basis_matrix(double c,double h,size_t p1,std::vector<double>& basis);
+static void poly_change_basis(const std::vector<double>& basis,const double* a,size_t p1,double* factor);
+}
+
+///
+/// \brief t=(x-c)/h的升幂系数a换算为x的升幂系数的矩阵
+///
+/// a_k·t^k = a_k·h^-k·Σ_j C(k,j)·x^j·(-c)^(k-j)，basis[j*p1+k] = C(k,j)·(-c)^(k-j)/h^k
+///
+void SA::poly_basis_matrix(double c, double h, size_t p1, std::vector<double> &basis)
+{
+    basis.assign(p1*p1,0.0);
+    double hk = 1.0;
+    for(size_t k=0;k<p1;++k)
+    {
+        //C(k,j)·(-c)^(k-j)，j从k递减到0
+        double term = 1.0 / hk;
+        for(size_t j=k+1;j-- > 0;)
+        {
+            basis[j*p1+k] = term;
+            if(j > 0)
+            {
+                term *= -c * double(j) / double(k - j + 1);
+            }
+        }
+        hk *= h;
+    }
+}
+
+void SA::poly_change_basis(const std::vector<double> &basis, const double *a, size_t p1, double *factor)
+{
+    for(size_t j=0;j<p1;++j)
+    {
+        double s = 0.0;
+        for(size_t k=j;k<p1;++k)
+        {
+            s += basis[j*p1+k]*a[k];
+        }
+        factor[j] = s;
+    }
+}
+
+SA::SAPolyFitBatch::SAPolyFitBatch()
+    :m_size(0)
+    ,m_order(0)
+{
+
+}
+
+SA::SAPolyFitBatch::SAPolyFitBatch(const double *x, size_t n, unsigned order)
+    :m_size(0)
+    ,m_order(0)
+{
+    init(x,n,order);
+}
+
+/**
+ * @brief 根据x和阶次做QR分解
+ * @param x 拟合的x值
+ * @param n 数据点数
+ * @param order 多项式阶次
+ * @return x中不同的值少于order+1个或x有非有限值时返回false
+ */
+bool SA::SAPolyFitBatch::init(const double *x, size_t n, unsigned order)
+{
+    m_q.clear();
+    m_r.clear();
+    m_basis.clear();
+    m_size = 0;
+    m_order = order;
+    const size_t p1 = size_t(order) + 1;
+    if(n < p1)
+    {
+        return false;
+    }
+    double lo = x[0],hi = x[0];
+    for(size_t i=0;i<n;++i)
+    {
+        if(!std::isfinite(x[i]))
+        {
+            return false;
+        }
+        lo = std::min(lo,x[i]);
+        hi = std::max(hi,x[i]);
+    }
+    const double c = (lo + hi) / 2;
+    const double h = (hi > lo) ? (hi - lo) / 2 : 1.0;
+    //修正Gram-Schmidt正交化，每列做两次以保证正交性，Q先按列存储，最后转为按行存储
+    std::vector<double> q(n*p1,0.0);
+    std::vector<double> r(p1*p1,0.0);
+    for(size_t k=0;k<p1;++k)
+    {
+        double* v = q.data() + k*n;
+        for(size_t i=0;i<n;++i)
+        {
+            v[i] = std::pow((x[i] - c) / h,double(k));
+        }
+        double before = 0.0;
+        for(size_t i=0;i<n;++i)
+        {
+            before += v[i]*v[i];
+        }
+        for(int pass=0;pass<2;++pass)
+        {
+            for(size_t j=0;j<k;++j)
+            {
+                const double* qj = q.data() + j*n;
+                double dot = 0.0;
+                for(size_t i=0;i<n;++i)
+                {
+                    dot += qj[i]*v[i];
+                }
+                r[j*p1+k] += dot;
+                for(size_t i=0;i<n;++i)
+                {
+                    v[i] -= dot*qj[i];
+                }
+            }
+        }
+        double norm = 0.0;
+        for(size_t i=0;i<n;++i)
+        {
+            norm += v[i]*v[i];
+        }
+        if(!(norm > SA_POLYFIT_RANK_EPS * before))
+        {
+            return false;
+        }
+        norm = std::sqrt(norm);
+        r[k*p1+k] = norm;
+        for(size_t i=0;i<n;++i)
+        {
+            v[i] /= norm;
+        }
+    }
+    m_q.resize(n*p1);
+    for(size_t i=0;i<n;++i)
+    {
+        for(size_t k=0;k<p1;++k)
+        {
+            m_q[i*p1+k] = q[k*n+i];
+        }
+    }
+    m_r.swap(r);
+    poly_basis_matrix(c,h,p1,m_basis);
+    m_size = n;
+    return true;
+}
+
+bool SA::SAPolyFitBatch::isValid() const
+{
+    return m_size > 0;
+}
+
+unsigned SA::SAPolyFitBatch::order() const
+{
+    return m_order;
+}
+
+size_t SA::SAPolyFitBatch::factorSize() const
+{
+    return size_t(m_order) + 1;
+}
+
+size_t SA::SAPolyFitBatch::size() const
+{
+    return m_size;
+}
+
+/**
+ * @brief 拟合一组y
+ * @param y 拟合的y值，长度为size()
+ * @param factor 拟合的系数，按升幂保存factorSize()个
+ * @param chisq 不为nullptr时输出残差平方和
+ * @param fitted 不为nullptr时输出拟合值，长度为size()
+ * @return 未初始化或y中有nan时返回false
+ */
+bool SA::SAPolyFitBatch::fit(const double *y, double *factor, double *chisq, double *fitted) const
+{
+    if(!isValid())
+    {
+        return false;
+    }
+    const size_t n = m_size;
+    const size_t p1 = factorSize();
+    //z = Q^T·y，一次遍历
+    std::vector<double> z(p1,0.0);
+    for(size_t i=0;i<n;++i)
+    {
+        const double* row = m_q.data() + i*p1;
+        const double yi = y[i];
+        for(size_t k=0;k<p1;++k)
+        {
+            z[k] += row[k]*yi;
+        }
+    }
+    //R·a = z回代
+    std::vector<double> a(p1,0.0);
+    for(size_t k=p1;k-- > 0;)
+    {
+        double s = z[k];
+        for(size_t j=k+1;j<p1;++j)
+        {
+            s -= m_r[k*p1+j]*a[j];
+        }
+        a[k] = s / m_r[k*p1+k];
+    }
+    if(chisq || fitted)
+    {
+        double sse = 0.0;
+        for(size_t i=0;i<n;++i)
+        {
+            const double* row = m_q.data() + i*p1;
+            double f = 0.0;
+            for(size_t k=0;k<p1;++k)
+            {
+                f += row[k]*z[k];
+            }
+            if(fitted)
+            {
+                fitted[i] = f;
+            }
+            sse += (y[i] - f)*(y[i] - f);
+        }
+        if(chisq)
+        {
+            *chisq = sse;
+        }
+    }
+    poly_change_basis(m_basis,a.data(),p1,factor);
+    for(size_t k=0;k<p1;++k)
+    {
+        if(!std::isfinite(factor[k]))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief 并行拟合多组y
+ * @param ys count组y的指针，每组长度为size()
+ * @param count 组数
+ * @param factors 拟合的系数，第i组写入factors+i*factorSize()
+ * @param chisqs 不为nullptr时输出每组的残差平方和
+ * @return 全部拟合成功时返回true
+ */
+bool SA::SAPolyFitBatch::fitMany(const double * const *ys, size_t count, double *factors, double *chisqs) const
+{
+    if(!isValid())
+    {
+        return false;
+    }
+    const size_t p1 = factorSize();
+    const int parts = static_cast<int>(std::min<qint64>(parallelPartCount(static_cast<qint64>(count * m_size * p1),SA_POLYFIT_PARALLEL_WORK)
+                                                        ,static_cast<qint64>(std::max<size_t>(count,1))));
+    const size_t step = (count + parts - 1) / parts;
+    std::atomic<bool> ok(true);
+    parallelFor(parts,[&](int part){
+        const size_t b = std::min(count,part * step);
+        const size_t e = std::min(count,b + step);
+        for(size_t i=b;i<e;++i)
+        {
+            if(!fit(ys[i],factors + i*p1,chisqs ? chisqs + i : nullptr))
+            {
+                ok = false;
+            }
+        }
+    });
+    return ok;
+}
+
+SA::SAPolyFitAccumulator::SAPolyFitAccumulator(unsigned order, double origin, double scale)
+    :m_tt(2*size_t(order)+1,0.0)
+    ,m_ty(size_t(order)+1,0.0)
+    ,m_yy(0)
+    ,m_count(0)
+    ,m_origin(origin)
+    ,m_scale((scale > 0) ? scale : 1.0)
+    ,m_order(order)
+{
+
+}
+
+unsigned SA::SAPolyFitAccumulator::order() const
+{
+    return m_order;
+}
+
+double SA::SAPolyFitAccumulator::origin() const
+{
+    return m_origin;
+}
+
+double SA::SAPolyFitAccumulator::scale() const
+{
+    return m_scale;
+}
+
+void SA::SAPolyFitAccumulator::add(double x, double y, double w)
+{
+    update(x,y,w);
+    ++m_count;
+}
+
+void SA::SAPolyFitAccumulator::remove(double x, double y, double w)
+{
+    update(x,y,-w);
+    --m_count;
+}
+
+void SA::SAPolyFitAccumulator::add(const double *x, const double *y, size_t n)
+{
+    for(size_t i=0;i<n;++i)
+    {
+        add(x[i],y[i]);
+    }
+}
+
+void SA::SAPolyFitAccumulator::remove(const double *x, const double *y, size_t n)
+{
+    for(size_t i=0;i<n;++i)
+    {
+        remove(x[i],y[i]);
+    }
+}
+
+long long SA::SAPolyFitAccumulator::count() const
+{
+    return m_count;
+}
+
+void SA::SAPolyFitAccumulator::clear()
+{
+    std::fill(m_tt.begin(),m_tt.end(),0.0);
+    std::fill(m_ty.begin(),m_ty.end(),0.0);
+    m_yy = 0;
+    m_count = 0;
+}
+
+/**
+ * @brief 解法方程
+ *
+ * 法方程的系数矩阵为A[j][k]=Σw·t^(j+k)，用Cholesky分解求解
+ * @param factor 拟合的系数，按x的升幂保存order+1个
+ * @param chisq 不为nullptr时输出残差平方和Σw·y²-a·Σw·t^k·y
+ * @return 点数不足或方程奇异时返回false
+ */
+bool SA::SAPolyFitAccumulator::solve(double *factor, double *chisq) const
+{
+    const size_t p1 = size_t(m_order) + 1;
+    if(m_count < static_cast<long long>(p1))
+    {
+        return false;
+    }
+    std::vector<double> l(p1*p1,0.0);
+    for(size_t j=0;j<p1;++j)
+    {
+        for(size_t k=0;k<=j;++k)
+        {
+            double s = m_tt[j+k];
+            for(size_t m=0;m<k;++m)
+            {
+                s -= l[j*p1+m]*l[k*p1+m];
+            }
+            if(j == k)
+            {
+                if(!(s > SA_POLYFIT_RANK_EPS * m_tt[2*j]))
+                {
+                    return false;
+                }
+                l[j*p1+j] = std::sqrt(s);
+            }
+            else
+            {
+                l[j*p1+k] = s / l[k*p1+k];
+            }
+        }
+    }
+    //L·u = b，L^T·a = u
+    std::vector<double> a(p1,0.0);
+    for(size_t j=0;j<p1;++j)
+    {
+        double s = m_ty[j];
+        for(size_t k=0;k<j;++k)
+        {
+            s -= l[j*p1+k]*a[k];
+        }
+        a[j] = s / l[j*p1+j];
+    }
+    for(size_t j=p1;j-- > 0;)
+    {
+        double s = a[j];
+        for(size_t k=j+1;k<p1;++k)
+        {
+            s -= l[k*p1+j]*a[k];
+        }
+        a[j] = s / l[j*p1+j];
+    }
+    if(chisq)
+    {
+        double ab = 0.0;
+        for(size_t k=0;k<p1;++k)
+        {
+            ab += a[k]*m_ty[k];
+        }
+        *chisq = std::max(0.0,m_yy - ab);
+    }
+    std::vector<double> basis;
+    poly_basis_matrix(m_origin,m_scale,p1,basis);
+    poly_change_basis(basis,a.data(),p1,factor);
+    return true;
+}
+
+void SA::SAPolyFitAccumulator::update(double x, double y, double w)
+{
+    const double t = (x - m_origin) / m_scale;
+    const size_t p1 = m_ty.size();
+    double p = w;
+    for(size_t k=0;k<m_tt.size();++k)
+    {
+        m_tt[k] += p;
+        if(k < p1)
+        {
+            m_ty[k] += p*y;
+        }
+        p *= t;
+    }
+    m_yy += w*y*y;
+}
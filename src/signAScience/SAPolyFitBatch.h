@@ -0,0 +1,101 @@
+#ifndef SAPOLYFITBATCH_H
+#define SAPOLYFITBATCH_H
+#include <stddef.h>
+#include <vector>
+#include "SAScienceGlobal.h"
+namespace SA {
+///
+/// \brief 同一组x的批量多项式拟合
+///
+/// x归一化为t=(x-c)/h∈[-1,1]后对范德蒙矩阵的列1,t,t^2...做QR分解，分解只做一次，
+/// 之后每组y的拟合只需一次Q^T·y和回代，O(n·(order+1))，系数再换算回x的升幂。
+///
+/// - 构造后只读，\sa fit 可以多线程同时调用
+/// - \sa fitMany 在线程池中并行拟合多组y
+/// - x中不同的值少于order+1个时无法拟合
+///
+/// \code
+/// SA::SAPolyFitBatch batch(xs.data(),xs.size(),3);
+/// std::vector<double> factors(count*4);
+/// batch.fitMany(ys.data(),count,factors.data());
+/// \endcode
+///
+class SASCIENCE_API SAPolyFitBatch
+{
+public:
+    SAPolyFitBatch();
+    SAPolyFitBatch(const double* x,size_t n,unsigned order);
+    //根据x和阶次做分解，失败时返回false
+    bool init(const double* x,size_t n,unsigned order);
+    bool isValid() const;
+    unsigned order() const;
+    //系数个数，order+1
+    size_t factorSize() const;
+    //数据点数
+    size_t size() const;
+    //拟合一组y，factor按升幂保存factorSize()个系数，chisq为残差平方和，fitted为拟合值
+    bool fit(const double* y,double* factor,double* chisq = nullptr,double* fitted = nullptr) const;
+    //并行拟合count组y，第i组的系数写入factors+i*factorSize()
+    bool fitMany(const double* const* ys,size_t count,double* factors,double* chisqs = nullptr) const;
+private:
+    std::vector<double> m_q;///< 按行保存的Q，n×(order+1)
+    std::vector<double> m_r;///< 上三角R，(order+1)×(order+1)
+    std::vector<double> m_basis;///< t的升幂系数换算为x的升幂系数的矩阵
+    size_t m_size;
+    unsigned m_order;
+};
+
+///
+/// \brief 多项式拟合的法方程累加器
+///
+/// 累加Σw·t^k(k≤2·order)、Σw·t^k·y和Σw·y²，t=(x-origin)/scale，可以随时加入或移除数据点，
+/// 求解只需解一个(order+1)阶的方程组，适合滑动窗口和实时数据的拟合：
+/// 窗口移动时加入新的点、移除旧的点，不需要重新遍历窗口。
+///
+/// 法方程的条件数是原问题的平方，origin和scale应使t大致落在[-1,1]，
+/// 长时间加入移除后的累计误差可以通过\sa clear 后重新加入窗口数据消除
+///
+/// \code
+/// SA::SAPolyFitAccumulator acc(2,xs[0],window);
+/// for(size_t i=0;i<n;++i)
+/// {
+///     acc.add(xs[i],ys[i]);
+///     if(i >= window)
+///     {
+///         acc.remove(xs[i-window],ys[i-window]);
+///     }
+///     acc.solve(factor);
+/// }
+/// \endcode
+///
+class SASCIENCE_API SAPolyFitAccumulator
+{
+public:
+    SAPolyFitAccumulator(unsigned order,double origin = 0,double scale = 1);
+    unsigned order() const;
+    double origin() const;
+    double scale() const;
+    //加入一个数据点
+    void add(double x,double y,double w = 1);
+    //移除一个之前加入过的数据点
+    void remove(double x,double y,double w = 1);
+    void add(const double* x,const double* y,size_t n);
+    void remove(const double* x,const double* y,size_t n);
+    //当前的数据点数
+    long long count() const;
+    void clear();
+    //求解，factor按升幂保存order+1个系数，chisq为残差平方和，方程奇异时返回false
+    bool solve(double* factor,double* chisq = nullptr) const;
+private:
+    void update(double x,double y,double w);
+private:
+    std::vector<double> m_tt;///< Σw·t^k，k∈[0,2·order]
+    std::vector<double> m_ty;///< Σw·t^k·y，k∈[0,order]
+    double m_yy;
+    long long m_count;
+    double m_origin;
+    double m_scale;
+    unsigned m_order;
+};
+}
+#endif // SAPOLYFITBATCH_H
@@ -0,0 +1,451 @@
+#include "SARollingStatistics.h"
+#include "SAParallel.h"
+#include <vector>
+#include <deque>
+#include <set>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <iterator>
+
+///
+/// \def 每个并行分段至少处理的数据个数，数据量小时不分段
+///
+#ifndef SA_ROLLING_PARALLEL_CHUNK
+#define SA_ROLLING_PARALLEL_CHUNK (1<<16)
+#endif
+
+namespace SA {
+///
+/// \brief 滑动窗口的状态，各统计量的实现继承此类
+///
+class SARollingState
+{
+public:
+    SARollingState(int w):m_ring(w,0.0),m_pos(0),m_size(0),m_seq(0){}
+    virtual ~SARollingState(){}
+    double push(double v)
+    {
+        const int w = static_cast<int>(m_ring.size());
+        if(m_size == w)
+        {
+            const double old = m_ring[m_pos];
+            if(!std::isnan(old))
+            {
+                remove(old);
+            }
+        }
+        else
+        {
+            ++m_size;
+        }
+        m_ring[m_pos] = v;
+        if(!std::isnan(v))
+        {
+            insert(v);
+        }
+        ++m_seq;
+        if(++m_pos == w)
+        {
+            m_pos = 0;
+            wrapped();
+        }
+        return value();
+    }
+    void reset()
+    {
+        m_pos = 0;
+        m_size = 0;
+        m_seq = 0;
+        clear();
+    }
+    virtual double value() const = 0;
+    virtual int count() const = 0;
+protected:
+    virtual void insert(double v) = 0;
+    virtual void remove(double v) = 0;
+    virtual void clear() = 0;
+    //写位置回到开头时调用，此时窗口已满
+    virtual void wrapped(){}
+protected:
+    std::vector<double> m_ring;///< 窗口数据，m_pos为最早的数据
+    int m_pos;
+    int m_size;
+    long long m_seq;///< 正在推入的数据的序号
+};
+
+///
+/// \brief 均值、方差、均方根
+///
+class SARollingMoments : public SARollingState
+{
+public:
+    SARollingMoments(int w,SARollingStatistics::Statistic s):SARollingState(w),m_stat(s),m_n(0),m_mean(0),m_m2(0){}
+    virtual double value() const
+    {
+        if(0 == m_n)
+        {
+            return std::numeric_limits<double>::quiet_NaN();
+        }
+        switch(m_stat)
+        {
+        case SARollingStatistics::Variance:
+            return (m_n > 1) ? (m_m2 / (m_n - 1)) : 0.0;
+        case SARollingStatistics::RMS:
+            return std::sqrt(m_m2 / m_n + m_mean * m_mean);
+        default:
+            return m_mean;
+        }
+    }
+    virtual int count() const
+    {
+        return m_n;
+    }
+protected:
+    virtual void insert(double v)
+    {
+        ++m_n;
+        const double d = v - m_mean;
+        m_mean += d / m_n;
+        m_m2 += d * (v - m_mean);
+    }
+    virtual void remove(double v)
+    {
+        if(m_n <= 1)
+        {
+            clear();
+            return;
+        }
+        --m_n;
+        const double d = v - m_mean;
+        m_mean -= d / m_n;
+        m_m2 = std::max(m_m2 - d * (v - m_mean),0.0);
+    }
+    virtual void clear()
+    {
+        m_n = 0;
+        m_mean = 0;
+        m_m2 = 0;
+    }
+    //递推的删除会累积舍入误差，每过一个窗口按两遍法重新计算
+    virtual void wrapped()
+    {
+        int n = 0;
+        double s = 0;
+        for(double v : m_ring)
+        {
+            if(!std::isnan(v))
+            {
+                s += v;
+                ++n;
+            }
+        }
+        m_n = n;
+        if(0 == n)
+        {
+            clear();
+            return;
+        }
+        m_mean = s / n;
+        double m2 = 0;
+        for(double v : m_ring)
+        {
+            if(!std::isnan(v))
+            {
+                m2 += (v - m_mean) * (v - m_mean);
+            }
+        }
+        m_m2 = m2;
+    }
+private:
+    SARollingStatistics::Statistic m_stat;
+    int m_n;
+    double m_mean;
+    double m_m2;///< 离均差平方和
+};
+
+///
+/// \brief 最小值、最大值，单调队列
+///
+/// 队列中保存可能成为极值的数据及其序号，从队首到队尾单调，队首就是窗口的极值
+///
+class SARollingExtremum : public SARollingState
+{
+public:
+    SARollingExtremum(int w,bool isMax):SARollingState(w),m_isMax(isMax),m_n(0){}
+    virtual double value() const
+    {
+        return m_queue.empty() ? std::numeric_limits<double>::quiet_NaN() : m_queue.front().second;
+    }
+    virtual int count() const
+    {
+        return m_n;
+    }
+protected:
+    virtual void insert(double v)
+    {
+        ++m_n;
+        if(m_isMax)
+        {
+            while(!m_queue.empty() && m_queue.back().second <= v)
+            {
+                m_queue.pop_back();
+            }
+        }
+        else
+        {
+            while(!m_queue.empty() && m_queue.back().second >= v)
+            {
+                m_queue.pop_back();
+            }
+        }
+        m_queue.push_back(std::make_pair(m_seq,v));
+    }
+    virtual void remove(double v)
+    {
+        Q_UNUSED(v);
+        --m_n;
+        //离开窗口的数据序号为m_seq-w，只有它还是极值时才在队首
+        const long long old = m_seq - static_cast<long long>(m_ring.size());
+        if(!m_queue.empty() && m_queue.front().first == old)
+        {
+            m_queue.pop_front();
+        }
+    }
+    virtual void clear()
+    {
+        m_queue.clear();
+        m_n = 0;
+    }
+private:
+    bool m_isMax;
+    int m_n;
+    std::deque<std::pair<long long,double> > m_queue;///< (序号,数据)
+};
+
+///
+/// \brief 中位数、百分位数
+///
+/// 窗口的有效数据分为下集合和上集合，下集合的最大值不大于上集合的最小值，
+/// 下集合保持k+1个元素，k为目标位置的整数部分，插入删除后最多移动一个元素
+///
+class SARollingQuantile : public SARollingState
+{
+public:
+    SARollingQuantile(int w,double p):SARollingState(w),m_p(p / 100.0){}
+    virtual double value() const
+    {
+        if(m_low.empty())
+        {
+            return std::numeric_limits<double>::quiet_NaN();
+        }
+        const double pos = m_p * (count() - 1);
+        const double frac = pos - std::floor(pos);
+        const double lo = *m_low.rbegin();
+        if(frac <= 0 || m_high.empty())
+        {
+            return lo;
+        }
+        return lo + frac * (*m_high.begin() - lo);
+    }
+    virtual int count() const
+    {
+        return static_cast<int>(m_low.size() + m_high.size());
+    }
+protected:
+    virtual void insert(double v)
+    {
+        if(!m_low.empty() && v <= *m_low.rbegin())
+        {
+            m_low.insert(v);
+        }
+        else
+        {
+            m_high.insert(v);
+        }
+        balance();
+    }
+    virtual void remove(double v)
+    {
+        //v小于下集合最大值时一定在下集合，相等时下集合中有同值的元素，删除哪一个都一样
+        if(!m_low.empty() && v <= *m_low.rbegin())
+        {
+            m_low.erase(m_low.find(v));
+        }
+        else
+        {
+            m_high.erase(m_high.find(v));
+        }
+        balance();
+    }
+    virtual void clear()
+    {
+        m_low.clear();
+        m_high.clear();
+    }
+private:
+    void balance()
+    {
+        const int n = count();
+        if(0 == n)
+        {
+            return;
+        }
+        const size_t lowSize = static_cast<size_t>(std::floor(m_p * (n - 1))) + 1;
+        while(m_low.size() > lowSize)
+        {
+            std::multiset<double>::iterator i = std::prev(m_low.end());
+            m_high.insert(*i);
+            m_low.erase(i);
+        }
+        while(m_low.size() < lowSize)
+        {
+            std::multiset<double>::iterator i = m_high.begin();
+            m_low.insert(*i);
+            m_high.erase(i);
+        }
+    }
+private:
+    double m_p;
+    std::multiset<double> m_low;
+    std::multiset<double> m_high;
+};
+
+static SARollingState* create_rolling_state(int w,SARollingStatistics::Statistic s,double p);
+
+SARollingStatistics::SARollingStatistics(int window, Statistic statistic, double percentile)
+    :m_window(window)
+    ,m_statistic(statistic)
+    ,m_percentile((Median == statistic) ? 50 : percentile)
+{
+    if(isValid())
+    {
+        m_state.reset(create_rolling_state(m_window,m_statistic,m_percentile));
+    }
+}
+
+SARollingStatistics::~SARollingStatistics()
+{
+
+}
+
+bool SARollingStatistics::isValid() const
+{
+    return (m_window > 0) && (m_percentile >= 0) && (m_percentile <= 100);
+}
+
+int SARollingStatistics::window() const
+{
+    return m_window;
+}
+
+SARollingStatistics::Statistic SARollingStatistics::statistic() const
+{
+    return m_statistic;
+}
+
+double SARollingStatistics::percentile() const
+{
+    return m_percentile;
+}
+///
+/// \brief 推入一个数据
+/// \param v 数据，nan占用窗口中的一个位置但不参与统计
+/// \return 推入后窗口的统计值
+///
+double SARollingStatistics::push(double v)
+{
+    if(!m_state)
+    {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    return m_state->push(v);
+}
+
+double SARollingStatistics::value() const
+{
+    return m_state ? m_state->value() : std::numeric_limits<double>::quiet_NaN();
+}
+
+int SARollingStatistics::count() const
+{
+    return m_state ? m_state->count() : 0;
+}
+
+void SARollingStatistics::reset()
+{
+    if(m_state)
+    {
+        m_state->reset();
+    }
+}
+///
+/// \brief 批量计算
+///
+/// 用独立的窗口计算，不影响\sa push 的窗口
+/// \param in 输入
+/// \param out 输出，可以和in是同一块内存
+/// \param n 数据长度
+/// \return 参数无效时返回false
+///
+bool SARollingStatistics::apply(const double *in, double *out, size_t n) const
+{
+    if(!isValid())
+    {
+        return false;
+    }
+    if(0 == n)
+    {
+        return true;
+    }
+    const size_t w = static_cast<size_t>(m_window);
+    const bool inplace = (in == out);
+    const int parts = inplace ? 1 : parallelPartCount(static_cast<qint64>(n)
+                                                      ,qMax<qint64>(SA_ROLLING_PARALLEL_CHUNK,4 * static_cast<qint64>(w)));
+    const size_t step = (n + parts - 1) / parts;
+    const Statistic stat = m_statistic;
+    const double p = m_percentile;
+    parallelFor(parts,[&](int part){
+        const size_t b = std::min(n,part * step);
+        const size_t e = std::min(n,b + step);
+        std::unique_ptr<SARollingState> state(create_rolling_state(static_cast<int>(w),stat,p));
+        //预热：推入段前的window-1个数据
+        for(size_t i = (b >= w - 1) ? (b - (w - 1)) : 0;i<b;++i)
+        {
+            state->push(in[i]);
+        }
+        for(size_t i=b;i<e;++i)
+        {
+            out[i] = state->push(in[i]);
+        }
+    });
+    return true;
+}
+///
+/// \brief 批量计算
+/// \see SARollingStatistics::apply
+///
+bool SARollingStatistics::filter(const double *in, double *out, size_t n, int window, Statistic statistic, double percentile)
+{
+    SARollingStatistics rs(window,statistic,percentile);
+    return rs.apply(in,out,n);
+}
+
+SARollingState* create_rolling_state(int w,SARollingStatistics::Statistic s,double p)
+{
+    switch(s)
+    {
+    case SARollingStatistics::Min:
+        return new SARollingExtremum(w,false);
+    case SARollingStatistics::Max:
+        return new SARollingExtremum(w,true);
+    case SARollingStatistics::Median:
+        return new SARollingQuantile(w,50);
+    case SARollingStatistics::Percentile:
+        return new SARollingQuantile(w,p);
+    default:
+        return new SARollingMoments(w,s);
+    }
+}
+
+}
@@ -0,0 +1,71 @@
+#ifndef SAROLLINGSTATISTICS_H
+#define SAROLLINGSTATISTICS_H
+#include <stddef.h>
+#include <memory>
+#include "SAScienceGlobal.h"
+namespace SA {
+class SARollingState;
+///
+/// \brief 滑动窗口统计
+///
+/// 窗口为最近的window个数据，每推入一个数据更新一次统计值：
+/// - 均值、方差、均方根用滑动的Welford递推，每推入一个窗口长度的数据重新求和一次消除累积误差，O(1)
+/// - 最小值、最大值用单调队列，均摊O(1)
+/// - 中位数、百分位数把窗口分成上下两个有序集合，下集合保持目标秩的元素个数，O(log window)
+///
+/// 数据开始不足一个窗口时按已有的数据计算。nan不参与统计，窗口内没有有效数据时结果为nan。
+/// 方差和\sa SA::var 一致，除以n-1；百分位数在相邻两个秩之间线性插值。
+///
+/// 实时采集时逐个调用\sa push ，批量数据用\sa apply ，数据量大时分段并行，
+/// 每段先推入前面window-1个数据预热
+///
+/// \code
+/// SA::SARollingStatistics med(101,SA::SARollingStatistics::Median);
+/// for(double v : samples)
+/// {
+///     double m = med.push(v);
+/// }
+/// \endcode
+///
+class SASCIENCE_API SARollingStatistics
+{
+public:
+    enum Statistic
+    {
+        Mean///< 均值
+        ,Variance///< 方差
+        ,RMS///< 均方根
+        ,Min///< 最小值
+        ,Max///< 最大值
+        ,Median///< 中位数
+        ,Percentile///< 百分位数
+    };
+    SARollingStatistics(int window,Statistic statistic,double percentile = 50);
+    ~SARollingStatistics();
+    //参数是否有效，窗口为正数，百分位数在[0,100]
+    bool isValid() const;
+    int window() const;
+    Statistic statistic() const;
+    double percentile() const;
+    //推入一个数据，返回推入后窗口的统计值，参数无效时返回nan
+    double push(double v);
+    //当前窗口的统计值
+    double value() const;
+    //窗口中有效数据(非nan)的个数
+    int count() const;
+    //清空窗口
+    void reset();
+    //批量计算，out[i]为以in[i]结尾的窗口的统计值，不影响当前窗口，参数无效时返回false
+    bool apply(const double* in,double* out,size_t n) const;
+    static bool filter(const double* in,double* out,size_t n,int window,Statistic statistic,double percentile = 50);
+private:
+    SARollingStatistics(const SARollingStatistics&) = delete;
+    SARollingStatistics& operator=(const SARollingStatistics&) = delete;
+private:
+    std::unique_ptr<SARollingState> m_state;
+    int m_window;
+    Statistic m_statistic;
+    double m_percentile;
+};
+}
+#endif // SAROLLINGSTATISTICS_H
@@ -0,0 +1,406 @@
+#include "SASavitzkyGolay.h"
+#include "SAParallel.h"
+#include <QHash>
+#include <QString>
+#include <QMutex>
+#include <QMutexLocker>
+#include <cmath>
+#include <algorithm>
+
+///
+/// \def 定义此宏关闭卷积的simd
+///
+//#define SA_SG_NO_SIMD
+
+#if !defined(SA_SG_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define SA_SG_SSE2
+#include <emmintrin.h>
+#endif
+
+///
+/// \def 卷积分块的长度，一块的输出常驻L1缓存
+///
+#ifndef SA_SG_BLOCK_SIZE
+#define SA_SG_BLOCK_SIZE 512
+#endif
+
+///
+/// \def 每个并行分段至少处理的乘加次数，数据量小时不分段
+///
+#ifndef SA_SG_PARALLEL_WORK
+#define SA_SG_PARALLEL_WORK (1<<22)
+#endif
+
+///
+/// \def 缓存的系数组数上限，超过时清空
+///
+#ifndef SA_SG_CACHE_SIZE
+#define SA_SG_CACHE_SIZE 64
+#endif
+
+namespace SA {
+///
+/// \brief Savitzky-Golay的系数，构造后只读，可以在多个线程共享
+///
+/// 窗口内坐标归一化为t=(i-half)/half∈[-1,1]，对单项式1,t,t^2...做正交分解(QR)求最小二乘解，
+/// 避免大窗口高阶次时法方程病态
+///
+class SASavitzkyGolayCoefficients
+{
+public:
+    SASavitzkyGolayCoefficients(int w,int o,int d);
+    //窗口数据的拟合多项式系数(归一化坐标)
+    void fitPolynomial(const double* y,std::vector<double>& a) const;
+    //拟合多项式在t处的导数，已换算为采样间隔为1
+    double evalPolynomial(const std::vector<double>& a,double t) const;
+public:
+    int window;
+    int half;
+    int order;
+    int derivative;
+    double scale;///< 归一化坐标的导数换算为采样间隔为1的导数的系数:1/half^derivative
+    std::vector<double> center;///< 中心点的卷积系数
+    std::vector<double> fit;///< (order+1)×window，窗口数据到多项式系数的矩阵
+};
+
+SASavitzkyGolayCoefficients::SASavitzkyGolayCoefficients(int w, int o, int d)
+    :window(w)
+    ,half(w/2)
+    ,order(o)
+    ,derivative(d)
+    ,scale(1.0)
+{
+    const int m = window;
+    const int p1 = order + 1;
+    std::vector<double> t(m,0.0);
+    if(half > 0)
+    {
+        for(int i=0;i<m;++i)
+        {
+            t[i] = double(i - half) / half;
+        }
+        scale = std::pow(double(half),-derivative);
+    }
+    //修正Gram-Schmidt正交化，每列做两次以保证正交性，q按列存储
+    std::vector<double> q(size_t(m)*p1,0.0);
+    std::vector<double> r(size_t(p1)*p1,0.0);
+    for(int k=0;k<p1;++k)
+    {
+        double* v = q.data() + size_t(k)*m;
+        for(int i=0;i<m;++i)
+        {
+            v[i] = std::pow(t[i],k);
+        }
+        for(int pass=0;pass<2;++pass)
+        {
+            for(int j=0;j<k;++j)
+            {
+                const double* qj = q.data() + size_t(j)*m;
+                double dot = 0.0;
+                for(int i=0;i<m;++i)
+                {
+                    dot += qj[i]*v[i];
+                }
+                r[size_t(j)*p1+k] += dot;
+                for(int i=0;i<m;++i)
+                {
+                    v[i] -= dot*qj[i];
+                }
+            }
+        }
+        double norm = 0.0;
+        for(int i=0;i<m;++i)
+        {
+            norm += v[i]*v[i];
+        }
+        norm = std::sqrt(norm);
+        r[size_t(k)*p1+k] = norm;
+        for(int i=0;i<m;++i)
+        {
+            v[i] /= norm;
+        }
+    }
+    //fit = R^-1 * Q^T，逐列回代
+    fit.assign(size_t(p1)*m,0.0);
+    std::vector<double> x(p1,0.0);
+    for(int i=0;i<m;++i)
+    {
+        for(int k=p1-1;k>=0;--k)
+        {
+            double s = q[size_t(k)*m+i];
+            for(int j=k+1;j<p1;++j)
+            {
+                s -= r[size_t(k)*p1+j]*x[j];
+            }
+            x[k] = s / r[size_t(k)*p1+k];
+            fit[size_t(k)*m+i] = x[k];
+        }
+    }
+    //中心点t=0，只有derivative次项的导数不为0
+    center.assign(m,0.0);
+    if(derivative <= order)
+    {
+        double fac = 1.0;
+        for(int k=2;k<=derivative;++k)
+        {
+            fac *= k;
+        }
+        const double* row = fit.data() + size_t(derivative)*m;
+        for(int i=0;i<m;++i)
+        {
+            center[i] = row[i]*fac*scale;
+        }
+    }
+}
+
+void SASavitzkyGolayCoefficients::fitPolynomial(const double *y, std::vector<double> &a) const
+{
+    const int p1 = order + 1;
+    a.assign(p1,0.0);
+    for(int k=0;k<p1;++k)
+    {
+        const double* row = fit.data() + size_t(k)*window;
+        double s = 0.0;
+        for(int i=0;i<window;++i)
+        {
+            s += row[i]*y[i];
+        }
+        a[k] = s;
+    }
+}
+
+double SASavitzkyGolayCoefficients::evalPolynomial(const std::vector<double> &a, double t) const
+{
+    //sum(a[k]*k!/(k-d)!*t^(k-d))，秦九韶算法
+    double res = 0.0;
+    for(int k=order;k>=derivative;--k)
+    {
+        double fall = 1.0;
+        for(int j=0;j<derivative;++j)
+        {
+            fall *= (k - j);
+        }
+        res = res*t + a[k]*fall;
+    }
+    return res*scale;
+}
+}
+
+///
+/// \brief 获取缓存的系数，没有时计算
+///
+static std::shared_ptr<const SA::SASavitzkyGolayCoefficients> sg_coefficients(int window,int order,int derivative)
+{
+    static QMutex s_mutex;
+    static QHash<QString,std::shared_ptr<const SA::SASavitzkyGolayCoefficients> > s_cache;
+    const QString key = QString("%1,%2,%3").arg(window).arg(order).arg(derivative);
+    QMutexLocker locker(&s_mutex);
+    std::shared_ptr<const SA::SASavitzkyGolayCoefficients> c = s_cache.value(key);
+    if(nullptr == c)
+    {
+        if(s_cache.size() >= SA_SG_CACHE_SIZE)
+        {
+            s_cache.clear();
+        }
+        c = std::make_shared<const SA::SASavitzkyGolayCoefficients>(window,order,derivative);
+        s_cache.insert(key,c);
+    }
+    return c;
+}
+
+///
+/// \brief o = c*x
+///
+static void sg_scale(double* o,const double* x,double c,int n)
+{
+    int k = 0;
+#ifdef SA_SG_SSE2
+    const __m128d vc = _mm_set1_pd(c);
+    for(;k+2<=n;k+=2)
+    {
+        _mm_storeu_pd(o+k,_mm_mul_pd(vc,_mm_loadu_pd(x+k)));
+    }
+#endif
+    for(;k<n;++k)
+    {
+        o[k] = c*x[k];
+    }
+}
+
+///
+/// \brief 对称系数成对累加，o += c*(x1+x2)，反对称时o += c*(x1-x2)
+///
+template<bool SYMMETRIC>
+static void sg_accumulate_pair(double* o,const double* x1,const double* x2,double c,int n)
+{
+    int k = 0;
+#ifdef SA_SG_SSE2
+    const __m128d vc = _mm_set1_pd(c);
+    for(;k+4<=n;k+=4)
+    {
+        __m128d a0 = _mm_loadu_pd(x1+k);
+        __m128d a1 = _mm_loadu_pd(x1+k+2);
+        const __m128d b0 = _mm_loadu_pd(x2+k);
+        const __m128d b1 = _mm_loadu_pd(x2+k+2);
+        a0 = SYMMETRIC ? _mm_add_pd(a0,b0) : _mm_sub_pd(a0,b0);
+        a1 = SYMMETRIC ? _mm_add_pd(a1,b1) : _mm_sub_pd(a1,b1);
+        _mm_storeu_pd(o+k,_mm_add_pd(_mm_loadu_pd(o+k),_mm_mul_pd(vc,a0)));
+        _mm_storeu_pd(o+k+2,_mm_add_pd(_mm_loadu_pd(o+k+2),_mm_mul_pd(vc,a1)));
+    }
+#endif
+    for(;k<n;++k)
+    {
+        o[k] += c*(SYMMETRIC ? (x1[k]+x2[k]) : (x1[k]-x2[k]));
+    }
+}
+
+///
+/// \brief 计算中间部分[s,e)的卷积
+///
+/// 偶数阶导数的系数对称，奇数阶反对称，成对计算使乘法减半。
+/// 按块计算，块内对每个系数扫描一遍输入，输出块始终在缓存中
+///
+static void sg_convolve(const std::vector<double>& c,const double* in,double* out,size_t s,size_t e,bool symmetric)
+{
+    const int m = static_cast<int>(c.size());
+    const int half = m/2;
+    for(size_t b=s;b<e;b+=SA_SG_BLOCK_SIZE)
+    {
+        const int len = static_cast<int>(std::min<size_t>(SA_SG_BLOCK_SIZE,e-b));
+        double* o = out + b;
+        const double* x = in + b - half;
+        sg_scale(o,x+half,c[half],len);
+        for(int j=0;j<half;++j)
+        {
+            if(symmetric)
+            {
+                sg_accumulate_pair<true>(o,x+j,x+m-1-j,c[j],len);
+            }
+            else
+            {
+                sg_accumulate_pair<false>(o,x+j,x+m-1-j,c[j],len);
+            }
+        }
+    }
+}
+
+SA::SASavitzkyGolay::SASavitzkyGolay(int window, int order, int derivative)
+    :m_window(window)
+    ,m_order(order)
+    ,m_derivative(derivative)
+{
+    if(isValid())
+    {
+        m_coef = sg_coefficients(window,order,derivative);
+    }
+}
+
+SA::SASavitzkyGolay::~SASavitzkyGolay()
+{
+
+}
+
+bool SA::SASavitzkyGolay::isValid() const
+{
+    return isValidParameter(m_window,m_order,m_derivative);
+}
+
+///
+/// \brief 参数是否有效
+///
+/// 窗口为正奇数，阶次小于窗口且不超过SA_SG_MAX_ORDER，导数阶次非负
+///
+bool SA::SASavitzkyGolay::isValidParameter(int window, int order, int derivative)
+{
+    return (window > 0 && 1 == (window % 2) && order >= 0 && order < window && order <= SA_SG_MAX_ORDER && derivative >= 0);
+}
+
+int SA::SASavitzkyGolay::window() const
+{
+    return m_window;
+}
+
+int SA::SASavitzkyGolay::order() const
+{
+    return m_order;
+}
+
+int SA::SASavitzkyGolay::derivative() const
+{
+    return m_derivative;
+}
+
+std::vector<double> SA::SASavitzkyGolay::coefficients() const
+{
+    return m_coef ? m_coef->center : std::vector<double>();
+}
+
+///
+/// \brief 计算平滑或导数
+/// \param in 输入
+/// \param out 输出，长度为n
+/// \param n 数据长度，不能小于窗口长度
+/// \param delta 采样间隔，求导时使用
+/// \return 参数无效或数据长度小于窗口时返回false，out不变
+///
+bool SA::SASavitzkyGolay::apply(const double *in, double *out, size_t n, double delta) const
+{
+    if(nullptr == m_coef || n < size_t(m_window))
+    {
+        return false;
+    }
+    const SASavitzkyGolayCoefficients& coef = *m_coef;
+    const double dscale = (m_derivative > 0) ? std::pow(delta,-m_derivative) : 1.0;
+    std::vector<double> c = coef.center;
+    for(double& v : c)
+    {
+        v *= dscale;
+    }
+    const size_t half = size_t(coef.half);
+    const size_t count = n - 2*half;
+    const bool symmetric = (0 == (m_derivative % 2));
+    const int parts = parallelPartCount(qint64(count)*m_window,SA_SG_PARALLEL_WORK);
+    parallelFor(parts,[&](int p){
+        const size_t s = half + count*p/parts;
+        const size_t e = half + count*(p+1)/parts;
+        sg_convolve(c,in,out,s,e,symmetric);
+    });
+    //边缘用第一个和最后一个窗口的拟合多项式求值
+    if(half > 0)
+    {
+        std::vector<double> a;
+        coef.fitPolynomial(in,a);
+        for(size_t i=0;i<half;++i)
+        {
+            out[i] = coef.evalPolynomial(a,(double(i) - half)/half)*dscale;
+        }
+        const size_t last = n - size_t(m_window);
+        coef.fitPolynomial(in+last,a);
+        for(size_t i=n-half;i<n;++i)
+        {
+            out[i] = coef.evalPolynomial(a,(double(i - last) - half)/half)*dscale;
+        }
+    }
+    return true;
+}
+///
+/// \brief 计算平滑或导数
+/// \param in 输入
+/// \param out 输出，长度为n，不能和in是同一块内存
+/// \param n 数据长度
+/// \param window 窗口长度，正奇数
+/// \param order 多项式阶次，小于窗口长度
+/// \param derivative 导数阶次，0为平滑
+/// \param delta 采样间隔，求导时使用
+/// \return 参数无效或数据长度小于窗口时返回false
+///
+bool SA::SASavitzkyGolay::filter(const double *in, double *out, size_t n, int window, int order, int derivative, double delta)
+{
+    //先检查数据长度，避免为无法计算的大窗口计算系数
+    if(!isValidParameter(window,order,derivative) || n < static_cast<size_t>(window))
+    {
+        return false;
+    }
+    SASavitzkyGolay sg(window,order,derivative);
+    return sg.apply(in,out,n,delta);
+}
@@ -0,0 +1,58 @@
+#ifndef SASAVITZKYGOLAY_H
+#define SASAVITZKYGOLAY_H
+#include <stddef.h>
+#include <memory>
+#include <vector>
+#include "SAScienceGlobal.h"
+///
+/// \def 多项式阶次的上限，系数的计算量为窗口×阶次²，过高的阶次也失去了平滑的意义
+///
+#ifndef SA_SG_MAX_ORDER
+#define SA_SG_MAX_ORDER 32
+#endif
+namespace SA {
+class SASavitzkyGolayCoefficients;
+///
+/// \brief Savitzky-Golay平滑及求导
+///
+/// 对每个点用窗口内的数据做最小二乘多项式拟合，取拟合多项式在该点的值或导数：
+/// - 窗口长度为任意奇数，多项式阶次小于窗口长度且不超过SA_SG_MAX_ORDER
+/// - 构造时就会计算系数，窗口由外部输入时应先用\sa isValidParameter 和数据长度检查
+/// - 系数按(窗口,阶次,导数阶次)计算一次后缓存，同样参数的对象共享系数
+/// - 边缘不足半个窗口的点用第一个/最后一个完整窗口的拟合多项式求值，而不是补零或镜像
+/// - 中间部分是固定系数的卷积，分块在线程池中并行计算，每块读取两侧半个窗口的重叠数据
+///
+/// \code
+/// SA::SASavitzkyGolay sg(21,3);
+/// if(sg.isValid())
+/// {
+///     sg.apply(in.data(),out.data(),in.size());
+/// }
+/// \endcode
+///
+class SASCIENCE_API SASavitzkyGolay
+{
+public:
+    SASavitzkyGolay(int window,int order,int derivative = 0);
+    ~SASavitzkyGolay();
+    //参数是否有效，窗口为正奇数且阶次小于窗口
+    bool isValid() const;
+    //参数是否有效，不计算系数
+    static bool isValidParameter(int window,int order,int derivative);
+    int window() const;
+    int order() const;
+    int derivative() const;
+    //中心点的卷积系数，out[i] = sum(c[j]*in[i-window/2+j])，导数为采样间隔为1时的值
+    std::vector<double> coefficients() const;
+    //计算，数据长度小于窗口时返回false，in和out不能是同一块内存
+    bool apply(const double* in,double* out,size_t n,double delta = 1.0) const;
+    //计算，参数无效或数据长度小于窗口时返回false
+    static bool filter(const double* in,double* out,size_t n,int window,int order,int derivative = 0,double delta = 1.0);
+private:
+    std::shared_ptr<const SASavitzkyGolayCoefficients> m_coef;
+    int m_window;
+    int m_order;
+    int m_derivative;
+};
+}
+#endif // SASAVITZKYGOLAY_H
@@ -37,15 +37,28 @@ HEADERS += \
     SADsp.h \
     SAMath.h \
     SAScienceDefine.h \
-    SASmooth.h
+    SASmooth.h \
+    SASavitzkyGolay.h \
+    SARollingStatistics.h \
+    SAHampelFilter.h \
+    SAHistogram.h \
+    SAPolyFitBatch.h
 
 SOURCES += \
     SADsp.cpp \
     SAInterpolation.cpp \
     SAPolyFit.cpp \
-    SASmooth.cpp
+    SASmooth.cpp \
+    SASavitzkyGolay.cpp \
+    SARollingStatistics.cpp \
+    SAHampelFilter.cpp \
+    SAHistogram.cpp \
+    SAPolyFitBatch.cpp
 
 
+#sa util
+include($$PWD/../signAUtil/signAUtil.pri)
+
 #the gsl lib support
 include($$PWD/../3rdParty/gsl/gsl.pri)
 
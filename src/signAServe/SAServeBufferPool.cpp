@@ -0,0 +1,154 @@
+#include "SAServeBufferPool.h"
+#include <QMutex>
+#include <QMutexLocker>
+#include <QVector>
+
+class SAServeBufferPoolPrivate
+{
+    SA_IMPL_PUBLIC(SAServeBufferPool)
+public:
+    SAServeBufferPoolPrivate(SAServeBufferPool *p);
+    //获取能容纳size的最小级别，超过最大级别返回-1
+    static int sizeClass(int size);
+
+    //获取容量能满足的最大级别，小于最小级别返回-1
+    static int capacityClass(int capacity);
+
+    QMutex m_mutex;
+    QVector<QList<QByteArray> > m_freeList;   ///< 每个级别的空闲缓冲
+    qint64 m_pooledBytes;
+};
+
+SAServeBufferPoolPrivate::SAServeBufferPoolPrivate(SAServeBufferPool *p) : q_ptr(p)
+    , m_freeList(SA_SERVE_BUFFER_POOL_MAX_CLASS + 1)
+    , m_pooledBytes(0)
+{
+}
+
+
+int SAServeBufferPoolPrivate::sizeClass(int size)
+{
+    int c = SA_SERVE_BUFFER_POOL_MIN_CLASS;
+
+    while ((c <= SA_SERVE_BUFFER_POOL_MAX_CLASS) && ((1 << c) < size))
+    {
+        ++c;
+    }
+    return ((c <= SA_SERVE_BUFFER_POOL_MAX_CLASS) ? c : -1);
+}
+
+
+int SAServeBufferPoolPrivate::capacityClass(int capacity)
+{
+    int c = SA_SERVE_BUFFER_POOL_MAX_CLASS;
+
+    while ((c >= SA_SERVE_BUFFER_POOL_MIN_CLASS) && ((1 << c) > capacity))
+    {
+        --c;
+    }
+    return ((c >= SA_SERVE_BUFFER_POOL_MIN_CLASS) ? c : -1);
+}
+
+
+SAServeBufferPool::SAServeBufferPool() : d_ptr(new SAServeBufferPoolPrivate(this))
+{
+}
+
+
+SAServeBufferPool::~SAServeBufferPool()
+{
+}
+
+
+SAServeBufferPool& SAServeBufferPool::getInstance()
+{
+    static SAServeBufferPool s_p;
+
+    return (s_p);
+}
+
+
+/**
+ * @brief 申请缓冲
+ * @param size 需要的尺寸
+ * @return 尺寸为size的缓冲，内容未初始化
+ */
+QByteArray SAServeBufferPool::acquire(int size)
+{
+    const int c = SAServeBufferPoolPrivate::sizeClass(size);
+    QByteArray buf;
+
+    if (c < 0) {
+        //超大帧直接分配
+        buf.resize(size);
+        return (buf);
+    }
+    {
+        QMutexLocker locker(&(d_ptr->m_mutex));
+        QList<QByteArray>& l = d_ptr->m_freeList[c];
+        if (!l.isEmpty()) {
+            buf = l.takeLast();
+            d_ptr->m_pooledBytes -= buf.capacity();
+        }
+    }
+    //reserve会标记容量保留，之后resize缩小时不会释放内存
+    buf.reserve(1 << c);
+    buf.resize(size);
+    return (buf);
+}
+
+
+/**
+ * @brief 归还缓冲
+ * @param buf 归还后buf为空
+ */
+void SAServeBufferPool::release(QByteArray& buf)
+{
+    QByteArray b;
+
+    b.swap(buf);
+    //被共享的缓冲说明还有别人在用，不能复用
+    if (!b.isDetached()) {
+        return;
+    }
+    const int c = SAServeBufferPoolPrivate::capacityClass(b.capacity());
+
+    if ((c < 0) || (b.capacity() > (1 << SA_SERVE_BUFFER_POOL_MAX_CLASS))) {
+        //太小或超大的缓冲不进入池
+        return;
+    }
+    QMutexLocker locker(&(d_ptr->m_mutex));
+
+    if ((d_ptr->m_pooledBytes + b.capacity()) > SA_SERVE_BUFFER_POOL_MAX_BYTES) {
+        return;
+    }
+    d_ptr->m_pooledBytes += b.capacity();
+    d_ptr->m_freeList[c].append(b);
+}
+
+
+/**
+ * @brief 池中缓存的字节数
+ * @return
+ */
+qint64 SAServeBufferPool::pooledBytes() const
+{
+    QMutexLocker locker(&(d_ptr->m_mutex));
+
+    return (d_ptr->m_pooledBytes);
+}
+
+
+/**
+ * @brief 清空池
+ */
+void SAServeBufferPool::clear()
+{
+    QMutexLocker locker(&(d_ptr->m_mutex));
+
+    for (QList<QByteArray>& l : d_ptr->m_freeList)
+    {
+        l.clear();
+    }
+    d_ptr->m_pooledBytes = 0;
+}
@@ -0,0 +1,66 @@
+#ifndef SASERVEBUFFERPOOL_H
+#define SASERVEBUFFERPOOL_H
+#include "SAServeGlobal.h"
+#include <QByteArray>
+
+///
+/// \def 最小的尺寸级别，2^10=1KB
+///
+#ifndef SA_SERVE_BUFFER_POOL_MIN_CLASS
+#define SA_SERVE_BUFFER_POOL_MIN_CLASS    10
+#endif
+
+///
+/// \def 最大的尺寸级别，2^26=64MB，超过此尺寸的帧不进入池
+///
+#ifndef SA_SERVE_BUFFER_POOL_MAX_CLASS
+#define SA_SERVE_BUFFER_POOL_MAX_CLASS    26
+#endif
+
+///
+/// \def 池中缓存的总字节上限
+///
+#ifndef SA_SERVE_BUFFER_POOL_MAX_BYTES
+#define SA_SERVE_BUFFER_POOL_MAX_BYTES    (128*1024*1024)
+#endif
+
+class SAServeBufferPoolPrivate;
+
+/**
+ * @brief 按尺寸级别管理的帧缓冲池
+ *
+ * 尺寸按2的幂分级，申请时取不小于所需尺寸的级别，避免每个协议帧都重新分配内存，
+ * 各个socket在不同线程中，因此此类是线程安全的
+ *
+ * @code
+ * QByteArray buf = SAServeBufferPool::getInstance().acquire(header.dataSize);
+ * ...读取数据到buf.data()...
+ * SAServeBufferPool::getInstance().release(buf);
+ * @endcode
+ * @note 此类为单例
+ */
+class SASERVE_EXPORT SAServeBufferPool
+{
+    SA_IMPL(SAServeBufferPool)
+    Q_DISABLE_COPY(SAServeBufferPool)
+private:
+    SAServeBufferPool();
+public:
+    ~SAServeBufferPool();
+    //获取实例
+    static SAServeBufferPool& getInstance();
+
+    //申请size大小的缓冲，返回的QByteArray尺寸为size，容量为对应的级别
+    QByteArray acquire(int size);
+
+    //归还缓冲，buf会被清空，被其他地方共享的缓冲不会进入池
+    void release(QByteArray& buf);
+
+    //池中缓存的字节数
+    qint64 pooledBytes() const;
+
+    //清空池
+    void clear();
+};
+
+#endif // SASERVEBUFFERPOOL_H
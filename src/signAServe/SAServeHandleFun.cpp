@@ -34,7 +34,7 @@ bool SA::ensure_write(const char *data, qint64 len, SATcpSocket *socket, short m
 
     do
     {
-        wed += (socket->write(data + wed, len - wed));
+        wed += (socket->transport()->device()->write(data + wed, len - wed));
         ++count;
     }while(wed < len && count < maxtry);
     return (wed == len);
@@ -43,13 +43,13 @@ bool SA::ensure_write(const char *data, qint64 len, SATcpSocket *socket, short m
 
 bool SA::ensure_write(const QByteArray& data, SATcpSocket *socket, short maxtry)
 {
-    qint64 wed = socket->write(data);
+    qint64 wed = socket->transport()->device()->write(data.constData(), data.size());
 
     if ((wed < data.size()) && (wed >= 0)) {
         //没写完继续写
         return (ensure_write(data.data() + wed, data.size() - wed, socket, maxtry));
     }else if (-1 == wed) {
-        qDebug() << "write error:" << socket->errorString();
+        qDebug() << "write error:" << socket->transport()->device()->errorString();
         return (false);
     }
     return (true);
@@ -67,22 +67,104 @@ bool SA::write(const SAProtocolHeader& header, const QByteArray& data, SATcpSock
 {
     bool stat = false;
 
-    socket->waitForBytesWritten();
+    socket->transport()->device()->waitForBytesWritten(30000);
     stat = ensure_write((const char *)(&header), sizeof(SAProtocolHeader), socket);
     if (data.size() > 0) {
         stat &= ensure_write(data, socket);
     }
-    socket->flush();
+    socket->transport()->flush();
     return (stat);
 }
 
 
+/**
+ * @brief 本端支持的数据区编码
+ * @return 编码名称列表，在token握手时发送给对方
+ */
+QStringList SA::supported_payload_codecs()
+{
+    return (QStringList() << "zlib");
+}
+
+
+/**
+ * @brief 根据对方支持的编码选择双方都支持的编码
+ * @param peerCodecs 对方支持的编码名称
+ * @return \sa SAProtocolHeader::PayloadCodec
+ */
+int SA::select_payload_codec(const QStringList& peerCodecs)
+{
+    if (peerCodecs.contains("zlib", Qt::CaseInsensitive) && supported_payload_codecs().contains("zlib")) {
+        return (SAProtocolHeader::CodecZlib);
+    }
+    return (SAProtocolHeader::CodecNone);
+}
+
+
+/**
+ * @brief 按编码压缩数据区
+ *
+ * zlib使用最快的压缩级别，目的是减少传输量而不是压缩率
+ * @param codec \sa SAProtocolHeader::PayloadCodec
+ * @param in
+ * @param out
+ * @return 不认识的编码返回false
+ */
+bool SA::encode_payload(int codec, const QByteArray& in, QByteArray& out)
+{
+    switch (codec)
+    {
+    case SAProtocolHeader::CodecNone:
+        out = in;
+        return (true);
+
+    case SAProtocolHeader::CodecZlib:
+        out = qCompress(in, 1);
+        return (!out.isEmpty());
+
+    default:
+        break;
+    }
+    return (false);
+}
+
+
+/**
+ * @brief 按编码解压数据区
+ * @param codec \sa SAProtocolHeader::PayloadCodec
+ * @param in
+ * @param out
+ * @return 不认识的编码或数据损坏返回false
+ */
+bool SA::decode_payload(int codec, const QByteArray& in, QByteArray& out)
+{
+    switch (codec)
+    {
+    case SAProtocolHeader::CodecNone:
+        out = in;
+        return (true);
+
+    case SAProtocolHeader::CodecZlib:
+        out = qUncompress(in);
+        return (!out.isEmpty());
+
+    default:
+        break;
+    }
+    return (false);
+}
+
+
 /**
  * @brief 写xml协议
+ *
+ * 数据区超过SA_PROTOCOL_COMPRESS_THRESHOLD且socket已协商编码时压缩发送，
+ * 编码记录在extendValue的最高字节，crc32按压缩后的数据计算，
+ * 数据区超过SA_SERVE_MAX_FRAME_SIZE时不发送，返回false
  * @param socket
  * @param xml
  * @param sequenceID
- * @param extendValue
+ * @param extendValue 只使用低24位
  * @return
  */
 bool SA::write_xml_protocol(SATcpSocket *socket, const SAXMLProtocol *xml, int funid, int sequenceID, uint32_t extendValue)
@@ -92,11 +174,26 @@ bool SA::write_xml_protocol(SATcpSocket *socket, const SAXMLProtocol *xml, int f
 
     header.init();
     header.protocolFunID = funid;
-    header.dataSize = data.size();
     header.protocolTypeID = SA::ProtocolTypeXml;
-    header.dataCrc32 = SACRC::crc32(data);
     header.sequenceID = sequenceID;
     header.extendValue = extendValue;
+    header.setCodec(SAProtocolHeader::CodecNone);
+    const int codec = socket->getPayloadCodec();
+
+    if ((SAProtocolHeader::CodecNone != codec) && (data.size() >= SA_PROTOCOL_COMPRESS_THRESHOLD)) {
+        QByteArray compressed;
+        //压缩后没有变小就按原样发送
+        if (encode_payload(codec, data, compressed) && (compressed.size() < data.size())) {
+            data = compressed;
+            header.setCodec(codec);
+        }
+    }
+    if (data.size() > SA_SERVE_MAX_FRAME_SIZE) {
+        //对方会拒绝并断开
+        return (false);
+    }
+    header.dataSize = data.size();
+    header.dataCrc32 = SACRC::crc32(data);
 
     return (write(header, data, socket));
 }
@@ -140,6 +237,8 @@ bool SA::request_token_xml(int pid, const QString& appid, SATcpSocket *socket, i
     data.setFunctionID(SA::ProtocolFunReqToken);
     data.setValue(SA_SERVER_VALUE_GROUP_SA_DEFAULT, "pid", pid);
     data.setValue(SA_SERVER_VALUE_GROUP_SA_DEFAULT, "appid", appid);
+    //告诉服务端本端支持的数据区编码
+    data.setValue(SA_SERVER_VALUE_GROUP_SA_DEFAULT, "codecs", supported_payload_codecs().join(','));
     return (write_xml_protocol(socket, &data, SA::ProtocolFunReqToken, sequenceID, extendValue));
 }
 
@@ -159,6 +258,22 @@ bool SA::receive_request_token_xml(const SAXMLProtocol *xml, int& pid, QString&
 }
 
 
+/**
+ * @brief 解析token请求参数
+ * @param xml
+ * @param pid
+ * @param appid
+ * @param codecs 对方支持的数据区编码，旧版本的客户端为空
+ * @return
+ */
+bool SA::receive_request_token_xml(const SAXMLProtocol *xml, int& pid, QString& appid, QStringList& codecs)
+{
+    receive_request_token_xml(xml, pid, appid);
+    codecs = xml->getDefaultGroupValue("codecs").toString().split(',', QString::SkipEmptyParts);
+    return (true);
+}
+
+
 /**
  * @brief 请求心跳
  * @param socket
@@ -371,9 +486,10 @@ void write_saitem_to_xml(QXmlStreamWriter& xml, const SAItem *item)
  * @param header
  * @param pid
  * @param appid
+ * @param codec 协商的数据区编码 \sa SA::select_payload_codec
  * @return
  */
-bool SA::reply_token_xml(SATcpSocket *socket, const SAProtocolHeader& header, int pid, const QString& appid)
+bool SA::reply_token_xml(SATcpSocket *socket, const SAProtocolHeader& header, int pid, const QString& appid, int codec)
 {
 #if SA_SERVE_DEBUG_PRINT_HandleFun
     FUNCTION_RUN_PRINT();
@@ -385,6 +501,7 @@ bool SA::reply_token_xml(SATcpSocket *socket, const SAProtocolHeader& header, in
     reply.setClassID(SA::ProtocolTypeXml);
     reply.setFunctionID(SA::ProtocolFunReplyToken);
     reply.setValue("token", token);
+    reply.setValue("codec", codec);
     return (write_xml_protocol(socket, &reply, SA::ProtocolFunReplyToken, header.sequenceID, header.extendValue));
 }
 
@@ -402,6 +519,21 @@ bool SA::receive_reply_token_xml(const SAXMLProtocol *xml, QString& token)
 }
 
 
+/**
+ * @brief 解析token请求的xml
+ * @param xml
+ * @param token
+ * @param codec 协商的数据区编码，旧版本的服务端为CodecNone
+ * @return
+ */
+bool SA::receive_reply_token_xml(const SAXMLProtocol *xml, QString& token, int& codec)
+{
+    receive_reply_token_xml(xml, token);
+    codec = xml->getDefaultGroupValue("codec", (int)SAProtocolHeader::CodecNone).toInt();
+    return (true);
+}
+
+
 /**
  * @brief 处理心跳请求
  * @param socket
@@ -422,6 +554,28 @@ bool SA::reply_heartbreat_xml(SATcpSocket *socket, const SAProtocolHeader& reche
 }
 
 
+/**
+ * @brief 取消sequenceID对应的请求
+ *
+ * 取消协议只有协议头，没有数据区，被取消的请求会收到错误码为ProtocolErrorCanceled的错误回复，
+ * 如果请求已经处理完，取消协议会被忽略
+ * @param socket
+ * @param sequenceID 需要取消的请求的流水号
+ * @return
+ */
+bool SA::request_cancel(SATcpSocket *socket, int sequenceID)
+{
+    SAProtocolHeader header;
+
+    header.init();
+    header.sequenceID = sequenceID;
+    header.dataSize = 0;
+    header.protocolTypeID = SA::ProtocolTypeXml;
+    header.protocolFunID = SA::ProtocolFunReqCancel;
+    return (write(header, QByteArray(), socket));
+}
+
+
 /**
  * @brief 异常的回复
  * @param socket
@@ -520,6 +674,57 @@ bool SA::receive_request_2d_points_describe_xml(const SAXMLProtocol *xml, QVecto
 }
 
 
+/**
+ * @brief 请求2维数据的统计描述，点序列已经写入共享数据区，协议中只携带句柄
+ * @param socket socket
+ * @param handle 共享数据区句柄，数据类型需要为SAServeSharedBufferHandle::TypePointF
+ * @param sequenceID 流水号，返回的reply中会带着此值，用于区别请求的回复
+ * @param sortcount 返回排序的前后n个值
+ * @return
+ */
+bool SA::request_2d_points_describe_shm_xml(SATcpSocket *socket, const SAServeSharedBufferHandle& handle, int sequenceID, int sortcount)
+{
+    SAXMLProtocol xml;
+
+    xml.setClassID(SA::ProtocolTypeXml);
+    xml.setFunctionID(SA::ProtocolFunReq2DPointsDescribeShm);
+    xml.setValue("shm-slot", handle.slotID);
+    xml.setValue("shm-generation", handle.generation);
+    xml.setValue("shm-segment", handle.segment);
+    xml.setValue("shm-offset", qulonglong(handle.offset));
+    xml.setValue("shm-length", qulonglong(handle.length));
+    xml.setValue("shm-dtype", handle.dtype);
+    xml.setValue("sort-count", sortcount);
+
+    return (write_xml_protocol(socket, &xml, SA::ProtocolFunReq2DPointsDescribeShm, sequenceID, 0));
+}
+
+
+/**
+ * @brief 针对request_2d_points_describe_shm_xml的解析
+ * @param xml
+ * @param handle
+ * @param sortcount
+ * @return
+ */
+bool SA::receive_request_2d_points_describe_shm_xml(const SAXMLProtocol *xml, SAServeSharedBufferHandle& handle, int& sortcount)
+{
+    bool ok = false;
+
+    handle.slotID = xml->getDefaultGroupValue("shm-slot", -1).toInt(&ok);
+    if (!ok) {
+        return (false);
+    }
+    handle.generation = xml->getDefaultGroupValue("shm-generation").toUInt();
+    handle.segment = xml->getDefaultGroupValue("shm-segment", 0).toUInt();
+    handle.offset = xml->getDefaultGroupValue("shm-offset").toULongLong();
+    handle.length = xml->getDefaultGroupValue("shm-length").toULongLong();
+    handle.dtype = xml->getDefaultGroupValue("shm-dtype").toInt();
+    sortcount = xml->getDefaultGroupValue("sort-count").toInt();
+    return (handle.isValid());
+}
+
+
 /**
  * @brief 回复2维数组描述
  * @param socket
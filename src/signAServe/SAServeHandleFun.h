@@ -7,6 +7,7 @@
 #include "SATcpSocket.h"
 #include "SAXMLProtocol.h"
 #include "SATree.h"
+#include "SAServeSharedBuffer.h"
 class QObject;
 
 /**
@@ -48,7 +49,23 @@ SASERVE_EXPORT bool write(const SAProtocolHeader& header
 SASERVE_EXPORT QString make_token(int pid
     , const QString& appID);
 
-//写xml协议
+//本端支持的数据区编码
+SASERVE_EXPORT QStringList supported_payload_codecs();
+
+//根据对方支持的编码选择双方都支持的编码
+SASERVE_EXPORT int select_payload_codec(const QStringList& peerCodecs);
+
+//按编码压缩数据区
+SASERVE_EXPORT bool encode_payload(int codec
+    , const QByteArray& in
+    , QByteArray& out);
+
+//按编码解压数据区
+SASERVE_EXPORT bool decode_payload(int codec
+    , const QByteArray& in
+    , QByteArray& out);
+
+//写xml协议，数据区超过SA_PROTOCOL_COMPRESS_THRESHOLD时按socket协商的编码压缩
 SASERVE_EXPORT bool write_xml_protocol(SATcpSocket *socket
     , const SAXMLProtocol *xml
     , int funid
@@ -98,16 +115,28 @@ SASERVE_EXPORT bool receive_request_token_xml(const SAXMLProtocol *xml
     , int& pid
     , QString& appid);
 
+//解析token请求参数，包含对方支持的数据区编码
+SASERVE_EXPORT bool receive_request_token_xml(const SAXMLProtocol *xml
+    , int& pid
+    , QString& appid
+    , QStringList& codecs);
+
 //处理token请求
 SASERVE_EXPORT bool reply_token_xml(SATcpSocket *socket
     , const SAProtocolHeader& header
     , int pid
-    , const QString& appid);
+    , const QString& appid
+    , int codec = SAProtocolHeader::CodecNone);
 
 //解析token返回参数
 SASERVE_EXPORT bool receive_reply_token_xml(const SAXMLProtocol *xml
     , QString& token);
 
+//解析token返回参数，包含协商的数据区编码
+SASERVE_EXPORT bool receive_reply_token_xml(const SAXMLProtocol *xml
+    , QString& token
+    , int& codec);
+
 //请求心跳
 SASERVE_EXPORT bool request_heartbreat(SATcpSocket *socket);
 
@@ -115,6 +144,10 @@ SASERVE_EXPORT bool request_heartbreat(SATcpSocket *socket);
 SASERVE_EXPORT bool reply_heartbreat_xml(SATcpSocket *socket
     , const SAProtocolHeader& recheader);
 
+//取消sequenceID对应的请求
+SASERVE_EXPORT bool request_cancel(SATcpSocket *socket
+    , int sequenceID);
+
 //////////////////////
 //请求2维数组描述
 /////////////////////
@@ -128,6 +161,17 @@ SASERVE_EXPORT bool receive_request_2d_points_describe_xml(const SAXMLProtocol *
     , QVector<QPointF>& arrs
     , int& sortcount);
 
+//请求2维数组描述，点序列位于共享数据区
+SASERVE_EXPORT bool request_2d_points_describe_shm_xml(SATcpSocket *socket
+    , const SAServeSharedBufferHandle& handle
+    , int sequenceID
+    , int sortcount = 20);
+
+//
+SASERVE_EXPORT bool receive_request_2d_points_describe_shm_xml(const SAXMLProtocol *xml
+    , SAServeSharedBufferHandle& handle
+    , int& sortcount);
+
 //回复2维数组描述
 SASERVE_EXPORT bool reply_2d_points_describe_xml(SATcpSocket *socket
     , const SAProtocolHeader& requestHeader
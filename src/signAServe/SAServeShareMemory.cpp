@@ -5,10 +5,12 @@
 struct SAServeShareMemoryPrivateData {
     int	serve_state;    //0
     int	serve_port;     //4
+    int	serve_local;    //8
 };
 
 #define OFFSET_STATE	0       //状态的内存偏移
 #define OFFSET_PORT	4       //端口号的内存偏移
+#define OFFSET_LOCAL	8       //本地socket开启标记的内存偏移
 
 class SAServeShareMemoryPrivate
 {
@@ -152,6 +154,25 @@ void SAServeShareMemory::setPort(int port)
 }
 
 
+/**
+ * @brief 服务是否开启了本地socket
+ * @return 开启了返回true，此时客户端可以通过@ref SA_SERVE_LOCAL_SERVER_NAME 连接
+ */
+bool SAServeShareMemory::isLocalServeEnabled() const
+{
+    return (d_ptr->m_data.serve_local != 0);
+}
+
+
+void SAServeShareMemory::setLocalServeEnabled(bool on)
+{
+    if (isAttach()) {
+        d_ptr->m_data.serve_local = (on ? 1 : 0);
+        d_ptr->updateDataToSharedMem();
+    }
+}
+
+
 /**
  * @brief 把共享内存的内容更新到本地内存
  */
@@ -190,6 +211,7 @@ QTextStream& operator <<(QTextStream& io, const SAServeShareMemory& mem)
         << "\n error:" << (int)mem.d_ptr->m_sharemem.error() << " ,error string:" << mem.d_ptr->m_sharemem.errorString()
         << "\n serve_state:" << mem.getServeState()
         << "\n serve_port:" << mem.getPort()
+        << "\n serve_local:" << mem.isLocalServeEnabled()
     ;
     return (io);
 }
@@ -31,6 +31,10 @@ public:
     int getPort() const;
     //设置端口
     void setPort(int port);
+    //服务是否开启了本地socket
+    bool isLocalServeEnabled() const;
+    //设置服务是否开启了本地socket
+    void setLocalServeEnabled(bool on);
     //从共享内存中更新数据
     void updateFromMem();
     //返回描述
@@ -0,0 +1,617 @@
+#include "SAServeSharedBuffer.h"
+#include <QSharedMemory>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <limits>
+
+#define SA_SERVE_SHARED_BUFFER_MAGIC	(0x5A5B0627)
+#define SA_SERVE_SHARED_SEGMENT_MAGIC	(0x5A5B5E67)
+#define SA_SERVE_SHARED_BUFFER_ALIGN	64      //数据区的对齐
+
+/**
+ * @brief 共享内存的头，位于共享内存的起始位置
+ */
+struct SAServeSharedBufferHeader {
+    uint32_t	magic;          ///< 魔数，用于判断共享内存是否已经初始化
+    int32_t		slotCount;      ///< 槽数量
+    uint32_t	slotSize;       ///< 每个槽的尺寸
+    int32_t		cursor;         ///< 下次开始查找空闲槽的位置，形成环形分配
+    uint32_t	segmentSerial;  ///< 最近一次分配的单独共享内存段编号
+};
+
+/**
+ * @brief 每个槽的描述，紧跟在头后面
+ */
+struct SAServeSharedBufferSlot {
+    int32_t		refCount;       ///< 引用计数，0代表空闲
+    uint32_t	generation;     ///< 代号，每次被申请加1
+    int32_t		head;           ///< 所在连续段的起始槽号，-1代表空闲
+    int32_t		runLength;      ///< 所在连续段的槽数量
+};
+
+/**
+ * @brief 单独共享内存段的头，位于段的起始位置，数据从对齐后的位置开始
+ */
+struct SAServeSharedSegmentHeader {
+    uint32_t	magic;          ///< 魔数
+    uint32_t	segment;        ///< 段编号，和句柄的segment对应
+    int32_t		refCount;       ///< 跨进程的引用计数
+    int32_t		reserved;
+    uint64_t	length;         ///< 数据长度(byte)
+};
+
+/**
+ * @brief 本进程attach的单独共享内存段
+ */
+struct SAServeSharedSegment {
+    QSharedMemory *mem;
+    int localRef;           ///< 本进程持有的引用数，为0时detach
+};
+
+SAServeSharedBufferHandle::SAServeSharedBufferHandle()
+    : slotID(-1)
+    , generation(0)
+    , segment(0)
+    , offset(0)
+    , length(0)
+    , dtype(TypeUnknow)
+{
+}
+
+
+bool SAServeSharedBufferHandle::isValid() const
+{
+    return ((slotID >= 0) || (segment != 0));
+}
+
+
+/**
+ * @brief 按数据类型计算元素个数
+ * @return 未知类型返回字节数
+ */
+qint64 SAServeSharedBufferHandle::elementCount() const
+{
+    switch (dtype)
+    {
+    case TypeDouble:
+        return (length / sizeof(double));
+
+    case TypePointF:
+        return (length / (2*sizeof(double)));
+
+    default:
+        break;
+    }
+    return (qint64(length));
+}
+
+
+class SAServeSharedBufferPrivate
+{
+    SA_IMPL_PUBLIC(SAServeSharedBuffer)
+public:
+    SAServeSharedBufferPrivate(SAServeSharedBuffer *p, int slotCount, uint32_t slotSize, const QString& key);
+    ~SAServeSharedBufferPrivate();
+    SAServeSharedBufferHeader *header() const;
+    SAServeSharedBufferSlot *slot(int i) const;
+    char *slotData(int i) const;
+
+    //此函数需要在lock后调用
+    bool isHandleAlive(const SAServeSharedBufferHandle& h) const;
+    static size_t dataOffset(int slotCount);
+
+    //单独共享内存段的key
+    QString segmentKey(uint32_t segment) const;
+
+    //创建单独的共享内存段，失败返回无效句柄
+    SAServeSharedBufferHandle createSegment(uint64_t size, int dtype);
+
+    //单独共享内存段的头，段需要已经attach
+    static SAServeSharedSegmentHeader *segmentHeader(QSharedMemory *mem);
+
+    //单独共享内存段的引用计数加减，返回false说明句柄过期
+    bool retainSegment(const SAServeSharedBufferHandle& h);
+    bool releaseSegment(const SAServeSharedBufferHandle& h);
+
+    QSharedMemory m_sharemem;
+    QMutex m_segmentMutex;                              ///< 保护m_segments
+    QHash<uint32_t, SAServeSharedSegment> m_segments;   ///< 本进程attach的单独共享内存段
+};
+
+SAServeSharedBufferPrivate::SAServeSharedBufferPrivate(SAServeSharedBuffer *p, int slotCount, uint32_t slotSize, const QString& key)
+    : q_ptr(p)
+    , m_sharemem(key)
+{
+    size_t size = dataOffset(slotCount) + size_t(slotCount) * slotSize;
+
+    if (!m_sharemem.create(size)) {
+        // 已经有别的进程创建了共享数据区，直接attach，槽的布局以创建者为准
+        // attach失败时isAttach返回false，错误信息可以通过describe获取
+        m_sharemem.attach();
+        return;
+    }
+    //说明是第一次创建，初始化头和槽
+    m_sharemem.lock();
+    SAServeSharedBufferHeader *h = header();
+
+    h->slotCount = slotCount;
+    h->slotSize = slotSize;
+    h->cursor = 0;
+    h->segmentSerial = 0;
+    for (int i = 0; i < slotCount; ++i)
+    {
+        SAServeSharedBufferSlot *s = slot(i);
+        s->refCount = 0;
+        s->generation = 0;
+        s->head = -1;
+        s->runLength = 0;
+    }
+    h->magic = SA_SERVE_SHARED_BUFFER_MAGIC;
+    m_sharemem.unlock();
+}
+
+
+SAServeSharedBufferPrivate::~SAServeSharedBufferPrivate()
+{
+    //没有释放的单独共享内存段在这里detach，最后一个detach的进程负责回收
+    for (auto i = m_segments.begin(); i != m_segments.end(); ++i)
+    {
+        delete i.value().mem;
+    }
+}
+
+
+SAServeSharedBufferHeader *SAServeSharedBufferPrivate::header() const
+{
+    return ((SAServeSharedBufferHeader *)m_sharemem.data());
+}
+
+
+SAServeSharedBufferSlot *SAServeSharedBufferPrivate::slot(int i) const
+{
+    return ((SAServeSharedBufferSlot *)((char *)m_sharemem.data() + sizeof(SAServeSharedBufferHeader)) + i);
+}
+
+
+char *SAServeSharedBufferPrivate::slotData(int i) const
+{
+    const SAServeSharedBufferHeader *h = header();
+
+    return ((char *)m_sharemem.data() + dataOffset(h->slotCount) + size_t(i) * h->slotSize);
+}
+
+
+bool SAServeSharedBufferPrivate::isHandleAlive(const SAServeSharedBufferHandle& h) const
+{
+    if (!m_sharemem.isAttached() || (header()->magic != SA_SERVE_SHARED_BUFFER_MAGIC)) {
+        return (false);
+    }
+    if (h.segment != 0) {
+        return (false);
+    }
+    if ((h.slotID < 0) || (h.slotID >= header()->slotCount)) {
+        return (false);
+    }
+    const SAServeSharedBufferSlot *s = slot(h.slotID);
+
+    if ((s->head != h.slotID) || (s->generation != h.generation) || (s->refCount <= 0)) {
+        return (false);
+    }
+    return ((uint64_t(h.offset) + h.length) <= uint64_t(s->runLength) * header()->slotSize);
+}
+
+
+/**
+ * @brief 数据区相对共享内存起始位置的偏移
+ * @param slotCount
+ * @return
+ */
+size_t SAServeSharedBufferPrivate::dataOffset(int slotCount)
+{
+    size_t s = sizeof(SAServeSharedBufferHeader) + sizeof(SAServeSharedBufferSlot) * slotCount;
+
+    return ((s + SA_SERVE_SHARED_BUFFER_ALIGN - 1) / SA_SERVE_SHARED_BUFFER_ALIGN * SA_SERVE_SHARED_BUFFER_ALIGN);
+}
+
+
+QString SAServeSharedBufferPrivate::segmentKey(uint32_t segment) const
+{
+    return (QStringLiteral("%1.%2").arg(m_sharemem.key()).arg(segment));
+}
+
+
+/**
+ * @brief 按请求的尺寸创建单独的共享内存段
+ *
+ * 段编号在槽序列的头中分配，因此多个进程创建的段不会重名
+ * @param size 数据尺寸(byte)
+ * @param dtype 数据类型
+ * @return 失败返回无效句柄
+ */
+SAServeSharedBufferHandle SAServeSharedBufferPrivate::createSegment(uint64_t size, int dtype)
+{
+    SAServeSharedBufferHandle res;
+    const uint64_t total = SA_SERVE_SHARED_BUFFER_ALIGN + size;
+
+    if (total > uint64_t(std::numeric_limits<int>::max())) {
+        return (res);
+    }
+    QSharedMemory *mem = nullptr;
+
+    //编号回绕后可能和还存在的段重名，此时取下一个编号
+    for (int tryCount = 0; tryCount < 16 && (nullptr == mem); ++tryCount)
+    {
+        m_sharemem.lock();
+        SAServeSharedBufferHeader *h = header();
+        if (0 == ++(h->segmentSerial)) {
+            h->segmentSerial = 1;
+        }
+        const uint32_t segment = h->segmentSerial;
+        m_sharemem.unlock();
+        mem = new QSharedMemory(segmentKey(segment));
+        if (!mem->create(int(total))) {
+            const bool exists = (QSharedMemory::AlreadyExists == mem->error());
+            delete mem;
+            mem = nullptr;
+            if (!exists) {
+                break;
+            }
+            continue;
+        }
+        SAServeSharedSegmentHeader *sh = segmentHeader(mem);
+        sh->segment = segment;
+        sh->refCount = 1;
+        sh->reserved = 0;
+        sh->length = size;
+        sh->magic = SA_SERVE_SHARED_SEGMENT_MAGIC;
+        res.segment = segment;
+        res.generation = segment;
+    }
+    if (nullptr == mem) {
+        return (res);
+    }
+    res.offset = 0;
+    res.length = size;
+    res.dtype = dtype;
+    QMutexLocker locker(&m_segmentMutex);
+    SAServeSharedSegment seg;
+
+    seg.mem = mem;
+    seg.localRef = 1;
+    m_segments.insert(res.segment, seg);
+    return (res);
+}
+
+
+SAServeSharedSegmentHeader *SAServeSharedBufferPrivate::segmentHeader(QSharedMemory *mem)
+{
+    return ((SAServeSharedSegmentHeader *)mem->data());
+}
+
+
+/**
+ * @brief 单独共享内存段的引用计数加1，本进程还没有attach时先attach
+ * @param h
+ * @return 段已经不存在或句柄过期返回false
+ */
+bool SAServeSharedBufferPrivate::retainSegment(const SAServeSharedBufferHandle& h)
+{
+    QMutexLocker locker(&m_segmentMutex);
+    auto i = m_segments.find(h.segment);
+    QSharedMemory *mem = nullptr;
+
+    if (i != m_segments.end()) {
+        mem = i.value().mem;
+    }else {
+        mem = new QSharedMemory(segmentKey(h.segment));
+        if (!mem->attach()) {
+            delete mem;
+            return (false);
+        }
+    }
+    bool alive = false;
+
+    mem->lock();
+    SAServeSharedSegmentHeader *sh = segmentHeader(mem);
+    if ((SA_SERVE_SHARED_SEGMENT_MAGIC == sh->magic) && (sh->segment == h.generation) && (sh->refCount > 0)
+        && ((h.offset + h.length) <= sh->length)) {
+        ++(sh->refCount);
+        alive = true;
+    }
+    mem->unlock();
+    if (i != m_segments.end()) {
+        if (alive) {
+            ++(i.value().localRef);
+        }
+    }else if (alive) {
+        SAServeSharedSegment seg;
+        seg.mem = mem;
+        seg.localRef = 1;
+        m_segments.insert(h.segment, seg);
+    }else {
+        delete mem;
+    }
+    return (alive);
+}
+
+
+/**
+ * @brief 单独共享内存段的引用计数减1，本进程不再持有时detach
+ * @param h
+ * @return 本进程没有持有此段返回false
+ */
+bool SAServeSharedBufferPrivate::releaseSegment(const SAServeSharedBufferHandle& h)
+{
+    QMutexLocker locker(&m_segmentMutex);
+    auto i = m_segments.find(h.segment);
+
+    if (i == m_segments.end()) {
+        return (false);
+    }
+    QSharedMemory *mem = i.value().mem;
+
+    mem->lock();
+    SAServeSharedSegmentHeader *sh = segmentHeader(mem);
+    if (sh->refCount > 0) {
+        --(sh->refCount);
+    }
+    mem->unlock();
+    if (--(i.value().localRef) <= 0) {
+        m_segments.erase(i);
+        delete mem;
+    }
+    return (true);
+}
+
+
+/**
+ * @brief 构造，若共享数据区还不存在将以slotCount和slotSize进行创建
+ * @param slotCount 槽数量
+ * @param slotSize 每个槽的尺寸
+ * @param key 共享内存的key，通讯双方需要一致
+ */
+SAServeSharedBuffer::SAServeSharedBuffer(int slotCount, uint32_t slotSize, const QString& key)
+    : d_ptr(new SAServeSharedBufferPrivate(this, slotCount, slotSize, key))
+{
+}
+
+
+SAServeSharedBuffer::~SAServeSharedBuffer()
+{
+}
+
+
+bool SAServeSharedBuffer::isAttach() const
+{
+    return (d_ptr->m_sharemem.isAttached() && (d_ptr->header()->magic == SA_SERVE_SHARED_BUFFER_MAGIC));
+}
+
+
+int SAServeSharedBuffer::slotCount() const
+{
+    return (isAttach() ? d_ptr->header()->slotCount : 0);
+}
+
+
+uint32_t SAServeSharedBuffer::slotSize() const
+{
+    return (isAttach() ? d_ptr->header()->slotSize : 0);
+}
+
+
+/**
+ * @brief 槽序列的总尺寸
+ * @return
+ */
+uint64_t SAServeSharedBuffer::slotCapacity() const
+{
+    return (uint64_t(slotCount()) * slotSize());
+}
+
+
+/**
+ * @brief 能申请的最大尺寸
+ *
+ * 超过槽序列的数据放在单独的共享内存段，QSharedMemory的尺寸为int，因此上限略小于2GB
+ * @return 没有连接共享数据区时返回0
+ */
+uint64_t SAServeSharedBuffer::capacity() const
+{
+    if (!isAttach()) {
+        return (0);
+    }
+    return (qMax<uint64_t>(slotCapacity(), uint64_t(std::numeric_limits<int>::max()) - SA_SERVE_SHARED_BUFFER_ALIGN));
+}
+
+
+/**
+ * @brief 申请一段空间
+ *
+ * 从上次分配的位置开始环形查找足够数量的连续空闲槽，找到后引用计数置1，代号加1，
+ * 槽序列放不下时按size单独创建一个共享内存段
+ * @param size 尺寸(byte)
+ * @param dtype 数据类型 \sa SAServeSharedBufferHandle::DataType
+ * @return 没有足够空间返回无效句柄
+ */
+SAServeSharedBufferHandle SAServeSharedBuffer::acquire(uint64_t size, int dtype)
+{
+    SAServeSharedBufferHandle res;
+
+    if (!isAttach() || (size == 0)) {
+        return (res);
+    }
+    d_ptr->m_sharemem.lock();
+    SAServeSharedBufferHeader *h = d_ptr->header();
+    const uint64_t needSlots = (size + h->slotSize - 1) / h->slotSize;
+    const int need = (needSlots <= uint64_t(h->slotCount)) ? int(needSlots) : (h->slotCount + 1);
+
+    for (int k = 0; k < h->slotCount; ++k)
+    {
+        int start = (h->cursor + k) % h->slotCount;
+        if ((start + need) > h->slotCount) {
+            //连续段不回绕
+            continue;
+        }
+        bool isFree = true;
+        for (int i = start; i < start + need; ++i)
+        {
+            if (d_ptr->slot(i)->refCount > 0) {
+                isFree = false;
+                break;
+            }
+        }
+        if (!isFree) {
+            continue;
+        }
+        for (int i = start; i < start + need; ++i)
+        {
+            SAServeSharedBufferSlot *s = d_ptr->slot(i);
+            s->refCount = 1;
+            ++(s->generation);
+            s->head = start;
+            s->runLength = need;
+        }
+        h->cursor = (start + need) % h->slotCount;
+        res.slotID = start;
+        res.generation = d_ptr->slot(start)->generation;
+        res.offset = 0;
+        res.length = size;
+        res.dtype = dtype;
+        break;
+    }
+    d_ptr->m_sharemem.unlock();
+    if (!res.isValid()) {
+        res = d_ptr->createSegment(size, dtype);
+    }
+    return (res);
+}
+
+
+/**
+ * @brief 增加引用计数
+ * @param h
+ * @return 句柄过期返回false
+ */
+bool SAServeSharedBuffer::retain(const SAServeSharedBufferHandle& h)
+{
+    if (h.segment != 0) {
+        return (d_ptr->retainSegment(h));
+    }
+    d_ptr->m_sharemem.lock();
+    bool alive = d_ptr->isHandleAlive(h);
+
+    if (alive) {
+        const int run = d_ptr->slot(h.slotID)->runLength;
+        for (int i = h.slotID; i < h.slotID + run; ++i)
+        {
+            ++(d_ptr->slot(i)->refCount);
+        }
+    }
+    d_ptr->m_sharemem.unlock();
+    return (alive);
+}
+
+
+/**
+ * @brief 减少引用计数，计数为0时槽被回收
+ * @param h
+ * @return 句柄过期返回false
+ */
+bool SAServeSharedBuffer::release(const SAServeSharedBufferHandle& h)
+{
+    if (h.segment != 0) {
+        return (d_ptr->releaseSegment(h));
+    }
+    d_ptr->m_sharemem.lock();
+    bool alive = d_ptr->isHandleAlive(h);
+
+    if (alive) {
+        const int run = d_ptr->slot(h.slotID)->runLength;
+        for (int i = h.slotID; i < h.slotID + run; ++i)
+        {
+            SAServeSharedBufferSlot *s = d_ptr->slot(i);
+            if (--(s->refCount) <= 0) {
+                s->refCount = 0;
+                s->head = -1;
+                s->runLength = 0;
+            }
+        }
+    }
+    d_ptr->m_sharemem.unlock();
+    return (alive);
+}
+
+
+/**
+ * @brief 获取句柄对应的内存地址
+ *
+ * 返回的地址在持有引用期间有效
+ * @param h
+ * @return 句柄过期返回nullptr
+ */
+void *SAServeSharedBuffer::data(const SAServeSharedBufferHandle& h)
+{
+    return (const_cast<void *>(constData(h)));
+}
+
+
+const void *SAServeSharedBuffer::constData(const SAServeSharedBufferHandle& h) const
+{
+    if (h.segment != 0) {
+        //单独的段只有本进程持有引用时才有映射
+        QMutexLocker locker(&(d_ptr->m_segmentMutex));
+        auto i = d_ptr->m_segments.constFind(h.segment);
+        if (i == d_ptr->m_segments.constEnd()) {
+            return (nullptr);
+        }
+        const SAServeSharedSegmentHeader *sh = SAServeSharedBufferPrivate::segmentHeader(i.value().mem);
+        if ((sh->segment != h.generation) || ((h.offset + h.length) > sh->length)) {
+            return (nullptr);
+        }
+        return ((const char *)i.value().mem->constData() + SA_SERVE_SHARED_BUFFER_ALIGN + h.offset);
+    }
+    d_ptr->m_sharemem.lock();
+    const void *p = nullptr;
+
+    if (d_ptr->isHandleAlive(h)) {
+        p = d_ptr->slotData(h.slotID) + h.offset;
+    }
+    d_ptr->m_sharemem.unlock();
+    return (p);
+}
+
+
+/**
+ * @brief 返回描述
+ * @return
+ */
+QString SAServeSharedBuffer::describe() const
+{
+    QString str;
+    QTextStream io(&str);
+
+    io << (*this);
+    io.flush();
+    return (str);
+}
+
+
+/**
+ * @brief 对SAServeSharedBuffer进行格式化文本输出
+ * @param io
+ * @param mem
+ * @return
+ */
+QTextStream& operator <<(QTextStream& io, const SAServeSharedBuffer& mem)
+{
+    io	<< "SAServeSharedBuffer->"
+        << "\n shared memory key:" << mem.d_ptr->m_sharemem.key()
+        << "\n is attached:" << mem.isAttach()
+        << "\n size:" << mem.d_ptr->m_sharemem.size()
+        << "\n error:" << (int)mem.d_ptr->m_sharemem.error() << " ,error string:" << mem.d_ptr->m_sharemem.errorString()
+        << "\n slot count:" << mem.slotCount()
+        << "\n slot size:" << mem.slotSize()
+    ;
+    return (io);
+}
@@ -0,0 +1,137 @@
+#ifndef SASERVESHAREDBUFFER_H
+#define SASERVESHAREDBUFFER_H
+#include "SAServeGlobal.h"
+#include <QTextStream>
+#include <QMetaType>
+
+///
+/// \def 共享数据区的默认槽数量
+///
+#ifndef SA_SERVE_SHARED_BUFFER_SLOT_COUNT
+#define SA_SERVE_SHARED_BUFFER_SLOT_COUNT    16
+#endif
+
+///
+/// \def 共享数据区每个槽的默认尺寸(byte)
+///
+#ifndef SA_SERVE_SHARED_BUFFER_SLOT_SIZE
+#define SA_SERVE_SHARED_BUFFER_SLOT_SIZE    (16*1024*1024)
+#endif
+
+///
+/// \def 超过此尺寸(byte)的数据才通过共享数据区传递，小数据走tcp更划算
+///
+#ifndef SA_SERVE_SHARED_BUFFER_THRESHOLD
+#define SA_SERVE_SHARED_BUFFER_THRESHOLD    (256*1024)
+#endif
+
+/**
+ * @brief 共享数据区的句柄
+ *
+ * 句柄只描述数据的位置，tcp协议里只传递句柄，数据本身留在共享内存中
+ *
+ * generation用于判断句柄是否过期，槽每被申请一次generation就会加1，
+ * 因此持有旧句柄的一方无法访问已经被重新分配的槽
+ *
+ * segment不为0时数据位于按请求尺寸单独创建的共享内存段，此时slotID无意义，
+ * segment由槽序列的头统一分配，不会重复
+ */
+struct SASERVE_EXPORT SAServeSharedBufferHandle
+{
+    /**
+     * @brief 数据类型
+     */
+    enum DataType {
+        TypeUnknow	= 0     ///< 未知类型
+        , TypeDouble	= 1     ///< double数组
+        , TypePointF	= 2     ///< QPointF数组（x,y双double）
+    };
+    SAServeSharedBufferHandle();
+    int slotID;             ///< 起始槽号，-1代表无效
+    uint32_t generation;    ///< 申请时的代号
+    uint32_t segment;       ///< 单独的共享内存段编号，0代表位于槽序列
+    uint64_t offset;        ///< 数据相对起始槽的偏移
+    uint64_t length;        ///< 数据长度(byte)
+    int dtype;              ///< 数据类型 \sa DataType
+    bool isValid() const;
+
+    //按数据类型计算元素个数
+    qint64 elementCount() const;
+};
+Q_DECLARE_METATYPE(SAServeSharedBufferHandle)
+
+class SAServeSharedBufferPrivate;
+
+/**
+ * @brief signA和signADataProc之间传递大数据的共享内存区
+ *
+ * 共享内存被划分为一个环形的槽序列，每个槽有引用计数和代号，
+ * 大数据写入一段连续的空闲槽后，只需要把@ref SAServeSharedBufferHandle 通过tcp发送给对方，
+ * 对方直接在映射的内存上进行计算，避免数据的拷贝和序列化
+ *
+ * 槽序列放不下（超过槽序列的总尺寸或没有足够的连续空闲槽）的数据，按请求的尺寸单独创建一个共享内存段，
+ * 段的开头记录跨进程的引用计数，每个进程attach后持有映射，最后一个进程detach时由系统回收，
+ * 单个段的尺寸受QSharedMemory限制，最大为@ref capacity
+ *
+ * 和@ref SAServeShareMemory 一样，第一个构造的进程负责创建共享内存，其余的进程attach
+ *
+ * 典型的使用流程：
+ * @code
+ * //发送方
+ * SAServeSharedBufferHandle h = buffer.acquire(size,SAServeSharedBufferHandle::TypePointF);
+ * memcpy(buffer.data(h),src,size);
+ * ...发送h...
+ * //接收方
+ * if(buffer.retain(h)){
+ *     const QPointF* p = (const QPointF*)buffer.data(h);
+ *     ...
+ *     buffer.release(h);
+ * }
+ * //发送方收到回复后
+ * buffer.release(h);
+ * @endcode
+ */
+class SASERVE_EXPORT SAServeSharedBuffer
+{
+    SA_IMPL(SAServeSharedBuffer)
+public:
+    SAServeSharedBuffer(int slotCount = SA_SERVE_SHARED_BUFFER_SLOT_COUNT
+        , uint32_t slotSize = SA_SERVE_SHARED_BUFFER_SLOT_SIZE
+        , const QString& key = QStringLiteral("signaDataProc.Buffer"));
+    ~SAServeSharedBuffer();
+    //是否连接内存
+    bool isAttach() const;
+
+    //槽的数量
+    int slotCount() const;
+
+    //每个槽的尺寸
+    uint32_t slotSize() const;
+
+    //槽序列的总尺寸，不超过此尺寸的数据优先放在槽序列
+    uint64_t slotCapacity() const;
+
+    //能申请的最大尺寸
+    uint64_t capacity() const;
+
+    //申请一段空间，引用计数为1，失败返回无效句柄
+    SAServeSharedBufferHandle acquire(uint64_t size, int dtype);
+
+    //增加引用计数，句柄过期返回false
+    bool retain(const SAServeSharedBufferHandle& h);
+
+    //减少引用计数，计数为0时槽被回收
+    bool release(const SAServeSharedBufferHandle& h);
+
+    //获取句柄对应的内存地址，句柄过期返回nullptr
+    void *data(const SAServeSharedBufferHandle& h);
+    const void *constData(const SAServeSharedBufferHandle& h) const;
+
+    //返回描述
+    QString describe() const;
+
+    //序列化字符串的友元函数
+    SASERVE_EXPORT friend QTextStream& operator <<(QTextStream& io, const SAServeSharedBuffer& mem);
+};
+
+#endif // SASERVESHAREDBUFFER_H
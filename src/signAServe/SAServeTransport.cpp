@@ -0,0 +1,154 @@
+#include "SAServeTransport.h"
+
+SAServeTransport::SAServeTransport(QObject *par) : QObject(par)
+{
+}
+
+
+SAServeTransport::~SAServeTransport()
+{
+}
+
+
+SAServeTcpTransport::SAServeTcpTransport(QAbstractSocket *socket, QObject *par) : SAServeTransport(par)
+    , m_socket(socket)
+{
+    connect(socket, &QAbstractSocket::connected, this, &SAServeTransport::connected);
+    connect(socket, &QAbstractSocket::disconnected, this, &SAServeTransport::disconnected);
+    connect(socket, &QIODevice::readyRead, this, &SAServeTransport::readyRead);
+    connect(socket, static_cast<void (QAbstractSocket::*)(QAbstractSocket::SocketError)>(&QAbstractSocket::error)
+        , this, &SAServeTransport::transportError);
+}
+
+
+SAServeTransport::TransportType SAServeTcpTransport::type() const
+{
+    return (TransportTcp);
+}
+
+
+QIODevice *SAServeTcpTransport::device() const
+{
+    return (m_socket);
+}
+
+
+bool SAServeTcpTransport::isConnected() const
+{
+    return (m_socket->state() == QAbstractSocket::ConnectedState);
+}
+
+
+bool SAServeTcpTransport::flush()
+{
+    return (m_socket->flush());
+}
+
+
+void SAServeTcpTransport::disconnectFromPeer()
+{
+    m_socket->disconnectFromHost();
+}
+
+
+bool SAServeTcpTransport::waitForDisconnected(int msecs)
+{
+    return ((m_socket->state() == QAbstractSocket::UnconnectedState) || m_socket->waitForDisconnected(msecs));
+}
+
+
+void SAServeTcpTransport::abort()
+{
+    m_socket->abort();
+}
+
+
+/**
+ * @brief 构造
+ * @param socket 已经连接的本地socket，所有权转移给此对象，为nullptr时创建一个未连接的QLocalSocket
+ * @param par
+ */
+SAServeLocalTransport::SAServeLocalTransport(QLocalSocket *socket, QObject *par) : SAServeTransport(par)
+    , m_socket(socket)
+{
+    if (nullptr == m_socket) {
+        m_socket = new QLocalSocket();
+    }
+    m_socket->setParent(this);
+    connect(m_socket, &QLocalSocket::connected, this, &SAServeTransport::connected);
+    connect(m_socket, &QLocalSocket::disconnected, this, &SAServeTransport::disconnected);
+    connect(m_socket, &QIODevice::readyRead, this, &SAServeTransport::readyRead);
+    connect(m_socket, static_cast<void (QLocalSocket::*)(QLocalSocket::LocalSocketError)>(&QLocalSocket::error)
+        , this, &SAServeLocalTransport::onLocalSocketError);
+}
+
+
+/**
+ * @brief 连接本地服务
+ * @param name 本地服务名
+ * @param timeout 超时时间ms
+ * @return
+ */
+bool SAServeLocalTransport::connectToServer(const QString& name, int timeout)
+{
+    m_socket->connectToServer(name);
+    return (m_socket->waitForConnected(timeout));
+}
+
+
+QLocalSocket *SAServeLocalTransport::localSocket() const
+{
+    return (m_socket);
+}
+
+
+SAServeTransport::TransportType SAServeLocalTransport::type() const
+{
+    return (TransportLocal);
+}
+
+
+QIODevice *SAServeLocalTransport::device() const
+{
+    return (m_socket);
+}
+
+
+bool SAServeLocalTransport::isConnected() const
+{
+    return (m_socket->state() == QLocalSocket::ConnectedState);
+}
+
+
+bool SAServeLocalTransport::flush()
+{
+    return (m_socket->flush());
+}
+
+
+void SAServeLocalTransport::disconnectFromPeer()
+{
+    m_socket->disconnectFromServer();
+}
+
+
+bool SAServeLocalTransport::waitForDisconnected(int msecs)
+{
+    return ((m_socket->state() == QLocalSocket::UnconnectedState) || m_socket->waitForDisconnected(msecs));
+}
+
+
+void SAServeLocalTransport::abort()
+{
+    m_socket->abort();
+}
+
+
+/**
+ * @brief QLocalSocket::LocalSocketError的取值和QAbstractSocket::SocketError对应，直接转换
+ * @param err
+ */
+void SAServeLocalTransport::onLocalSocketError(QLocalSocket::LocalSocketError err)
+{
+    emit transportError(static_cast<QAbstractSocket::SocketError>(err));
+}
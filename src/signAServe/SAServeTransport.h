@@ -0,0 +1,126 @@
+#ifndef SASERVETRANSPORT_H
+#define SASERVETRANSPORT_H
+#include <QObject>
+#include <QAbstractSocket>
+#include <QLocalSocket>
+#include "SAServeGlobal.h"
+class QIODevice;
+
+/**
+ * @brief 协议帧之下的传输层接口
+ *
+ * 协议层只通过@ref device 读写数据，连接状态的变化和错误统一通过此接口的信号通知，
+ * 因此帧的收发和具体的传输方式无关，新的传输方式只需要实现此接口
+ *
+ * 错误码统一使用QAbstractSocket::SocketError，QLocalSocket::LocalSocketError的取值和它是对应的
+ */
+class SASERVE_EXPORT SAServeTransport : public QObject
+{
+    Q_OBJECT
+public:
+
+    /**
+     * @brief 传输层类型
+     */
+    enum TransportType {
+        TransportTcp	= 0,    ///< tcp
+        TransportLocal	= 1     ///< 本地socket（windows下为命名管道，unix下为unix domain socket）
+    };
+    SAServeTransport(QObject *par = nullptr);
+    virtual ~SAServeTransport();
+
+    //传输层类型
+    virtual TransportType type() const = 0;
+
+    //读写数据的设备
+    virtual QIODevice *device() const = 0;
+
+    //是否处于连接状态
+    virtual bool isConnected() const = 0;
+
+    //把缓冲的数据写出
+    virtual bool flush() = 0;
+
+    //断开连接
+    virtual void disconnectFromPeer() = 0;
+
+    //等待断开，已经断开或在超时前断开返回true
+    virtual bool waitForDisconnected(int msecs = 30000) = 0;
+
+    //立即断开，丢弃缓冲的数据
+    virtual void abort() = 0;
+
+signals:
+
+    /**
+     * @brief 连接成功
+     */
+    void connected();
+
+    /**
+     * @brief 连接断开
+     */
+    void disconnected();
+
+    /**
+     * @brief 有数据可读
+     */
+    void readyRead();
+
+    /**
+     * @brief 发生错误
+     * @param err 错误码
+     */
+    void transportError(QAbstractSocket::SocketError err);
+};
+
+/**
+ * @brief tcp传输层，不持有socket
+ */
+class SASERVE_EXPORT SAServeTcpTransport : public SAServeTransport
+{
+    Q_OBJECT
+public:
+    SAServeTcpTransport(QAbstractSocket *socket, QObject *par = nullptr);
+    virtual TransportType type() const override;
+    virtual QIODevice *device() const override;
+    virtual bool isConnected() const override;
+    virtual bool flush() override;
+    virtual void disconnectFromPeer() override;
+    virtual bool waitForDisconnected(int msecs = 30000) override;
+    virtual void abort() override;
+
+private:
+    QAbstractSocket *m_socket;
+};
+
+/**
+ * @brief 本地socket传输层，QLocalSocket作为此对象的子对象
+ */
+class SASERVE_EXPORT SAServeLocalTransport : public SAServeTransport
+{
+    Q_OBJECT
+public:
+    //socket为nullptr时创建一个未连接的QLocalSocket
+    SAServeLocalTransport(QLocalSocket *socket = nullptr, QObject *par = nullptr);
+
+    //连接本地服务
+    bool connectToServer(const QString& name, int timeout = 5000);
+    QLocalSocket *localSocket() const;
+
+    virtual TransportType type() const override;
+    virtual QIODevice *device() const override;
+    virtual bool isConnected() const override;
+    virtual bool flush() override;
+    virtual void disconnectFromPeer() override;
+    virtual bool waitForDisconnected(int msecs = 30000) override;
+    virtual void abort() override;
+
+private slots:
+    void onLocalSocketError(QLocalSocket::LocalSocketError err);
+
+private:
+    QLocalSocket *m_socket;
+};
+
+#endif // SASERVETRANSPORT_H
@@ -19,6 +19,21 @@
 #define SA_SERVER_VALUE_GROUP_SA_DEFAULT    "@sa-default"
 #endif
 
+///
+/// \def 本地socket服务名，客户端和服务端在同一台机器时优先使用本地socket
+///
+#ifndef SA_SERVE_LOCAL_SERVER_NAME
+#define SA_SERVE_LOCAL_SERVER_NAME    "signADataProc.Local"
+#endif
+
+///
+/// \def 单帧数据区的最大尺寸(byte)，协议头声明的尺寸超过此值时认为对方异常，直接断开，
+/// 大数据应通过共享数据区传递
+///
+#ifndef SA_SERVE_MAX_FRAME_SIZE
+#define SA_SERVE_MAX_FRAME_SIZE    (128*1024*1024)
+#endif
+
 namespace SA {
 /**
  * @brief 协议类型
@@ -42,6 +57,8 @@ enum ServeProtocolFunctionType {
 
     , ProtocolFunReq2DPointsDescribe        ///< 6 请求2维点序列的描述
     , ProtocolFunReply2DPointsDescribe      ///< 7 回复2维点序列的描述
+    , ProtocolFunReq2DPointsDescribeShm     ///< 8 请求2维点序列的描述，点序列位于共享数据区，回复为ProtocolFunReply2DPointsDescribe
+    , ProtocolFunReqCancel                  ///< 9 取消请求，协议头的sequenceID为需要取消的请求，被取消的请求会回复ProtocolErrorCanceled
 };
 
 /**
@@ -51,6 +68,11 @@ enum ServeProtocolErrorCode {
     ProtocolErrorUnknow = 0         ///< 位置错误
     , ProtocolErrorUnknowFun        ///< 位置功能id
     , ProtocolErrorContent          ///< 协议内容错误
+    , ProtocolErrorSharedBuffer     ///< 共享数据区的句柄无效或已过期
+    , ProtocolErrorBusy             ///< 此连接上正在处理的请求已达上限
+    , ProtocolErrorCanceled         ///< 请求已被取消
+    , ProtocolErrorDecode           ///< 数据区无法按协议头的编码解码
+    , ProtocolErrorCrc              ///< 数据区的crc32和协议头不一致
 };
 }
 
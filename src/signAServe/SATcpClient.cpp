@@ -159,6 +159,13 @@ void SATcpClient::connectToServe(int timeout)
         destroySocket();
     }
     createSocket();
+    //服务开启了本地socket优先使用本地socket，失败再走tcp
+    if (ssm.isLocalServeEnabled()) {
+        if (d_ptr->m_socket->connectToLocalServe(SA_SERVE_LOCAL_SERVER_NAME, timeout)) {
+            qDebug() << tr("success connect to local serve:") << SA_SERVE_LOCAL_SERVER_NAME;
+            return;
+        }
+    }
     d_ptr->m_socket->connectToHost(QHostAddress::LocalHost, port);
     if (d_ptr->m_socket->waitForConnected(timeout)) {
         qDebug() << tr("success connect to LocalHost:") << port;
@@ -174,7 +181,7 @@ void SATcpClient::disconnectFromServe()
     if (nullptr == getSocket()) {
         return;
     }
-    getSocket()->disconnectFromHost();
+    getSocket()->transport()->disconnectFromPeer();
 }
 
 
@@ -235,9 +242,8 @@ void SATcpClient::onSocketConnected()
 void SATcpClient::close()
 {
     if (d_ptr->m_socket) {
-        d_ptr->m_socket->disconnectFromHost();
-        if ((d_ptr->m_socket->state() == QAbstractSocket::UnconnectedState) ||
-            d_ptr->m_socket->waitForDisconnected(5000)) {
+        d_ptr->m_socket->transport()->disconnectFromPeer();
+        if (d_ptr->m_socket->transport()->waitForDisconnected(5000)) {
             d_ptr->m_socket.reset(nullptr);
         }
     }
@@ -284,10 +290,9 @@ void SATcpClient::destroySocket()
 
 void SATcpClient::connectSocket()
 {
-    connect(d_ptr->m_socket.get(), &QAbstractSocket::connected, this, &SATcpClient::onSocketConnected);
-    connect(d_ptr->m_socket.get(), &QAbstractSocket::disconnected, this, &SATcpClient::disconnectedServe);
-    connect(d_ptr->m_socket.get(), static_cast<void (QAbstractSocket::*)(QAbstractSocket::SocketError)>(&QAbstractSocket::error)
-        , this, &SATcpClient::socketError);
+    connect(d_ptr->m_socket.get(), &SATcpSocket::transportConnected, this, &SATcpClient::onSocketConnected);
+    connect(d_ptr->m_socket.get(), &SATcpSocket::transportDisconnected, this, &SATcpClient::disconnectedServe);
+    connect(d_ptr->m_socket.get(), &SATcpSocket::transportError, this, &SATcpClient::socketError);
     connect(d_ptr->m_socket.get(), &QIODevice::aboutToClose, this, &SATcpClient::aboutToClose);
     connect(d_ptr->m_socket.get(), &SATcpSocket::receivedHeartbreat, this, &SATcpClient::onReceivedHeartbreat);
     connect(d_ptr->m_socket.get(), &SATcpSocket::receiveToken, this, &SATcpClient::receiveToken);
@@ -296,10 +301,9 @@ void SATcpClient::connectSocket()
 
 void SATcpClient::disconnectSocket()
 {
-    disconnect(d_ptr->m_socket.get(), &QAbstractSocket::connected, this, &SATcpClient::onSocketConnected);
-    disconnect(d_ptr->m_socket.get(), &QAbstractSocket::disconnected, this, &SATcpClient::disconnectedServe);
-    disconnect(d_ptr->m_socket.get(), static_cast<void (QAbstractSocket::*)(QAbstractSocket::SocketError)>(&QAbstractSocket::error)
-        , this, &SATcpClient::socketError);
+    disconnect(d_ptr->m_socket.get(), &SATcpSocket::transportConnected, this, &SATcpClient::onSocketConnected);
+    disconnect(d_ptr->m_socket.get(), &SATcpSocket::transportDisconnected, this, &SATcpClient::disconnectedServe);
+    disconnect(d_ptr->m_socket.get(), &SATcpSocket::transportError, this, &SATcpClient::socketError);
     disconnect(d_ptr->m_socket.get(), &QIODevice::aboutToClose, this, &SATcpClient::aboutToClose);
     disconnect(d_ptr->m_socket.get(), &SATcpSocket::receivedHeartbreat, this, &SATcpClient::onReceivedHeartbreat);
     disconnect(d_ptr->m_socket.get(), &SATcpSocket::receiveToken, this, &SATcpClient::receiveToken);
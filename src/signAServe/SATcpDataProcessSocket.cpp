@@ -2,12 +2,20 @@
 #include "SAServeHandleFun.h"
 #include "SAServerDefine.h"
 #include "SAXMLProtocol.h"
+#include "SAServeSharedBuffer.h"
+#include <QMultiHash>
+#include <memory>
 
 class SATcpDataProcessSocketPrivate
 {
     SA_IMPL_PUBLIC(SATcpDataProcessSocket)
 public:
     SATcpDataProcessSocketPrivate(SATcpDataProcessSocket *p);
+    //获取共享数据区，第一次调用时才attach
+    SAServeSharedBuffer *sharedBuffer();
+
+    std::unique_ptr<SAServeSharedBuffer> m_sharedBuffer;
+    QMultiHash<int, SAServeSharedBufferHandle> m_pendingHandles;    ///< 等待回复的请求所占用的共享数据区
 };
 
 SATcpDataProcessSocketPrivate::SATcpDataProcessSocketPrivate(SATcpDataProcessSocket *p) : q_ptr(p)
@@ -15,7 +23,17 @@ SATcpDataProcessSocketPrivate::SATcpDataProcessSocketPrivate(SATcpDataProcessSoc
 }
 
 
+SAServeSharedBuffer *SATcpDataProcessSocketPrivate::sharedBuffer()
+{
+    if (nullptr == m_sharedBuffer) {
+        m_sharedBuffer.reset(new SAServeSharedBuffer());
+    }
+    return (m_sharedBuffer->isAttach() ? m_sharedBuffer.get() : nullptr);
+}
+
+
 SATcpDataProcessSocket::SATcpDataProcessSocket(QObject *par) : SATcpSocket(par)
+    , d_ptr(new SATcpDataProcessSocketPrivate(this))
 {
     qRegisterMetaType<QVector<QPointF> >();
     qRegisterMetaType<SAPropertiesGroup >();
@@ -24,6 +42,13 @@ SATcpDataProcessSocket::SATcpDataProcessSocket(QObject *par) : SATcpSocket(par)
 
 SATcpDataProcessSocket::~SATcpDataProcessSocket()
 {
+    //未收到回复的请求也要释放占用的共享数据区
+    if (d_ptr->m_sharedBuffer) {
+        for (const SAServeSharedBufferHandle& h : d_ptr->m_pendingHandles)
+        {
+            d_ptr->m_sharedBuffer->release(h);
+        }
+    }
 }
 
 
@@ -35,6 +60,10 @@ SATcpDataProcessSocket::~SATcpDataProcessSocket()
  */
 bool SATcpDataProcessSocket::dealXmlProtocol(const SAProtocolHeader& header, const SAXMLProtocol& xml)
 {
+    if (SA::ProtocolFunErrorOcc == header.protocolFunID) {
+        //请求出错也不会再有回复，共享数据区需要释放
+        releaseSharedBuffer(header.sequenceID);
+    }
     if (SATcpSocket::dealXmlProtocol(header, xml)) {
         return (true);
     }
@@ -61,19 +90,61 @@ bool SATcpDataProcessSocket::dealXmlProtocol(const SAProtocolHeader& header, con
 bool SATcpDataProcessSocket::dealReply2DPointsDescribe(const SAProtocolHeader& header,
     const SAXMLProtocol& xml)
 {
-    qDebug() <<"rec 2DPointsDescribe Reply";
+    releaseSharedBuffer(header.sequenceID);
     emit receive2DPointsDescribe(xml.toPropGroup(),header.sequenceID,header.extendValue);
     return (true);
 }
 
 
+/**
+ * @brief 释放请求时占用的共享数据区
+ * @param sequenceID 请求的流水号
+ */
+void SATcpDataProcessSocket::releaseSharedBuffer(int sequenceID)
+{
+    if ((nullptr == d_ptr->m_sharedBuffer) || !d_ptr->m_pendingHandles.contains(sequenceID)) {
+        return;
+    }
+    //同一个流水号多次请求时按先进先出释放
+    QList<SAServeSharedBufferHandle> hs = d_ptr->m_pendingHandles.values(sequenceID);
+    SAServeSharedBufferHandle h = hs.last();
+
+    d_ptr->m_pendingHandles.remove(sequenceID, h);
+    d_ptr->m_sharedBuffer->release(h);
+}
+
+
 /**
  * @brief 请求2维数据的统计描述
+ *
+ * 点序列超过SA_SERVE_SHARED_BUFFER_THRESHOLD时会写入共享数据区，协议只携带句柄，
+ * 槽序列放不下的点序列会按尺寸单独创建共享内存段；
+ * 共享数据区不可用时退回到xml传输，超过@ref SAServeSharedBuffer::capacity 时返回false
  * @param arrs 待计算的点序列
  * @param key 标致，返回的reply中会带着此key，用于区别请求的回复
  * @param sortcount 返回排序的前后n个值
  */
 bool SATcpDataProcessSocket::request2DPointsDescribe(const QVector<QPointF>& arrs, int sequenceID, int sortcount)
 {
+    const uint64_t bytes = uint64_t(arrs.size()) * sizeof(QPointF);
+
+    if (bytes >= SA_SERVE_SHARED_BUFFER_THRESHOLD) {
+        SAServeSharedBuffer *buffer = d_ptr->sharedBuffer();
+        if (buffer) {
+            if (bytes > buffer->capacity()) {
+                return (false);
+            }
+            SAServeSharedBufferHandle h = buffer->acquire(bytes, SAServeSharedBufferHandle::TypePointF);
+            void *p = buffer->data(h);
+            if (p) {
+                memcpy(p, arrs.constData(), bytes);
+                if (SA::request_2d_points_describe_shm_xml(this, h, sequenceID, sortcount)) {
+                    d_ptr->m_pendingHandles.insert(sequenceID, h);
+                    return (true);
+                }
+                buffer->release(h);
+            }
+        }
+    }
     return (SA::request_2d_points_describe_xml(this, arrs, sequenceID, sortcount));
 }
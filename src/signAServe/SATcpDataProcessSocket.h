@@ -25,6 +25,9 @@ protected:
 private:
     bool dealReply2DPointsDescribe(const SAProtocolHeader& header, const SAXMLProtocol& xml);
 
+    //释放请求时占用的共享数据区
+    void releaseSharedBuffer(int sequenceID);
+
 public slots:
     //请求2维数据的统计描述
     bool request2DPointsDescribe(const QVector<QPointF>& arrs, int sequenceID, int sortcount = 20);
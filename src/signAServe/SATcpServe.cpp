@@ -5,6 +5,8 @@
 #include <QThread>
 #include <QDateTime>
 #include <QHostAddress>
+#include <QLocalServer>
+#include <QLocalSocket>
 #include "SAThreadPool.h"
 
 SATcpSocket *create_default_ser_socket();
@@ -55,10 +57,12 @@ public:
     SATcpServePrivate(SATcpServe *p);
     SATcpServe::FunPtrSocketFactory fpSocketFactory;
     QHash<SATcpSocket *, _client_info> socketToInfo;
+    std::unique_ptr<QLocalServer> localServer;
 };
 
 SATcpServePrivate::SATcpServePrivate(SATcpServe *p) : q_ptr(p)
     , fpSocketFactory(nullptr)
+    , localServer(nullptr)
 {
     fpSocketFactory = create_default_ser_socket;
 }
@@ -101,11 +105,10 @@ QList<SATcpSocket *> SATcpServe::getSockets() const
 void SATcpServe::closeSocket(SATcpSocket *s)
 {
     //先断开之前的信号槽连接，避免重复析构
-    disconnect(s, &SATcpSocket::disconnected, this, &SATcpServe::onSocketDisconnected);
+    disconnect(s, &SATcpSocket::transportDisconnected, this, &SATcpServe::onSocketDisconnected);
     //主动断开连接
-    s->disconnectFromHost();
-    if ((s->state() == QAbstractSocket::UnconnectedState) ||
-        s->waitForDisconnected(5000)) {
+    s->transport()->disconnectFromPeer();
+    if (s->transport()->waitForDisconnected(5000)) {
         s->deleteLater();
     }else {
         //断开异常，强制delete
@@ -125,6 +128,44 @@ void SATcpServe::registSocketFactory(SATcpServe::FunPtrSocketFactory fp)
 }
 
 
+/**
+ * @brief 监听本地socket
+ *
+ * 本地socket在windows下为命名管道，在unix下为unix domain socket，同机通讯省去了tcp协议栈的开销，
+ * 可以和tcp同时监听
+ * @param name 本地服务名
+ * @return 成功返回true
+ */
+bool SATcpServe::listenLocal(const QString& name)
+{
+    if (nullptr == d_ptr->localServer) {
+        d_ptr->localServer.reset(new QLocalServer());
+        connect(d_ptr->localServer.get(), &QLocalServer::newConnection, this, &SATcpServe::onLocalNewConnection);
+    }
+    d_ptr->localServer->close();
+    //上次进程异常退出可能残留socket文件，先移除
+    QLocalServer::removeServer(name);
+    if (!d_ptr->localServer->listen(name)) {
+        qDebug() << "listen local serve " << name << " failed:" << d_ptr->localServer->errorString();
+        return (false);
+    }
+    return (true);
+}
+
+
+/**
+ * @brief 本地socket服务名
+ * @return 没有监听返回空字符串
+ */
+QString SATcpServe::localServerName() const
+{
+    if (d_ptr->localServer && d_ptr->localServer->isListening()) {
+        return (d_ptr->localServer->serverName());
+    }
+    return (QString());
+}
+
+
 void SATcpServe::incomingConnection(qintptr socketDescriptor)
 {
     FUNCTION_RUN_PRINT();
@@ -141,16 +182,7 @@ void SATcpServe::incomingConnection(qintptr socketDescriptor)
 #endif
         return;
     }
-    _client_info clinfo;
-    QThread *thread = SAThreadPool::getThread();
-    while (thread == QThread::currentThread())
-    {
-        //找到一个和当前线程不一致的线程作为socket的线程
-        thread = SAThreadPool::getThread();
-    }
-
     FunPtrSocketFactory fp = d_ptr->fpSocketFactory;
-    clinfo.socketDescriptor = socketDescriptor;
     std::unique_ptr<SATcpSocket> socket(fp());
     if (!(socket->setSocketDescriptor(socketDescriptor))) {
 #ifdef SA_SERVE_DEBUG_PRINT
@@ -160,14 +192,35 @@ void SATcpServe::incomingConnection(qintptr socketDescriptor)
     }
     QString ip = socket->peerAddress().toString();
     qint16 port = socket->peerPort();
+
+    acceptSocket(socket.release(), socketDescriptor, ip, port);
+}
+
+
+/**
+ * @brief 记录socket并把socket移动到工作线程
+ * @param socket
+ * @param socketDescriptor
+ * @param ip
+ * @param port
+ */
+void SATcpServe::acceptSocket(SATcpSocket *socket, qintptr socketDescriptor, const QString& ip, qint16 port)
+{
+    QThread *thread = SAThreadPool::getThread();
+
+    while (thread == QThread::currentThread())
+    {
+        //找到一个和当前线程不一致的线程作为socket的线程
+        thread = SAThreadPool::getThread();
+    }
     //对socket断开的处理
-    connect(socket.get(), &SATcpSocket::disconnected, this, &SATcpServe::onSocketDisconnected);
+    connect(socket, &SATcpSocket::transportDisconnected, this, &SATcpServe::onSocketDisconnected);
     //把socket移动到线程中，不和此线程同一个
     socket->moveToThread(thread);
     //记录信息
     _client_info info;
     info.socketDescriptor = socketDescriptor;
-    info.socket = socket.release(); // 此时智能指针释放控制权，注意这里一定要release，否则指针会被智能指针删除了
+    info.socket = socket;
     info.thread = thread;
     info.ip = ip;
     info.port = port;
@@ -200,3 +253,34 @@ void SATcpServe::onSocketDisconnected()
     //
     socket->deleteLater();
 }
+
+
+/**
+ * @brief 本地socket连接
+ *
+ * 本地socket不是通过描述符交接的，因此先在此线程取出QLocalSocket，交给socket工厂创建的SATcpSocket作为传输层，
+ * 再和tcp连接一样移动到工作线程
+ */
+void SATcpServe::onLocalNewConnection()
+{
+    while (d_ptr->localServer && d_ptr->localServer->hasPendingConnections())
+    {
+        QLocalSocket *local = d_ptr->localServer->nextPendingConnection();
+        if (nullptr == local) {
+            break;
+        }
+        if (d_ptr->socketToInfo.size() >= maxPendingConnections()) {
+            //连接过多自动断开
+            local->disconnectFromServer();
+            local->deleteLater();
+#ifdef SA_SERVE_DEBUG_PRINT
+            qDebug() << "too much connections:"<<maxPendingConnections()<<" ,disconnect";
+#endif
+            continue;
+        }
+        FunPtrSocketFactory fp = d_ptr->fpSocketFactory;
+        SATcpSocket *socket = fp();
+        socket->setLocalSocket(local);
+        acceptSocket(socket, local->socketDescriptor(), d_ptr->localServer->serverName(), 0);
+    }
+}
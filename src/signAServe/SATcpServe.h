@@ -10,6 +10,9 @@ class SASocketHandle;
 /**
  * @brief QTcpServer的多线程支持
  * SATCPServe 以长链接为基础，每个socket都应该是长链接，由于每个socket都在一个线程中，短连接的效率会比较低
+ *
+ * 除了tcp，还可以通过@ref listenLocal 同时监听本地socket，本地连接同样通过socket工厂创建@ref SATcpSocket ，
+ * 只是传输层替换为@ref SAServeLocalTransport ，协议层的处理完全一致
  */
 class SASERVE_EXPORT SATcpServe : public QTcpServer
 {
@@ -29,6 +32,12 @@ public:
     //注册socket工厂
     void registSocketFactory(FunPtrSocketFactory fp);
 
+    //监听本地socket
+    bool listenLocal(const QString& name);
+
+    //本地socket服务名，没有监听返回空字符串
+    QString localServerName() const;
+
 protected:
     void incomingConnection(qintptr socketDescriptor) override;
 
@@ -37,6 +46,13 @@ protected:
 
 private slots:
     void onSocketDisconnected();
+
+    //本地socket连接
+    void onLocalNewConnection();
+
+private:
+    //记录socket并移动到工作线程
+    void acceptSocket(SATcpSocket *socket, qintptr socketDescriptor, const QString& ip, qint16 port);
 };
 
 #endif // SATCPSERVE_H
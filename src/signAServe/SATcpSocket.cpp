@@ -4,6 +4,7 @@
 #include "SAServeHandleFun.h"
 #include "SAServerDefine.h"
 #include "SACRC.h"
+#include "SAServeBufferPool.h"
 
 #define SA_SERVE_DEBUG_PRINT_Socket    0
 
@@ -12,6 +13,7 @@ class SATcpSocketPrivate
     SA_IMPL_PUBLIC(SATcpSocket)
 public:
     SATcpSocketPrivate(SATcpSocket *p);
+    ~SATcpSocketPrivate();
     void resetBuffer();
     void mallocBuffer(size_t size);
 
@@ -21,6 +23,9 @@ public:
     uint m_index;
     QByteArray m_buffer;
     SAAbstractSocketHandle *m_handle;
+    int m_payloadCodec;     ///< 发送时使用的编码
+    SAServeTcpTransport *m_tcp;     ///< 此socket本身的tcp传输层
+    SAServeTransport *m_transport;  ///< 当前使用的传输层
 };
 
 SATcpSocketPrivate::SATcpSocketPrivate(SATcpSocket *p) : q_ptr(p)
@@ -28,21 +33,38 @@ SATcpSocketPrivate::SATcpSocketPrivate(SATcpSocket *p) : q_ptr(p)
     , m_dataSize(0)
     , m_index(0)
     , m_handle(nullptr)
+    , m_payloadCodec(SAProtocolHeader::CodecNone)
+    , m_tcp(nullptr)
+    , m_transport(nullptr)
 {
 }
 
 
+SATcpSocketPrivate::~SATcpSocketPrivate()
+{
+    SAServeBufferPool::getInstance().release(m_buffer);
+}
+
+
+/**
+ * @brief 一帧处理完，缓冲归还到池中
+ */
 void SATcpSocketPrivate::resetBuffer()
 {
     m_isReadedMainHeader = false;
     m_dataSize = 0;
     m_index = 0;
+    SAServeBufferPool::getInstance().release(m_buffer);
 }
 
 
+/**
+ * @brief 从池中申请一帧的缓冲，数据会直接从socket读入此缓冲
+ * @param size 调用前已经检查不超过SA_SERVE_MAX_FRAME_SIZE
+ */
 void SATcpSocketPrivate::mallocBuffer(size_t size)
 {
-    m_buffer.resize(size);
+    m_buffer = SAServeBufferPool::getInstance().acquire(int(size));
     m_index = 0;
     m_dataSize = size;
 }
@@ -51,7 +73,8 @@ void SATcpSocketPrivate::mallocBuffer(size_t size)
 SATcpSocket::SATcpSocket(QObject *par) : QTcpSocket(par)
     , d_ptr(new SATcpSocketPrivate(this))
 {
-    connect(this, &QIODevice::readyRead, this, &SATcpSocket::onReadyRead);
+    d_ptr->m_tcp = new SAServeTcpTransport(this, this);
+    setTransport(nullptr);
 }
 
 
@@ -60,6 +83,86 @@ SATcpSocket::~SATcpSocket()
 }
 
 
+/**
+ * @brief 传输层
+ * @return 不会为nullptr
+ */
+SAServeTransport *SATcpSocket::transport() const
+{
+    return (d_ptr->m_transport);
+}
+
+
+/**
+ * @brief 替换传输层
+ *
+ * 传输层会作为此对象的子对象，随此对象一起moveToThread和析构，
+ * 传输层的连接、断开和错误通过@ref transportConnected @ref transportDisconnected @ref transportError 转发
+ * @param t 传输层，为nullptr时恢复为tcp
+ */
+void SATcpSocket::setTransport(SAServeTransport *t)
+{
+    if (nullptr == t) {
+        t = d_ptr->m_tcp;
+    }
+    SAServeTransport *old = d_ptr->m_transport;
+
+    if (old == t) {
+        return;
+    }
+    if (old) {
+        old->disconnect(this);
+        if (old != d_ptr->m_tcp) {
+            old->device()->disconnect(this);
+            old->deleteLater();
+        }
+    }
+    d_ptr->m_transport = t;
+    t->setParent(this);
+    connect(t, &SAServeTransport::readyRead, this, &SATcpSocket::onReadyRead);
+    connect(t, &SAServeTransport::connected, this, &SATcpSocket::transportConnected);
+    connect(t, &SAServeTransport::disconnected, this, &SATcpSocket::transportDisconnected);
+    connect(t, &SAServeTransport::transportError, this, &SATcpSocket::transportError);
+    if (t->device() != this) {
+        connect(t->device(), &QIODevice::aboutToClose, this, &QIODevice::aboutToClose);
+    }
+}
+
+
+/**
+ * @brief 使用已经连接的本地socket作为传输层
+ * @param s
+ */
+void SATcpSocket::setLocalSocket(QLocalSocket *s)
+{
+    setTransport(s ? new SAServeLocalTransport(s) : nullptr);
+}
+
+
+/**
+ * @brief 连接本地服务作为传输层
+ *
+ * 连接成功后才替换传输层，连接过程中的错误不会通过@ref transportError 发出，
+ * 替换后发射@ref transportConnected
+ * @param name 本地服务名
+ * @param timeout 超时时间ms
+ * @return 连接失败时传输层保持不变
+ */
+bool SATcpSocket::connectToLocalServe(const QString& name, int timeout)
+{
+    SAServeLocalTransport *local = new SAServeLocalTransport();
+
+    if (!local->connectToServer(name, timeout)) {
+        qDebug() << "connect to local serve " << name << " failed:" << local->device()->errorString();
+        delete local;
+        return (false);
+    }
+    setTransport(local);
+    emit transportConnected();
+    return (true);
+}
+
+
 /**
  * @brief 从socket中安全的读取文件
  * @param p 指针
@@ -73,7 +176,7 @@ bool SATcpSocket::readFromSocket(void *p, int n)
 
     do
     {
-        readLen = read((char *)p+index, n);
+        readLen = d_ptr->m_transport->device()->read((char *)p+index, n);
         if (readLen <= 0) {
             break;
         }
@@ -87,6 +190,24 @@ bool SATcpSocket::readFromSocket(void *p, int n)
 }
 
 
+/**
+ * @brief 发送数据区使用的编码
+ *
+ * 默认不压缩，在token握手时双方协商，协商成功后超过SA_PROTOCOL_COMPRESS_THRESHOLD的数据区会压缩发送
+ * @return \sa SAProtocolHeader::PayloadCodec
+ */
+int SATcpSocket::getPayloadCodec() const
+{
+    return (d_ptr->m_payloadCodec);
+}
+
+
+void SATcpSocket::setPayloadCodec(int codec)
+{
+    d_ptr->m_payloadCodec = codec;
+}
+
+
 /**
  * @brief 带重试的写socket
  * @param data
@@ -104,7 +225,12 @@ void SATcpSocket::ensureWrite(const QByteArray& data)
  */
 void SATcpSocket::ensureWrite(const SAProtocolHeader& header, const QByteArray& data)
 {
-    SA::write(header, data, this);
+    //接收方会校验crc，这里按实际发送的数据填写
+    SAProtocolHeader h = header;
+
+    h.dataSize = data.size();
+    h.dataCrc32 = SACRC::crc32(data);
+    SA::write(h, data, this);
 }
 
 
@@ -117,17 +243,7 @@ void SATcpSocket::ensureWrite(const SAProtocolHeader& header, const QByteArray&
  */
 void SATcpSocket::ensureWrite(const SAXMLProtocol& xml, int funid, int sequenceID, uint32_t extendValue)
 {
-    QByteArray data = xml.toByteArray();
-    SAProtocolHeader header;
-
-    header.init();
-    header.protocolFunID = funid;
-    header.dataSize = data.size();
-    header.protocolTypeID = SA::ProtocolTypeXml;
-    header.dataCrc32 = SACRC::crc32(data);
-    header.sequenceID = sequenceID;
-    header.extendValue = extendValue;
-    ensureWrite(header, data);
+    SA::write_xml_protocol(this, &xml, funid, sequenceID, extendValue);
 }
 
 
@@ -157,6 +273,16 @@ void SATcpSocket::requestToken(int pid, const QString& appid)
 }
 
 
+/**
+ * @brief 取消请求
+ * @param sequenceID 需要取消的请求的流水号
+ */
+void SATcpSocket::requestCancel(int sequenceID)
+{
+    SA::request_cancel(this, sequenceID);
+}
+
+
 /**
  * @brief 回复错误给对应端
  * @param sequenceID
@@ -183,88 +309,107 @@ void SATcpSocket::replyError(const SAProtocolHeader& requestHeader, const QStrin
 
 /**
  * @brief readyRead对应的槽函数，处理文件头和数据
+ *
+ * 数据区不等整帧到齐，每次readyRead都把已到达的数据直接读入帧缓冲，
+ * 避免大帧先在QTcpSocket内部缓冲中堆积再拷贝一次，帧缓冲来自@ref SAServeBufferPool
  */
 void SATcpSocket::onReadyRead()
 {
     const static unsigned int s_headerSize = sizeof(SAProtocolHeader);
 
-    if (d_ptr->m_isReadedMainHeader) {
-        //此时已经读取了头
-        if (bytesAvailable() >= d_ptr->m_mainHeader.dataSize) {
-            //说明数据接收完
+    for (;;)
+    {
+        if (!d_ptr->m_isReadedMainHeader) {
+            if (d_ptr->m_transport->device()->bytesAvailable() < s_headerSize) {
+                //包头还未接收完
+                return;
+            }
+            if (!readFromSocket((void *)(&(d_ptr->m_mainHeader)), s_headerSize)) {
+                qDebug() << "can not read from socket" << __LINE__;
+                d_ptr->resetBuffer();
+                d_ptr->m_transport->abort();
+                return;
+            }
 #if SA_SERVE_DEBUG_PRINT_Socket
-            qDebug()	<< " rec Data:"<<bytesAvailable()<< " bytes "
-                    <<"\n header:"<<d_ptr->m_mainHeader
+            qDebug()	<< "readed header from socket"
+                    << ",type:" << d_ptr->m_mainHeader.protocolTypeID
+                    << ",fun:" << d_ptr->m_mainHeader.protocolFunID
+                    << ",size:" << d_ptr->m_mainHeader.dataSize
+                    << ",sequenceID:" << d_ptr->m_mainHeader.sequenceID
             ;
 #endif
-            if ((uint32_t)d_ptr->m_buffer.size() < d_ptr->m_mainHeader.dataSize) {
-                d_ptr->m_buffer.resize(d_ptr->m_mainHeader.dataSize);
+            if (!(d_ptr->m_mainHeader.isValid())) {
+                d_ptr->resetBuffer();
+                qDebug()	<< "receive unknow header[1]"
+                        << "\n" << d_ptr->m_mainHeader;
+                d_ptr->m_transport->abort();
+                return;
             }
-            if (!readFromSocket(d_ptr->m_buffer.data()+d_ptr->m_index, d_ptr->m_mainHeader.dataSize-d_ptr->m_index)) {
+            if (0 == d_ptr->m_mainHeader.dataSize) {
+                //说明文件头之后无数据
+                deal(d_ptr->m_mainHeader, QByteArray());
                 d_ptr->resetBuffer();
-                abort();
-                qDebug() << "socket abort!!!  can not read from socket io!";
+                continue;
+            }
+            if (d_ptr->m_mainHeader.dataSize > SA_SERVE_MAX_FRAME_SIZE) {
+                //尺寸来自对方，不可信，超过上限时不分配内存
+                qDebug()	<< "frame too large:" << d_ptr->m_mainHeader.dataSize
+                        << "\n" << d_ptr->m_mainHeader;
+                d_ptr->resetBuffer();
+                d_ptr->m_transport->abort();
                 return;
             }
-#if SA_SERVE_DEBUG_PRINT_Socket
-            printQByteArray(d_ptr->m_buffer);
-#endif
-            deal(d_ptr->m_mainHeader, d_ptr->m_buffer);
+            //说明文件头之后有数据，分配好内存
+            d_ptr->m_isReadedMainHeader = true;
+            d_ptr->mallocBuffer(d_ptr->m_mainHeader.dataSize);
+        }
+        //把已到达的数据直接读入帧缓冲
+        qint64 readLen = d_ptr->m_transport->device()->read(d_ptr->m_buffer.data() + d_ptr->m_index, d_ptr->m_dataSize - d_ptr->m_index);
+
+        if (readLen < 0) {
             d_ptr->resetBuffer();
-            if (bytesAvailable() >= s_headerSize) {
-                onReadyRead();
-            }
-        }else {
-            //说明一次没把数据接收完
+            d_ptr->m_transport->abort();
+            qDebug() << "socket abort!!!  can not read from socket io!";
+            return;
         }
-    }else if (bytesAvailable() >= s_headerSize) {
-        //说明包头还未接收
-        //但socket收到的数据已经满足包头数据需要的数据
-#if SA_SERVE_DEBUG_PRINT_Socket
-        qDebug() <<"main header may receive:byte available:"<<bytesAvailable();
-#endif
-        if (!readFromSocket((void *)(&(d_ptr->m_mainHeader)), s_headerSize)) {
-            qDebug() << "can not read from socket" << __LINE__;
-            d_ptr->m_isReadedMainHeader = false;
-            abort();
+        d_ptr->m_index += readLen;
+        if (d_ptr->m_index < d_ptr->m_dataSize) {
+            //说明一次没把数据接收完
             return;
         }
 #if SA_SERVE_DEBUG_PRINT_Socket
-        qDebug()	<< "readed header from socket"
-                << ",type:" << d_ptr->m_mainHeader.protocolTypeID
-                << ",fun:" << d_ptr->m_mainHeader.protocolFunID
-                << ",size:" << d_ptr->m_mainHeader.dataSize
-                << ",sequenceID:" << d_ptr->m_mainHeader.sequenceID
+        qDebug()	<< " rec Data:" << d_ptr->m_dataSize << " bytes "
+                << "\n header:" << d_ptr->m_mainHeader
         ;
 #endif
-        d_ptr->m_index = 0; // 不需要mallocBuffer会设置此值
-        if (!(d_ptr->m_mainHeader.isValid())) {
+        if (SACRC::crc32(d_ptr->m_buffer) != d_ptr->m_mainHeader.dataCrc32) {
+            //crc按线上的数据计算，在解压之前校验，错误帧本身出错时不再回复
+            if (SA::ProtocolFunErrorOcc != d_ptr->m_mainHeader.protocolFunID) {
+                replyError(d_ptr->m_mainHeader, tr("payload crc32 mismatch"), SA::ProtocolErrorCrc);
+            }
             d_ptr->resetBuffer();
-            qDebug()	<< "receive unknow header[1]"
-                    << "\n" << d_ptr->m_mainHeader;
-            abort();
-            return;
+            continue;
         }
-
-        if (d_ptr->m_mainHeader.dataSize > 0) {
-            //说明文件头之后有数据
-            d_ptr->m_isReadedMainHeader = true;
-            //分配好内存
-            d_ptr->mallocBuffer(d_ptr->m_mainHeader.dataSize);
+        if (SAProtocolHeader::CodecNone != d_ptr->m_mainHeader.getCodec()) {
+            //压缩的数据区先解压，上层看到的协议头不带编码
+            QByteArray data;
+            if (!SA::decode_payload(d_ptr->m_mainHeader.getCodec(), d_ptr->m_buffer, data)) {
+                //丢弃此帧，回复错误让对方结束这个sequenceID的等待，错误帧本身出错时不再回复，避免互相回复
+                if (SA::ProtocolFunErrorOcc != d_ptr->m_mainHeader.protocolFunID) {
+                    replyError(d_ptr->m_mainHeader
+                        , tr("can not decode payload,codec:%1").arg(d_ptr->m_mainHeader.getCodec())
+                        , SA::ProtocolErrorDecode);
+                }
+                d_ptr->resetBuffer();
+                continue;
+            }
+            d_ptr->m_mainHeader.setCodec(SAProtocolHeader::CodecNone);
+            d_ptr->m_mainHeader.dataSize = data.size();
+            deal(d_ptr->m_mainHeader, data);
         }else {
-            //说明文件头之后无数据
-            deal(d_ptr->m_mainHeader, QByteArray());
-            d_ptr->resetBuffer();
-            d_ptr->m_isReadedMainHeader = false;
-        }
-
-        if (bytesAvailable() > 0) {
-#if SA_SERVE_DEBUG_PRINT_Socket
-            qDebug() << "have avaliable data,size:"<<bytesAvailable()
-            ;
-#endif
-            onReadyRead();
+            deal(d_ptr->m_mainHeader, d_ptr->m_buffer);
         }
+        d_ptr->resetBuffer();
     }
 }
 
@@ -308,6 +453,10 @@ bool SATcpSocket::deal(const SAProtocolHeader& header, const QByteArray& data)
 
     case SA::ProtocolTypeXml:
     {
+        if (SA::ProtocolFunReqCancel == header.protocolFunID) {
+            //取消请求只有协议头
+            return (dealCancel(header));
+        }
         //解析xml协议
         SAXMLProtocol xml;
         if (!xml.fromByteArray(data)) {
@@ -346,18 +495,25 @@ bool SATcpSocket::dealXmlProtocol(const SAProtocolHeader& header, const SAXMLPro
 
     case SA::ProtocolFunReqToken:
     {
-        //接收到获取token请求
+        //接收到获取token请求，同时协商数据区编码
         int pid;
         QString appid;
-        SA::receive_request_token_xml(&xml, pid, appid);
-        return (SA::reply_token_xml(this, header, pid, appid));
+        QStringList codecs;
+        SA::receive_request_token_xml(&xml, pid, appid, codecs);
+        int codec = SA::select_payload_codec(codecs);
+        bool ret = SA::reply_token_xml(this, header, pid, appid, codec);
+        //token回复本身不压缩，之后的数据按协商结果发送
+        setPayloadCodec(codec);
+        return (ret);
     }
 
     case SA::ProtocolFunReplyToken:
     {
         //接收到token应答，发射token内容
         QString token;
-        SA::receive_reply_token_xml(&xml, token);
+        int codec = SAProtocolHeader::CodecNone;
+        SA::receive_reply_token_xml(&xml, token, codec);
+        setPayloadCodec(codec);
         if (!token.isEmpty()) {
             emit receiveToken(token, header.sequenceID);
             return (true);
@@ -370,3 +526,17 @@ bool SATcpSocket::dealXmlProtocol(const SAProtocolHeader& header, const SAXMLPro
     }
     return (false);
 }
+
+
+/**
+ * @brief 处理取消请求，默认不做处理
+ *
+ * 需要支持取消的socket重写此函数，header.sequenceID为需要取消的请求
+ * @param header
+ * @return 返回false代表数据没有处理，返回true代表数据已经被处理
+ */
+bool SATcpSocket::dealCancel(const SAProtocolHeader& header)
+{
+    Q_UNUSED(header);
+    return (false);
+}
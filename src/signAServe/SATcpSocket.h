@@ -2,6 +2,7 @@
 #define SATCPSOCKET_H
 #include <QTcpSocket>
 #include "SAServeGlobal.h"
+#include "SAServeTransport.h"
 #include "SAProtocolHeader.h"
 #include "SAXMLProtocol.h"
 #include <memory>
@@ -10,6 +11,10 @@ class SAAbstractSocketHandle;
 
 /**
  * @brief 针对sa tcp协议的socket封装
+ *
+ * 协议帧的收发只依赖@ref SAServeTransport ，传输层默认为此类本身的tcp连接，
+ * 客户端和服务端位于同一台机器时可以通过@ref setTransport 切换为其他的传输层，例如本地socket，
+ * 协议层的所有读写都通过@ref transport 进行，不要直接调用QTcpSocket的读写函数
  */
 class SASERVE_EXPORT SATcpSocket : public QTcpSocket
 {
@@ -26,11 +31,44 @@ public:
     };
     SATcpSocket(QObject *par = nullptr);
     ~SATcpSocket();
+
+    //传输层，协议帧的读写都通过传输层进行
+    SAServeTransport *transport() const;
+
+    //替换传输层，所有权转移给此类，为nullptr时恢复为tcp
+    void setTransport(SAServeTransport *t);
+
+    //使用已经连接的本地socket作为传输层，socket的所有权转移给此类
+    void setLocalSocket(QLocalSocket *s);
+
+    //连接本地服务作为传输层
+    bool connectToLocalServe(const QString& name, int timeout = 5000);
+
     //从socket读数据
     bool readFromSocket(void *p, int n);
 
+    //发送数据区使用的编码，token握手时协商
+    int getPayloadCodec() const;
+    void setPayloadCodec(int codec);
+
 signals:
 
+    /**
+     * @brief 传输层连接成功，tcp和本地socket都会发射
+     */
+    void transportConnected();
+
+    /**
+     * @brief 传输层断开，tcp和本地socket都会发射
+     */
+    void transportDisconnected();
+
+    /**
+     * @brief 传输层发生错误，tcp和本地socket都会发射
+     * @param err 错误码
+     */
+    void transportError(QAbstractSocket::SocketError err);
+
     /**
      * @brief 接收到心跳
      * @param header 包头
@@ -74,6 +112,9 @@ public slots:
     //发出token请求
     void requestToken(int pid, const QString& appid);
 
+    //取消请求
+    void requestCancel(int sequenceID);
+
     //回复错误给对方
     void replyError(int sequenceID, int extendValue, const QString& msg, int errcode);
 
@@ -89,6 +130,9 @@ protected:
 
     //处理xml相关请求
     virtual bool dealXmlProtocol(const SAProtocolHeader& header, const SAXMLProtocol& xml);
+
+    //处理取消请求
+    virtual bool dealCancel(const SAProtocolHeader& header);
 };
 
 #endif // SATCPSOCKET_H
@@ -27,8 +27,11 @@ HEADERS += \
     SAAbstractServe.h \
     SATcpDataProcessSocket.h \
     SATcpSocket.h \
+    SAServeTransport.h \
     SATcpServe.h \
     SAServeShareMemory.h \
+    SAServeSharedBuffer.h \
+    SAServeBufferPool.h \
     SATcpClient.h \
     SAServerDefine.h \
     SAServeHandleFun.h
@@ -39,8 +42,11 @@ SOURCES += \
     SAAbstractServe.cpp \
     SATcpDataProcessSocket.cpp \
     SATcpSocket.cpp \
+    SAServeTransport.cpp \
     SATcpServe.cpp \
     SAServeShareMemory.cpp \
+    SAServeSharedBuffer.cpp \
+    SAServeBufferPool.cpp \
     SATcpClient.cpp \
     SAServeHandleFun.cpp
 
@@ -0,0 +1,114 @@
+#ifndef SAPARALLEL_H
+#define SAPARALLEL_H
+#include <QtGlobal>
+#include <QRunnable>
+#include <QThreadPool>
+#include <QThread>
+#include <QSemaphore>
+#include <QAtomicInt>
+#include <memory>
+#include <functional>
+
+namespace SA {
+
+///
+/// \brief 按工作量计算分段数
+/// \param work 总工作量
+/// \param minChunk 每段至少处理的工作量
+/// \return 分段数，范围为[1,线程数]
+///
+inline int parallelPartCount(qint64 work, qint64 minChunk)
+{
+    const qint64 parts = work / qMax<qint64>(minChunk,1);
+    return static_cast<int>(qBound<qint64>(1,parts,qMax(QThread::idealThreadCount(),1)));
+}
+
+///
+/// \brief 并行计算的共享状态，线程池中尚未开始的任务可能在parallelFor返回后才运行，因此用智能指针持有
+///
+class SAParallelState
+{
+public:
+    SAParallelState(int parts):m_parts(parts),m_next(0),m_done(0),m_finished(0)
+    {
+    }
+    ///
+    /// \brief 领取并执行剩余的分段，直到全部领取完
+    /// \param fp 只在领取到分段时调用，领取结束后不再访问
+    ///
+    void work(const std::function<void(int)>* fp)
+    {
+        int p = m_next.fetchAndAddOrdered(1);
+        while(p < m_parts)
+        {
+            (*fp)(p);
+            if(m_done.fetchAndAddOrdered(1) + 1 == m_parts)
+            {
+                m_finished.release();
+            }
+            p = m_next.fetchAndAddOrdered(1);
+        }
+    }
+    void wait()
+    {
+        m_finished.acquire();
+    }
+private:
+    const int m_parts;
+    QAtomicInt m_next;
+    QAtomicInt m_done;
+    QSemaphore m_finished;
+};
+
+///
+/// \brief 线程池任务，领取\sa SAParallelState 的分段执行
+///
+class SAParallelTask : public QRunnable
+{
+public:
+    SAParallelTask(const std::shared_ptr<SAParallelState>& state,const std::function<void(int)>* fp)
+        :m_state(state)
+        ,m_fp(fp)
+    {
+    }
+    virtual void run()
+    {
+        m_state->work(m_fp);
+    }
+private:
+    std::shared_ptr<SAParallelState> m_state;
+    const std::function<void(int)>* m_fp;
+};
+
+///
+/// \brief 把parts段任务分派到全局线程池执行，全部完成后返回
+///
+/// 调用线程也领取分段执行，线程池繁忙（例如调用者本身就在线程池中）时由调用线程完成剩余分段，不会死锁。
+/// 各段之间不能有写冲突
+/// \param parts 分段数
+/// \param fp 参数为段号[0,parts)
+///
+template<typename Fp>
+void parallelFor(int parts, Fp fp)
+{
+    if(parts <= 1)
+    {
+        fp(0);
+        return;
+    }
+    std::shared_ptr<SAParallelState> state = std::make_shared<SAParallelState>(parts);
+    //只有领取到分段的任务才会调用fun，而领取在全部完成前结束，因此可以引用局部变量
+    std::function<void(int)> fun = [&fp](int p){
+        fp(p);
+    };
+    for(int p=0;p<parts-1;++p)
+    {
+        QThreadPool::globalInstance()->start(new SAParallelTask(state,&fun));
+    }
+    state->work(&fun);
+    state->wait();
+}
+
+}
+
+#endif // SAPARALLEL_H
@@ -3,5 +3,6 @@ DEPENDPATH += $$PWD
 
 HEADERS += \
         $$PWD/SAUtilGlobal.H\
-        $$PWD/SAAlgorithm.h
+        $$PWD/SAAlgorithm.h\
+        $$PWD/SAParallel.h
         
\ No newline at end of file
@@ -35,7 +35,8 @@ HEADERS += \
         $$PWD/SAAlgorithm.h \
         SAColorAlgorithm.h \
         SAQtSeriesAlgorithm.h \
-        SASeriesAlgorithm.h
+        SASeriesAlgorithm.h \
+        SAParallel.h
 
 
 
@@ -0,0 +1,125 @@
+#include <QCoreApplication>
+#include <QDebug>
+#include <string.h>
+#include "SAServeSharedBuffer.h"
+//测试用的共享内存key，避免和正在运行的程序冲突
+#define TST_SHARED_BUFFER_KEY QStringLiteral("tst_saservesharedbuffer")
+#define TST_SLOT_COUNT 4
+#define TST_SLOT_SIZE 4096
+#define TST_CHECK(cond) \
+    do{ \
+        if(!(cond)){ \
+            qDebug() << "check failed:" << #cond << " line:" << __LINE__; \
+            ++s_failed; \
+        } \
+    }while(0)
+
+static int s_failed = 0;
+void test_slot_round_trip();
+void test_slot_reuse();
+void test_segment_round_trip();
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    test_slot_round_trip();
+    test_slot_reuse();
+    test_segment_round_trip();
+    qDebug() <<"done, failed:" << s_failed;
+    return (s_failed == 0 ? 0 : 1);
+}
+
+///
+/// \brief 一个实例写入，另一个实例attach后读取，双方释放后槽被回收
+///
+void test_slot_round_trip()
+{
+    SAServeSharedBuffer writer(TST_SLOT_COUNT,TST_SLOT_SIZE,TST_SHARED_BUFFER_KEY);
+    SAServeSharedBuffer reader(TST_SLOT_COUNT,TST_SLOT_SIZE,TST_SHARED_BUFFER_KEY);
+    TST_CHECK(writer.isAttach());
+    TST_CHECK(reader.isAttach());
+    TST_CHECK(reader.slotCapacity() == TST_SLOT_COUNT*TST_SLOT_SIZE);
+    //跨两个槽
+    const int n = (TST_SLOT_SIZE + 100)/sizeof(double);
+    SAServeSharedBufferHandle h = writer.acquire(n*sizeof(double),SAServeSharedBufferHandle::TypeDouble);
+    TST_CHECK(h.isValid());
+    TST_CHECK(h.segment == 0);
+    TST_CHECK(h.elementCount() == n);
+    double* w = static_cast<double*>(writer.data(h));
+    for(int i=0;i<n;++i)
+    {
+        w[i] = i*0.5;
+    }
+    TST_CHECK(reader.retain(h));
+    const double* r = static_cast<const double*>(reader.constData(h));
+    TST_CHECK(r != nullptr);
+    if(r)
+    {
+        TST_CHECK(memcmp(r,w,n*sizeof(double)) == 0);
+    }
+    TST_CHECK(writer.release(h));
+    //还有一个引用，数据依然有效
+    TST_CHECK(reader.constData(h) != nullptr);
+    TST_CHECK(reader.release(h));
+    TST_CHECK(reader.constData(h) == nullptr);
+    TST_CHECK(!reader.retain(h));
+}
+
+///
+/// \brief 槽被回收后重新申请，代号加1，旧句柄失效
+///
+void test_slot_reuse()
+{
+    SAServeSharedBuffer buffer(TST_SLOT_COUNT,TST_SLOT_SIZE,TST_SHARED_BUFFER_KEY);
+    SAServeSharedBuffer other(TST_SLOT_COUNT,TST_SLOT_SIZE,TST_SHARED_BUFFER_KEY);
+    //占满所有的槽，必然从0号槽开始
+    SAServeSharedBufferHandle old = buffer.acquire(buffer.slotCapacity(),SAServeSharedBufferHandle::TypeDouble);
+    TST_CHECK(old.isValid());
+    TST_CHECK(old.slotID == 0);
+    TST_CHECK(buffer.release(old));
+    SAServeSharedBufferHandle h = other.acquire(TST_SLOT_SIZE*TST_SLOT_COUNT,SAServeSharedBufferHandle::TypeDouble);
+    TST_CHECK(h.slotID == old.slotID);
+    TST_CHECK(h.generation == old.generation+1);
+    TST_CHECK(!buffer.retain(old));
+    TST_CHECK(buffer.constData(old) == nullptr);
+    TST_CHECK(other.release(h));
+}
+
+///
+/// \brief 超过槽序列的数据放在单独的共享内存段
+///
+void test_segment_round_trip()
+{
+    SAServeSharedBuffer writer(TST_SLOT_COUNT,TST_SLOT_SIZE,TST_SHARED_BUFFER_KEY);
+    SAServeSharedBuffer reader(TST_SLOT_COUNT,TST_SLOT_SIZE,TST_SHARED_BUFFER_KEY);
+    TST_CHECK(writer.capacity() > writer.slotCapacity());
+    const uint64_t bytes = writer.slotCapacity()*4;
+    SAServeSharedBufferHandle h = writer.acquire(bytes,SAServeSharedBufferHandle::TypeDouble);
+    TST_CHECK(h.isValid());
+    TST_CHECK(h.segment != 0);
+    TST_CHECK(h.length == bytes);
+    unsigned char* w = static_cast<unsigned char*>(writer.data(h));
+    TST_CHECK(w != nullptr);
+    if(nullptr == w)
+    {
+        return;
+    }
+    for(uint64_t i=0;i<bytes;++i)
+    {
+        w[i] = (unsigned char)(i%251);
+    }
+    TST_CHECK(reader.retain(h));
+    TST_CHECK(writer.release(h));
+    const unsigned char* r = static_cast<const unsigned char*>(reader.constData(h));
+    TST_CHECK(r != nullptr);
+    if(r)
+    {
+        TST_CHECK(r[bytes-1] == (unsigned char)((bytes-1)%251));
+    }
+    TST_CHECK(reader.release(h));
+    TST_CHECK(reader.constData(h) == nullptr);
+    TST_CHECK(!reader.retain(h));
+    //新的段编号不同
+    SAServeSharedBufferHandle h2 = writer.acquire(bytes,SAServeSharedBufferHandle::TypeDouble);
+    TST_CHECK(h2.segment != h.segment);
+    TST_CHECK(writer.release(h2));
+}
@@ -0,0 +1,24 @@
+QT += core
+QT -= gui
+CONFIG += c++11
+
+TARGET = tst_saservesharedbuffer
+CONFIG += console
+CONFIG -= app_bundle
+
+TEMPLATE = app
+
+CONFIG(debug, debug|release){
+    DESTDIR = $$PWD/../../bin_qt$$[QT_VERSION]_test_debug
+}else {
+    DESTDIR = $$PWD/../../bin_qt$$[QT_VERSION]_test_release
+}
+
+SOURCES += main.cpp
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+#sa api support
+include($$PWD/../../signALib/signALib.pri)
+include($$PWD/../../signAProtocol/signAProtocol.pri)
+include($$PWD/../../signAServe/signAServe.pri)